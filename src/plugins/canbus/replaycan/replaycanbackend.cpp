@@ -0,0 +1,174 @@
+/****************************************************************************
+**
+** Copyright (C) 2021 The Qt Company Ltd.
+** Contact: http://www.qt.io/licensing/
+**
+** This file is part of the QtSerialBus module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL3$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see http://www.qt.io/terms-conditions. For further
+** information use the contact form at http://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPLv3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or later as published by the Free
+** Software Foundation and appearing in the file LICENSE.GPL included in
+** the packaging of this file. Please review the following information to
+** ensure the GNU General Public License version 2.0 requirements will be
+** met: http://www.gnu.org/licenses/gpl-2.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include "replaycanbackend.h"
+
+#include <QtCore/qloggingcategory.h>
+
+#include <cmath>
+#include <limits>
+
+QT_BEGIN_NAMESPACE
+
+Q_DECLARE_LOGGING_CATEGORY(QT_CANBUS_PLUGINS_REPLAYCAN)
+
+enum {
+    // Frames handed to the application per event loop iteration.
+    MaximumBatchSize = 4096
+};
+
+ReplayCanBackend::ReplayCanBackend(const QString &fileName, QObject *parent)
+    : QCanBusDevice(parent)
+    , m_fileName(fileName)
+{
+    m_timer.setSingleShot(true);
+    m_timer.setTimerType(Qt::PreciseTimer);
+    connect(&m_timer, &QTimer::timeout, this, &ReplayCanBackend::replayFrames);
+    m_batch.reserve(MaximumBatchSize);
+}
+
+ReplayCanBackend::~ReplayCanBackend()
+{
+    m_timer.stop();
+}
+
+bool ReplayCanBackend::open()
+{
+    if (!m_reader.open(m_fileName)) {
+        setError(m_reader.errorString(), QCanBusDevice::CanBusError::ConnectionError);
+        return false;
+    }
+
+    const QVariant speed = configurationParameter(QCanBusDevice::ConfigurationKey(SpeedKey));
+    m_speed = speed.isValid() ? qMax(0.0, speed.toDouble()) : 1.0;
+
+    const qint64 offset = configurationParameter(
+        QCanBusDevice::ConfigurationKey(StartOffsetKey)).toLongLong();
+    if (offset > 0)
+        m_reader.seek(m_reader.startTime() + offset);
+
+    qCDebug(QT_CANBUS_PLUGINS_REPLAYCAN, "Replaying %llu frames of %ls at speed %g.",
+            m_reader.frameCount(), qUtf16Printable(m_fileName), m_speed);
+
+    m_origin = m_reader.nextTimeStamp();
+    m_clock.start();
+    setState(QCanBusDevice::ConnectedState);
+    scheduleNextFrame();
+    return true;
+}
+
+void ReplayCanBackend::close()
+{
+    m_timer.stop();
+    m_reader.close();
+    setState(QCanBusDevice::UnconnectedState);
+}
+
+void ReplayCanBackend::setConfigurationParameter(ConfigurationKey key, const QVariant &value)
+{
+    if (key == QCanBusDevice::ConfigurationKey(SpeedKey)) {
+        bool ok = false;
+        const double speed = value.toDouble(&ok);
+        if (!ok || speed < 0.0) {
+            setError(tr("Invalid replay speed %1.").arg(value.toString()),
+                     QCanBusDevice::CanBusError::ConfigurationError);
+            return;
+        }
+        m_speed = speed;
+        if (state() == ConnectedState) {
+            // Continue from the current position with the new speed.
+            m_origin = m_reader.nextTimeStamp();
+            m_clock.start();
+            scheduleNextFrame();
+        }
+    }
+    QCanBusDevice::setConfigurationParameter(key, value);
+}
+
+bool ReplayCanBackend::writeFrame(const QCanBusFrame &frame)
+{
+    Q_UNUSED(frame);
+    setError(tr("Cannot write frames to a replayed frame log."),
+             QCanBusDevice::CanBusError::WriteError);
+    return false;
+}
+
+QString ReplayCanBackend::interpretErrorFrame(const QCanBusFrame &errorFrame)
+{
+    Q_UNUSED(errorFrame);
+    return QString();
+}
+
+void ReplayCanBackend::replayFrames()
+{
+    // Time stamps are in microseconds, scale the elapsed wall time by the speed.
+    const qint64 due = m_speed > 0.0
+        ? m_origin + qint64(double(m_clock.nsecsElapsed() / 1000) * m_speed)
+        : std::numeric_limits<qint64>::max();
+
+    m_batch.clear();
+    while (m_batch.size() < MaximumBatchSize && !m_reader.atEnd()
+           && m_reader.nextTimeStamp() <= due) {
+        m_batch.append(QCanBusFrame());
+        m_reader.readFrame(&m_batch.last());
+    }
+    if (!m_batch.isEmpty())
+        enqueueReceivedFrames(m_batch);
+
+    if (m_reader.atEnd()) {
+        qCDebug(QT_CANBUS_PLUGINS_REPLAYCAN, "Replay of %ls finished.",
+                qUtf16Printable(m_fileName));
+        return;
+    }
+    scheduleNextFrame();
+}
+
+void ReplayCanBackend::scheduleNextFrame()
+{
+    m_timer.stop();
+    if (m_reader.atEnd())
+        return;
+    if (m_speed <= 0.0) {
+        m_timer.start(0);
+        return;
+    }
+
+    const double elapsed = double(m_clock.nsecsElapsed() / 1000);
+    const double delay = double(m_reader.nextTimeStamp() - m_origin) / m_speed - elapsed;
+    m_timer.start(delay > 0.0 ? int(qMin(std::ceil(delay / 1000.0), 1000.0 * 3600)) : 0);
+}
+
+QT_END_NAMESPACE
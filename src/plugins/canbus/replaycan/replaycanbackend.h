@@ -0,0 +1,88 @@
+/****************************************************************************
+**
+** Copyright (C) 2021 The Qt Company Ltd.
+** Contact: http://www.qt.io/licensing/
+**
+** This file is part of the QtSerialBus module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL3$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see http://www.qt.io/terms-conditions. For further
+** information use the contact form at http://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPLv3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or later as published by the Free
+** Software Foundation and appearing in the file LICENSE.GPL included in
+** the packaging of this file. Please review the following information to
+** ensure the GNU General Public License version 2.0 requirements will be
+** met: http://www.gnu.org/licenses/gpl-2.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#ifndef REPLAYCANBACKEND_H
+#define REPLAYCANBACKEND_H
+
+#include <QtSerialBus/qcanbusdevice.h>
+#include <QtSerialBus/qcanbusframe.h>
+#include <QtSerialBus/qcanbusframelog.h>
+
+#include <QtCore/qelapsedtimer.h>
+#include <QtCore/qlist.h>
+#include <QtCore/qtimer.h>
+
+QT_BEGIN_NAMESPACE
+
+class ReplayCanBackend : public QCanBusDevice
+{
+    Q_OBJECT
+    Q_DISABLE_COPY(ReplayCanBackend)
+
+public:
+    enum ReplayKey {
+        SpeedKey = QCanBusDevice::UserKey,
+        StartOffsetKey
+    };
+
+    explicit ReplayCanBackend(const QString &fileName, QObject *parent = nullptr);
+    ~ReplayCanBackend() override;
+
+    bool open() override;
+    void close() override;
+
+    void setConfigurationParameter(ConfigurationKey key, const QVariant &value) override;
+
+    bool writeFrame(const QCanBusFrame &frame) override;
+
+    QString interpretErrorFrame(const QCanBusFrame &errorFrame) override;
+
+private:
+    void replayFrames();
+    void scheduleNextFrame();
+
+    QString m_fileName;
+    QCanBusFrameLogReader m_reader;
+    QTimer m_timer;
+    QElapsedTimer m_clock;
+    QList<QCanBusFrame> m_batch;
+    qint64 m_origin = 0;        // time stamp of the first replayed frame
+    double m_speed = 1.0;       // 0 replays as fast as possible
+};
+
+QT_END_NAMESPACE
+
+#endif // REPLAYCANBACKEND_H
@@ -39,6 +39,8 @@
 #include "libsocketcan.h"
 
 #include <QtSerialBus/qcanbusdevice.h>
+#include <QtSerialBus/qcanisotpchannel.h>
+#include <QtSerialBus/qcanj1939channel.h>
 
 #include <QtCore/qdatastream.h>
 #include <QtCore/qdebug.h>
@@ -76,6 +78,8 @@ const char typeC[]        = "/type";
 const char virtualC[]     = "virtual";
 
 enum {
+    IsoTpMessageBufferSize = 4095,
+    J1939MessageBufferSize = 65536,
     CanFlexibleDataRateMtu = 72,
     TypeSocketCan = 280,
     DeviceIsActive = 1
@@ -218,16 +222,48 @@ bool SocketCanBackend::open()
 
 void SocketCanBackend::close()
 {
+    // the notifier may live in the receive thread, it must be destroyed there
+    runInReceiveThread([this]() {
+        delete notifier;
+        notifier = nullptr;
+    });
+    stopReceiveThread();
+
     ::close(canSocket);
     canSocket = -1;
 
     setState(QCanBusDevice::UnconnectedState);
 }
 
+static bool isMessageProtocolKey(QCanBusDevice::ConfigurationKey key)
+{
+    return (key >= int(QCanIsoTpChannel::TransmitIdKey)
+            && key <= int(QCanIsoTpChannel::BitrateSwitchKey))
+        || key == int(QCanJ1939Channel::NameKey) || key == int(QCanJ1939Channel::AddressKey);
+}
+
+static quint8 isoTpSeparationTime(int usecs)
+{
+    if (usecs <= 0)
+        return 0x00;
+    if (usecs <= 900)
+        return quint8(0xf0 + (usecs + 99) / 100);
+    return quint8(qMin((usecs + 999) / 1000, 127));
+}
+
 bool SocketCanBackend::applyConfigurationParameter(ConfigurationKey key, const QVariant &value)
 {
     bool success = false;
 
+    if (isMessageProtocol() && key != QCanBusDevice::BitRateKey) {
+        // ISO-TP and J1939 options are applied before the socket is bound.
+        setError(tr("Cannot change configuration key %1 of a connected %2 socket.")
+                     .arg(key).arg(protocol == CAN_ISOTP ? QLatin1String("ISO-TP")
+                                                         : QLatin1String("J1939")),
+                 QCanBusDevice::CanBusError::ConfigurationError);
+        return false;
+    }
+
     switch (key) {
     case QCanBusDevice::LoopbackKey:
     {
@@ -361,11 +397,81 @@ bool SocketCanBackend::applyConfigurationParameter(ConfigurationKey key, const Q
     return success;
 }
 
+bool SocketCanBackend::applyIsoTpOptions()
+{
+    const QVariant paddingByte = configurationParameter(QCanBusDevice::ConfigurationKey(
+        QCanIsoTpChannel::PaddingByteKey));
+    const int padding = paddingByte.isValid() ? paddingByte.toInt() : -1;
+    can_isotp_options options = {};
+    if (padding >= 0) {
+        options.flags |= CAN_ISOTP_TX_PADDING;
+        options.txpad_content = quint8(padding);
+    }
+    if (Q_UNLIKELY(setsockopt(canSocket, SOL_CAN_ISOTP, CAN_ISOTP_OPTS,
+                              &options, sizeof(options)) < 0)) {
+        setError(qt_error_string(errno), QCanBusDevice::CanBusError::ConfigurationError);
+        return false;
+    }
+
+    can_isotp_fc_options flowControl = {};
+    flowControl.bs = quint8(configurationParameter(QCanBusDevice::ConfigurationKey(
+        QCanIsoTpChannel::BlockSizeKey)).toInt());
+    flowControl.stmin = isoTpSeparationTime(configurationParameter(
+        QCanBusDevice::ConfigurationKey(QCanIsoTpChannel::SeparationTimeKey)).toInt());
+    if (Q_UNLIKELY(setsockopt(canSocket, SOL_CAN_ISOTP, CAN_ISOTP_RECV_FC,
+                              &flowControl, sizeof(flowControl)) < 0)) {
+        setError(qt_error_string(errno), QCanBusDevice::CanBusError::ConfigurationError);
+        return false;
+    }
+
+    if (canFdOptionEnabled) {
+        can_isotp_ll_options linkLayer = {};
+        linkLayer.mtu = CANFD_MTU;
+        linkLayer.tx_dl = CANFD_MAX_DLEN;
+        if (configurationParameter(QCanBusDevice::ConfigurationKey(
+                QCanIsoTpChannel::BitrateSwitchKey)).toBool()) {
+            linkLayer.tx_flags = CANFD_BRS;
+        }
+        if (Q_UNLIKELY(setsockopt(canSocket, SOL_CAN_ISOTP, CAN_ISOTP_LL_OPTS,
+                                  &linkLayer, sizeof(linkLayer)) < 0)) {
+            setError(qt_error_string(errno), QCanBusDevice::CanBusError::ConfigurationError);
+            return false;
+        }
+    }
+    return true;
+}
+
+bool SocketCanBackend::applyJ1939Options()
+{
+#ifdef SOL_CAN_J1939
+    const int broadcast = 1;
+    if (Q_UNLIKELY(setsockopt(canSocket, SOL_SOCKET, SO_BROADCAST,
+                              &broadcast, sizeof(broadcast)) < 0)) {
+        setError(qt_error_string(errno), QCanBusDevice::CanBusError::ConfigurationError);
+        return false;
+    }
+
+    const QVariant address = configurationParameter(QCanBusDevice::ConfigurationKey(
+        QCanJ1939Channel::AddressKey));
+    m_address.can_addr.j1939.name = configurationParameter(QCanBusDevice::ConfigurationKey(
+        QCanJ1939Channel::NameKey)).toULongLong();
+    m_address.can_addr.j1939.addr = address.isValid() ? quint8(address.toUInt()) : J1939_NO_ADDR;
+    m_address.can_addr.j1939.pgn = J1939_NO_PGN;
+    m_j1939Priority = -1;
+    return true;
+#else
+    setError(tr("J1939 sockets are not supported by this build."),
+             QCanBusDevice::CanBusError::ConnectionError);
+    return false;
+#endif
+}
+
 bool SocketCanBackend::connectSocket()
 {
     struct ifreq interface;
 
-    if (Q_UNLIKELY((canSocket = socket(PF_CAN, SOCK_RAW | SOCK_NONBLOCK, protocol)) < 0)) {
+    const int type = isMessageProtocol() ? SOCK_DGRAM : SOCK_RAW;
+    if (Q_UNLIKELY((canSocket = socket(PF_CAN, type | SOCK_NONBLOCK, protocol)) < 0)) {
         setError(qt_error_string(errno),
                  QCanBusDevice::CanBusError::ConnectionError);
         return false;
@@ -381,6 +487,44 @@ bool SocketCanBackend::connectSocket()
     m_address.can_family  = AF_CAN;
     m_address.can_ifindex = interface.ifr_ifindex;
 
+    if (protocol == CAN_ISOTP) {
+        if (!applyIsoTpOptions())
+            return false;
+
+        // Without a channel, the frame format follows from the identifiers.
+        const QVariant extended = configurationParameter(QCanBusDevice::ConfigurationKey(
+            QCanIsoTpChannel::ExtendedFrameFormatKey));
+        m_messageExtendedFrameFormat = extended.isValid()
+            ? extended.toBool()
+            : configurationParameter(QCanBusDevice::ConfigurationKey(
+                  QCanIsoTpChannel::TransmitIdKey)).toUInt() > CAN_SFF_MASK
+              || configurationParameter(QCanBusDevice::ConfigurationKey(
+                  QCanIsoTpChannel::ReceiveIdKey)).toUInt() > CAN_SFF_MASK;
+        const auto isoTpId = [this](QCanIsoTpChannel::ConfigurationKey key) {
+            const canid_t id = configurationParameter(QCanBusDevice::ConfigurationKey(key))
+                .toUInt();
+            return m_messageExtendedFrameFormat ? ((id & CAN_EFF_MASK) | CAN_EFF_FLAG)
+                                                : (id & CAN_SFF_MASK);
+        };
+        m_address.can_addr.tp.tx_id = isoTpId(QCanIsoTpChannel::TransmitIdKey);
+        m_address.can_addr.tp.rx_id = isoTpId(QCanIsoTpChannel::ReceiveIdKey);
+    } else if (protocol == CAN_J1939 && !applyJ1939Options()) {
+        return false;
+    }
+    if (protocol == CAN_ISOTP) {
+        // Without a channel, the classic ISO-TP limit applies. Longer messages are reported.
+        const QVariant maximumSize = configurationParameter(QCanBusDevice::ConfigurationKey(
+            QCanIsoTpChannel::MaximumMessageSizeKey));
+        m_messageBuffer.resize(maximumSize.isValid() ? qMax(1LL, maximumSize.toLongLong())
+                                                     : IsoTpMessageBufferSize);
+    } else if (protocol == CAN_J1939) {
+        m_messageBuffer.resize(J1939MessageBufferSize);
+    }
+    if (isMessageProtocol()) {
+        m_messageReceiveId = configurationParameter(QCanBusDevice::ConfigurationKey(
+            QCanIsoTpChannel::ReceiveIdKey)).toUInt();
+    }
+
     if (Q_UNLIKELY(bind(canSocket, reinterpret_cast<struct sockaddr *>(&m_address), sizeof(m_address)) < 0)) {
         setError(qt_error_string(errno),
                  QCanBusDevice::CanBusError::ConnectionError);
@@ -393,15 +537,20 @@ bool SocketCanBackend::connectSocket()
     m_msg.msg_iovlen = 1;
     m_msg.msg_control = &m_ctrlmsg;
 
-    delete notifier;
-
-    notifier = new QSocketNotifier(canSocket, QSocketNotifier::Read, this);
-    connect(notifier, &QSocketNotifier::activated,
-            this, &SocketCanBackend::readSocket);
+    // With the receive thread enabled, the notifier and thus readSocket() run in that thread.
+    startReceiveThread();
+    runInReceiveThread([this]() {
+        notifier = new QSocketNotifier(canSocket, QSocketNotifier::Read);
+        connect(notifier, &QSocketNotifier::activated,
+                this, &SocketCanBackend::readSocket, Qt::DirectConnection);
+    });
 
     //apply all stored configurations
     const auto keys = configurationKeys();
     for (ConfigurationKey key : keys) {
+        // the ISO-TP and J1939 options were applied before binding, raw socket options do not apply
+        if (isMessageProtocol() && key != QCanBusDevice::BitRateKey)
+            continue;
         const QVariant param = configurationParameter(key);
         bool success = applyConfigurationParameter(key, param);
         if (Q_UNLIKELY(!success)) {
@@ -449,10 +598,13 @@ void SocketCanBackend::setConfigurationParameter(ConfigurationKey key, const QVa
             qCWarning(QT_CANBUS_PLUGINS_SOCKETCAN, "%ls", qUtf16Printable(errorString));
             return;
         }
-        protocol = newProtocol;
+        // the protocol of a connected socket cannot change, see the error below
+        if (canSocket == -1)
+            protocol = newProtocol;
     }
     // connected & params not applyable/invalid
-    if (canSocket != -1 && !applyConfigurationParameter(key, value))
+    if (canSocket != -1 && (!isMessageProtocolKey(key) || isMessageProtocol())
+            && !applyConfigurationParameter(key, value))
         return;
 
     QCanBusDevice::setConfigurationParameter(key, value);
@@ -467,6 +619,20 @@ bool SocketCanBackend::writeFrame(const QCanBusFrame &newData)
     if (state() != ConnectedState)
         return false;
 
+    if (protocol == CAN_J1939)
+        return writeJ1939Message(newData);
+
+    if (protocol == CAN_ISOTP) {
+        // The frame carries a whole ISO-TP message, the kernel segments it.
+        const QByteArray message = newData.payload();
+        if (Q_UNLIKELY(::write(canSocket, message.constData(), message.size()) < 0)) {
+            setError(qt_error_string(errno), QCanBusDevice::CanBusError::WriteError);
+            return false;
+        }
+        emit framesWritten(1);
+        return true;
+    }
+
     if (Q_UNLIKELY(!newData.isValid())) {
         setError(tr("Cannot write invalid QCanBusFrame"), QCanBusDevice::WriteError);
         return false;
@@ -683,8 +849,106 @@ QString SocketCanBackend::interpretErrorFrame(const QCanBusFrame &errorFrame)
     return errorMsg;
 }
 
+bool SocketCanBackend::writeJ1939Message(const QCanBusFrame &message)
+{
+#ifdef SOL_CAN_J1939
+    // The frame carries a whole J1939 message, the kernel runs the transport protocol.
+    const quint32 id = message.frameId();
+    const int priority = QCanJ1939Channel::priority(id);
+    if (priority != m_j1939Priority) {
+        if (Q_UNLIKELY(setsockopt(canSocket, SOL_CAN_J1939, SO_J1939_SEND_PRIO,
+                                  &priority, sizeof(priority)) < 0)) {
+            setError(qt_error_string(errno), QCanBusDevice::CanBusError::WriteError);
+            return false;
+        }
+        m_j1939Priority = priority;
+    }
+
+    sockaddr_can destination = {};
+    destination.can_family = AF_CAN;
+    destination.can_ifindex = m_address.can_ifindex;
+    destination.can_addr.j1939.name = J1939_NO_NAME;
+    destination.can_addr.j1939.pgn = QCanJ1939Channel::parameterGroupNumber(id);
+    destination.can_addr.j1939.addr = QCanJ1939Channel::destinationAddress(id);
+
+    const QByteArray payload = message.payload();
+    if (Q_UNLIKELY(::sendto(canSocket, payload.constData(), payload.size(), 0,
+                            reinterpret_cast<sockaddr *>(&destination),
+                            sizeof(destination)) < 0)) {
+        setError(qt_error_string(errno), QCanBusDevice::CanBusError::WriteError);
+        return false;
+    }
+    emit framesWritten(1);
+    return true;
+#else
+    Q_UNUSED(message);
+    return false;
+#endif
+}
+
+void SocketCanBackend::readMessageSocket()
+{
+    QList<QCanBusFrame> newFrames;
+
+    // the source address of J1939 messages is needed, do not overwrite the bound address
+    m_msg.msg_name = &m_addr;
+    for (;;) {
+        m_iov.iov_base = m_messageBuffer.data();
+        m_iov.iov_len = m_messageBuffer.size();
+        m_msg.msg_namelen = sizeof(m_addr);
+        m_msg.msg_controllen = sizeof(m_ctrlmsg);
+        m_msg.msg_flags = 0;
+
+        const ssize_t bytesReceived = ::recvmsg(canSocket, &m_msg, 0);
+        if (bytesReceived <= 0)
+            break;
+        if (Q_UNLIKELY(m_msg.msg_flags & MSG_TRUNC)) {
+            setError(tr("ERROR SocketCanBackend: message longer than %1 bytes dropped")
+                         .arg(m_messageBuffer.size()),
+                     QCanBusDevice::CanBusError::ReadError);
+            continue;
+        }
+
+        struct timeval timeStamp = {};
+        gettimeofday(&timeStamp, nullptr);
+
+        quint32 frameId = m_messageReceiveId;
+#ifdef SOL_CAN_J1939
+        if (protocol == CAN_J1939) {
+            quint8 destination = J1939_NO_ADDR;
+            quint8 priority = 6;
+            for (cmsghdr *cmsg = CMSG_FIRSTHDR(&m_msg); cmsg; cmsg = CMSG_NXTHDR(&m_msg, cmsg)) {
+                if (cmsg->cmsg_level != SOL_CAN_J1939)
+                    continue;
+                if (cmsg->cmsg_type == SCM_J1939_DEST_ADDR)
+                    destination = *CMSG_DATA(cmsg);
+                else if (cmsg->cmsg_type == SCM_J1939_PRIO)
+                    priority = *CMSG_DATA(cmsg);
+            }
+            frameId = QCanJ1939Channel::frameId(m_addr.can_addr.j1939.pgn, priority,
+                                                m_addr.can_addr.j1939.addr, destination);
+        }
+#endif
+
+        QCanBusFrame message(frameId, QByteArray(m_messageBuffer.constData(), bytesReceived));
+        message.setExtendedFrameFormat(protocol == CAN_J1939 || m_messageExtendedFrameFormat);
+        message.setTimeStamp(QCanBusFrame::TimeStamp(timeStamp.tv_sec, timeStamp.tv_usec));
+        newFrames.append(std::move(message));
+    }
+
+    // restore the buffers used for raw frames
+    m_iov.iov_base = &m_frame;
+    m_msg.msg_name = &m_address;
+    enqueueReceivedFrames(newFrames);
+}
+
 void SocketCanBackend::readSocket()
 {
+    if (isMessageProtocol()) {
+        readMessageSocket();
+        return;
+    }
+
     QList<QCanBusFrame> newFrames;
 
     for (;;) {
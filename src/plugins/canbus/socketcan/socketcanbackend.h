@@ -78,6 +78,45 @@ struct canfd_frame {
 
 #endif
 
+#if __has_include(<linux/can/isotp.h>)
+#include <linux/can/isotp.h>
+#endif
+
+// The J1939 socket address was added by Linux kernel 5.4 and cannot be redefined,
+// J1939 sockets are only supported when building against newer kernel headers.
+#if __has_include(<linux/can/j1939.h>)
+#include <linux/can/j1939.h>
+#endif
+
+#ifndef SOL_CAN_ISOTP
+// The ISO-TP socket header was added by Linux kernel 5.10
+// For prior kernels we redefine the missing defines here
+// they are taken from linux/can/isotp.h
+#define SOL_CAN_ISOTP (SOL_CAN_BASE + CAN_ISOTP)
+#define CAN_ISOTP_OPTS 1
+#define CAN_ISOTP_RECV_FC 2
+#define CAN_ISOTP_LL_OPTS 5
+#define CAN_ISOTP_TX_PADDING 0x004
+struct can_isotp_options {
+    __u32 flags;
+    __u32 frame_txtime;
+    __u8  ext_address;
+    __u8  txpad_content;
+    __u8  rxpad_content;
+    __u8  rx_ext_address;
+};
+struct can_isotp_fc_options {
+    __u8  bs;
+    __u8  stmin;
+    __u8  wftmax;
+};
+struct can_isotp_ll_options {
+    __u8  mtu;
+    __u8  tx_dl;
+    __u8  tx_flags;
+};
+#endif
+
 QT_BEGIN_NAMESPACE
 
 class LibSocketCan;
@@ -107,6 +146,11 @@ private:
     void resetConfigurations();
     bool connectSocket();
     bool applyConfigurationParameter(ConfigurationKey key, const QVariant &value);
+    bool isMessageProtocol() const { return protocol == CAN_ISOTP || protocol == CAN_J1939; }
+    bool applyIsoTpOptions();
+    bool applyJ1939Options();
+    void readMessageSocket();
+    bool writeJ1939Message(const QCanBusFrame &message);
     void resetController();
     bool hasBusStatus() const;
     QCanBusDevice::CanBusStatus busStatus() const;
@@ -117,7 +161,14 @@ private:
     msghdr m_msg;
     iovec m_iov;
     sockaddr_can m_addr;
-    char m_ctrlmsg[CMSG_SPACE(sizeof(timeval)) + CMSG_SPACE(sizeof(__u32))];
+    // Raw sockets pass a time stamp and the drop counter, J1939 sockets the destination
+    // address, destination NAME and priority of each message.
+    char m_ctrlmsg[CMSG_SPACE(sizeof(timeval)) + CMSG_SPACE(sizeof(__u32))
+                   + 2 * CMSG_SPACE(sizeof(__u8)) + CMSG_SPACE(sizeof(__u64))];
+    QByteArray m_messageBuffer;
+    quint32 m_messageReceiveId = 0;
+    bool m_messageExtendedFrameFormat = false;
+    int m_j1939Priority = -1;
 
     qint64 canSocket = -1;
     QSocketNotifier *notifier = nullptr;
@@ -39,6 +39,7 @@
 #include <QtCore/qdatetime.h>
 #include <QtCore/qloggingcategory.h>
 #include <QtCore/qregularexpression.h>
+#include <QtCore/qthread.h>
 
 #include <QtNetwork/qtcpserver.h>
 #include <QtNetwork/qtcpsocket.h>
@@ -194,6 +195,10 @@ VirtualCanBackend::VirtualCanBackend(const QString &interface, QObject *parent)
 
 VirtualCanBackend::~VirtualCanBackend()
 {
+    if (hasReceiveThread()) {
+        runInReceiveThread([this]() { delete m_clientSocket; });
+        stopReceiveThread();
+    }
     qCDebug(QT_CANBUS_PLUGINS_VIRTUALCAN, "Client [%p] socket destructed.", this);
 }
 
@@ -208,11 +213,19 @@ bool VirtualCanBackend::open()
     if (address.isLoopback())
         g_server->start(port);
 
-    m_clientSocket = new QTcpSocket(this);
-    m_clientSocket->connectToHost(address, port, QIODevice::ReadWrite);
-    connect(m_clientSocket, &QAbstractSocket::connected, this, &VirtualCanBackend::clientConnected);
-    connect(m_clientSocket, &QAbstractSocket::disconnected, this, &VirtualCanBackend::clientDisconnected);
-    connect(m_clientSocket, &QIODevice::readyRead, this, &VirtualCanBackend::clientReadyRead);
+    // With the receive thread enabled, the socket lives in that thread. The frames are parsed
+    // there, while the state changes are still handled in the thread of the device.
+    QThread *ioThread = startReceiveThread();
+    runInReceiveThread([this, ioThread, address, port]() {
+        m_clientSocket = new QTcpSocket(ioThread ? nullptr : this);
+        m_clientSocket->connectToHost(address, port, QIODevice::ReadWrite);
+        connect(m_clientSocket, &QAbstractSocket::connected,
+                this, &VirtualCanBackend::clientConnected);
+        connect(m_clientSocket, &QAbstractSocket::disconnected,
+                this, &VirtualCanBackend::clientDisconnected);
+        connect(m_clientSocket, &QIODevice::readyRead,
+                this, &VirtualCanBackend::clientReadyRead, Qt::DirectConnection);
+    });
     qCDebug(QT_CANBUS_PLUGINS_VIRTUALCAN, "Client [%p] socket created.", this);
     return true;
 }
@@ -221,7 +234,7 @@ void VirtualCanBackend::close()
 {
     qCDebug(QT_CANBUS_PLUGINS_VIRTUALCAN, "Client [%p] sends disconnect to server.", this);
 
-    m_clientSocket->write("disconnect:can" + QByteArray::number(m_channel) + '\n');
+    writeToServer("disconnect:can" + QByteArray::number(m_channel) + '\n');
 }
 
 void VirtualCanBackend::setConfigurationParameter(ConfigurationKey key, const QVariant &value)
@@ -280,7 +293,7 @@ bool VirtualCanBackend::writeFrame(const QCanBusFrame &frame)
     const QByteArray frameId = QByteArray::number(frame.frameId());
     const QByteArray command = "can" + QByteArray::number(m_channel)
             + ':' + frameId + '#' + flags + '#' + frame.payload().toHex() + '\n';
-    m_clientSocket->write(command);
+    writeToServer(command);
 
     if (configurationParameter(QCanBusDevice::ReceiveOwnKey).toBool()) {
         const qint64 timeStamp = QDateTime::currentDateTime().toMSecsSinceEpoch();
@@ -317,7 +330,7 @@ QList<QCanBusDeviceInfo> VirtualCanBackend::interfaces()
 void VirtualCanBackend::clientConnected()
 {
     qCInfo(QT_CANBUS_PLUGINS_VIRTUALCAN, "Client [%p] socket connected.", this);
-    m_clientSocket->write("connect:can" + QByteArray::number(m_channel) + '\n');
+    writeToServer("connect:can" + QByteArray::number(m_channel) + '\n');
 
     setState(QCanBusDevice::ConnectedState);
 }
@@ -326,9 +339,29 @@ void VirtualCanBackend::clientDisconnected()
 {
     qCInfo(QT_CANBUS_PLUGINS_VIRTUALCAN, "Client [%p] socket disconnected.", this);
 
+    if (hasReceiveThread()) {
+        runInReceiveThread([this]() {
+            delete m_clientSocket;
+            m_clientSocket = nullptr;
+        });
+        stopReceiveThread();
+    }
+
     setState(UnconnectedState);
 }
 
+void VirtualCanBackend::writeToServer(const QByteArray &data)
+{
+    if (m_clientSocket->thread() == QThread::currentThread()) {
+        m_clientSocket->write(data);
+        return;
+    }
+
+    QTcpSocket *socket = m_clientSocket;
+    QMetaObject::invokeMethod(socket, [socket, data]() { socket->write(data); },
+                              Qt::QueuedConnection);
+}
+
 void VirtualCanBackend::clientReadyRead()
 {
     while (m_clientSocket->canReadLine()) {
@@ -94,6 +94,7 @@ private:
     void clientConnected();
     void clientDisconnected();
     void clientReadyRead();
+    void writeToServer(const QByteArray &data);
 
     QUrl m_url;
     uint m_channel = 0;
@@ -47,6 +47,17 @@
 #include <QtCore/qscopedvaluerollback.h>
 #include <QtCore/qtimer.h>
 
+#include <algorithm>
+#include <chrono>
+#include <iterator>
+
+#if defined(Q_OS_LINUX)
+#include <pthread.h>
+#include <sched.h>
+#elif defined(Q_OS_WIN)
+#include <qt_windows.h>
+#endif
+
 QT_BEGIN_NAMESPACE
 
 Q_LOGGING_CATEGORY(QT_CANBUS, "qt.canbus")
@@ -255,12 +266,23 @@ QCanBusDevice::QCanBusDevice(QObject *parent) :
     CAN bus implementations must use this function to update the device's
     error state.
 
-    \sa error(), errorOccurred(), clearError()
+    Since Qt 6.1, this function may also be called from the receive thread. The
+    error is then set and errorOccurred() emitted in the thread the device
+    lives in.
+
+    \sa error(), errorOccurred(), clearError(), startReceiveThread()
 */
 void QCanBusDevice::setError(const QString &errorText, CanBusError errorId)
 {
     Q_D(QCanBusDevice);
 
+    if (Q_UNLIKELY(QThread::currentThread() != thread())) {
+        QMetaObject::invokeMethod(this, [this, errorText, errorId]() {
+            setError(errorText, errorId);
+        }, Qt::QueuedConnection);
+        return;
+    }
+
     d->errorText = errorText;
     d->lastError = errorId;
 
@@ -290,6 +312,10 @@ void QCanBusDevice::clearError()
     accessed using \l readFrame() and emits the \l framesReceived()
     signal.
 
+    In the \l {ReceiveMode}{conflated receive mode}, \a newFrames replace
+    the latest frame stored for their frame id instead, and the signal is only
+    emitted if no changed frame was waiting to be read.
+
     Subclasses must call this function when they receive frames.
 
 */
@@ -300,10 +326,20 @@ void QCanBusDevice::enqueueReceivedFrames(const QList<QCanBusFrame> &newFrames)
     if (Q_UNLIKELY(newFrames.isEmpty()))
         return;
 
+    bool notify = true;
     d->incomingFramesGuard.lock();
-    d->incomingFrames.append(newFrames);
+    // Recording under the lock serializes it with resetStatistics() on other threads.
+    if (QCanBusStatisticsRecorder *recorder = d->statistics.load(std::memory_order_acquire))
+        recorder->record(newFrames);
+    if (d->receiveMode == ReceiveMode::Conflated) {
+        notify = d->changedFrames.isEmpty();
+        d->conflateFrames(newFrames);
+    } else {
+        d->incomingFrames.append(newFrames);
+    }
     d->incomingFramesGuard.unlock();
-    emit framesReceived();
+    if (notify)
+        emit framesReceived();
 }
 
 /*!
@@ -385,6 +421,13 @@ void QCanBusDevice::setConfigurationParameter(ConfigurationKey key, const QVaria
 {
     Q_D(QCanBusDevice);
 
+    if (QCanBusStatisticsRecorder *recorder = d->statistics.load(std::memory_order_relaxed)) {
+        if (key == BitRateKey)
+            recorder->setBitRate(value.toUInt());
+        else if (key == DataBitRateKey)
+            recorder->setDataBitRate(value.toUInt());
+    }
+
     for (int i = 0; i < d->configOptions.size(); i++) {
         if (d->configOptions.at(i).first == key) {
             if (value.isValid()) {
@@ -471,11 +514,19 @@ QString QCanBusDevice::errorString() const
     Returns the number of available frames. If no frames are available,
     this function returns 0.
 
+    In the \l {ReceiveMode}{conflated receive mode}, this is the number of
+    frame ids that changed since their latest frame was last read.
+
     \sa clear(), readFrame(), readAllFrames()
 */
 qint64 QCanBusDevice::framesAvailable() const
 {
-    return d_func()->incomingFrames.size();
+    Q_D(const QCanBusDevice);
+
+    QMutexLocker locker(&d->incomingFramesGuard);
+    if (d->receiveMode == ReceiveMode::Conflated)
+        return d->changedFrames.size();
+    return d->incomingFrames.size();
 }
 
 /*!
@@ -493,6 +544,104 @@ qint64 QCanBusDevice::framesToWrite() const
     return d_func()->outgoingFrames.size();
 }
 
+/*!
+    \since 6.1
+    \enum QCanBusDevice::ReceiveMode
+
+    This enum describes how received frames are made available for reading.
+
+    \value Queued       Every received frame is appended to a queue, which is
+                        read in FIFO order. This is the default.
+    \value Conflated    Only the latest frame of every frame id is kept. Reading
+                        returns the latest frame of each frame id that changed
+                        since it was last read. Frames are kept apart by frame
+                        id, frame format and frame type; error frames are kept
+                        apart by their \l {QCanBusFrame::error()}{error classes}.
+
+    In the conflated mode, memory use and read latency depend on the number of
+    frame ids on the bus rather than on the bus load. This suits consumers that
+    only display the current value of each signal, for example dashboards.
+
+    \sa setReceiveMode()
+*/
+
+/*!
+    \since 6.1
+
+    Sets the receive mode of the device to \a mode.
+
+    When switching to the \l {ReceiveMode}{Conflated} mode, the frames still
+    queued are conflated. When switching back to the \l {ReceiveMode}{Queued}
+    mode, the latest frames of all frame ids that changed since they were last
+    read are queued, and all other latest frames are dropped.
+
+    In the conflated mode, the framesReceived() signal is only emitted when a
+    frame id changes while no other changed frame is waiting to be read.
+    Consumers should therefore read all changed frames with readAllFrames() in
+    response to the signal.
+
+    \sa receiveMode(), latestFrame(), readAllFrames()
+*/
+void QCanBusDevice::setReceiveMode(ReceiveMode mode)
+{
+    Q_D(QCanBusDevice);
+
+    QMutexLocker locker(&d->incomingFramesGuard);
+
+    if (d->receiveMode == mode)
+        return;
+
+    if (mode == ReceiveMode::Conflated) {
+        d->conflateFrames(d->incomingFrames);
+        d->incomingFrames.clear();
+    } else {
+        d->incomingFrames = d->takeChangedFrames();
+        d->latestFrameSlots.clear();
+        d->latestFrames.clear();
+    }
+    d->receiveMode = mode;
+}
+
+/*!
+    \since 6.1
+
+    Returns the receive mode of the device.
+
+    \sa setReceiveMode()
+*/
+QCanBusDevice::ReceiveMode QCanBusDevice::receiveMode() const
+{
+    return d_func()->receiveMode;
+}
+
+/*!
+    \since 6.1
+
+    Returns the latest data frame received with the frame id \a frameId,
+    whether or not it was read already; otherwise returns an invalid
+    QCanBusFrame. If \a extendedFrameFormat is \c true, \a frameId is a 29 bit
+    identifier; otherwise it is an 11 bit identifier.
+
+    The latest frames are only kept in the \l {ReceiveMode}{conflated receive
+    mode}. Calling this function does not change the set of changed frames.
+
+    \sa setReceiveMode()
+*/
+QCanBusFrame QCanBusDevice::latestFrame(QCanBusFrame::FrameId frameId,
+                                        bool extendedFrameFormat) const
+{
+    Q_D(const QCanBusDevice);
+
+    QMutexLocker locker(&d->incomingFramesGuard);
+
+    const qsizetype index = d->latestFrameSlots.value(
+                QCanBusDevicePrivate::latestFrameKey(frameId, extendedFrameFormat,
+                                                     QCanBusFrame::DataFrame), -1);
+    if (index < 0)
+        return QCanBusFrame(QCanBusFrame::InvalidFrame);
+    return d->latestFrames.at(index).frame;
+}
+
 /*!
     \since 5.14
 
@@ -606,14 +755,328 @@ void QCanBusDevice::clear(QCanBusDevice::Directions direction)
     clearError();
 
     if (direction & Direction::Input) {
-        QMutexLocker(&d->incomingFramesGuard);
+        QMutexLocker locker(&d->incomingFramesGuard);
         d->incomingFrames.clear();
+        for (qsizetype index : qAsConst(d->changedFrames))
+            d->latestFrames[index].changed = false;
+        d->changedFrames.clear();
     }
 
     if (direction & Direction::Output)
         d->outgoingFrames.clear();
 }
 
+/*!
+    \since 6.1
+
+    Enables the statistics stage on the receive path if \a enabled is \c true;
+    otherwise disables it. Statistics are disabled by default.
+
+    While enabled, every frame passed to enqueueReceivedFrames() is accounted
+    before it is queued for reading. Enabling the statistics resets them; the
+    first call allocates a fixed size table for the per frame id counters, after
+    that recording a frame never allocates memory. Disabling the statistics
+    keeps the values gathered so far.
+
+    \sa statistics(), frameIdStatistics(), resetStatistics()
+*/
+void QCanBusDevice::setStatisticsEnabled(bool enabled)
+{
+    Q_D(QCanBusDevice);
+
+    QCanBusStatisticsRecorder *recorder = d->statistics.load(std::memory_order_relaxed);
+    if (!recorder) {
+        if (!enabled)
+            return;
+        recorder = new QCanBusStatisticsRecorder;
+        recorder->setBitRate(configurationParameter(BitRateKey).toUInt());
+        recorder->setDataBitRate(configurationParameter(DataBitRateKey).toUInt());
+        d->statistics.store(recorder, std::memory_order_release);
+    }
+    QMutexLocker locker(&d->incomingFramesGuard);
+    recorder->setEnabled(enabled);
+}
+
+/*!
+    \since 6.1
+
+    Returns \c true if the statistics stage on the receive path is enabled;
+    otherwise returns \c false.
+
+    \sa setStatisticsEnabled()
+*/
+bool QCanBusDevice::isStatisticsEnabled() const
+{
+    const QCanBusStatisticsRecorder *recorder =
+            d_func()->statistics.load(std::memory_order_acquire);
+    return recorder && recorder->isEnabled();
+}
+
+/*!
+    \since 6.1
+
+    Returns the bus load and frame counters gathered since the statistics were
+    enabled or resetStatistics() was last called.
+
+    The bus time of a frame is calculated from its exact length on the wire,
+    including stuff bits, the CRC field and the interframe space. It requires
+    the \l BitRateKey, and for CAN FD frames with bit rate switch the
+    \l DataBitRateKey, configuration parameters to be set; frames received
+    while the bit rate is unknown do not add to the bus time.
+
+    Reading the statistics does not take a lock, so this function may be called
+    from any thread. Each counter is read atomically, but the counters of a
+    snapshot taken while frames are arriving can be slightly out of step.
+
+    \sa frameIdStatistics(), setStatisticsEnabled(), QCanBusDeviceStatistics
+*/
+QCanBusDeviceStatistics QCanBusDevice::statistics() const
+{
+    if (const auto recorder = d_func()->statistics.load(std::memory_order_acquire))
+        return recorder->snapshot();
+    return QCanBusDeviceStatistics();
+}
+
+/*!
+    \since 6.1
+
+    Returns the statistics of every frame id seen since the statistics were
+    enabled or resetStatistics() was last called, ordered by frame format and
+    frame id.
+
+    The counters are kept in a table of fixed size that holds a few thousand
+    frame ids. Frames with an id that does not fit anymore are only counted in
+    QCanBusDeviceStatistics::untrackedFrames.
+
+    Like statistics(), this function may be called from any thread.
+
+    \sa QCanBusFrameIdStatistics
+*/
+QList<QCanBusFrameIdStatistics> QCanBusDevice::frameIdStatistics() const
+{
+    if (const auto recorder = d_func()->statistics.load(std::memory_order_acquire))
+        return recorder->frameIdSnapshot();
+    return {};
+}
+
+/*!
+    \since 6.1
+    \overload
+
+    Returns the statistics of the frame id \a frameId. If \a extendedFrameFormat
+    is \c true, the statistics of the 29 bit identifier are returned; otherwise
+    those of the 11 bit identifier. If no such frame was seen, the returned
+    statistics have a \l {QCanBusFrameIdStatistics::}{frames} count of zero.
+*/
+QCanBusFrameIdStatistics QCanBusDevice::frameIdStatistics(QCanBusFrame::FrameId frameId,
+                                                          bool extendedFrameFormat) const
+{
+    if (const auto recorder = d_func()->statistics.load(std::memory_order_acquire))
+        return recorder->frameIdSnapshot(frameId, extendedFrameFormat);
+
+    QCanBusFrameIdStatistics result;
+    result.frameId = frameId;
+    result.extendedFrameFormat = extendedFrameFormat;
+    return result;
+}
+
+/*!
+    \since 6.1
+
+    Sets all statistics of the device back to zero and forgets all frame ids.
+    The reset waits for frames that are being recorded at the same time, so it
+    is safe while frames are received on the receive thread.
+
+    \sa statistics(), frameIdStatistics(), setReceiveThreadEnabled()
+*/
+void QCanBusDevice::resetStatistics()
+{
+    Q_D(QCanBusDevice);
+
+    if (const auto recorder = d->statistics.load(std::memory_order_relaxed)) {
+        QMutexLocker locker(&d->incomingFramesGuard);
+        recorder->reset();
+    }
+}
+
+/*!
+    \since 6.1
+
+    Enables reading frames on an internal receive thread if \a enabled is
+    \c true; otherwise frames are read in the thread the device lives in,
+    which is the default. The setting takes effect the next time the device
+    is connected.
+
+    With the receive thread enabled, a stalled owner thread, for example a GUI
+    thread busy repainting, does not keep the plugin from draining the CAN
+    driver, so frames are not lost to an overflowing driver buffer. Received
+    frames are added to the thread-safe queue of the device. The signals of
+    the device are still delivered to receivers in the thread the device lives
+    in, unless they are connected with Qt::DirectConnection.
+
+    \note Only plugins that support it use the receive thread; currently the
+    \c socketcan and \c virtualcan plugins. Other plugins ignore this setting.
+    Use hasReceiveThread() to check whether a connected device reads frames on
+    the receive thread.
+
+    \sa setReceiveThreadPriority(), setReceiveThreadAffinity()
+*/
+void QCanBusDevice::setReceiveThreadEnabled(bool enabled)
+{
+    d_func()->receiveThreadEnabled = enabled;
+}
+
+/*!
+    \since 6.1
+
+    Returns \c true if frames are to be read on an internal receive thread;
+    otherwise returns \c false.
+
+    \sa setReceiveThreadEnabled(), hasReceiveThread()
+*/
+bool QCanBusDevice::isReceiveThreadEnabled() const
+{
+    return d_func()->receiveThreadEnabled;
+}
+
+/*!
+    \since 6.1
+
+    Sets the \a priority the receive thread is started with. The default is
+    QThread::InheritPriority. The setting takes effect the next time the
+    receive thread is started.
+
+    \sa setReceiveThreadEnabled(), QThread::start()
+*/
+void QCanBusDevice::setReceiveThreadPriority(QThread::Priority priority)
+{
+    d_func()->receiveThreadPriority = priority;
+}
+
+/*!
+    \since 6.1
+
+    Returns the priority the receive thread is started with.
+
+    \sa setReceiveThreadPriority()
+*/
+QThread::Priority QCanBusDevice::receiveThreadPriority() const
+{
+    return d_func()->receiveThreadPriority;
+}
+
+/*!
+    \since 6.1
+
+    Restricts the receive thread to the CPUs with the zero-based indexes in
+    \a cpus. An empty list, the default, lets the operating system schedule the
+    thread on any CPU. The setting takes effect the next time the receive
+    thread is started.
+
+    \note CPU affinity is supported on Linux and Windows. On other platforms,
+    and if the affinity cannot be applied, a warning is logged and the thread
+    runs on any CPU.
+
+    \sa setReceiveThreadEnabled()
+*/
+void QCanBusDevice::setReceiveThreadAffinity(const QList<int> &cpus)
+{
+    d_func()->receiveThreadAffinity = cpus;
+}
+
+/*!
+    \since 6.1
+
+    Returns the CPUs the receive thread is restricted to, or an empty list if
+    it may run on any CPU.
+
+    \sa setReceiveThreadAffinity()
+*/
+QList<int> QCanBusDevice::receiveThreadAffinity() const
+{
+    return d_func()->receiveThreadAffinity;
+}
+
+/*!
+    \since 6.1
+
+    Returns \c true if the receive thread is running, which is the case while
+    a plugin that supports it is connected with the receive thread enabled;
+    otherwise returns \c false.
+
+    \sa setReceiveThreadEnabled()
+*/
+bool QCanBusDevice::hasReceiveThread() const
+{
+    return d_func()->receiveThread != nullptr;
+}
+
+/*!
+    \since 6.1
+
+    Starts the receive thread if it is enabled and not running yet, and returns
+    it. Returns \c nullptr if the receive thread is disabled.
+
+    Plugins that support the receive thread call this function from open() and
+    create the objects that read from the CAN driver in the returned thread,
+    for example by using runInReceiveThread(). Reading code running in the
+    receive thread may call enqueueReceivedFrames() and setError(), but must
+    not call any other function of QCanBusDevice.
+
+    \sa stopReceiveThread(), setReceiveThreadEnabled()
+*/
+QThread *QCanBusDevice::startReceiveThread()
+{
+    Q_D(QCanBusDevice);
+
+    if (!d->receiveThreadEnabled)
+        return nullptr;
+
+    if (!d->receiveThread) {
+        d->receiveThread = new QCanBusReceiveThread(d->receiveThreadAffinity);
+        d->receiveThread->setObjectName(QStringLiteral("QCanBusDevice receive thread"));
+        d->receiveThreadContext = new QObject;
+        d->receiveThreadContext->moveToThread(d->receiveThread);
+        d->receiveThread->start(d->receiveThreadPriority);
+    }
+    return d->receiveThread;
+}
+
+/*!
+    \since 6.1
+
+    Stops the receive thread and waits for it to finish. Plugins call this
+    function from close(), after they destroyed the objects they created in the
+    receive thread.
+
+    \sa startReceiveThread()
+*/
+void QCanBusDevice::stopReceiveThread()
+{
+    d_func()->stopReceiveThread();
+}
+
+/*!
+    \since 6.1
+
+    Calls \a function in the receive thread and waits until it returns. If the
+    receive thread is not running, \a function is called directly. This makes
+    it possible to write the setup and teardown of a plugin's reading objects
+    once for both modes.
+
+    \sa startReceiveThread()
+*/
+void QCanBusDevice::runInReceiveThread(const std::function<void()> &function)
+{
+    Q_D(QCanBusDevice);
+
+    if (!d->receiveThread || QThread::currentThread() == d->receiveThread) {
+        function();
+        return;
+    }
+    QMetaObject::invokeMethod(d->receiveThreadContext, function, Qt::BlockingQueuedConnection);
+}
+
 /*!
     For buffered devices, this function waits until all buffered frames
     have been written to the device and the \l framesWritten() signal has been emitted,
@@ -692,6 +1155,10 @@ bool QCanBusDevice::waitForFramesWritten(int msecs)
     signal is emitted; otherwise returns \c false (if the operation timed out
     or if an error occurred).
 
+    In the \l {ReceiveMode}{conflated receive mode}, framesReceived() is not
+    emitted while changed frames are waiting to be read. This function then
+    returns \c true immediately.
+
     \note This function will start a local event loop. This may lead to scenarios whereby
     other application slots may be called while the execution of this function scope is blocking.
     To avoid problems, the signals for this class should not be connected to slots.
@@ -720,6 +1187,11 @@ bool QCanBusDevice::waitForFramesReceived(int msecs)
         return false;
     }
 
+    if (receiveMode() == ReceiveMode::Conflated && framesAvailable() > 0) {
+        clearError();
+        return true;
+    }
+
     QScopedValueRollback<bool> guard(d_func()->waitForReceivedEntered);
     d_func()->waitForReceivedEntered = true;
 
@@ -790,6 +1262,9 @@ bool QCanBusDevice::waitForFramesReceived(int msecs)
 
     The queue operates according to the FIFO principle.
 
+    In the \l {ReceiveMode}{conflated receive mode}, returns the latest frame
+    of the frame id that changed first since it was last read.
+
     \sa clear(), framesAvailable(), readAllFrames()
 */
 QCanBusFrame QCanBusDevice::readFrame()
@@ -807,6 +1282,9 @@ QCanBusFrame QCanBusDevice::readFrame()
 
     QMutexLocker locker(&d->incomingFramesGuard);
 
+    if (d->receiveMode == ReceiveMode::Conflated)
+        return d->takeChangedFrame();
+
     if (Q_UNLIKELY(d->incomingFrames.isEmpty()))
         return QCanBusFrame(QCanBusFrame::InvalidFrame);
 
@@ -820,6 +1298,10 @@ QCanBusFrame QCanBusDevice::readFrame()
 
     The queue operates according to the FIFO principle.
 
+    In the \l {ReceiveMode}{conflated receive mode}, returns the latest frame
+    of every frame id that changed since it was last read, in the order the
+    frame ids changed.
+
     \sa clear(), framesAvailable(), readFrame()
 */
 QList<QCanBusFrame> QCanBusDevice::readAllFrames()
@@ -837,6 +1319,9 @@ QList<QCanBusFrame> QCanBusDevice::readAllFrames()
 
     QMutexLocker locker(&d->incomingFramesGuard);
 
+    if (d->receiveMode == ReceiveMode::Conflated)
+        return d->takeChangedFrames();
+
     QList<QCanBusFrame> result;
     result.swap(d->incomingFrames);
     return result;
@@ -1026,4 +1511,693 @@ QCanBusDeviceInfo QCanBusDevice::createDeviceInfo(const QString &name, const QSt
     return QCanBusDeviceInfo(*info.take());
 }
 
+void QCanBusReceiveThread::run()
+{
+    if (!m_cpus.isEmpty()) {
+#if defined(Q_OS_LINUX)
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        for (int cpu : qAsConst(m_cpus)) {
+            if (cpu >= 0 && cpu < CPU_SETSIZE)
+                CPU_SET(cpu, &set);
+        }
+        const int result = pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+        if (Q_UNLIKELY(result != 0)) {
+            qCWarning(QT_CANBUS, "Cannot set the affinity of the receive thread: %ls",
+                      qUtf16Printable(qt_error_string(result)));
+        }
+#elif defined(Q_OS_WIN)
+        DWORD_PTR mask = 0;
+        for (int cpu : qAsConst(m_cpus)) {
+            if (cpu >= 0 && cpu < int(sizeof(mask) * 8))
+                mask |= DWORD_PTR(1) << cpu;
+        }
+        if (Q_UNLIKELY(!SetThreadAffinityMask(GetCurrentThread(), mask))) {
+            qCWarning(QT_CANBUS, "Cannot set the affinity of the receive thread: %ls",
+                      qUtf16Printable(qt_error_string()));
+        }
+#else
+        qCWarning(QT_CANBUS, "Setting the affinity of the receive thread is not supported "
+                             "on this platform.");
+#endif
+    }
+    exec();
+}
+
+void QCanBusDevicePrivate::stopReceiveThread()
+{
+    if (!receiveThread)
+        return;
+
+    receiveThread->quit();
+    receiveThread->wait();
+    delete receiveThreadContext;
+    receiveThreadContext = nullptr;
+    delete receiveThread;
+    receiveThread = nullptr;
+}
+
+quint32 QCanBusDevicePrivate::latestFrameKey(const QCanBusFrame &frame)
+{
+    if (frame.frameType() == QCanBusFrame::ErrorFrame)
+        return latestFrameKey(quint32(frame.error()), false, QCanBusFrame::ErrorFrame);
+    return latestFrameKey(frame.frameId(), frame.hasExtendedFrameFormat(), frame.frameType());
+}
+
+quint32 QCanBusDevicePrivate::latestFrameKey(QCanBusFrame::FrameId frameId,
+                                             bool extendedFrameFormat,
+                                             QCanBusFrame::FrameType type)
+{
+    quint32 key = frameId & 0x1fffffffu;
+    if (extendedFrameFormat)
+        key |= 0x80000000u;
+    if (type == QCanBusFrame::RemoteRequestFrame)
+        key |= 0x40000000u;
+    else if (type == QCanBusFrame::ErrorFrame)
+        key |= 0x20000000u;
+    return key;
+}
+
+void QCanBusDevicePrivate::conflateFrames(const QList<QCanBusFrame> &frames)
+{
+    for (const QCanBusFrame &frame : frames) {
+        const quint32 key = latestFrameKey(frame);
+        qsizetype index = latestFrameSlots.value(key, -1);
+        if (index < 0) {
+            index = latestFrames.size();
+            latestFrameSlots.insert(key, index);
+            latestFrames.append(LatestFrame());
+        }
+
+        LatestFrame &latest = latestFrames[index];
+        latest.frame = frame;
+        if (!latest.changed) {
+            latest.changed = true;
+            changedFrames.append(index);
+        }
+    }
+}
+
+QCanBusFrame QCanBusDevicePrivate::takeChangedFrame()
+{
+    if (changedFrames.isEmpty())
+        return QCanBusFrame(QCanBusFrame::InvalidFrame);
+
+    LatestFrame &latest = latestFrames[changedFrames.takeFirst()];
+    latest.changed = false;
+    return latest.frame;
+}
+
+QList<QCanBusFrame> QCanBusDevicePrivate::takeChangedFrames()
+{
+    QList<QCanBusFrame> result;
+    result.reserve(changedFrames.size());
+    for (qsizetype index : qAsConst(changedFrames)) {
+        LatestFrame &latest = latestFrames[index];
+        latest.changed = false;
+        result.append(latest.frame);
+    }
+    changedFrames.clear();
+    return result;
+}
+
+/*!
+    \class QCanBusDeviceStatistics
+    \inmodule QtSerialBus
+    \since 6.1
+
+    \brief The QCanBusDeviceStatistics struct holds the bus load and frame
+    counters of a \l QCanBusDevice.
+
+    \sa QCanBusDevice::statistics(), QCanBusFrameIdStatistics
+*/
+
+/*!
+    \variable QCanBusDeviceStatistics::ErrorClassCount
+
+    The number of entries in \l errorFramesByClass.
+*/
+
+/*!
+    \variable QCanBusDeviceStatistics::frames
+
+    The number of data and remote request frames received.
+*/
+
+/*!
+    \variable QCanBusDeviceStatistics::remoteRequestFrames
+
+    The number of remote request frames received.
+*/
+
+/*!
+    \variable QCanBusDeviceStatistics::flexibleDataRateFrames
+
+    The number of CAN FD frames received.
+*/
+
+/*!
+    \variable QCanBusDeviceStatistics::untrackedFrames
+
+    The number of frames that are included in \l frames, but could not be
+    accounted to their frame id because the table of frame ids was full.
+*/
+
+/*!
+    \variable QCanBusDeviceStatistics::errorFrames
+
+    The number of error frames received.
+*/
+
+/*!
+    \variable QCanBusDeviceStatistics::errorFramesByClass
+
+    The number of error frames received per error class. Entry \c i counts the
+    error frames whose \l QCanBusFrame::error() contains the flag \c{1 << i},
+    for example entry 6 counts \l QCanBusFrame::BusOffError. An error frame
+    can have several flags set.
+*/
+
+/*!
+    \variable QCanBusDeviceStatistics::nominalBits
+
+    The number of bits transmitted at the nominal bit rate, including stuff
+    bits and the interframe space.
+*/
+
+/*!
+    \variable QCanBusDeviceStatistics::dataBits
+
+    The number of bits transmitted at the data bit rate in the data phase of
+    CAN FD frames with bit rate switch, including stuff bits.
+*/
+
+/*!
+    \variable QCanBusDeviceStatistics::busTimeNSecs
+
+    The time in nanoseconds the received frames occupied the bus.
+*/
+
+/*!
+    \variable QCanBusDeviceStatistics::elapsedNSecs
+
+    The time in nanoseconds the statistics were enabled since they were last
+    reset.
+*/
+
+/*!
+    Returns the fraction of time the bus was occupied by the received frames,
+    a value between \c 0 and \c 1, or \c 0 if no time has elapsed.
+
+    The value is an average over \l elapsedNSecs. To get the current bus load,
+    subtract the \l busTimeNSecs and \l elapsedNSecs of an earlier snapshot.
+*/
+double QCanBusDeviceStatistics::busLoad() const
+{
+    if (elapsedNSecs <= 0)
+        return 0.0;
+    return qMin(1.0, double(busTimeNSecs) / double(elapsedNSecs));
+}
+
+/*!
+    \class QCanBusFrameIdStatistics
+    \inmodule QtSerialBus
+    \since 6.1
+
+    \brief The QCanBusFrameIdStatistics struct holds the counters and timing
+    of a single CAN frame id.
+
+    Times are taken from the \l {QCanBusFrame::timeStamp()}{time stamp} of the
+    received frames. For frames without a time stamp the system time at the
+    moment the frame is queued is used instead.
+
+    \sa QCanBusDevice::frameIdStatistics()
+*/
+
+/*!
+    \variable QCanBusFrameIdStatistics::frameId
+
+    The frame id the statistics belong to.
+*/
+
+/*!
+    \variable QCanBusFrameIdStatistics::extendedFrameFormat
+
+    \c true if \l frameId is a 29 bit identifier; \c false if it is an 11 bit
+    identifier.
+*/
+
+/*!
+    \variable QCanBusFrameIdStatistics::frames
+
+    The number of data and remote request frames received with this id.
+*/
+
+/*!
+    \variable QCanBusFrameIdStatistics::bits
+
+    The number of bits the frames with this id occupied on the bus, including
+    stuff bits and the interframe space.
+*/
+
+/*!
+    \variable QCanBusFrameIdStatistics::busTimeNSecs
+
+    The time in nanoseconds the frames with this id occupied the bus.
+*/
+
+/*!
+    \variable QCanBusFrameIdStatistics::firstSeenUSecs
+
+    The time stamp in microseconds of the first frame with this id.
+*/
+
+/*!
+    \variable QCanBusFrameIdStatistics::lastSeenUSecs
+
+    The time stamp in microseconds of the last frame with this id.
+*/
+
+/*!
+    \variable QCanBusFrameIdStatistics::minIntervalUSecs
+
+    The shortest time in microseconds between two consecutive frames with this
+    id, or \c 0 if fewer than two frames were received.
+*/
+
+/*!
+    \variable QCanBusFrameIdStatistics::maxIntervalUSecs
+
+    The longest time in microseconds between two consecutive frames with this
+    id, or \c 0 if fewer than two frames were received.
+*/
+
+/*!
+    \variable QCanBusFrameIdStatistics::jitterUSecs
+
+    The inter-arrival jitter in microseconds. It is a running average of the
+    difference between consecutive intervals, estimated the same way as the
+    interarrival jitter of RFC 3550.
+*/
+
+/*!
+    Returns the average number of frames per second received with this id
+    between the first and the last frame, or \c 0 if fewer than two frames
+    were received.
+*/
+double QCanBusFrameIdStatistics::frameRate() const
+{
+    const qint64 span = lastSeenUSecs - firstSeenUSecs;
+    if (frames < 2 || span <= 0)
+        return 0.0;
+    return double(frames - 1) * 1e6 / double(span);
+}
+
+namespace {
+
+qint64 steadyNSecs()
+{
+    using namespace std::chrono;
+    return duration_cast<nanoseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+// Matches the clock the socketcan time stamps are taken from.
+qint64 systemUSecs()
+{
+    using namespace std::chrono;
+    return duration_cast<microseconds>(system_clock::now().time_since_epoch()).count();
+}
+
+/*
+    Counts the bits of the dynamically stuffed part of a frame: after five consecutive bits
+    of equal value a complementary stuff bit is inserted, which itself starts the next run.
+    The stuff bit is only inserted once the next bit is transmitted or finish() is called,
+    so CAN FD can replace a trailing one with the first fixed stuff bit of the CRC field.
+*/
+class BitStuffer
+{
+public:
+    void push(quint32 value, int count)
+    {
+        for (int i = count - 1; i >= 0; --i) {
+            const bool bit = (value >> i) & 1;
+            if (m_run == 5) {
+                m_last = !m_last;
+                m_run = 1;
+                ++m_length;
+            }
+            if (bit == m_last) {
+                ++m_run;
+            } else {
+                m_last = bit;
+                m_run = 1;
+            }
+            ++m_length;
+            if (m_crc) {
+                const bool next = bit ^ ((*m_crc >> 14) & 1);
+                *m_crc = (*m_crc << 1) & 0x7fff;
+                if (next)
+                    *m_crc ^= 0x4599;
+            }
+        }
+    }
+
+    void finish()
+    {
+        if (m_run == 5) {
+            m_run = 0;
+            ++m_length;
+        }
+    }
+
+    // Classic frames need the CRC-15 value, as it is part of the stuffed bit stream.
+    void setCrc(quint16 *crc) { m_crc = crc; }
+
+    int length() const { return m_length; }
+
+private:
+    quint16 *m_crc = nullptr;
+    int m_length = 0;
+    int m_run = 0;
+    bool m_last = true; // the idle bus is recessive
+};
+
+struct FrameBits
+{
+    int nominal = 0;
+    int data = 0;
+};
+
+// CRC delimiter, ACK slot, ACK delimiter, end of frame and intermission
+constexpr int FrameTrailerBits = 1 + 1 + 1 + 7 + 3;
+
+void pushIdentifier(BitStuffer *stuffer, const QCanBusFrame &frame, bool lastBit)
+{
+    const quint32 id = frame.frameId();
+    if (frame.hasExtendedFrameFormat()) {
+        stuffer->push(id >> 18, 11);
+        stuffer->push(1, 1);                    // SRR
+        stuffer->push(1, 1);                    // IDE
+        stuffer->push(id & 0x3ffff, 18);
+        stuffer->push(lastBit, 1);              // RTR or RRS
+    } else {
+        stuffer->push(id & 0x7ff, 11);
+        stuffer->push(lastBit, 1);              // RTR or RRS
+        stuffer->push(0, 1);                    // IDE
+    }
+}
+
+/*
+    Returns the exact length of \a frame on the wire, including stuff bits, the CRC field,
+    the acknowledge and end of frame fields and the intermission. For CAN FD frames with
+    bit rate switch, the bits from the ESI bit up to the end of the CRC field are
+    transmitted at the data bit rate. The BRS bit and the CRC delimiter, during which the
+    bit rate switches, are counted at the nominal bit rate.
+*/
+FrameBits frameBits(const QCanBusFrame &frame)
+{
+    const QByteArray payload = frame.payload();
+    BitStuffer stuffer;
+    FrameBits result;
+
+    if (!frame.hasFlexibleDataRateFormat()) {
+        const bool remote = frame.frameType() == QCanBusFrame::RemoteRequestFrame;
+        const int length = qMin<int>(payload.size(), 8);
+        quint16 crc = 0;
+        stuffer.setCrc(&crc);
+        stuffer.push(0, 1);                     // SOF
+        pushIdentifier(&stuffer, frame, remote);
+        stuffer.push(0, frame.hasExtendedFrameFormat() ? 2 : 1); // r1, r0
+        stuffer.push(quint32(length), 4);
+        if (!remote) {
+            for (int i = 0; i < length; ++i)
+                stuffer.push(quint8(payload.at(i)), 8);
+        }
+        stuffer.setCrc(nullptr);
+        stuffer.push(crc, 15);
+        stuffer.finish();
+        result.nominal = stuffer.length() + FrameTrailerBits;
+        return result;
+    }
+
+    static constexpr quint8 fdLengths[] = { 0, 1, 2, 3, 4, 5, 6, 7, 8, 12, 16, 20, 24, 32, 48, 64 };
+    const int size = qMin<int>(payload.size(), 64);
+    const quint32 dlc = quint32(std::lower_bound(std::begin(fdLengths), std::end(fdLengths), size)
+                                - std::begin(fdLengths));
+    const int length = fdLengths[dlc];
+
+    stuffer.push(0, 1);                         // SOF
+    pushIdentifier(&stuffer, frame, false);
+    stuffer.push(1, 1);                         // FDF
+    stuffer.push(0, 1);                         // res
+    stuffer.push(frame.hasBitrateSwitch(), 1);
+    const int arbitrationBits = stuffer.length();
+    stuffer.push(frame.hasErrorStateIndicator(), 1);
+    stuffer.push(dlc, 4);
+    for (int i = 0; i < length; ++i)
+        stuffer.push(i < size ? quint8(payload.at(i)) : 0, 8);
+
+    // Stuff count and CRC with a fixed stuff bit in front of every four bits.
+    const int crcFieldBits = length > 16 ? 4 + 21 + 7 : 4 + 17 + 6;
+    const int dataPhaseBits = stuffer.length() - arbitrationBits + crcFieldBits;
+    if (frame.hasBitrateSwitch()) {
+        result.nominal = arbitrationBits + FrameTrailerBits;
+        result.data = dataPhaseBits;
+    } else {
+        result.nominal = arbitrationBits + dataPhaseBits + FrameTrailerBits;
+    }
+    return result;
+}
+
+quint64 bitsToNSecs(int bits, quint32 bitRate)
+{
+    if (bitRate == 0)
+        return 0;
+    return (quint64(bits) * 1000000000u + bitRate / 2) / bitRate;
+}
+
+} // namespace
+
+QCanBusStatisticsRecorder::QCanBusStatisticsRecorder()
+    : m_table(new Slot[TableSize])
+{
+}
+
+void QCanBusStatisticsRecorder::setEnabled(bool enabled)
+{
+    if (enabled) {
+        reset();
+        m_stopNSecs.store(0, std::memory_order_relaxed);
+    } else if (isEnabled()) {
+        m_stopNSecs.store(steadyNSecs(), std::memory_order_relaxed);
+    }
+    m_enabled.store(enabled, std::memory_order_relaxed);
+}
+
+void QCanBusStatisticsRecorder::record(const QList<QCanBusFrame> &frames)
+{
+    if (!isEnabled())
+        return;
+
+    const quint32 bitRate = m_bitRate.load(std::memory_order_relaxed);
+    const quint32 dataBitRate = m_dataBitRate.load(std::memory_order_relaxed);
+    qint64 now = -1;
+
+    for (const QCanBusFrame &frame : frames) {
+        switch (frame.frameType()) {
+        case QCanBusFrame::DataFrame:
+            break;
+        case QCanBusFrame::RemoteRequestFrame:
+            add(m_remoteRequestFrames);
+            break;
+        case QCanBusFrame::ErrorFrame: {
+            add(m_errorFrames);
+            const QCanBusFrame::FrameErrors errors = frame.error();
+            for (int i = 0; i < QCanBusDeviceStatistics::ErrorClassCount; ++i) {
+                if (errors.testFlag(QCanBusFrame::FrameError(1 << i)))
+                    add(m_errorFramesByClass[i]);
+            }
+            continue;
+        }
+        default:
+            continue;
+        }
+
+        add(m_frames);
+        if (frame.hasFlexibleDataRateFormat())
+            add(m_flexibleDataRateFrames);
+
+        const FrameBits bits = frameBits(frame);
+        const quint64 busTime = bitsToNSecs(bits.nominal, bitRate)
+                + bitsToNSecs(bits.data, dataBitRate ? dataBitRate : bitRate);
+        add(m_nominalBits, quint64(bits.nominal));
+        add(m_dataBits, quint64(bits.data));
+        add(m_busTimeNSecs, busTime);
+
+        Slot *s = slot(key(frame.frameId(), frame.hasExtendedFrameFormat()));
+        if (Q_UNLIKELY(!s)) {
+            add(m_untrackedFrames);
+            continue;
+        }
+
+        const QCanBusFrame::TimeStamp stamp = frame.timeStamp();
+        qint64 usecs = stamp.seconds() * 1000000 + stamp.microSeconds();
+        if (usecs == 0) {
+            if (now < 0)
+                now = systemUSecs();
+            usecs = now;
+        }
+
+        const quint64 count = s->frames.load(std::memory_order_relaxed);
+        if (count == 0) {
+            s->firstSeenUSecs.store(usecs, std::memory_order_relaxed);
+        } else {
+            const qint64 interval =
+                    qMax<qint64>(0, usecs - s->lastSeenUSecs.load(std::memory_order_relaxed));
+            if (count == 1 || interval < s->minIntervalUSecs.load(std::memory_order_relaxed))
+                s->minIntervalUSecs.store(interval, std::memory_order_relaxed);
+            if (interval > s->maxIntervalUSecs.load(std::memory_order_relaxed))
+                s->maxIntervalUSecs.store(interval, std::memory_order_relaxed);
+            if (count > 1) {
+                // RFC 3550: J += (|D| - J) / 16, kept scaled by 16 to stay in integers
+                const qint64 difference =
+                        qAbs(interval - s->lastIntervalUSecs.load(std::memory_order_relaxed));
+                const qint64 jitter = s->scaledJitterUSecs.load(std::memory_order_relaxed);
+                s->scaledJitterUSecs.store(jitter + difference - ((jitter + 8) >> 4),
+                                           std::memory_order_relaxed);
+            }
+            s->lastIntervalUSecs.store(interval, std::memory_order_relaxed);
+        }
+        s->lastSeenUSecs.store(usecs, std::memory_order_relaxed);
+        s->frames.store(count + 1, std::memory_order_relaxed);
+        add(s->bits, quint64(bits.nominal + bits.data));
+        add(s->busTimeNSecs, busTime);
+    }
+}
+
+QCanBusDeviceStatistics QCanBusStatisticsRecorder::snapshot() const
+{
+    QCanBusDeviceStatistics result;
+    result.frames = m_frames.load(std::memory_order_relaxed);
+    result.remoteRequestFrames = m_remoteRequestFrames.load(std::memory_order_relaxed);
+    result.flexibleDataRateFrames = m_flexibleDataRateFrames.load(std::memory_order_relaxed);
+    result.untrackedFrames = m_untrackedFrames.load(std::memory_order_relaxed);
+    result.errorFrames = m_errorFrames.load(std::memory_order_relaxed);
+    for (int i = 0; i < QCanBusDeviceStatistics::ErrorClassCount; ++i)
+        result.errorFramesByClass[i] = m_errorFramesByClass[i].load(std::memory_order_relaxed);
+    result.nominalBits = m_nominalBits.load(std::memory_order_relaxed);
+    result.dataBits = m_dataBits.load(std::memory_order_relaxed);
+    result.busTimeNSecs = m_busTimeNSecs.load(std::memory_order_relaxed);
+
+    const qint64 stop = m_stopNSecs.load(std::memory_order_relaxed);
+    result.elapsedNSecs = qMax<qint64>(0, (stop ? stop : steadyNSecs())
+                                       - m_startNSecs.load(std::memory_order_relaxed));
+    return result;
+}
+
+QList<QCanBusFrameIdStatistics> QCanBusStatisticsRecorder::frameIdSnapshot() const
+{
+    QList<QCanBusFrameIdStatistics> result;
+    for (quint32 i = 0; i < TableSize; ++i) {
+        const Slot &s = m_table[i];
+        const quint32 k = s.key.load(std::memory_order_acquire);
+        if (k != EmptyKey && s.frames.load(std::memory_order_relaxed) != 0)
+            result.append(frameIdStatistics(k, s));
+    }
+    std::sort(result.begin(), result.end(),
+              [](const QCanBusFrameIdStatistics &a, const QCanBusFrameIdStatistics &b) {
+        if (a.extendedFrameFormat != b.extendedFrameFormat)
+            return b.extendedFrameFormat;
+        return a.frameId < b.frameId;
+    });
+    return result;
+}
+
+QCanBusFrameIdStatistics QCanBusStatisticsRecorder::frameIdSnapshot(
+        QCanBusFrame::FrameId frameId, bool extendedFrameFormat) const
+{
+    const quint32 k = key(frameId, extendedFrameFormat);
+    if (const Slot *s = findSlot(k))
+        return frameIdStatistics(k, *s);
+
+    QCanBusFrameIdStatistics result;
+    result.frameId = frameId;
+    result.extendedFrameFormat = extendedFrameFormat;
+    return result;
+}
+
+void QCanBusStatisticsRecorder::reset()
+{
+    for (quint32 i = 0; i < TableSize; ++i) {
+        Slot &s = m_table[i];
+        s.key.store(EmptyKey, std::memory_order_relaxed);
+        for (Counter *counter : { &s.frames, &s.bits, &s.busTimeNSecs })
+            counter->store(0, std::memory_order_relaxed);
+        for (Time *time : { &s.firstSeenUSecs, &s.lastSeenUSecs, &s.lastIntervalUSecs,
+                            &s.minIntervalUSecs, &s.maxIntervalUSecs, &s.scaledJitterUSecs }) {
+            time->store(0, std::memory_order_relaxed);
+        }
+    }
+    for (Counter *counter : { &m_frames, &m_remoteRequestFrames, &m_flexibleDataRateFrames,
+                              &m_untrackedFrames, &m_errorFrames, &m_nominalBits, &m_dataBits,
+                              &m_busTimeNSecs }) {
+        counter->store(0, std::memory_order_relaxed);
+    }
+    for (Counter &counter : m_errorFramesByClass)
+        counter.store(0, std::memory_order_relaxed);
+
+    const qint64 now = steadyNSecs();
+    m_startNSecs.store(now, std::memory_order_relaxed);
+    if (m_stopNSecs.load(std::memory_order_relaxed))
+        m_stopNSecs.store(now, std::memory_order_relaxed);
+}
+
+QCanBusStatisticsRecorder::Slot *QCanBusStatisticsRecorder::slot(quint32 key)
+{
+    quint32 index = hash(key);
+    for (quint32 probe = 0; probe < MaximumProbes; ++probe) {
+        Slot &s = m_table[index];
+        const quint32 k = s.key.load(std::memory_order_relaxed);
+        if (k == key)
+            return &s;
+        if (k == EmptyKey) {
+            s.key.store(key, std::memory_order_release);
+            return &s;
+        }
+        index = (index + 1) & (TableSize - 1);
+    }
+    return nullptr;
+}
+
+const QCanBusStatisticsRecorder::Slot *QCanBusStatisticsRecorder::findSlot(quint32 key) const
+{
+    quint32 index = hash(key);
+    for (quint32 probe = 0; probe < MaximumProbes; ++probe) {
+        const Slot &s = m_table[index];
+        const quint32 k = s.key.load(std::memory_order_acquire);
+        if (k == key)
+            return &s;
+        if (k == EmptyKey)
+            return nullptr;
+        index = (index + 1) & (TableSize - 1);
+    }
+    return nullptr;
+}
+
+QCanBusFrameIdStatistics QCanBusStatisticsRecorder::frameIdStatistics(quint32 key, const Slot &s)
+{
+    QCanBusFrameIdStatistics result;
+    result.frameId = key & 0x1fffffffu;
+    result.extendedFrameFormat = key & 0x80000000u;
+    result.frames = s.frames.load(std::memory_order_relaxed);
+    result.bits = s.bits.load(std::memory_order_relaxed);
+    result.busTimeNSecs = s.busTimeNSecs.load(std::memory_order_relaxed);
+    result.firstSeenUSecs = s.firstSeenUSecs.load(std::memory_order_relaxed);
+    result.lastSeenUSecs = s.lastSeenUSecs.load(std::memory_order_relaxed);
+    result.minIntervalUSecs = s.minIntervalUSecs.load(std::memory_order_relaxed);
+    result.maxIntervalUSecs = s.maxIntervalUSecs.load(std::memory_order_relaxed);
+    result.jitterUSecs = s.scaledJitterUSecs.load(std::memory_order_relaxed) >> 4;
+    return result;
+}
+
 QT_END_NAMESPACE
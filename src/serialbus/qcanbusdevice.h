@@ -39,15 +39,54 @@
 #define QCANBUSDEVICE_H
 
 #include <QtCore/qobject.h>
+#include <QtCore/qthread.h>
 #include <QtSerialBus/qcanbusframe.h>
 #include <QtSerialBus/qcanbusdeviceinfo.h>
 
+#include <array>
 #include <functional>
 
 QT_BEGIN_NAMESPACE
 
 class QCanBusDevicePrivate;
 
+struct Q_SERIALBUS_EXPORT QCanBusDeviceStatistics
+{
+    static constexpr int ErrorClassCount = 10;
+
+    quint64 frames = 0;
+    quint64 remoteRequestFrames = 0;
+    quint64 flexibleDataRateFrames = 0;
+    quint64 untrackedFrames = 0;
+    quint64 errorFrames = 0;
+    std::array<quint64, ErrorClassCount> errorFramesByClass = {};
+
+    quint64 nominalBits = 0;
+    quint64 dataBits = 0;
+    quint64 busTimeNSecs = 0;
+    qint64 elapsedNSecs = 0;
+
+    double busLoad() const;
+};
+
+struct Q_SERIALBUS_EXPORT QCanBusFrameIdStatistics
+{
+    QCanBusFrame::FrameId frameId = 0;
+    bool extendedFrameFormat = false;
+
+    quint64 frames = 0;
+    quint64 bits = 0;
+    quint64 busTimeNSecs = 0;
+
+    qint64 firstSeenUSecs = 0;
+    qint64 lastSeenUSecs = 0;
+    qint64 minIntervalUSecs = 0;
+    qint64 maxIntervalUSecs = 0;
+    qint64 jitterUSecs = 0;
+
+    double frameRate() const;
+};
+
 class Q_SERIALBUS_EXPORT QCanBusDevice : public QObject
 {
     Q_OBJECT
@@ -84,6 +123,12 @@ public:
     };
     Q_ENUM(CanBusStatus)
 
+    enum class ReceiveMode {
+        Queued,
+        Conflated
+    };
+    Q_ENUM(ReceiveMode)
+
     enum ConfigurationKey {
         RawFilterKey = 0,
         ErrorFilterKey,
@@ -135,6 +180,11 @@ public:
     qint64 framesAvailable() const;
     qint64 framesToWrite() const;
 
+    void setReceiveMode(ReceiveMode mode);
+    ReceiveMode receiveMode() const;
+    QCanBusFrame latestFrame(QCanBusFrame::FrameId frameId,
+                             bool extendedFrameFormat = false) const;
+
     void resetController();
     bool hasBusStatus() const;
     QCanBusDevice::CanBusStatus busStatus() const;
@@ -147,6 +197,22 @@ public:
     Q_DECLARE_FLAGS(Directions, Direction)
     void clear(Directions direction = Direction::AllDirections);
 
+    void setStatisticsEnabled(bool enabled);
+    bool isStatisticsEnabled() const;
+    QCanBusDeviceStatistics statistics() const;
+    QList<QCanBusFrameIdStatistics> frameIdStatistics() const;
+    QCanBusFrameIdStatistics frameIdStatistics(QCanBusFrame::FrameId frameId,
+                                               bool extendedFrameFormat = false) const;
+    void resetStatistics();
+
+    void setReceiveThreadEnabled(bool enabled);
+    bool isReceiveThreadEnabled() const;
+    void setReceiveThreadPriority(QThread::Priority priority);
+    QThread::Priority receiveThreadPriority() const;
+    void setReceiveThreadAffinity(const QList<int> &cpus);
+    QList<int> receiveThreadAffinity() const;
+    bool hasReceiveThread() const;
+
     virtual bool waitForFramesWritten(int msecs);
     virtual bool waitForFramesReceived(int msecs);
 
@@ -180,6 +246,10 @@ protected:
     virtual bool open() = 0;
     virtual void close() = 0;
 
+    QThread *startReceiveThread();
+    void stopReceiveThread();
+    void runInReceiveThread(const std::function<void()> &function);
+
     void setResetControllerFunction(std::function<void()> resetter);
     void setCanBusStatusGetter(std::function<CanBusStatus()> busStatusGetter);
 
@@ -200,6 +270,8 @@ Q_DECLARE_TYPEINFO(QCanBusDevice::CanBusDeviceState, Q_PRIMITIVE_TYPE);
 Q_DECLARE_TYPEINFO(QCanBusDevice::ConfigurationKey, Q_PRIMITIVE_TYPE);
 Q_DECLARE_TYPEINFO(QCanBusDevice::Filter, Q_PRIMITIVE_TYPE);
 Q_DECLARE_TYPEINFO(QCanBusDevice::Filter::FormatFilter, Q_PRIMITIVE_TYPE);
+Q_DECLARE_TYPEINFO(QCanBusDeviceStatistics, Q_PRIMITIVE_TYPE);
+Q_DECLARE_TYPEINFO(QCanBusFrameIdStatistics, Q_PRIMITIVE_TYPE);
 
 Q_DECLARE_OPERATORS_FOR_FLAGS(QCanBusDevice::Filter::FormatFilters)
 Q_DECLARE_OPERATORS_FOR_FLAGS(QCanBusDevice::Directions)
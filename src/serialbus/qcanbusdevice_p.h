@@ -37,11 +37,15 @@
 #ifndef QCANBUSDEVICE_P_H
 #define QCANBUSDEVICE_P_H
 
+#include <QtCore/qhash.h>
 #include <QtCore/qmutex.h>
 #include <QtSerialBus/qcanbusdevice.h>
 
 #include <private/qobject_p.h>
 
+#include <atomic>
+#include <memory>
+
 //
 //  W A R N I N G
 //  -------------
@@ -57,18 +61,158 @@ QT_BEGIN_NAMESPACE
 
 typedef QPair<QCanBusDevice::ConfigurationKey, QVariant > ConfigEntry;
 
+/*
+    Collects the bus load and per frame id counters behind QCanBusDevice::statistics().
+
+    Frames are recorded while enqueueReceivedFrames() holds incomingFramesGuard, and reset()
+    and setEnabled() are called under the same lock, so there is one writer at a time and a
+    relaxed load and store is enough to bump a counter. Per frame id counters live in a fixed
+    size, open addressed table that is allocated once when the statistics get enabled;
+    recording a frame never allocates. Readers on other threads see each counter atomically, a
+    snapshot as a whole is not guaranteed to be consistent though.
+*/
+class QCanBusStatisticsRecorder
+{
+    Q_DISABLE_COPY_MOVE(QCanBusStatisticsRecorder)
+
+public:
+    QCanBusStatisticsRecorder();
+
+    void setEnabled(bool enabled);
+    bool isEnabled() const { return m_enabled.load(std::memory_order_relaxed); }
+
+    void setBitRate(quint32 bitRate) { m_bitRate.store(bitRate, std::memory_order_relaxed); }
+    void setDataBitRate(quint32 bitRate)
+    {
+        m_dataBitRate.store(bitRate, std::memory_order_relaxed);
+    }
+
+    void record(const QList<QCanBusFrame> &frames);
+
+    QCanBusDeviceStatistics snapshot() const;
+    QList<QCanBusFrameIdStatistics> frameIdSnapshot() const;
+    QCanBusFrameIdStatistics frameIdSnapshot(QCanBusFrame::FrameId frameId,
+                                             bool extendedFrameFormat) const;
+    void reset();
+
+private:
+    using Counter = std::atomic<quint64>;
+    using Time = std::atomic<qint64>;
+
+    // Room for a few thousand distinct frame ids, a lookup gives up after MaximumProbes
+    // occupied slots and counts the frame in untrackedFrames instead.
+    enum : quint32 {
+        TableBits = 12,
+        TableSize = 1u << TableBits,
+        MaximumProbes = 64,
+        EmptyKey = 0xffffffffu
+    };
+
+    struct Slot
+    {
+        std::atomic<quint32> key { EmptyKey };
+        Counter frames { 0 };
+        Counter bits { 0 };
+        Counter busTimeNSecs { 0 };
+        Time firstSeenUSecs { 0 };
+        Time lastSeenUSecs { 0 };
+        Time lastIntervalUSecs { 0 };
+        Time minIntervalUSecs { 0 };
+        Time maxIntervalUSecs { 0 };
+        Time scaledJitterUSecs { 0 };
+    };
+
+    static quint32 key(QCanBusFrame::FrameId frameId, bool extendedFrameFormat)
+    {
+        return (frameId & 0x1fffffffu) | (extendedFrameFormat ? 0x80000000u : 0u);
+    }
+    static quint32 hash(quint32 key) { return (key * 0x9e3779b1u) >> (32 - TableBits); }
+
+    static void add(Counter &counter, quint64 value = 1)
+    {
+        counter.store(counter.load(std::memory_order_relaxed) + value,
+                      std::memory_order_relaxed);
+    }
+
+    Slot *slot(quint32 key);
+    const Slot *findSlot(quint32 key) const;
+    static QCanBusFrameIdStatistics frameIdStatistics(quint32 key, const Slot &s);
+
+    std::unique_ptr<Slot[]> m_table;
+
+    std::atomic<bool> m_enabled { false };
+    std::atomic<quint32> m_bitRate { 0 };
+    std::atomic<quint32> m_dataBitRate { 0 };
+    Time m_startNSecs { 0 };
+    Time m_stopNSecs { 0 };
+
+    Counter m_frames { 0 };
+    Counter m_remoteRequestFrames { 0 };
+    Counter m_flexibleDataRateFrames { 0 };
+    Counter m_untrackedFrames { 0 };
+    Counter m_errorFrames { 0 };
+    std::array<Counter, QCanBusDeviceStatistics::ErrorClassCount> m_errorFramesByClass {};
+    Counter m_nominalBits { 0 };
+    Counter m_dataBits { 0 };
+    Counter m_busTimeNSecs { 0 };
+};
+
+/*
+    The thread behind QCanBusDevice::startReceiveThread(). It pins itself to the configured
+    CPUs before entering its event loop.
+*/
+class QCanBusReceiveThread : public QThread
+{
+public:
+    explicit QCanBusReceiveThread(const QList<int> &cpus) : m_cpus(cpus) {}
+
+protected:
+    void run() override;
+
+private:
+    QList<int> m_cpus;
+};
+
 class QCanBusDevicePrivate : public QObjectPrivate
 {
     Q_DECLARE_PUBLIC(QCanBusDevice)
 public:
     QCanBusDevicePrivate() {}
+    ~QCanBusDevicePrivate()
+    {
+        stopReceiveThread();
+        delete statistics.load(std::memory_order_relaxed);
+    }
+
+    void stopReceiveThread();
 
     QCanBusDevice::CanBusError lastError = QCanBusDevice::CanBusError::NoError;
     QCanBusDevice::CanBusDeviceState state = QCanBusDevice::UnconnectedState;
     QString errorText;
 
+    struct LatestFrame
+    {
+        QCanBusFrame frame;
+        bool changed = false;
+    };
+
+    static quint32 latestFrameKey(const QCanBusFrame &frame);
+    static quint32 latestFrameKey(QCanBusFrame::FrameId frameId, bool extendedFrameFormat,
+                                  QCanBusFrame::FrameType type);
+    void conflateFrames(const QList<QCanBusFrame> &frames);
+    QCanBusFrame takeChangedFrame();
+    QList<QCanBusFrame> takeChangedFrames();
+
     QList<QCanBusFrame> incomingFrames;
-    QMutex incomingFramesGuard;
+    mutable QMutex incomingFramesGuard;
+
+    // Conflated receive mode, guarded by incomingFramesGuard as well. A slot is created for
+    // every frame id seen and never removed, changedFrames lists the slots in the order they
+    // changed since they were last read.
+    QCanBusDevice::ReceiveMode receiveMode = QCanBusDevice::ReceiveMode::Queued;
+    QHash<quint32, qsizetype> latestFrameSlots;
+    QList<LatestFrame> latestFrames;
+    QList<qsizetype> changedFrames;
     QList<QCanBusFrame> outgoingFrames;
     QList<ConfigEntry> configOptions;
 
@@ -77,6 +221,17 @@ public:
 
     std::function<void()> m_resetControllerFunction;
     std::function<QCanBusDevice::CanBusStatus()> m_busStatusGetter;
+
+    bool receiveThreadEnabled = false;
+    QThread::Priority receiveThreadPriority = QThread::InheritPriority;
+    QList<int> receiveThreadAffinity;
+    QCanBusReceiveThread *receiveThread = nullptr;
+    // Lives in receiveThread, runInReceiveThread() invokes functions through it.
+    QObject *receiveThreadContext = nullptr;
+
+    // Created when the statistics are enabled for the first time and kept until the device is
+    // destroyed, so a receiving thread never sees it go away.
+    std::atomic<QCanBusStatisticsRecorder *> statistics { nullptr };
 };
 
 QT_END_NAMESPACE
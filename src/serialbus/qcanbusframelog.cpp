@@ -0,0 +1,819 @@
+/****************************************************************************
+**
+** Copyright (C) 2021 The Qt Company Ltd.
+** Contact: http://www.qt.io/licensing/
+**
+** This file is part of the QtSerialBus module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL3$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see http://www.qt.io/terms-conditions. For further
+** information use the contact form at http://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPLv3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or later as published by the Free
+** Software Foundation and appearing in the file LICENSE.GPL included in
+** the packaging of this file. Please review the following information to
+** ensure the GNU General Public License version 2.0 requirements will be
+** met: http://www.gnu.org/licenses/gpl-2.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include "qcanbusframelog.h"
+#include "qcanbusframelog_p.h"
+
+#include <QtCore/qdeadlinetimer.h>
+#include <QtCore/qloggingcategory.h>
+#include <QtCore/qthread.h>
+
+#include <algorithm>
+#include <cstring>
+
+QT_BEGIN_NAMESPACE
+
+Q_DECLARE_LOGGING_CATEGORY(QT_CANBUS)
+
+namespace QCanBusFrameLogFormat {
+
+void writeChunkHeader(uchar *data, const ChunkHeader &header)
+{
+    qToLittleEndian<quint32>(ChunkMagic, data);
+    qToLittleEndian<quint32>(header.size, data + 4);
+    qToLittleEndian<quint32>(header.frameCount, data + 8);
+    qToLittleEndian<quint32>(0, data + 12);
+    qToLittleEndian<qint64>(header.firstTimeStamp, data + 16);
+    qToLittleEndian<qint64>(header.lastTimeStamp, data + 24);
+}
+
+bool readChunkHeader(const uchar *data, ChunkHeader *header)
+{
+    if (qFromLittleEndian<quint32>(data) != ChunkMagic)
+        return false;
+    header->size = qFromLittleEndian<quint32>(data + 4);
+    header->frameCount = qFromLittleEndian<quint32>(data + 8);
+    header->firstTimeStamp = qFromLittleEndian<qint64>(data + 16);
+    header->lastTimeStamp = qFromLittleEndian<qint64>(data + 24);
+    return true;
+}
+
+void writeIndexEntry(uchar *data, const IndexEntry &entry)
+{
+    qToLittleEndian<qint64>(entry.firstTimeStamp, data);
+    qToLittleEndian<qint64>(entry.lastTimeStamp, data + 8);
+    qToLittleEndian<quint64>(entry.offset, data + 16);
+    qToLittleEndian<quint32>(entry.frameCount, data + 24);
+    qToLittleEndian<quint32>(0, data + 28);
+}
+
+IndexEntry readIndexEntry(const uchar *data)
+{
+    IndexEntry entry;
+    entry.firstTimeStamp = qFromLittleEndian<qint64>(data);
+    entry.lastTimeStamp = qFromLittleEndian<qint64>(data + 8);
+    entry.offset = qFromLittleEndian<quint64>(data + 16);
+    entry.frameCount = qFromLittleEndian<quint32>(data + 24);
+    return entry;
+}
+
+qsizetype writeRecord(uchar *data, const QCanBusFrame &frame)
+{
+    const QByteArray payload = frame.payload();
+    const qsizetype size = payloadSize(frame);
+    const bool error = frame.frameType() == QCanBusFrame::ErrorFrame;
+
+    quint8 flags = 0;
+    if (frame.hasExtendedFrameFormat())
+        flags |= ExtendedFrameFormat;
+    if (frame.hasFlexibleDataRateFormat())
+        flags |= FlexibleDataRate;
+    if (frame.hasBitrateSwitch())
+        flags |= BitrateSwitch;
+    if (frame.hasErrorStateIndicator())
+        flags |= ErrorStateIndicator;
+    if (frame.hasLocalEcho())
+        flags |= LocalEcho;
+
+    qToLittleEndian<qint64>(toMicroSeconds(frame.timeStamp()), data);
+    qToLittleEndian<quint32>(error ? quint32(frame.error()) : frame.frameId(), data + 8);
+    data[12] = flags;
+    data[13] = quint8(frame.frameType());
+    qToLittleEndian<quint16>(quint16(size), data + 14);
+    std::memcpy(data + RecordHeaderSize, payload.constData(), size_t(size));
+    return RecordHeaderSize + size;
+}
+
+qsizetype readRecord(const uchar *data, qsizetype size, QCanBusFrame *frame)
+{
+    if (size < RecordHeaderSize)
+        return 0;
+    const qsizetype payloadSize = qFromLittleEndian<quint16>(data + 14);
+    if (size < RecordHeaderSize + payloadSize)
+        return 0;
+    if (!frame)
+        return RecordHeaderSize + payloadSize;
+
+    const quint32 id = qFromLittleEndian<quint32>(data + 8);
+    const quint8 flags = data[12];
+    const auto type = QCanBusFrame::FrameType(data[13]);
+
+    *frame = QCanBusFrame(type);
+    if (type == QCanBusFrame::ErrorFrame)
+        frame->setError(QCanBusFrame::FrameErrors(int(id)));
+    else
+        frame->setFrameId(id);
+    frame->setExtendedFrameFormat(flags & ExtendedFrameFormat);
+    frame->setPayload(QByteArray(reinterpret_cast<const char *>(data + RecordHeaderSize),
+                                 payloadSize));
+    frame->setFlexibleDataRateFormat(flags & FlexibleDataRate);
+    frame->setBitrateSwitch(flags & BitrateSwitch);
+    frame->setErrorStateIndicator(flags & ErrorStateIndicator);
+    frame->setLocalEcho(flags & LocalEcho);
+    frame->setTimeStamp(QCanBusFrame::TimeStamp::fromMicroSeconds(
+        qFromLittleEndian<qint64>(data)));
+    return RecordHeaderSize + payloadSize;
+}
+
+} // namespace QCanBusFrameLogFormat
+
+using namespace QCanBusFrameLogFormat;
+
+/*!
+    \class QCanBusFrameRecorder
+    \inmodule QtSerialBus
+    \since 6.1
+
+    \brief The QCanBusFrameRecorder class records CAN frames into a compact
+    binary log file.
+
+    The recorder is meant to capture a bus at full rate. record() encodes a
+    frame into an in-memory chunk of 64 KiB without any system call; full
+    chunks are handed to a background thread that appends them to the file.
+    The chunk buffers are recycled, so recording does not allocate memory
+    once the first chunks have been written.
+
+    Every chunk starts with a header holding the number of frames and the
+    time stamps of its first and last frame. When the recording is closed,
+    an index of all chunks is appended to the file, so a
+    QCanBusFrameLogReader can seek to a point in time without reading the
+    frames before it. A log that was not closed, for example because the
+    application crashed, is still readable up to its last complete chunk.
+
+    If the disk cannot keep up and 16 MiB of chunks are waiting to be
+    written, further chunks are dropped and counted in droppedFrames()
+    instead of blocking the caller.
+
+    \code
+        QCanBusFrameRecorder recorder;
+        if (!recorder.open(QStringLiteral("capture.qcanlog")))
+            qWarning() << recorder.errorString();
+
+        connect(device, &QCanBusDevice::framesReceived, this, [device, &recorder]() {
+            recorder.record(device->readAllFrames());
+        });
+    \endcode
+
+    All functions must be called from the same thread. The log can be
+    replayed with the \l {Using ReplayCAN Plugin}{ReplayCAN plugin}.
+
+    \sa QCanBusFrameLogReader
+*/
+
+void QCanBusFrameRecorderPrivate::startChunk()
+{
+    m_current.header = ChunkHeader();
+    if (m_current.data.size() < ChunkSize)
+        m_current.data.resize(ChunkSize);
+}
+
+bool QCanBusFrameRecorderPrivate::submitChunk()
+{
+    if (m_current.header.frameCount == 0)
+        return !m_failed.loadRelaxed();
+
+    bool submitted = true;
+    {
+        QMutexLocker locker(&m_mutex);
+        if (m_failed.loadRelaxed() || m_pending.size() >= size_t(MaximumPendingChunks)) {
+            // The writer fell behind or failed, keep the buffer and drop its frames.
+            m_droppedFrames += m_current.header.frameCount;
+            submitted = false;
+        } else {
+            m_pending.push_back(std::move(m_current));
+            m_chunkAvailable.wakeOne();
+            m_current = Chunk();
+            if (!m_spareBuffers.empty()) {
+                m_current.data = std::move(m_spareBuffers.back());
+                m_spareBuffers.pop_back();
+            }
+        }
+    }
+    startChunk();
+    return submitted;
+}
+
+/*
+    Submits the current chunk if its first frame was recorded MaximumChunkAge milliseconds
+    ago. Returns the time in milliseconds until the current chunk is due next.
+*/
+qint64 QCanBusFrameRecorderPrivate::submitAgedChunk()
+{
+    QMutexLocker locker(&m_currentMutex);
+    if (m_current.header.frameCount == 0)
+        return MaximumChunkAge / 4; // look again, a frame may be recorded meanwhile
+    const qint64 age = m_chunkAge.elapsed();
+    if (age < MaximumChunkAge)
+        return MaximumChunkAge - age;
+    submitChunk();
+    return MaximumChunkAge / 4;
+}
+
+void QCanBusFrameRecorderPrivate::writeLoop()
+{
+    QMutexLocker locker(&m_mutex);
+    for (;;) {
+        while (m_pending.empty() && !m_stop) {
+            // On a quiet bus the recording thread does not fill the current chunk, write
+            // it once it is old enough. m_currentMutex must not be taken under m_mutex.
+            locker.unlock();
+            const qint64 due = submitAgedChunk();
+            locker.relock();
+            if (m_pending.empty() && !m_stop)
+                m_chunkAvailable.wait(&m_mutex, QDeadlineTimer(due));
+        }
+        if (m_pending.empty())
+            return;
+
+        Chunk chunk = std::move(m_pending.front());
+        m_pending.pop_front();
+        m_writing = true;
+        locker.unlock();
+
+        const bool written = !m_failed.loadRelaxed() && writeChunk(chunk);
+
+        locker.relock();
+        m_writing = false;
+        if (!written) {
+            m_droppedFrames += chunk.header.frameCount;
+            if (!m_failed.loadRelaxed()) {
+                m_errorString = m_file.errorString();
+                m_failed.storeRelaxed(1);
+                qCWarning(QT_CANBUS, "Cannot write frame log %ls: %ls",
+                          qUtf16Printable(m_file.fileName()), qUtf16Printable(m_errorString));
+            }
+        }
+        m_spareBuffers.push_back(std::move(chunk.data));
+        m_chunkWritten.wakeAll();
+    }
+}
+
+bool QCanBusFrameRecorderPrivate::writeChunk(const Chunk &chunk)
+{
+    IndexEntry entry;
+    entry.firstTimeStamp = chunk.header.firstTimeStamp;
+    entry.lastTimeStamp = chunk.header.lastTimeStamp;
+    entry.offset = quint64(m_file.pos());
+    entry.frameCount = chunk.header.frameCount;
+
+    uchar header[ChunkHeaderSize];
+    writeChunkHeader(header, chunk.header);
+    if (m_file.write(reinterpret_cast<const char *>(header), ChunkHeaderSize) != ChunkHeaderSize
+            || m_file.write(chunk.data.constData(), chunk.header.size) != chunk.header.size) {
+        return false;
+    }
+    m_index.push_back(entry);
+    return true;
+}
+
+bool QCanBusFrameRecorderPrivate::writeIndex()
+{
+    QByteArray index(qsizetype(m_index.size()) * IndexEntrySize + TrailerSize, Qt::Uninitialized);
+    uchar *data = reinterpret_cast<uchar *>(index.data());
+    for (const IndexEntry &entry : m_index) {
+        writeIndexEntry(data, entry);
+        data += IndexEntrySize;
+    }
+    qToLittleEndian<quint32>(IndexMagic, data);
+    qToLittleEndian<quint32>(quint32(m_index.size()), data + 4);
+    qToLittleEndian<quint64>(quint64(m_file.pos()), data + 8);
+    return m_file.write(index) == index.size();
+}
+
+/*!
+    Constructs a recorder without an open log.
+*/
+QCanBusFrameRecorder::QCanBusFrameRecorder()
+    : d_ptr(new QCanBusFrameRecorderPrivate)
+{
+}
+
+/*!
+    Closes the log and destroys the recorder.
+*/
+QCanBusFrameRecorder::~QCanBusFrameRecorder()
+{
+    close();
+}
+
+/*!
+    Creates the log \a fileName, replacing an existing file, and starts the
+    writer thread. A log that is already open is closed first.
+
+    Returns \c true on success; otherwise returns \c false and sets
+    errorString().
+*/
+bool QCanBusFrameRecorder::open(const QString &fileName)
+{
+    Q_D(QCanBusFrameRecorder);
+    close();
+
+    d->m_fileName = fileName;
+    d->m_recordedFrames = 0;
+    d->m_droppedFrames = 0;
+    d->m_errorString.clear();
+    d->m_failed.storeRelaxed(0);
+    d->m_stop = false;
+    d->m_index.clear();
+
+    // Unbuffered, so that a written chunk reaches the operating system right away.
+    d->m_file.setFileName(fileName);
+    if (!d->m_file.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Unbuffered)) {
+        d->m_errorString = d->m_file.errorString();
+        return false;
+    }
+
+    uchar header[FileHeaderSize];
+    std::memcpy(header, FileMagic, sizeof(FileMagic));
+    qToLittleEndian<quint32>(Version, header + 8);
+    qToLittleEndian<quint32>(0, header + 12);
+    if (d->m_file.write(reinterpret_cast<const char *>(header), FileHeaderSize)
+            != FileHeaderSize) {
+        d->m_errorString = d->m_file.errorString();
+        d->m_file.close();
+        return false;
+    }
+
+    d->startChunk();
+    d->m_thread.reset(QThread::create([d]() { d->writeLoop(); }));
+    d->m_thread->setObjectName(QStringLiteral("QCanBusFrameRecorder"));
+    d->m_thread->start();
+    return true;
+}
+
+/*!
+    Writes the frames recorded so far and the chunk index, stops the writer
+    thread and closes the log. Returns \c false if not all frames could be
+    written.
+*/
+bool QCanBusFrameRecorder::close()
+{
+    Q_D(QCanBusFrameRecorder);
+    if (!d->m_thread)
+        return true;
+
+    {
+        QMutexLocker locker(&d->m_currentMutex);
+        d->submitChunk();
+    }
+    {
+        QMutexLocker locker(&d->m_mutex);
+        d->m_stop = true;
+        d->m_chunkAvailable.wakeAll();
+    }
+    d->m_thread->wait();
+    d->m_thread.reset();
+
+    bool written = !d->m_failed.loadRelaxed();
+    if (written && !d->writeIndex()) {
+        d->m_errorString = d->m_file.errorString();
+        written = false;
+    }
+    d->m_file.close();
+    d->m_current = QCanBusFrameRecorderPrivate::Chunk();
+    d->m_spareBuffers.clear();
+    return written;
+}
+
+/*!
+    Returns \c true if a log is open for recording.
+*/
+bool QCanBusFrameRecorder::isOpen() const
+{
+    Q_D(const QCanBusFrameRecorder);
+    return d->m_thread != nullptr;
+}
+
+/*!
+    Returns the file name of the last opened log.
+*/
+QString QCanBusFrameRecorder::fileName() const
+{
+    Q_D(const QCanBusFrameRecorder);
+    return d->m_fileName;
+}
+
+/*!
+    Appends \a frame to the log. Returns \c false if no log is open or
+    writing the log failed.
+
+    Chunks are handed to the writer thread when they are full or one second
+    after their first frame was recorded, whichever comes first. The writer
+    thread submits a chunk that is due on its own, so frames recorded on a
+    quiet bus reach the file within that second as well.
+*/
+bool QCanBusFrameRecorder::record(const QCanBusFrame &frame)
+{
+    Q_D(QCanBusFrameRecorder);
+    if (!d->m_thread || d->m_failed.loadRelaxed())
+        return false;
+
+    QMutexLocker locker(&d->m_currentMutex);
+    QCanBusFrameRecorderPrivate::Chunk &chunk = d->m_current;
+    const qsizetype size = RecordHeaderSize + payloadSize(frame);
+    if (chunk.header.size + size > chunk.data.size()
+            || (chunk.header.frameCount && d->m_chunkAge.hasExpired(
+                    QCanBusFrameRecorderPrivate::MaximumChunkAge))) {
+        d->submitChunk();
+        if (size > chunk.data.size())
+            chunk.data.resize(size);
+    }
+
+    const qint64 timeStamp = toMicroSeconds(frame.timeStamp());
+    if (chunk.header.frameCount == 0) {
+        chunk.header.firstTimeStamp = timeStamp;
+        d->m_chunkAge.start();
+    }
+    chunk.header.lastTimeStamp = timeStamp;
+    ++chunk.header.frameCount;
+    chunk.header.size += quint32(writeRecord(
+        reinterpret_cast<uchar *>(chunk.data.data()) + chunk.header.size, frame));
+    ++d->m_recordedFrames;
+    return true;
+}
+
+/*!
+    \overload
+
+    Appends \a frames to the log and returns the number of frames recorded.
+*/
+qsizetype QCanBusFrameRecorder::record(const QList<QCanBusFrame> &frames)
+{
+    qsizetype recorded = 0;
+    for (const QCanBusFrame &frame : frames) {
+        if (!record(frame))
+            break;
+        ++recorded;
+    }
+    return recorded;
+}
+
+/*!
+    Hands the current chunk to the writer thread and waits until all chunks
+    are written to the file. Returns \c false if writing failed.
+*/
+bool QCanBusFrameRecorder::flush()
+{
+    Q_D(QCanBusFrameRecorder);
+    if (!d->m_thread)
+        return false;
+
+    {
+        QMutexLocker locker(&d->m_currentMutex);
+        d->submitChunk();
+    }
+    QMutexLocker locker(&d->m_mutex);
+    while (!d->m_pending.empty() || d->m_writing)
+        d->m_chunkWritten.wait(&d->m_mutex);
+    // The writer thread is idle and cannot take a chunk while the mutex is held.
+    return !d->m_failed.loadRelaxed() && d->m_file.flush();
+}
+
+/*!
+    Returns the number of frames passed to record() since the log was
+    opened, including dropped frames.
+*/
+quint64 QCanBusFrameRecorder::recordedFrames() const
+{
+    Q_D(const QCanBusFrameRecorder);
+    return d->m_recordedFrames;
+}
+
+/*!
+    Returns the number of recorded frames that were discarded because the
+    writer thread fell behind or writing the log failed.
+*/
+quint64 QCanBusFrameRecorder::droppedFrames() const
+{
+    Q_D(const QCanBusFrameRecorder);
+    QMutexLocker locker(&d->m_mutex);
+    return d->m_droppedFrames;
+}
+
+/*!
+    Returns a description of the last error.
+*/
+QString QCanBusFrameRecorder::errorString() const
+{
+    Q_D(const QCanBusFrameRecorder);
+    QMutexLocker locker(&d->m_mutex);
+    return d->m_errorString;
+}
+
+/*!
+    \class QCanBusFrameLogReader
+    \inmodule QtSerialBus
+    \since 6.1
+
+    \brief The QCanBusFrameLogReader class reads CAN frames from a log
+    written by QCanBusFrameRecorder.
+
+    The reader maps the log into memory and decodes the frames in place,
+    so reading does not copy the file. seek() uses the chunk index of the
+    log to find a point in time; for logs that were not closed properly the
+    index is rebuilt from the chunk headers when the log is opened.
+
+    \code
+        QCanBusFrameLogReader reader;
+        if (reader.open(QStringLiteral("capture.qcanlog"))) {
+            reader.seek(reader.startTime() + 60 * 1000000);    // skip the first minute
+            QCanBusFrame frame;
+            while (reader.readFrame(&frame))
+                process(frame);
+        }
+    \endcode
+
+    \sa QCanBusFrameRecorder
+*/
+
+bool QCanBusFrameLogReaderPrivate::readIndex()
+{
+    if (m_size < FileHeaderSize + TrailerSize)
+        return false;
+
+    const uchar *trailer = m_data + m_size - TrailerSize;
+    if (qFromLittleEndian<quint32>(trailer) != IndexMagic)
+        return false;
+    const quint64 count = qFromLittleEndian<quint32>(trailer + 4);
+    const quint64 offset = qFromLittleEndian<quint64>(trailer + 8);
+    if (offset < quint64(FileHeaderSize)
+            || offset + count * IndexEntrySize != quint64(m_size - TrailerSize)) {
+        return false;
+    }
+
+    std::vector<IndexEntry> index;
+    index.reserve(size_t(count));
+    for (quint64 i = 0; i < count; ++i) {
+        const IndexEntry entry = readIndexEntry(m_data + offset + i * IndexEntrySize);
+        ChunkHeader header;
+        if (entry.offset < quint64(FileHeaderSize) || entry.offset + ChunkHeaderSize > offset
+                || !readChunkHeader(m_data + entry.offset, &header)
+                || entry.offset + ChunkHeaderSize + header.size > offset) {
+            return false;
+        }
+        index.push_back(entry);
+    }
+    m_index = std::move(index);
+    return true;
+}
+
+bool QCanBusFrameLogReaderPrivate::scanChunks()
+{
+    m_index.clear();
+    qsizetype position = FileHeaderSize;
+    ChunkHeader header;
+    while (position + ChunkHeaderSize <= m_size && readChunkHeader(m_data + position, &header)) {
+        if (position + ChunkHeaderSize + qsizetype(header.size) > m_size)
+            break;
+        IndexEntry entry;
+        entry.firstTimeStamp = header.firstTimeStamp;
+        entry.lastTimeStamp = header.lastTimeStamp;
+        entry.offset = quint64(position);
+        entry.frameCount = header.frameCount;
+        m_index.push_back(entry);
+        position += ChunkHeaderSize + header.size;
+    }
+    return true;
+}
+
+void QCanBusFrameLogReaderPrivate::enterChunk(qsizetype chunk)
+{
+    m_chunk = chunk;
+    m_position = m_chunkEnd = 0;
+    if (size_t(chunk) >= m_index.size())
+        return;
+
+    ChunkHeader header;
+    const qsizetype offset = qsizetype(m_index[size_t(chunk)].offset);
+    readChunkHeader(m_data + offset, &header);
+    m_position = offset + ChunkHeaderSize;
+    m_chunkEnd = m_position + header.size;
+}
+
+/*!
+    Constructs a reader without an open log.
+*/
+QCanBusFrameLogReader::QCanBusFrameLogReader()
+    : d_ptr(new QCanBusFrameLogReaderPrivate)
+{
+}
+
+/*!
+    Closes the log and destroys the reader.
+*/
+QCanBusFrameLogReader::~QCanBusFrameLogReader()
+{
+    close();
+}
+
+/*!
+    Opens and maps the log \a fileName and positions the reader at its
+    first frame. Returns \c true on success; otherwise returns \c false and
+    sets errorString().
+*/
+bool QCanBusFrameLogReader::open(const QString &fileName)
+{
+    Q_D(QCanBusFrameLogReader);
+    close();
+    d->m_errorString.clear();
+
+    d->m_file.setFileName(fileName);
+    if (!d->m_file.open(QIODevice::ReadOnly)) {
+        d->m_errorString = d->m_file.errorString();
+        return false;
+    }
+
+    d->m_size = d->m_file.size();
+    if (d->m_size >= FileHeaderSize)
+        d->m_data = d->m_file.map(0, d->m_size);
+    if (!d->m_data || std::memcmp(d->m_data, FileMagic, sizeof(FileMagic)) != 0
+            || qFromLittleEndian<quint32>(d->m_data + 8) != Version) {
+        d->m_errorString = d->m_data ? tr("%1 is not a CAN frame log.").arg(fileName)
+                                     : tr("Cannot map %1: %2").arg(fileName,
+                                                                   d->m_file.errorString());
+        close();
+        return false;
+    }
+
+    if (!d->readIndex()) {
+        qCDebug(QT_CANBUS, "Frame log %ls has no valid index, scanning its chunks.",
+                qUtf16Printable(fileName));
+        d->scanChunks();
+    }
+    d->m_frameCount = 0;
+    for (const IndexEntry &entry : d->m_index)
+        d->m_frameCount += entry.frameCount;
+    rewind();
+    return true;
+}
+
+/*!
+    Unmaps and closes the log.
+*/
+void QCanBusFrameLogReader::close()
+{
+    Q_D(QCanBusFrameLogReader);
+    if (d->m_data)
+        d->m_file.unmap(const_cast<uchar *>(d->m_data));
+    d->m_file.close();
+    d->m_data = nullptr;
+    d->m_size = 0;
+    d->m_index.clear();
+    d->m_frameCount = 0;
+    d->enterChunk(0);
+}
+
+/*!
+    Returns \c true if a log is open.
+*/
+bool QCanBusFrameLogReader::isOpen() const
+{
+    Q_D(const QCanBusFrameLogReader);
+    return d->m_data != nullptr;
+}
+
+/*!
+    Returns a description of the last error.
+*/
+QString QCanBusFrameLogReader::errorString() const
+{
+    Q_D(const QCanBusFrameLogReader);
+    return d->m_errorString;
+}
+
+/*!
+    Returns the number of frames in the log.
+*/
+quint64 QCanBusFrameLogReader::frameCount() const
+{
+    Q_D(const QCanBusFrameLogReader);
+    return d->m_frameCount;
+}
+
+/*!
+    Returns the time stamp in microseconds of the first frame in the log,
+    or \c 0 if the log is empty.
+*/
+qint64 QCanBusFrameLogReader::startTime() const
+{
+    Q_D(const QCanBusFrameLogReader);
+    return d->m_index.empty() ? 0 : d->m_index.front().firstTimeStamp;
+}
+
+/*!
+    Returns the time stamp in microseconds of the last frame in the log,
+    or \c 0 if the log is empty.
+*/
+qint64 QCanBusFrameLogReader::endTime() const
+{
+    Q_D(const QCanBusFrameLogReader);
+    return d->m_index.empty() ? 0 : d->m_index.back().lastTimeStamp;
+}
+
+/*!
+    Positions the reader at the first frame of the log.
+*/
+void QCanBusFrameLogReader::rewind()
+{
+    Q_D(QCanBusFrameLogReader);
+    d->enterChunk(0);
+}
+
+/*!
+    Positions the reader at the first frame with a time stamp of at least
+    \a timeStamp microseconds. The chunk is found with the index, only the
+    frames of that chunk before \a timeStamp are skipped. Returns \c false
+    if there is no such frame.
+*/
+bool QCanBusFrameLogReader::seek(qint64 timeStamp)
+{
+    Q_D(QCanBusFrameLogReader);
+    const auto chunk = std::partition_point(d->m_index.cbegin(), d->m_index.cend(),
+                                            [timeStamp](const IndexEntry &entry) {
+        return entry.lastTimeStamp < timeStamp;
+    });
+    d->enterChunk(qsizetype(chunk - d->m_index.cbegin()));
+    while (!atEnd() && nextTimeStamp() < timeStamp)
+        readFrame(nullptr);
+    return !atEnd();
+}
+
+/*!
+    Returns \c true if all frames of the log were read.
+*/
+bool QCanBusFrameLogReader::atEnd() const
+{
+    Q_D(const QCanBusFrameLogReader);
+    return size_t(d->m_chunk) >= d->m_index.size();
+}
+
+/*!
+    Returns the time stamp in microseconds of the frame readFrame() returns
+    next, or \c -1 at the end of the log.
+*/
+qint64 QCanBusFrameLogReader::nextTimeStamp() const
+{
+    Q_D(const QCanBusFrameLogReader);
+    if (atEnd() || d->m_chunkEnd - d->m_position < RecordHeaderSize)
+        return -1;
+    return qFromLittleEndian<qint64>(d->m_data + d->m_position);
+}
+
+/*!
+    Reads the next frame into \a frame and returns \c true, or returns
+    \c false at the end of the log. If \a frame is \nullptr, the frame is
+    skipped.
+*/
+bool QCanBusFrameLogReader::readFrame(QCanBusFrame *frame)
+{
+    Q_D(QCanBusFrameLogReader);
+    while (!atEnd()) {
+        const qsizetype size = readRecord(d->m_data + d->m_position,
+                                          d->m_chunkEnd - d->m_position, frame);
+        if (size == 0) {
+            // A truncated record ends the chunk.
+            d->enterChunk(d->m_chunk + 1);
+            continue;
+        }
+        d->m_position += size;
+        if (d->m_position >= d->m_chunkEnd)
+            d->enterChunk(d->m_chunk + 1);
+        return true;
+    }
+    return false;
+}
+
+QT_END_NAMESPACE
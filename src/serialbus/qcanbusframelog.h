@@ -0,0 +1,108 @@
+/****************************************************************************
+**
+** Copyright (C) 2021 The Qt Company Ltd.
+** Contact: http://www.qt.io/licensing/
+**
+** This file is part of the QtSerialBus module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL3$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see http://www.qt.io/terms-conditions. For further
+** information use the contact form at http://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPLv3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or later as published by the Free
+** Software Foundation and appearing in the file LICENSE.GPL included in
+** the packaging of this file. Please review the following information to
+** ensure the GNU General Public License version 2.0 requirements will be
+** met: http://www.gnu.org/licenses/gpl-2.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#ifndef QCANBUSFRAMELOG_H
+#define QCANBUSFRAMELOG_H
+
+#include <QtCore/qcoreapplication.h>
+#include <QtCore/qlist.h>
+#include <QtCore/qscopedpointer.h>
+#include <QtSerialBus/qcanbusframe.h>
+
+QT_BEGIN_NAMESPACE
+
+class QCanBusFrameRecorderPrivate;
+class QCanBusFrameLogReaderPrivate;
+
+class Q_SERIALBUS_EXPORT QCanBusFrameRecorder
+{
+    Q_DECLARE_PRIVATE(QCanBusFrameRecorder)
+    Q_DECLARE_TR_FUNCTIONS(QCanBusFrameRecorder)
+
+public:
+    QCanBusFrameRecorder();
+    ~QCanBusFrameRecorder();
+
+    bool open(const QString &fileName);
+    bool close();
+    bool isOpen() const;
+    QString fileName() const;
+
+    bool record(const QCanBusFrame &frame);
+    qsizetype record(const QList<QCanBusFrame> &frames);
+    bool flush();
+
+    quint64 recordedFrames() const;
+    quint64 droppedFrames() const;
+    QString errorString() const;
+
+private:
+    Q_DISABLE_COPY(QCanBusFrameRecorder)
+    QScopedPointer<QCanBusFrameRecorderPrivate> d_ptr;
+};
+
+class Q_SERIALBUS_EXPORT QCanBusFrameLogReader
+{
+    Q_DECLARE_PRIVATE(QCanBusFrameLogReader)
+    Q_DECLARE_TR_FUNCTIONS(QCanBusFrameLogReader)
+
+public:
+    QCanBusFrameLogReader();
+    ~QCanBusFrameLogReader();
+
+    bool open(const QString &fileName);
+    void close();
+    bool isOpen() const;
+    QString errorString() const;
+
+    quint64 frameCount() const;
+    qint64 startTime() const;
+    qint64 endTime() const;
+
+    void rewind();
+    bool seek(qint64 timeStamp);
+    bool atEnd() const;
+    qint64 nextTimeStamp() const;
+    bool readFrame(QCanBusFrame *frame);
+
+private:
+    Q_DISABLE_COPY(QCanBusFrameLogReader)
+    QScopedPointer<QCanBusFrameLogReaderPrivate> d_ptr;
+};
+
+QT_END_NAMESPACE
+
+#endif // QCANBUSFRAMELOG_H
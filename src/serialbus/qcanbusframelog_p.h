@@ -0,0 +1,214 @@
+/****************************************************************************
+**
+** Copyright (C) 2021 The Qt Company Ltd.
+** Contact: http://www.qt.io/licensing/
+**
+** This file is part of the QtSerialBus module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL3$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see http://www.qt.io/terms-conditions. For further
+** information use the contact form at http://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPLv3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or later as published by the Free
+** Software Foundation and appearing in the file LICENSE.GPL included in
+** the packaging of this file. Please review the following information to
+** ensure the GNU General Public License version 2.0 requirements will be
+** met: http://www.gnu.org/licenses/gpl-2.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#ifndef QCANBUSFRAMELOG_P_H
+#define QCANBUSFRAMELOG_P_H
+
+#include <QtCore/qatomic.h>
+#include <QtCore/qelapsedtimer.h>
+#include <QtCore/qendian.h>
+#include <QtCore/qfile.h>
+#include <QtCore/qmutex.h>
+#include <QtCore/qwaitcondition.h>
+#include <QtSerialBus/qcanbusframelog.h>
+
+#include <deque>
+#include <memory>
+#include <vector>
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API. It exists purely as an
+// implementation detail. This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+//
+
+QT_BEGIN_NAMESPACE
+
+class QThread;
+
+/*
+    Layout of a frame log, all values are little endian:
+
+    file header     8 bytes magic "QtCanLog", quint32 version, quint32 reserved
+    chunk           chunk header followed by size bytes of records
+      ...
+    index           one index entry per chunk, missing if the recording was not closed
+    trailer         quint32 magic "CIDX", quint32 entry count, quint64 index offset
+
+    A chunk header holds quint32 magic "CHNK", quint32 size, quint32 frame count, four
+    reserved bytes and the qint64 time stamps of the first and last frame. An index entry
+    holds the qint64 time stamps of the first and last frame, the quint64 offset of the chunk
+    header, the quint32 frame count and four reserved bytes.
+
+    A record is a 16 byte header followed by the payload: qint64 time stamp in microseconds,
+    quint32 frame identifier (error flags for error frames), quint8 flags, quint8 frame type
+    and quint16 payload length.
+*/
+namespace QCanBusFrameLogFormat {
+
+constexpr char FileMagic[8] = { 'Q', 't', 'C', 'a', 'n', 'L', 'o', 'g' };
+constexpr quint32 Version = 1;
+constexpr quint32 ChunkMagic = 0x4b4e4843;      // "CHNK"
+constexpr quint32 IndexMagic = 0x58444943;      // "CIDX"
+
+enum : qsizetype {
+    FileHeaderSize = 16,
+    ChunkHeaderSize = 32,
+    RecordHeaderSize = 16,
+    IndexEntrySize = 32,
+    TrailerSize = 16,
+    ChunkSize = 64 * 1024
+};
+
+enum RecordFlag : quint8 {
+    ExtendedFrameFormat = 0x01,
+    FlexibleDataRate = 0x02,
+    BitrateSwitch = 0x04,
+    ErrorStateIndicator = 0x08,
+    LocalEcho = 0x10
+};
+
+struct ChunkHeader
+{
+    quint32 size = 0;
+    quint32 frameCount = 0;
+    qint64 firstTimeStamp = 0;
+    qint64 lastTimeStamp = 0;
+};
+
+struct IndexEntry
+{
+    qint64 firstTimeStamp = 0;
+    qint64 lastTimeStamp = 0;
+    quint64 offset = 0;         // of the chunk header
+    quint32 frameCount = 0;
+};
+
+inline qint64 toMicroSeconds(QCanBusFrame::TimeStamp timeStamp)
+{
+    return timeStamp.seconds() * 1000000 + timeStamp.microSeconds();
+}
+
+void writeChunkHeader(uchar *data, const ChunkHeader &header);
+bool readChunkHeader(const uchar *data, ChunkHeader *header);
+void writeIndexEntry(uchar *data, const IndexEntry &entry);
+IndexEntry readIndexEntry(const uchar *data);
+
+// Writes the record of frame to data, which must have room for it, and returns its size.
+qsizetype writeRecord(uchar *data, const QCanBusFrame &frame);
+// Reads the record at data of at most size bytes, returns its size or 0 if it is truncated.
+qsizetype readRecord(const uchar *data, qsizetype size, QCanBusFrame *frame);
+
+inline qsizetype payloadSize(const QCanBusFrame &frame)
+{
+    return qMin(frame.payload().size(), qsizetype(0xffff));
+}
+
+} // namespace QCanBusFrameLogFormat
+
+class QCanBusFrameRecorderPrivate
+{
+public:
+    enum {
+        MaximumPendingChunks = 256,     // 16 MiB waiting for the disk
+        MaximumChunkAge = 1000          // milliseconds until a chunk is written anyway
+    };
+
+    struct Chunk
+    {
+        QByteArray data;
+        QCanBusFrameLogFormat::ChunkHeader header;
+    };
+
+    void startChunk();
+    bool submitChunk();
+    qint64 submitAgedChunk();
+    void writeLoop();
+    bool writeChunk(const Chunk &chunk);
+    bool writeIndex();
+
+    // Owned by the recording thread. The writer thread takes m_currentMutex to submit a
+    // chunk that stays partially filled on a quiet bus; it is taken before m_mutex.
+    QMutex m_currentMutex;
+    Chunk m_current;
+    QElapsedTimer m_chunkAge;           // started with the first frame of m_current
+    QString m_fileName;
+    quint64 m_recordedFrames = 0;
+
+    // Shared with the writer thread, guarded by m_mutex.
+    mutable QMutex m_mutex;
+    QWaitCondition m_chunkAvailable;
+    QWaitCondition m_chunkWritten;
+    std::deque<Chunk> m_pending;
+    std::vector<QByteArray> m_spareBuffers;
+    bool m_writing = false;
+    bool m_stop = false;
+    quint64 m_droppedFrames = 0;
+    QString m_errorString;
+    QAtomicInt m_failed;                // set once writing failed, read without the mutex
+
+    // Owned by the writer thread while it runs.
+    QFile m_file;
+    std::vector<QCanBusFrameLogFormat::IndexEntry> m_index;
+    std::unique_ptr<QThread> m_thread;
+};
+
+class QCanBusFrameLogReaderPrivate
+{
+public:
+    bool readIndex();
+    bool scanChunks();
+    void enterChunk(qsizetype chunk);
+
+    QFile m_file;
+    const uchar *m_data = nullptr;
+    qsizetype m_size = 0;
+    std::vector<QCanBusFrameLogFormat::IndexEntry> m_index;
+    quint64 m_frameCount = 0;
+    qsizetype m_chunk = 0;          // chunk of the next record
+    qsizetype m_position = 0;       // offset of the next record
+    qsizetype m_chunkEnd = 0;       // end of the records of the current chunk
+    QString m_errorString;
+};
+
+QT_END_NAMESPACE
+
+#endif // QCANBUSFRAMELOG_P_H
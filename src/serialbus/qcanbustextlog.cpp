@@ -0,0 +1,1161 @@
+/****************************************************************************
+**
+** Copyright (C) 2021 The Qt Company Ltd.
+** Contact: http://www.qt.io/licensing/
+**
+** This file is part of the QtSerialBus module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL3$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see http://www.qt.io/terms-conditions. For further
+** information use the contact form at http://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPLv3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or later as published by the Free
+** Software Foundation and appearing in the file LICENSE.GPL included in
+** the packaging of this file. Please review the following information to
+** ensure the GNU General Public License version 2.0 requirements will be
+** met: http://www.gnu.org/licenses/gpl-2.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include "qcanbustextlog.h"
+#include "qcanbustextlog_p.h"
+
+#include <QtCore/qdatetime.h>
+#include <QtCore/qfiledevice.h>
+#include <QtCore/qiodevice.h>
+#include <QtCore/qlocale.h>
+
+#include <cstring>
+
+QT_BEGIN_NAMESPACE
+
+namespace {
+
+enum : quint32 {
+    FrameIdMask = 0x1fffffff,
+    CandumpErrorFlag = 0x20000000,      // CAN_ERR_FLAG of SocketCAN
+    CandumpBitrateSwitch = 0x1,
+    CandumpErrorStateIndicator = 0x2,
+    AscRemoteFlag = 0x10,
+    AscExtendedDataLengthFlag = 0x1000,
+    AscBitrateSwitchFlag = 0x2000,
+    AscErrorStateIndicatorFlag = 0x4000
+};
+
+constexpr char HexDigits[] = "0123456789ABCDEF";
+
+inline bool isSpace(char c)
+{
+    return c == ' ' || c == '\t';
+}
+
+inline int hexValue(char c)
+{
+    if (c >= '0' && c <= '9')
+        return c - '0';
+    if (c >= 'A' && c <= 'F')
+        return c - 'A' + 10;
+    if (c >= 'a' && c <= 'f')
+        return c - 'a' + 10;
+    return -1;
+}
+
+// Scans one line in place. All functions leave the position unchanged if they do not match.
+struct Scanner
+{
+    const char *p;
+    const char *end;
+
+    bool atEnd() const { return p == end; }
+    char peek() const { return p != end ? *p : '\0'; }
+
+    bool skipSpaces()
+    {
+        const char *begin = p;
+        while (p != end && isSpace(*p))
+            ++p;
+        return p != begin;
+    }
+
+    bool skip(char c)
+    {
+        if (p == end || *p != c)
+            return false;
+        ++p;
+        return true;
+    }
+
+    // Skips word if it is followed by a space or the end of the line.
+    bool skipWord(QByteArrayView word)
+    {
+        if (end - p < word.size() || std::memcmp(p, word.data(), size_t(word.size())) != 0)
+            return false;
+        const char *next = p + word.size();
+        if (next != end && !isSpace(*next))
+            return false;
+        p = next;
+        return true;
+    }
+
+    QByteArrayView token()
+    {
+        const char *begin = p;
+        while (p != end && !isSpace(*p))
+            ++p;
+        return QByteArrayView(begin, p - begin);
+    }
+
+    // Returns the number of hexadecimal digits read, at most maximumDigits.
+    int hex(quint32 *value, int maximumDigits = 8)
+    {
+        quint32 result = 0;
+        int digits = 0;
+        for (; p != end && digits < maximumDigits; ++p, ++digits) {
+            const int digit = hexValue(*p);
+            if (digit < 0)
+                break;
+            result = (result << 4) | quint32(digit);
+        }
+        *value = result;
+        return digits;
+    }
+
+    int decimal(quint64 *value, int maximumDigits = 19)
+    {
+        quint64 result = 0;
+        int digits = 0;
+        for (; p != end && digits < maximumDigits && *p >= '0' && *p <= '9'; ++p, ++digits)
+            result = result * 10 + quint64(*p - '0');
+        *value = result;
+        return digits;
+    }
+
+    bool number(quint32 *value, bool isDecimal)
+    {
+        if (!isDecimal)
+            return hex(value) > 0;
+        quint64 result;
+        if (!decimal(&result, 10) || result > 0xffffffffU)
+            return false;
+        *value = quint32(result);
+        return true;
+    }
+
+    // Reads seconds with up to six significant fractional digits.
+    bool timeStamp(qint64 *microSeconds)
+    {
+        const char *begin = p;
+        const bool negative = skip('-');
+        quint64 seconds;
+        if (!decimal(&seconds, 12)) {
+            p = begin;
+            return false;
+        }
+        quint64 fraction = 0;
+        if (skip('.')) {
+            int digits = 0;
+            for (; p != end && *p >= '0' && *p <= '9'; ++p) {
+                if (digits < 6) {
+                    fraction = fraction * 10 + quint64(*p - '0');
+                    ++digits;
+                }
+            }
+            for (; digits < 6; ++digits)
+                fraction *= 10;
+        }
+        const qint64 result = qint64(seconds * 1000000 + fraction);
+        *microSeconds = negative ? -result : result;
+        return true;
+    }
+};
+
+inline char *writeHex(char *out, quint32 value, int digits)
+{
+    for (int i = digits - 1; i >= 0; --i, value >>= 4)
+        out[i] = HexDigits[value & 0xf];
+    return out + digits;
+}
+
+inline char *writeHex(char *out, quint32 value)
+{
+    int digits = 1;
+    while (digits < 8 && (value >> (4 * digits)))
+        ++digits;
+    return writeHex(out, value, digits);
+}
+
+inline char *writeDecimal(char *out, quint64 value, int minimumDigits = 1)
+{
+    char digits[20];
+    int count = 0;
+    do {
+        digits[count++] = char('0' + value % 10);
+        value /= 10;
+    } while (value || count < minimumDigits);
+    while (count)
+        *out++ = digits[--count];
+    return out;
+}
+
+inline char *writeTimeStamp(char *out, qint64 microSeconds, int minimumSecondDigits)
+{
+    if (microSeconds < 0) {
+        *out++ = '-';
+        microSeconds = -microSeconds;
+    }
+    out = writeDecimal(out, quint64(microSeconds / 1000000), minimumSecondDigits);
+    *out++ = '.';
+    return writeDecimal(out, quint64(microSeconds % 1000000), 6);
+}
+
+inline char *writeBytes(char *out, const char *data, qsizetype size, bool separated)
+{
+    for (qsizetype i = 0; i < size; ++i) {
+        if (separated && i > 0)
+            *out++ = ' ';
+        out = writeHex(out, quint8(data[i]), 2);
+    }
+    return out;
+}
+
+inline char *writeText(char *out, const char *text, qsizetype size)
+{
+    std::memcpy(out, text, size_t(size));
+    return out + size;
+}
+
+inline char *writePadding(char *out, qsizetype size)
+{
+    if (size <= 0)
+        return out;
+    std::memset(out, ' ', size_t(size));
+    return out + size;
+}
+
+inline qint64 toMicroSeconds(QCanBusFrame::TimeStamp timeStamp)
+{
+    return timeStamp.seconds() * 1000000 + timeStamp.microSeconds();
+}
+
+inline quint32 flexibleDataRateDlc(qsizetype size)
+{
+    if (size <= 8)
+        return quint32(size);
+    constexpr qsizetype sizes[] = { 12, 16, 20, 24, 32, 48 };
+    for (quint32 i = 0; i < sizeof(sizes) / sizeof(sizes[0]); ++i) {
+        if (size <= sizes[i])
+            return 9 + i;
+    }
+    return 15;
+}
+
+} // namespace
+
+/*!
+    \class QCanBusTextLogReader
+    \inmodule QtSerialBus
+    \since 6.1
+
+    \brief The QCanBusTextLogReader class reads CAN frames from candump and
+    Vector ASC text logs.
+
+    The reader streams a log from a QIODevice and never holds more than one
+    megabyte of it in memory, so it is suitable for logs of any size. Lines
+    are scanned in place without converting them to QString; the only
+    allocation per frame is its payload.
+
+    \code
+        QFile file(QStringLiteral("trace.log"));
+        if (!file.open(QIODevice::ReadOnly))
+            return;
+
+        QCanBusTextLogReader reader(QCanBusTextLogReader::CandumpFormat, &file);
+        QCanBusFrame frame;
+        while (reader.readFrame(&frame))
+            process(frame);
+    \endcode
+
+    Lines that do not hold a frame are skipped and counted in
+    skippedLines(). In ASC logs, the header lines set the time base, the
+    number base and whether time stamps are relative; events such as
+    \c {Start of measurement} are skipped.
+
+    \sa QCanBusTextLogWriter, QCanBusFrameLogReader
+*/
+
+/*!
+    \enum QCanBusTextLogReader::Format
+
+    This enum describes the text log formats.
+
+    \value CandumpFormat    The log format of the Linux \c candump utility,
+                            as written by \c {candump -l}, for example
+                            \c {(1602345600.123456) can0 123#DEADBEEF}.
+                            A trailing \c T marks frames sent by the
+                            interface; they are read as local echo frames.
+    \value AscFormat        The Vector ASC format.
+*/
+
+/*!
+    \enum QCanBusTextLogReader::Error
+
+    This enum describes the errors of the reader.
+
+    \value NoError          No error occurred.
+    \value ReadError        Reading the device failed.
+*/
+
+void QCanBusTextLogReaderPrivate::reset()
+{
+    m_begin = m_end = 0;
+    m_discarding = false;
+    m_deviceAtEnd = false;
+    m_lineNumber = 0;
+    m_skippedLines = 0;
+    m_error = QCanBusTextLogReader::NoError;
+    m_errorString.clear();
+    m_ascDecimal = false;
+    m_ascRelative = false;
+    m_ascStartTime = 0;
+    m_ascLastTime = 0;
+}
+
+bool QCanBusTextLogReaderPrivate::nextLine(const char **begin, const char **end)
+{
+    if (!m_device)
+        return false;
+    if (m_buffer.isEmpty())
+        m_buffer = QByteArray(BufferSize, Qt::Uninitialized);
+
+    for (;;) {
+        char *data = m_buffer.data();
+        const char *lineBegin = data + m_begin;
+        const auto newline = static_cast<const char *>(
+            std::memchr(lineBegin, '\n', size_t(m_end - m_begin)));
+        if (newline || (m_deviceAtEnd && m_begin < m_end)) {
+            const char *lineEnd = newline ? newline : data + m_end;
+            m_begin = newline ? newline + 1 - data : m_end;
+            if (m_discarding) {
+                m_discarding = false;
+                continue;
+            }
+            ++m_lineNumber;
+            if (lineEnd != lineBegin && lineEnd[-1] == '\r')
+                --lineEnd;
+            *begin = lineBegin;
+            *end = lineEnd;
+            return true;
+        }
+        if (m_deviceAtEnd)
+            return false;
+
+        if (m_begin == 0 && m_end == BufferSize) {
+            // The line does not fit into the buffer, drop it up to its end.
+            if (!m_discarding) {
+                ++m_lineNumber;
+                ++m_skippedLines;
+                m_discarding = true;
+            }
+            m_end = 0;
+        } else if (m_begin > 0) {
+            std::memmove(data, data + m_begin, size_t(m_end - m_begin));
+            m_end -= m_begin;
+            m_begin = 0;
+        }
+
+        const qint64 read = m_device->read(data + m_end, BufferSize - m_end);
+        if (read < 0) {
+            m_error = QCanBusTextLogReader::ReadError;
+            m_errorString = m_device->errorString();
+            m_deviceAtEnd = true;
+        } else if (read == 0) {
+            // A sequential device may deliver the rest of the line later.
+            if (!m_device->atEnd())
+                return false;
+            m_deviceAtEnd = true;
+        } else {
+            m_end += read;
+        }
+    }
+}
+
+QCanBusTextLogReaderPrivate::LineType QCanBusTextLogReaderPrivate::parseCandump(
+        const char *begin, const char *end, QCanBusFrame *frame)
+{
+    Scanner s{begin, end};
+    s.skipSpaces();
+    if (s.atEnd())
+        return MetaDataLine;
+
+    qint64 timeStamp;
+    if (!s.skip('(') || !s.timeStamp(&timeStamp) || !s.skip(')') || !s.skipSpaces())
+        return InvalidLine;
+    if (s.token().isEmpty() || !s.skipSpaces())    // interface name
+        return InvalidLine;
+
+    quint32 id;
+    const int idDigits = s.hex(&id);
+    if ((idDigits != 3 && idDigits != 8) || !s.skip('#'))
+        return InvalidLine;
+    const bool isError = idDigits == 8 && (id & ~FrameIdMask) == CandumpErrorFlag;
+    if (!isError && id > FrameIdMask)
+        return InvalidLine;
+
+    char payload[64];
+    qsizetype size = 0;
+    bool isRemote = false;
+    bool isFlexibleDataRate = false;
+    quint32 flags = 0;
+    if (s.skip('R')) {
+        isRemote = true;
+        quint32 length = 0;
+        s.hex(&length, 1);
+        size = qMin(qsizetype(length), qsizetype(8));
+        std::memset(payload, 0, size_t(size));
+    } else {
+        // CAN XL frames (###) have no flags digit and are rejected here.
+        if (s.skip('#')) {
+            isFlexibleDataRate = true;
+            if (!s.hex(&flags, 1))
+                return InvalidLine;
+        }
+        const qsizetype maximumSize = isFlexibleDataRate ? 64 : 8;
+        for (;;) {
+            s.skip('.');
+            quint32 byte;
+            const int digits = s.hex(&byte, 2);
+            if (digits == 0)
+                break;
+            if (digits != 2 || size == maximumSize)
+                return InvalidLine;
+            payload[size++] = char(byte);
+        }
+        // The raw DLC of classic frames with eight bytes (_9 to _F) cannot be represented.
+        quint32 dlc;
+        if (!isFlexibleDataRate && s.skip('_') && !s.hex(&dlc, 1))
+            return InvalidLine;
+    }
+
+    bool isLocalEcho = false;
+    if (s.skipSpaces()) {
+        isLocalEcho = s.skipWord("T");
+        if (!isLocalEcho)
+            s.skipWord("R");
+        s.skipSpaces();
+    }
+    if (!s.atEnd())
+        return InvalidLine;
+
+    if (isError) {
+        *frame = QCanBusFrame(QCanBusFrame::ErrorFrame);
+        frame->setError(QCanBusFrame::FrameErrors(int(id & FrameIdMask)));
+    } else {
+        *frame = QCanBusFrame(isRemote ? QCanBusFrame::RemoteRequestFrame
+                                       : QCanBusFrame::DataFrame);
+        frame->setExtendedFrameFormat(idDigits == 8);
+        frame->setFrameId(id);
+    }
+    frame->setPayload(QByteArray(payload, size));
+    frame->setFlexibleDataRateFormat(isFlexibleDataRate);
+    frame->setBitrateSwitch(flags & CandumpBitrateSwitch);
+    frame->setErrorStateIndicator(flags & CandumpErrorStateIndicator);
+    frame->setLocalEcho(isLocalEcho);
+    frame->setTimeStamp(QCanBusFrame::TimeStamp::fromMicroSeconds(timeStamp));
+    return FrameLine;
+}
+
+QCanBusTextLogReaderPrivate::LineType QCanBusTextLogReaderPrivate::parseAscHeader(
+        const char *begin, const char *end)
+{
+    Scanner s{begin, end};
+    if (s.skipWord("date")) {
+        s.skipSpaces();
+        const QString text = QString::fromLatin1(s.p, s.end - s.p).simplified();
+        const QLocale c = QLocale::c();
+        for (const char *format : { "ddd MMM d hh:mm:ss.zzz ap yyyy", "ddd MMM d hh:mm:ss ap yyyy",
+                                    "ddd MMM d HH:mm:ss.zzz yyyy", "ddd MMM d HH:mm:ss yyyy" }) {
+            const QDateTime dateTime = c.toDateTime(text, QLatin1String(format));
+            if (dateTime.isValid()) {
+                m_ascStartTime = dateTime.toMSecsSinceEpoch() * 1000;
+                break;
+            }
+        }
+        return MetaDataLine;
+    }
+    if (s.skipWord("base")) {
+        s.skipSpaces();
+        m_ascDecimal = s.skipWord("dec");
+        if (!m_ascDecimal)
+            s.token();
+        s.skipSpaces();
+        if (s.skipWord("timestamps")) {
+            s.skipSpaces();
+            m_ascRelative = s.skipWord("relative");
+        }
+        return MetaDataLine;
+    }
+    if (s.skipWord("Begin")) {
+        m_ascLastTime = 0;
+        return MetaDataLine;
+    }
+    if (s.skipWord("End") || s.skipWord("internal") || s.skipWord("no")
+            || (s.skip('/') && s.skip('/'))) {
+        return MetaDataLine;
+    }
+    return InvalidLine;
+}
+
+QCanBusTextLogReaderPrivate::LineType QCanBusTextLogReaderPrivate::parseAsc(
+        const char *begin, const char *end, QCanBusFrame *frame)
+{
+    Scanner s{begin, end};
+    s.skipSpaces();
+    if (s.atEnd())
+        return MetaDataLine;
+    if (s.peek() != '-' && (s.peek() < '0' || s.peek() > '9'))
+        return parseAscHeader(s.p, s.end);
+
+    qint64 time;
+    if (!s.timeStamp(&time) || !s.skipSpaces())
+        return InvalidLine;
+    if (m_ascRelative)
+        time += m_ascLastTime;
+    m_ascLastTime = time;
+    const auto timeStamp = QCanBusFrame::TimeStamp::fromMicroSeconds(m_ascStartTime + time);
+
+    const auto readId = [this, &s](quint32 *id, bool *isExtended) {
+        if (!s.number(id, m_ascDecimal))
+            return false;
+        *isExtended = s.skip('x') || *id > 0x7ff;
+        return *id <= FrameIdMask && s.skipSpaces();
+    };
+    const auto readDirection = [&s](bool *isTransmitted) {
+        *isTransmitted = s.skipWord("Tx");
+        return (*isTransmitted || s.skipWord("Rx")) && s.skipSpaces();
+    };
+    const auto readBytes = [this, &s](char *payload, qsizetype size) {
+        for (qsizetype i = 0; i < size; ++i) {
+            quint32 byte;
+            s.skipSpaces();
+            if (!s.number(&byte, m_ascDecimal) || byte > 0xff)
+                return false;
+            payload[i] = char(byte);
+        }
+        return true;
+    };
+
+    char payload[64];
+    qsizetype size = 0;
+    quint32 id;
+    bool isExtended = false;
+    bool isTransmitted = false;
+    bool isRemote = false;
+    bool isFlexibleDataRate = false;
+    bool bitrateSwitch = false;
+    bool errorStateIndicator = false;
+    quint64 channel;
+
+    if (s.skipWord("CANFD")) {
+        // channel dir id [name] brs esi dlc length data duration bits flags crc timing...
+        s.skipSpaces();
+        quint32 dlc;
+        quint64 length;
+        if (!s.decimal(&channel) || !s.skipSpaces() || !readDirection(&isTransmitted)
+                || !readId(&id, &isExtended)) {
+            return InvalidLine;
+        }
+        const auto isFlag = [&s]() {
+            return (s.peek() == '0' || s.peek() == '1') && (s.end - s.p == 1 || isSpace(s.p[1]));
+        };
+        if (!isFlag()) {
+            s.token();      // symbolic name
+            s.skipSpaces();
+        }
+        if (!isFlag())
+            return InvalidLine;
+        bitrateSwitch = s.peek() == '1';
+        s.token();
+        s.skipSpaces();
+        if (!isFlag())
+            return InvalidLine;
+        errorStateIndicator = s.peek() == '1';
+        s.token();
+        s.skipSpaces();
+        if (!s.hex(&dlc, 1) || !s.skipSpaces() || !s.decimal(&length, 2) || length > 64)
+            return InvalidLine;
+        size = qsizetype(length);
+        if (!readBytes(payload, size))
+            return InvalidLine;
+
+        isFlexibleDataRate = true;
+        s.skipSpaces();
+        s.token();          // message duration
+        s.skipSpaces();
+        s.token();          // message length
+        s.skipSpaces();
+        quint32 flags;
+        if (s.hex(&flags) > 0 && !(flags & AscExtendedDataLengthFlag)) {
+            // A classic frame logged in the CAN FD format.
+            isFlexibleDataRate = bitrateSwitch = errorStateIndicator = false;
+            isRemote = flags & AscRemoteFlag;
+            if (isRemote) {
+                size = qMin(qsizetype(dlc), qsizetype(8));
+                std::memset(payload, 0, size_t(size));
+            }
+        }
+    } else {
+        // Events such as "Start of measurement" have no channel.
+        if (!s.decimal(&channel) || !s.skipSpaces())
+            return InvalidLine;
+        if (s.skipWord("ErrorFrame")) {
+            *frame = QCanBusFrame(QCanBusFrame::ErrorFrame);
+            frame->setError(QCanBusFrame::UnknownError);
+            frame->setTimeStamp(timeStamp);
+            return FrameLine;
+        }
+        if (!readId(&id, &isExtended) || !readDirection(&isTransmitted))
+            return InvalidLine;
+
+        quint32 dlc = 0;
+        if (s.skipWord("r")) {
+            isRemote = true;
+            s.skipSpaces();
+            s.hex(&dlc, 1);
+            size = qMin(qsizetype(dlc), qsizetype(8));
+            std::memset(payload, 0, size_t(size));
+        } else if (s.skipWord("d")) {
+            s.skipSpaces();
+            if (!s.hex(&dlc, 1))
+                return InvalidLine;
+            size = qMin(qsizetype(dlc), qsizetype(8));
+            if (!readBytes(payload, size))
+                return InvalidLine;
+        } else {
+            return InvalidLine;
+        }
+    }
+
+    *frame = QCanBusFrame(isRemote ? QCanBusFrame::RemoteRequestFrame : QCanBusFrame::DataFrame);
+    frame->setExtendedFrameFormat(isExtended);
+    frame->setFrameId(id);
+    frame->setPayload(QByteArray(payload, size));
+    frame->setFlexibleDataRateFormat(isFlexibleDataRate);
+    frame->setBitrateSwitch(bitrateSwitch);
+    frame->setErrorStateIndicator(errorStateIndicator);
+    frame->setLocalEcho(isTransmitted);
+    frame->setTimeStamp(timeStamp);
+    return FrameLine;
+}
+
+/*!
+    Constructs a reader for logs in \a format that reads from \a device.
+*/
+QCanBusTextLogReader::QCanBusTextLogReader(Format format, QIODevice *device)
+    : d_ptr(new QCanBusTextLogReaderPrivate)
+{
+    Q_D(QCanBusTextLogReader);
+    d->m_format = format;
+    d->m_device = device;
+}
+
+/*!
+    Destroys the reader. The device is not closed.
+*/
+QCanBusTextLogReader::~QCanBusTextLogReader() = default;
+
+/*!
+    Returns the format of the log.
+*/
+QCanBusTextLogReader::Format QCanBusTextLogReader::format() const
+{
+    Q_D(const QCanBusTextLogReader);
+    return d->m_format;
+}
+
+/*!
+    Sets the \a format of the log.
+*/
+void QCanBusTextLogReader::setFormat(Format format)
+{
+    Q_D(QCanBusTextLogReader);
+    d->m_format = format;
+}
+
+/*!
+    Returns the device the log is read from.
+*/
+QIODevice *QCanBusTextLogReader::device() const
+{
+    Q_D(const QCanBusTextLogReader);
+    return d->m_device;
+}
+
+/*!
+    Sets the \a device to read the log from, which must be open for
+    reading. Data buffered from the previous device is discarded and the
+    line counters and the error are reset.
+*/
+void QCanBusTextLogReader::setDevice(QIODevice *device)
+{
+    Q_D(QCanBusTextLogReader);
+    d->m_device = device;
+    d->reset();
+}
+
+/*!
+    Reads the next frame of the log into \a frame and returns \c true.
+    Returns \c false at the end of the log, if reading the device failed,
+    or if a sequential device has no complete line available yet; in the
+    last case atEnd() returns \c false and the call can be repeated once
+    more data arrived.
+*/
+bool QCanBusTextLogReader::readFrame(QCanBusFrame *frame)
+{
+    Q_D(QCanBusTextLogReader);
+    Q_ASSERT(frame);
+
+    const char *begin;
+    const char *end;
+    while (d->nextLine(&begin, &end)) {
+        const auto type = d->m_format == AscFormat ? d->parseAsc(begin, end, frame)
+                                                   : d->parseCandump(begin, end, frame);
+        if (type == QCanBusTextLogReaderPrivate::FrameLine)
+            return true;
+        if (type == QCanBusTextLogReaderPrivate::InvalidLine)
+            ++d->m_skippedLines;
+    }
+    return false;
+}
+
+/*!
+    Returns \c true if the reader reached the end of the device or no
+    device is set.
+*/
+bool QCanBusTextLogReader::atEnd() const
+{
+    Q_D(const QCanBusTextLogReader);
+    return !d->m_device || (d->m_deviceAtEnd && d->m_begin == d->m_end);
+}
+
+/*!
+    Returns the number of the line that was read last, starting at 1.
+*/
+qint64 QCanBusTextLogReader::lineNumber() const
+{
+    Q_D(const QCanBusTextLogReader);
+    return d->m_lineNumber;
+}
+
+/*!
+    Returns the number of non-empty lines that were skipped because they
+    did not hold a frame in the log format, or were longer than one
+    megabyte.
+*/
+qint64 QCanBusTextLogReader::skippedLines() const
+{
+    Q_D(const QCanBusTextLogReader);
+    return d->m_skippedLines;
+}
+
+/*!
+    Returns the last error.
+*/
+QCanBusTextLogReader::Error QCanBusTextLogReader::error() const
+{
+    Q_D(const QCanBusTextLogReader);
+    return d->m_error;
+}
+
+/*!
+    Returns a description of the last error.
+*/
+QString QCanBusTextLogReader::errorString() const
+{
+    Q_D(const QCanBusTextLogReader);
+    return d->m_errorString;
+}
+
+/*!
+    \class QCanBusTextLogWriter
+    \inmodule QtSerialBus
+    \since 6.1
+
+    \brief The QCanBusTextLogWriter class writes CAN frames as candump or
+    Vector ASC text logs.
+
+    Lines are formatted into a 64 KiB buffer without going through QString
+    and handed to the device when the buffer is full, or when flush() or
+    finish() is called.
+
+    \code
+        QFile file(QStringLiteral("trace.asc"));
+        if (!file.open(QIODevice::WriteOnly))
+            return;
+
+        QCanBusTextLogWriter writer(QCanBusTextLogReader::AscFormat, &file);
+        for (const QCanBusFrame &frame : frames)
+            writer.writeFrame(frame);
+        writer.finish();
+    \endcode
+
+    ASC time stamps are written relative to the time stamp of the first
+    frame, which is written to the header of the log in local time. ASC
+    error frames do not carry the error flags of QCanBusFrame::error().
+
+    \sa QCanBusTextLogReader, QCanBusFrameRecorder
+*/
+
+/*!
+    \enum QCanBusTextLogWriter::Error
+
+    This enum describes the errors of the writer.
+
+    \value NoError          No error occurred.
+    \value WriteError       Writing to the device failed.
+*/
+
+char *QCanBusTextLogWriterPrivate::reserve(qsizetype size)
+{
+    if (m_size + size > m_buffer.size() && m_size > 0)
+        writeBuffer();
+    if (size > m_buffer.size())
+        m_buffer = QByteArray(qMax(size, qsizetype(BufferSize)), Qt::Uninitialized);
+    return m_buffer.data() + m_size;
+}
+
+bool QCanBusTextLogWriterPrivate::writeBuffer()
+{
+    const qsizetype size = m_size;
+    m_size = 0;
+    if (size == 0 || m_error != QCanBusTextLogWriter::NoError)
+        return m_error == QCanBusTextLogWriter::NoError;
+    if (m_device->write(m_buffer.constData(), size) != size) {
+        m_error = QCanBusTextLogWriter::WriteError;
+        m_errorString = m_device->errorString();
+        return false;
+    }
+    return true;
+}
+
+void QCanBusTextLogWriterPrivate::writeAscHeader(qint64 timeStamp)
+{
+    const qint64 milliSeconds = timeStamp / 1000;
+    m_startTime = milliSeconds * 1000;
+    const QByteArray date = QLocale::c().toString(QDateTime::fromMSecsSinceEpoch(milliSeconds),
+                                                  u"ddd MMM dd hh:mm:ss.zzz ap yyyy").toLatin1();
+    const QByteArray header = "date " + date + "\n"
+                              "base hex  timestamps absolute\n"
+                              "no internal events logged\n"
+                              "// version 13.0.0\n"
+                              "Begin Triggerblock " + date + "\n"
+                              "   0.000000 Start of measurement\n";
+    char *out = writeText(reserve(header.size()), header.constData(), header.size());
+    m_size = out - m_buffer.constData();
+}
+
+void QCanBusTextLogWriterPrivate::writeCandump(const QCanBusFrame &frame, qint64 timeStamp)
+{
+    static const QByteArray defaultChannel = QByteArrayLiteral("can0");
+    const QByteArray &channel = m_channel.isEmpty() ? defaultChannel : m_channel;
+
+    char *out = reserve(MaximumLineSize + channel.size());
+    *out++ = '(';
+    out = writeTimeStamp(out, timeStamp, 10);
+    *out++ = ')';
+    *out++ = ' ';
+    out = writeText(out, channel.constData(), channel.size());
+    *out++ = ' ';
+
+    const QByteArray payload = frame.payload();
+    const bool isFlexibleDataRate = frame.hasFlexibleDataRateFormat();
+    const qsizetype size = qMin(payload.size(), qsizetype(isFlexibleDataRate ? 64 : 8));
+    if (frame.frameType() == QCanBusFrame::ErrorFrame) {
+        out = writeHex(out, CandumpErrorFlag | (quint32(frame.error()) & FrameIdMask), 8);
+        *out++ = '#';
+        out = writeBytes(out, payload.constData(), size, false);
+    } else {
+        out = writeHex(out, frame.frameId(), frame.hasExtendedFrameFormat() ? 8 : 3);
+        *out++ = '#';
+        if (frame.frameType() == QCanBusFrame::RemoteRequestFrame) {
+            *out++ = 'R';
+            if (size > 0)
+                *out++ = HexDigits[size];
+        } else {
+            if (isFlexibleDataRate) {
+                *out++ = '#';
+                *out++ = HexDigits[(frame.hasBitrateSwitch() ? CandumpBitrateSwitch : 0)
+                        | (frame.hasErrorStateIndicator() ? CandumpErrorStateIndicator : 0)];
+            }
+            out = writeBytes(out, payload.constData(), size, false);
+        }
+    }
+    if (frame.hasLocalEcho()) {
+        *out++ = ' ';
+        *out++ = 'T';
+    }
+    *out++ = '\n';
+    m_size = out - m_buffer.constData();
+}
+
+void QCanBusTextLogWriterPrivate::writeAsc(const QCanBusFrame &frame, qint64 timeStamp)
+{
+    static const QByteArray defaultChannel = QByteArrayLiteral("1");
+    const QByteArray &channel = m_channel.isEmpty() ? defaultChannel : m_channel;
+
+    char *out = reserve(MaximumLineSize + channel.size());
+    char field[32];
+    char *fieldEnd = writeTimeStamp(field, timeStamp - m_startTime, 1);
+    out = writePadding(out, 11 - (fieldEnd - field));
+    out = writeText(out, field, fieldEnd - field);
+    *out++ = ' ';
+
+    const auto writeId = [&frame](char *out) {
+        out = writeHex(out, frame.frameId());
+        if (frame.hasExtendedFrameFormat())
+            *out++ = 'x';
+        return out;
+    };
+    const char *direction = frame.hasLocalEcho() ? "Tx  " : "Rx  ";
+    const QByteArray payload = frame.payload();
+
+    if (frame.frameType() == QCanBusFrame::ErrorFrame) {
+        out = writeText(out, channel.constData(), channel.size());
+        out = writeText(out, "  ErrorFrame", 12);
+    } else if (frame.hasFlexibleDataRateFormat()) {
+        const qsizetype size = qMin(payload.size(), qsizetype(64));
+        const quint32 flags = AscExtendedDataLengthFlag
+                | (frame.hasBitrateSwitch() ? AscBitrateSwitchFlag : 0)
+                | (frame.hasErrorStateIndicator() ? AscErrorStateIndicatorFlag : 0);
+        out = writeText(out, "CANFD ", 6);
+        out = writePadding(out, 3 - channel.size());
+        out = writeText(out, channel.constData(), channel.size());
+        *out++ = ' ';
+        out = writeText(out, direction, 4);
+        *out++ = ' ';
+        fieldEnd = writeId(field);
+        out = writePadding(out, 8 - (fieldEnd - field));
+        out = writeText(out, field, fieldEnd - field);
+        *out++ = ' ';
+        *out++ = frame.hasBitrateSwitch() ? '1' : '0';
+        *out++ = ' ';
+        *out++ = frame.hasErrorStateIndicator() ? '1' : '0';
+        *out++ = ' ';
+        *out++ = HexDigits[flexibleDataRateDlc(size)];
+        *out++ = ' ';
+        if (size < 10)
+            *out++ = ' ';
+        out = writeDecimal(out, quint64(size));
+        *out++ = ' ';
+        if (size > 0) {
+            out = writeBytes(out, payload.constData(), size, true);
+            *out++ = ' ';
+        }
+        out = writeText(out, "0 0 ", 4);
+        out = writeHex(out, flags);
+        out = writeText(out, " 0 0 0 0 0", 10);
+    } else {
+        const qsizetype size = qMin(payload.size(), qsizetype(8));
+        out = writeText(out, channel.constData(), channel.size());
+        out = writeText(out, "  ", 2);
+        fieldEnd = writeId(field);
+        out = writeText(out, field, fieldEnd - field);
+        out = writePadding(out, 16 - (fieldEnd - field));
+        out = writeText(out, direction, 4);
+        *out++ = ' ';
+        if (frame.frameType() == QCanBusFrame::RemoteRequestFrame) {
+            *out++ = 'r';
+            if (size > 0) {
+                *out++ = ' ';
+                *out++ = HexDigits[size];
+            }
+        } else {
+            *out++ = 'd';
+            *out++ = ' ';
+            *out++ = HexDigits[size];
+            if (size > 0) {
+                *out++ = ' ';
+                out = writeBytes(out, payload.constData(), size, true);
+            }
+        }
+    }
+    *out++ = '\n';
+    m_size = out - m_buffer.constData();
+}
+
+/*!
+    Constructs a writer for logs in \a format that writes to \a device.
+*/
+QCanBusTextLogWriter::QCanBusTextLogWriter(QCanBusTextLogReader::Format format,
+                                           QIODevice *device)
+    : d_ptr(new QCanBusTextLogWriterPrivate)
+{
+    Q_D(QCanBusTextLogWriter);
+    d->m_format = format;
+    d->m_device = device;
+}
+
+/*!
+    Calls finish() and destroys the writer. The device is not closed.
+*/
+QCanBusTextLogWriter::~QCanBusTextLogWriter()
+{
+    finish();
+}
+
+/*!
+    Returns the format of the log.
+*/
+QCanBusTextLogReader::Format QCanBusTextLogWriter::format() const
+{
+    Q_D(const QCanBusTextLogWriter);
+    return d->m_format;
+}
+
+/*!
+    Sets the \a format of the log. The format should be set before the
+    first frame is written.
+*/
+void QCanBusTextLogWriter::setFormat(QCanBusTextLogReader::Format format)
+{
+    Q_D(QCanBusTextLogWriter);
+    d->m_format = format;
+}
+
+/*!
+    Returns the device the log is written to.
+*/
+QIODevice *QCanBusTextLogWriter::device() const
+{
+    Q_D(const QCanBusTextLogWriter);
+    return d->m_device;
+}
+
+/*!
+    Calls finish() for the current device and sets the \a device to write
+    the log to, which must be open for writing. The error is reset.
+*/
+void QCanBusTextLogWriter::setDevice(QIODevice *device)
+{
+    Q_D(QCanBusTextLogWriter);
+    finish();
+    d->m_device = device;
+    d->m_error = NoError;
+    d->m_errorString.clear();
+}
+
+/*!
+    Returns the channel written for each frame. The default is \c can0 for
+    candump logs and \c 1 for ASC logs.
+*/
+QString QCanBusTextLogWriter::channel() const
+{
+    Q_D(const QCanBusTextLogWriter);
+    if (!d->m_channel.isEmpty())
+        return QString::fromLatin1(d->m_channel);
+    return d->m_format == QCanBusTextLogReader::AscFormat ? QStringLiteral("1")
+                                                          : QStringLiteral("can0");
+}
+
+/*!
+    Sets the \a channel written for each frame: the interface name for
+    candump logs, or the channel number for ASC logs. An empty string
+    restores the default.
+*/
+void QCanBusTextLogWriter::setChannel(const QString &channel)
+{
+    Q_D(QCanBusTextLogWriter);
+    d->m_channel = channel.toLatin1();
+}
+
+/*!
+    Appends \a frame to the log. Returns \c false if no device is set or
+    writing to the device failed.
+*/
+bool QCanBusTextLogWriter::writeFrame(const QCanBusFrame &frame)
+{
+    Q_D(QCanBusTextLogWriter);
+    if (!d->m_device || d->m_error != NoError)
+        return false;
+
+    const qint64 timeStamp = toMicroSeconds(frame.timeStamp());
+    if (d->m_format == QCanBusTextLogReader::AscFormat) {
+        if (!d->m_started)
+            d->writeAscHeader(timeStamp);
+        d->writeAsc(frame, timeStamp);
+    } else {
+        d->writeCandump(frame, timeStamp);
+    }
+    d->m_started = true;
+    return d->m_error == NoError;
+}
+
+/*!
+    Writes the buffered lines to the device and flushes it if it is a
+    QFileDevice. Returns \c false if writing failed.
+*/
+bool QCanBusTextLogWriter::flush()
+{
+    Q_D(QCanBusTextLogWriter);
+    if (!d->m_device)
+        return false;
+    if (!d->writeBuffer())
+        return false;
+    if (auto file = qobject_cast<QFileDevice *>(d->m_device))
+        file->flush();
+    return true;
+}
+
+/*!
+    Completes the log, for example by writing the end of the trigger block
+    of an ASC log, and calls flush(). Frames written afterwards start a new
+    log. Returns \c false if writing failed.
+*/
+bool QCanBusTextLogWriter::finish()
+{
+    Q_D(QCanBusTextLogWriter);
+    if (!d->m_device)
+        return false;
+    if (d->m_started && d->m_format == QCanBusTextLogReader::AscFormat) {
+        char *out = writeText(d->reserve(17), "End TriggerBlock\n", 17);
+        d->m_size = out - d->m_buffer.constData();
+    }
+    d->m_started = false;
+    return flush();
+}
+
+/*!
+    Returns the last error.
+*/
+QCanBusTextLogWriter::Error QCanBusTextLogWriter::error() const
+{
+    Q_D(const QCanBusTextLogWriter);
+    return d->m_error;
+}
+
+/*!
+    Returns a description of the last error.
+*/
+QString QCanBusTextLogWriter::errorString() const
+{
+    Q_D(const QCanBusTextLogWriter);
+    return d->m_errorString;
+}
+
+QT_END_NAMESPACE
@@ -0,0 +1,125 @@
+/****************************************************************************
+**
+** Copyright (C) 2021 The Qt Company Ltd.
+** Contact: http://www.qt.io/licensing/
+**
+** This file is part of the QtSerialBus module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL3$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see http://www.qt.io/terms-conditions. For further
+** information use the contact form at http://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPLv3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or later as published by the Free
+** Software Foundation and appearing in the file LICENSE.GPL included in
+** the packaging of this file. Please review the following information to
+** ensure the GNU General Public License version 2.0 requirements will be
+** met: http://www.gnu.org/licenses/gpl-2.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#ifndef QCANBUSTEXTLOG_H
+#define QCANBUSTEXTLOG_H
+
+#include <QtCore/qcoreapplication.h>
+#include <QtCore/qscopedpointer.h>
+#include <QtSerialBus/qcanbusframe.h>
+
+QT_BEGIN_NAMESPACE
+
+class QIODevice;
+class QCanBusTextLogReaderPrivate;
+class QCanBusTextLogWriterPrivate;
+
+class Q_SERIALBUS_EXPORT QCanBusTextLogReader
+{
+    Q_DECLARE_PRIVATE(QCanBusTextLogReader)
+    Q_DECLARE_TR_FUNCTIONS(QCanBusTextLogReader)
+
+public:
+    enum Format {
+        CandumpFormat,
+        AscFormat
+    };
+
+    enum Error {
+        NoError,
+        ReadError
+    };
+
+    explicit QCanBusTextLogReader(Format format = CandumpFormat, QIODevice *device = nullptr);
+    ~QCanBusTextLogReader();
+
+    Format format() const;
+    void setFormat(Format format);
+    QIODevice *device() const;
+    void setDevice(QIODevice *device);
+
+    bool readFrame(QCanBusFrame *frame);
+    bool atEnd() const;
+
+    qint64 lineNumber() const;
+    qint64 skippedLines() const;
+
+    Error error() const;
+    QString errorString() const;
+
+private:
+    Q_DISABLE_COPY(QCanBusTextLogReader)
+    QScopedPointer<QCanBusTextLogReaderPrivate> d_ptr;
+};
+
+class Q_SERIALBUS_EXPORT QCanBusTextLogWriter
+{
+    Q_DECLARE_PRIVATE(QCanBusTextLogWriter)
+    Q_DECLARE_TR_FUNCTIONS(QCanBusTextLogWriter)
+
+public:
+    enum Error {
+        NoError,
+        WriteError
+    };
+
+    explicit QCanBusTextLogWriter(QCanBusTextLogReader::Format format
+                                      = QCanBusTextLogReader::CandumpFormat,
+                                  QIODevice *device = nullptr);
+    ~QCanBusTextLogWriter();
+
+    QCanBusTextLogReader::Format format() const;
+    void setFormat(QCanBusTextLogReader::Format format);
+    QIODevice *device() const;
+    void setDevice(QIODevice *device);
+    QString channel() const;
+    void setChannel(const QString &channel);
+
+    bool writeFrame(const QCanBusFrame &frame);
+    bool flush();
+    bool finish();
+
+    Error error() const;
+    QString errorString() const;
+
+private:
+    Q_DISABLE_COPY(QCanBusTextLogWriter)
+    QScopedPointer<QCanBusTextLogWriterPrivate> d_ptr;
+};
+
+QT_END_NAMESPACE
+
+#endif // QCANBUSTEXTLOG_H
@@ -0,0 +1,121 @@
+/****************************************************************************
+**
+** Copyright (C) 2021 The Qt Company Ltd.
+** Contact: http://www.qt.io/licensing/
+**
+** This file is part of the QtSerialBus module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL3$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see http://www.qt.io/terms-conditions. For further
+** information use the contact form at http://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPLv3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or later as published by the Free
+** Software Foundation and appearing in the file LICENSE.GPL included in
+** the packaging of this file. Please review the following information to
+** ensure the GNU General Public License version 2.0 requirements will be
+** met: http://www.gnu.org/licenses/gpl-2.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#ifndef QCANBUSTEXTLOG_P_H
+#define QCANBUSTEXTLOG_P_H
+
+#include <QtCore/qbytearray.h>
+#include <QtSerialBus/qcanbustextlog.h>
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API. It exists purely as an
+// implementation detail. This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+//
+
+QT_BEGIN_NAMESPACE
+
+class QCanBusTextLogReaderPrivate
+{
+public:
+    enum {
+        BufferSize = 1024 * 1024        // longer lines are skipped
+    };
+
+    enum LineType {
+        FrameLine,
+        MetaDataLine,                   // empty lines, ASC header and trailer
+        InvalidLine
+    };
+
+    bool nextLine(const char **begin, const char **end);
+    LineType parseCandump(const char *begin, const char *end, QCanBusFrame *frame);
+    LineType parseAsc(const char *begin, const char *end, QCanBusFrame *frame);
+    LineType parseAscHeader(const char *begin, const char *end);
+    void reset();
+
+    QCanBusTextLogReader::Format m_format = QCanBusTextLogReader::CandumpFormat;
+    QIODevice *m_device = nullptr;
+    QByteArray m_buffer;                // BufferSize bytes once the first line is read
+    qsizetype m_begin = 0;              // start of the next line
+    qsizetype m_end = 0;                // end of the buffered data
+    bool m_discarding = false;          // inside a line longer than the buffer
+    bool m_deviceAtEnd = false;
+    qint64 m_lineNumber = 0;
+    qint64 m_skippedLines = 0;
+    QCanBusTextLogReader::Error m_error = QCanBusTextLogReader::NoError;
+    QString m_errorString;
+
+    // State of an ASC log, set by its header.
+    bool m_ascDecimal = false;
+    bool m_ascRelative = false;
+    qint64 m_ascStartTime = 0;          // microseconds since the epoch
+    qint64 m_ascLastTime = 0;           // microseconds since the start of the measurement
+};
+
+class QCanBusTextLogWriterPrivate
+{
+public:
+    enum {
+        BufferSize = 64 * 1024,
+        MaximumLineSize = 512           // excluding the channel name
+    };
+
+    char *reserve(qsizetype size);
+    bool writeBuffer();
+    void writeAscHeader(qint64 timeStamp);
+    void writeCandump(const QCanBusFrame &frame, qint64 timeStamp);
+    void writeAsc(const QCanBusFrame &frame, qint64 timeStamp);
+
+    QCanBusTextLogReader::Format m_format = QCanBusTextLogReader::CandumpFormat;
+    QIODevice *m_device = nullptr;
+    QByteArray m_channel;
+    QByteArray m_buffer;                // BufferSize bytes once the first frame is written
+    qsizetype m_size = 0;               // bytes waiting in m_buffer
+    bool m_started = false;             // the header of the log was written
+    qint64 m_startTime = 0;             // time stamp ASC times are relative to
+    QCanBusTextLogWriter::Error m_error = QCanBusTextLogWriter::NoError;
+    QString m_errorString;
+};
+
+QT_END_NAMESPACE
+
+#endif // QCANBUSTEXTLOG_P_H
@@ -0,0 +1,361 @@
+/****************************************************************************
+**
+** Copyright (C) 2021 The Qt Company Ltd.
+** Contact: http://www.qt.io/licensing/
+**
+** This file is part of the QtSerialBus module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL3$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see http://www.qt.io/terms-conditions. For further
+** information use the contact form at http://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPLv3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or later as published by the Free
+** Software Foundation and appearing in the file LICENSE.GPL included in
+** the packaging of this file. Please review the following information to
+** ensure the GNU General Public License version 2.0 requirements will be
+** met: http://www.gnu.org/licenses/gpl-2.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include "qcandbcfileparser.h"
+#include "qcandbcfileparser_p.h"
+
+#include <QtCore/qfile.h>
+#include <QtCore/qloggingcategory.h>
+#include <QtCore/qregularexpression.h>
+#include <QtCore/qstringconverter.h>
+
+QT_BEGIN_NAMESPACE
+
+Q_DECLARE_LOGGING_CATEGORY(QT_CANBUS)
+
+/*!
+    \class QCanDbcFileParser
+    \inmodule QtSerialBus
+    \since 6.1
+
+    \brief The QCanDbcFileParser class loads message and signal descriptions
+    from DBC files.
+
+    The parser reads the messages (\c BO_), their signals (\c SG_) and the
+    floating point value types of signals (\c SIG_VALTYPE_). Simple
+    multiplexing with one multiplexor switch per message is supported. All
+    other statements, like comments, attributes and value tables, are
+    skipped.
+
+    The signals of the \c VECTOR__INDEPENDENT_SIG_MSG pseudo message are not
+    part of any frame and are ignored.
+
+    \sa QCanSignalDecoder
+*/
+
+/*!
+    \enum QCanDbcFileParser::Error
+
+    This enum describes the errors that can occur while parsing.
+
+    \value NoError          No error occurred.
+    \value FileReadError    The file could not be read.
+    \value ParseError       A message or signal definition is malformed.
+*/
+
+namespace {
+// DBC identifiers of extended frames have bit 31 set.
+constexpr quint32 ExtendedFrameFlag = 0x80000000U;
+constexpr quint32 IndependentSignalsId = 0xc0000000U;
+}
+
+void QCanDbcFileParserPrivate::reset()
+{
+    m_messages.clear();
+    m_messageIndex.clear();
+    m_currentMessage = -1;
+    m_skipSignals = false;
+    m_error = QCanDbcFileParser::NoError;
+    m_errorString.clear();
+    m_warnings.clear();
+}
+
+void QCanDbcFileParserPrivate::setError(QCanDbcFileParser::Error error,
+                                        const QString &errorString)
+{
+    m_error = error;
+    m_errorString = errorString;
+    qCWarning(QT_CANBUS, "%ls", qUtf16Printable(errorString));
+}
+
+bool QCanDbcFileParserPrivate::parseText(const QString &text)
+{
+    const QStringList lines = text.split(QLatin1Char('\n'));
+    bool inString = false;
+
+    for (int i = 0; i < lines.size(); ++i) {
+        const QString line = lines.at(i).trimmed();
+        const int lineNumber = i + 1;
+
+        // Comments and attributes may contain line breaks inside quoted strings.
+        const bool continued = inString;
+        if (line.count(QLatin1Char('"')) % 2)
+            inString = !inString;
+        if (continued || line.isEmpty())
+            continue;
+
+        if (line.startsWith(QLatin1String("BO_ "))) {
+            if (!parseMessage(line, lineNumber))
+                return false;
+        } else if (line.startsWith(QLatin1String("SG_ "))) {
+            if (!parseSignal(line, lineNumber))
+                return false;
+        } else if (line.startsWith(QLatin1String("SIG_VALTYPE_ "))) {
+            parseValueType(line, lineNumber);
+        } else if (line.startsWith(QLatin1String("SG_MUL_VAL_ "))) {
+            m_warnings.append(QCanDbcFileParser::tr("Line %1: extended multiplexing is not "
+                                                    "supported.").arg(lineNumber));
+        } else {
+            m_currentMessage = -1;
+        }
+    }
+    return true;
+}
+
+bool QCanDbcFileParserPrivate::parseMessage(const QString &line, int lineNumber)
+{
+    static const QRegularExpression expression(QStringLiteral(
+        "^BO_\\s+(\\d+)\\s+(\\w+)\\s*:\\s*(\\d+)\\s*(\\w*)"));
+    const QRegularExpressionMatch match = expression.match(line);
+    bool ok = false;
+    const quint32 id = match.hasMatch() ? match.captured(1).toUInt(&ok) : 0;
+    if (!ok) {
+        setError(QCanDbcFileParser::ParseError,
+                 QCanDbcFileParser::tr("Line %1: malformed message definition.").arg(lineNumber));
+        return false;
+    }
+
+    m_currentMessage = -1;
+    m_skipSignals = id == IndependentSignalsId;
+    if (m_skipSignals)
+        return true;
+
+    if (m_messageIndex.contains(id)) {
+        m_warnings.append(QCanDbcFileParser::tr("Line %1: message %2 is defined twice.")
+                              .arg(lineNumber).arg(match.captured(2)));
+        m_skipSignals = true;
+        return true;
+    }
+
+    QCanMessageDescription message(id & ~ExtendedFrameFlag, match.captured(2),
+                                   match.captured(3).toInt());
+    message.setExtendedFrameFormat(id & ExtendedFrameFlag);
+    message.setTransmitter(match.captured(4));
+    if (!message.isValid()) {
+        m_warnings.append(QCanDbcFileParser::tr("Line %1: message %2 is invalid.")
+                              .arg(lineNumber).arg(message.name()));
+    }
+
+    m_currentMessage = int(m_messages.size());
+    m_messageIndex.insert(id, m_currentMessage);
+    m_messages.append(message);
+    return true;
+}
+
+bool QCanDbcFileParserPrivate::parseSignal(const QString &line, int lineNumber)
+{
+    static const QRegularExpression expression(QStringLiteral(
+        "^SG_\\s+(\\w+)\\s*(M|m\\d+M?)?\\s*:\\s*(\\d+)\\s*\\|\\s*(\\d+)\\s*@\\s*([01])\\s*([+-])"
+        "\\s*\\(\\s*([^,\\s]+)\\s*,\\s*([^)\\s]+)\\s*\\)"
+        "\\s*\\[\\s*([^|\\s]+)\\s*\\|\\s*([^\\]\\s]+)\\s*\\]\\s*\"([^\"]*)\""));
+
+    if (m_skipSignals)
+        return true;
+    if (m_currentMessage < 0) {
+        setError(QCanDbcFileParser::ParseError,
+                 QCanDbcFileParser::tr("Line %1: signal outside of a message.").arg(lineNumber));
+        return false;
+    }
+
+    const QRegularExpressionMatch match = expression.match(line);
+    if (!match.hasMatch()) {
+        setError(QCanDbcFileParser::ParseError,
+                 QCanDbcFileParser::tr("Line %1: malformed signal definition.").arg(lineNumber));
+        return false;
+    }
+
+    // DBC uses @1 for little endian (Intel) and @0 for big endian (Motorola) signals.
+    QCanSignalDescription description(
+        match.captured(1), match.captured(3).toInt(), match.captured(4).toInt(),
+        match.captured(5) == QLatin1String("1") ? QSysInfo::LittleEndian : QSysInfo::BigEndian,
+        match.captured(6) == QLatin1String("-") ? QCanSignalDescription::Signed
+                                                : QCanSignalDescription::Unsigned);
+    description.setFactor(match.captured(7).toDouble());
+    description.setOffset(match.captured(8).toDouble());
+    description.setRange(match.captured(9).toDouble(), match.captured(10).toDouble());
+    description.setUnit(match.captured(11));
+
+    const QString multiplexing = match.captured(2);
+    if (multiplexing == QLatin1String("M")) {
+        description.setMultiplexing(QCanSignalDescription::MultiplexorSwitch);
+    } else if (!multiplexing.isEmpty()) {
+        if (multiplexing.endsWith(QLatin1Char('M'))) {
+            m_warnings.append(QCanDbcFileParser::tr("Line %1: nested multiplexor %2 is decoded "
+                                                    "as a multiplexed signal.")
+                                  .arg(lineNumber).arg(description.name()));
+        }
+        description.setMultiplexing(QCanSignalDescription::MultiplexedSignal);
+        description.setMultiplexValue(multiplexing.mid(1).remove(QLatin1Char('M')).toULongLong());
+    }
+
+    if (!description.isValid()) {
+        m_warnings.append(QCanDbcFileParser::tr("Line %1: signal %2 is invalid.")
+                              .arg(lineNumber).arg(description.name()));
+    }
+    m_messages[m_currentMessage].addSignalDescription(description);
+    return true;
+}
+
+void QCanDbcFileParserPrivate::parseValueType(const QString &line, int lineNumber)
+{
+    static const QRegularExpression expression(QStringLiteral(
+        "^SIG_VALTYPE_\\s+(\\d+)\\s+(\\w+)\\s*:?\\s*([0-3])"));
+    const QRegularExpressionMatch match = expression.match(line);
+    const int index = match.hasMatch() ? m_messageIndex.value(match.captured(1).toUInt(), -1)
+                                       : -1;
+    if (index < 0) {
+        m_warnings.append(QCanDbcFileParser::tr("Line %1: value type of an unknown signal.")
+                              .arg(lineNumber));
+        return;
+    }
+
+    QCanMessageDescription &message = m_messages[index];
+    QList<QCanSignalDescription> descriptions = message.signalDescriptions();
+    for (QCanSignalDescription &description : descriptions) {
+        if (description.name() != match.captured(2))
+            continue;
+        // 1 is IEEE float, 2 is IEEE double; 0 and 3 keep the integer type.
+        const int type = match.captured(3).toInt();
+        if (type == 1)
+            description.setValueType(QCanSignalDescription::Float);
+        else if (type == 2)
+            description.setValueType(QCanSignalDescription::Double);
+        if (!description.isValid()) {
+            m_warnings.append(QCanDbcFileParser::tr("Line %1: signal %2 is invalid.")
+                                  .arg(lineNumber).arg(description.name()));
+        }
+        message.setSignalDescriptions(descriptions);
+        return;
+    }
+    m_warnings.append(QCanDbcFileParser::tr("Line %1: value type of an unknown signal.")
+                          .arg(lineNumber));
+}
+
+/*!
+    Constructs a parser.
+*/
+QCanDbcFileParser::QCanDbcFileParser()
+    : d_ptr(new QCanDbcFileParserPrivate)
+{
+}
+
+/*!
+    Destroys the parser.
+*/
+QCanDbcFileParser::~QCanDbcFileParser() = default;
+
+/*!
+    Parses the DBC file \a fileName. Returns \c true on success; otherwise
+    returns \c false and sets error() and errorString().
+
+    \sa messageDescriptions(), warnings()
+*/
+bool QCanDbcFileParser::parse(const QString &fileName)
+{
+    Q_D(QCanDbcFileParser);
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly)) {
+        d->reset();
+        d->setError(FileReadError, tr("Cannot read %1: %2").arg(fileName, file.errorString()));
+        return false;
+    }
+    return parseData(file.readAll());
+}
+
+/*!
+    Parses \a data as the contents of a DBC file. The data is decoded as
+    UTF-8, or as Latin-1 if it is not valid UTF-8. Returns \c true on
+    success; otherwise returns \c false and sets error() and errorString().
+*/
+bool QCanDbcFileParser::parseData(const QByteArray &data)
+{
+    Q_D(QCanDbcFileParser);
+    d->reset();
+
+    QStringDecoder decoder(QStringDecoder::Utf8);
+    QString text = decoder(data);
+    if (decoder.hasError())
+        text = QString::fromLatin1(data);
+
+    if (!d->parseText(text)) {
+        d->m_messages.clear();
+        d->m_messageIndex.clear();
+        return false;
+    }
+    for (const QString &warning : qAsConst(d->m_warnings))
+        qCDebug(QT_CANBUS, "%ls", qUtf16Printable(warning));
+    return true;
+}
+
+/*!
+    Returns the messages of the last parsed file in the order of their
+    definition.
+*/
+QList<QCanMessageDescription> QCanDbcFileParser::messageDescriptions() const
+{
+    Q_D(const QCanDbcFileParser);
+    return d->m_messages;
+}
+
+/*!
+    Returns the error of the last parse.
+*/
+QCanDbcFileParser::Error QCanDbcFileParser::error() const
+{
+    Q_D(const QCanDbcFileParser);
+    return d->m_error;
+}
+
+/*!
+    Returns a description of the error of the last parse.
+*/
+QString QCanDbcFileParser::errorString() const
+{
+    Q_D(const QCanDbcFileParser);
+    return d->m_errorString;
+}
+
+/*!
+    Returns the problems of the last parse that did not stop it, like
+    invalid signals or unsupported statements.
+*/
+QStringList QCanDbcFileParser::warnings() const
+{
+    Q_D(const QCanDbcFileParser);
+    return d->m_warnings;
+}
+
+QT_END_NAMESPACE
@@ -0,0 +1,80 @@
+/****************************************************************************
+**
+** Copyright (C) 2021 The Qt Company Ltd.
+** Contact: http://www.qt.io/licensing/
+**
+** This file is part of the QtSerialBus module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL3$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see http://www.qt.io/terms-conditions. For further
+** information use the contact form at http://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPLv3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or later as published by the Free
+** Software Foundation and appearing in the file LICENSE.GPL included in
+** the packaging of this file. Please review the following information to
+** ensure the GNU General Public License version 2.0 requirements will be
+** met: http://www.gnu.org/licenses/gpl-2.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#ifndef QCANDBCFILEPARSER_H
+#define QCANDBCFILEPARSER_H
+
+#include <QtCore/qcoreapplication.h>
+#include <QtCore/qscopedpointer.h>
+#include <QtCore/qstringlist.h>
+#include <QtSerialBus/qcanmessagedescription.h>
+
+QT_BEGIN_NAMESPACE
+
+class QCanDbcFileParserPrivate;
+
+class Q_SERIALBUS_EXPORT QCanDbcFileParser
+{
+    Q_DECLARE_PRIVATE(QCanDbcFileParser)
+    Q_DECLARE_TR_FUNCTIONS(QCanDbcFileParser)
+
+public:
+    enum Error {
+        NoError,
+        FileReadError,
+        ParseError
+    };
+
+    QCanDbcFileParser();
+    ~QCanDbcFileParser();
+
+    bool parse(const QString &fileName);
+    bool parseData(const QByteArray &data);
+
+    QList<QCanMessageDescription> messageDescriptions() const;
+
+    Error error() const;
+    QString errorString() const;
+    QStringList warnings() const;
+
+private:
+    Q_DISABLE_COPY(QCanDbcFileParser)
+    QScopedPointer<QCanDbcFileParserPrivate> d_ptr;
+};
+
+QT_END_NAMESPACE
+
+#endif // QCANDBCFILEPARSER_H
@@ -0,0 +1,77 @@
+/****************************************************************************
+**
+** Copyright (C) 2021 The Qt Company Ltd.
+** Contact: http://www.qt.io/licensing/
+**
+** This file is part of the QtSerialBus module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL3$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see http://www.qt.io/terms-conditions. For further
+** information use the contact form at http://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPLv3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or later as published by the Free
+** Software Foundation and appearing in the file LICENSE.GPL included in
+** the packaging of this file. Please review the following information to
+** ensure the GNU General Public License version 2.0 requirements will be
+** met: http://www.gnu.org/licenses/gpl-2.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#ifndef QCANDBCFILEPARSER_P_H
+#define QCANDBCFILEPARSER_P_H
+
+#include <QtCore/qhash.h>
+#include <QtSerialBus/qcandbcfileparser.h>
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API. It exists purely as an
+// implementation detail. This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+//
+
+QT_BEGIN_NAMESPACE
+
+class QCanDbcFileParserPrivate
+{
+public:
+    void reset();
+    bool parseText(const QString &text);
+    bool parseMessage(const QString &line, int lineNumber);
+    bool parseSignal(const QString &line, int lineNumber);
+    void parseValueType(const QString &line, int lineNumber);
+    void setError(QCanDbcFileParser::Error error, const QString &errorString);
+
+    QList<QCanMessageDescription> m_messages;
+    QHash<quint32, int> m_messageIndex;     // DBC message identifier to index in m_messages
+    int m_currentMessage = -1;              // message the following SG_ lines belong to
+    bool m_skipSignals = false;             // signals of the pseudo message are not decoded
+    QCanDbcFileParser::Error m_error = QCanDbcFileParser::NoError;
+    QString m_errorString;
+    QStringList m_warnings;
+};
+
+QT_END_NAMESPACE
+
+#endif // QCANDBCFILEPARSER_P_H
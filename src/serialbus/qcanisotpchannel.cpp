@@ -0,0 +1,913 @@
+/****************************************************************************
+**
+** Copyright (C) 2021 The Qt Company Ltd.
+** Contact: http://www.qt.io/licensing/
+**
+** This file is part of the QtSerialBus module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL3$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see http://www.qt.io/terms-conditions. For further
+** information use the contact form at http://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPLv3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or later as published by the Free
+** Software Foundation and appearing in the file LICENSE.GPL included in
+** the packaging of this file. Please review the following information to
+** ensure the GNU General Public License version 2.0 requirements will be
+** met: http://www.gnu.org/licenses/gpl-2.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include "qcanisotpchannel.h"
+#include "qcanisotpchannel_p.h"
+
+#include <QtCore/qendian.h>
+#include <QtCore/qloggingcategory.h>
+
+#include <cstring>
+
+QT_BEGIN_NAMESPACE
+
+Q_DECLARE_LOGGING_CATEGORY(QT_CANBUS)
+
+/*!
+    \class QCanIsoTpChannel
+    \inmodule QtSerialBus
+    \since 6.1
+
+    \brief The QCanIsoTpChannel class transfers messages of up to 4 GiB over a
+    CAN bus using the ISO-TP transport protocol (ISO 15765-2).
+
+    ISO-TP is the transport layer below diagnostic protocols like UDS
+    (ISO 14229). It splits messages that do not fit into a single CAN frame
+    into a first frame and numbered consecutive frames, and lets the receiver
+    pace the sender with flow control frames.
+
+    A channel connects two peers with a pair of CAN identifiers: it sends on
+    transmitId() and receives on receiveId(). The channel writes its frames
+    to the \l QCanBusDevice it was created for. Incoming frames are passed to
+    processFrame() by the application, which usually reads the device anyway
+    for other traffic:
+
+    \code
+        auto channel = new QCanIsoTpChannel(device, 0x7e0, 0x7e8, this);
+        connect(device, &QCanBusDevice::framesReceived, this, [device, channel]() {
+            while (device->framesAvailable())
+                channel->processFrame(device->readFrame());
+        });
+        connect(channel, &QCanIsoTpChannel::messageReceived, this, [channel]() {
+            while (channel->messagesAvailable())
+                handleResponse(channel->readMessage());
+        });
+        channel->sendMessage(QByteArray::fromHex("1003"));
+    \endcode
+
+    Messages are reassembled in place into a buffer sized from the length
+    announced by the first frame, so no reallocation happens while the
+    consecutive frames arrive. If the application releases a message before
+    the next one starts, the buffer is reused for it.
+
+    The channel uses classic CAN frames of 8 bytes by default. With
+    setFlexibleDataRateFormat() it sends CAN FD frames of up to 64 bytes
+    and uses the escape sequences for single frames longer than 7 bytes and
+    for messages longer than 4095 bytes. Received frames of either size are
+    always accepted.
+
+    \section1 Kernel offload
+
+    On Linux, the SocketCAN plugin can leave segmentation, flow control and
+    reassembly to the kernel's ISO-TP sockets, which keep up with the bus
+    speed during multi-megabyte transfers such as flashing an ECU. Set the
+    device's \l QCanBusDevice::ProtocolKey to \l KernelIsoTpProtocol and
+    create the channel before connecting the device. The channel then passes
+    its identifiers and flow control settings to the device with the
+    \l {QCanIsoTpChannel::ConfigurationKey}{configuration keys} below, and
+    the device exchanges whole messages instead of frames: each message is
+    carried by one QCanBusFrame with the message as its payload. The API of
+    the channel stays the same. Settings changed while the device is
+    connected take effect when it connects the next time.
+
+    \value TransmitIdKey        The CAN identifier the device sends on.
+    \value ReceiveIdKey         The CAN identifier the device receives on.
+    \value BlockSizeKey         The block size the device announces, see setBlockSize().
+    \value SeparationTimeKey    The separation time in microseconds the device
+                                announces, see setSeparationTime().
+    \value PaddingByteKey       The padding byte, or -1 to send frames without
+                                padding, see setPaddingByte().
+    \value MaximumMessageSizeKey The size of the longest message the device
+                                receives, see setMaximumMessageSize().
+    \value ExtendedFrameFormatKey Whether the identifiers are 29 bit identifiers,
+                                see setExtendedFrameFormat().
+    \value BitrateSwitchKey     Whether CAN FD frames switch to the data bitrate,
+                                see setBitrateSwitch().
+
+    \sa isKernelOffloaded()
+*/
+
+/*!
+    \enum QCanIsoTpChannel::Error
+
+    This enum describes the errors that may occur.
+
+    \value NoError          No errors have occurred.
+    \value TimeoutError     The peer did not send a flow control or consecutive
+                            frame in time, see setTimeout().
+    \value SequenceError    A consecutive frame arrived out of sequence.
+    \value OverflowError    The message is larger than the receiver can take.
+    \value BusyError        A message is already being sent.
+    \value WriteError       The device could not write a frame.
+    \value MessageSizeError The message is empty or longer than the protocol
+                            allows.
+*/
+
+/*!
+    \fn void QCanIsoTpChannel::messageReceived()
+
+    This signal is emitted when a message was received completely. Read it
+    with readMessage().
+*/
+
+/*!
+    \fn void QCanIsoTpChannel::messageSent()
+
+    This signal is emitted when the last frame of the message passed to
+    sendMessage() was written.
+*/
+
+/*!
+    \fn void QCanIsoTpChannel::errorOccurred(QCanIsoTpChannel::Error error)
+
+    This signal is emitted when a transfer is aborted because of \a error.
+*/
+
+enum {
+    MaximumClassicLength = 4095,
+    FlexibleDataRateSingleFrameLength = 62
+};
+
+/*!
+    Constructs an ISO-TP channel on \a device that sends frames with the
+    identifier \a transmitId and receives frames with the identifier
+    \a receiveId. The \a parent is passed to the QObject constructor.
+
+    The channel does not take ownership of \a device.
+*/
+QCanIsoTpChannel::QCanIsoTpChannel(QCanBusDevice *device, quint32 transmitId,
+                                   quint32 receiveId, QObject *parent)
+    : QObject(*new QCanIsoTpChannelPrivate, parent)
+{
+    Q_D(QCanIsoTpChannel);
+    d->m_device = device;
+    d->m_transmitId = transmitId;
+    d->m_receiveId = receiveId;
+    d->m_extendedFrameFormat = transmitId > 0x7ff || receiveId > 0x7ff;
+    d->setup();
+}
+
+/*!
+    Destroys the channel. Transfers in progress are abandoned.
+*/
+QCanIsoTpChannel::~QCanIsoTpChannel() = default;
+
+void QCanIsoTpChannelPrivate::setup()
+{
+    Q_Q(QCanIsoTpChannel);
+
+    m_flowControlTimer.setSingleShot(true);
+    QObject::connect(&m_flowControlTimer, &QTimer::timeout, q, [this]() {
+        abortTransmission(QCanIsoTpChannel::TimeoutError,
+                          QCanIsoTpChannel::tr("No flow control frame received."));
+    });
+
+    m_separationTimer.setSingleShot(true);
+    m_separationTimer.setTimerType(Qt::PreciseTimer);
+    QObject::connect(&m_separationTimer, &QTimer::timeout, q, [this]() {
+        transmitConsecutiveFrames();
+    });
+
+    m_consecutiveFrameTimer.setSingleShot(true);
+    QObject::connect(&m_consecutiveFrameTimer, &QTimer::timeout, q, [this]() {
+        abortReception(QCanIsoTpChannel::TimeoutError,
+                       QCanIsoTpChannel::tr("No consecutive frame received."));
+    });
+
+    if (m_device) {
+        QObject::connect(m_device, &QCanBusDevice::stateChanged, q,
+                         [this](QCanBusDevice::CanBusDeviceState state) {
+            if (state == QCanBusDevice::ConnectingState)
+                applyKernelConfiguration();
+        });
+    }
+    applyKernelConfiguration();
+}
+
+/*!
+    Returns the device the channel sends its frames to.
+*/
+QCanBusDevice *QCanIsoTpChannel::device() const
+{
+    Q_D(const QCanIsoTpChannel);
+    return d->m_device;
+}
+
+/*!
+    Returns the CAN identifier of the frames sent by the channel.
+*/
+quint32 QCanIsoTpChannel::transmitId() const
+{
+    Q_D(const QCanIsoTpChannel);
+    return d->m_transmitId;
+}
+
+/*!
+    Returns the CAN identifier of the frames received by the channel.
+*/
+quint32 QCanIsoTpChannel::receiveId() const
+{
+    Q_D(const QCanIsoTpChannel);
+    return d->m_receiveId;
+}
+
+/*!
+    Sets whether the channel uses 29 bit identifiers to \a extended. The
+    default is \c true if one of the identifiers does not fit into 11 bits.
+*/
+void QCanIsoTpChannel::setExtendedFrameFormat(bool extended)
+{
+    Q_D(QCanIsoTpChannel);
+    d->m_extendedFrameFormat = extended;
+    d->applyKernelConfiguration();
+}
+
+/*!
+    Returns \c true if the channel uses 29 bit identifiers.
+*/
+bool QCanIsoTpChannel::hasExtendedFrameFormat() const
+{
+    Q_D(const QCanIsoTpChannel);
+    return d->m_extendedFrameFormat;
+}
+
+/*!
+    Sets whether the channel sends CAN FD frames of up to 64 bytes to
+    \a flexibleDataRate. The device must have \l QCanBusDevice::CanFdKey
+    enabled. The default is \c false.
+*/
+void QCanIsoTpChannel::setFlexibleDataRateFormat(bool flexibleDataRate)
+{
+    Q_D(QCanIsoTpChannel);
+    d->m_flexibleDataRate = flexibleDataRate;
+    if (!flexibleDataRate)
+        d->m_bitrateSwitch = false;
+    d->applyKernelConfiguration();
+}
+
+/*!
+    Returns \c true if the channel sends CAN FD frames.
+*/
+bool QCanIsoTpChannel::hasFlexibleDataRateFormat() const
+{
+    Q_D(const QCanIsoTpChannel);
+    return d->m_flexibleDataRate;
+}
+
+/*!
+    Sets whether the CAN FD frames sent by the channel switch to the data
+    bitrate to \a bitrateSwitch. Enabling it also enables
+    setFlexibleDataRateFormat().
+*/
+void QCanIsoTpChannel::setBitrateSwitch(bool bitrateSwitch)
+{
+    Q_D(QCanIsoTpChannel);
+    d->m_bitrateSwitch = bitrateSwitch;
+    if (bitrateSwitch)
+        d->m_flexibleDataRate = true;
+    d->applyKernelConfiguration();
+}
+
+/*!
+    Returns \c true if the CAN FD frames sent by the channel switch to the
+    data bitrate.
+*/
+bool QCanIsoTpChannel::hasBitrateSwitch() const
+{
+    Q_D(const QCanIsoTpChannel);
+    return d->m_bitrateSwitch;
+}
+
+/*!
+    Sets the number of consecutive frames the peer may send before waiting
+    for the next flow control frame to \a blockSize. The value is clamped to
+    0 to 255; \c 0, the default, lets the peer send the whole message at once.
+*/
+void QCanIsoTpChannel::setBlockSize(int blockSize)
+{
+    Q_D(QCanIsoTpChannel);
+    d->m_blockSize = qBound(0, blockSize, 255);
+    d->applyKernelConfiguration();
+}
+
+/*!
+    Returns the block size the channel announces to its peer.
+*/
+int QCanIsoTpChannel::blockSize() const
+{
+    Q_D(const QCanIsoTpChannel);
+    return d->m_blockSize;
+}
+
+/*!
+    Sets the minimum time the peer has to wait between two consecutive
+    frames to \a usecs microseconds. ISO-TP can express 100 to 900 µs in
+    steps of 100 µs, and 1 to 127 ms in steps of 1 ms; other values are
+    rounded up to the next one that can be expressed. The default is \c 0.
+*/
+void QCanIsoTpChannel::setSeparationTime(int usecs)
+{
+    Q_D(QCanIsoTpChannel);
+    d->m_separationTime = QCanIsoTpChannelPrivate::decodeSeparationTime(
+        QCanIsoTpChannelPrivate::encodeSeparationTime(usecs));
+    d->applyKernelConfiguration();
+}
+
+/*!
+    Returns the separation time in microseconds the channel announces to its
+    peer.
+*/
+int QCanIsoTpChannel::separationTime() const
+{
+    Q_D(const QCanIsoTpChannel);
+    return d->m_separationTime;
+}
+
+/*!
+    Sets the byte used to fill up frames that are not used completely to
+    \a padding. Pass \c -1, the default, to send classic CAN frames only as
+    long as needed. CAN FD frames longer than 8 bytes are always padded to
+    the next valid length, with \c 0xcc if no padding byte is set.
+*/
+void QCanIsoTpChannel::setPaddingByte(int padding)
+{
+    Q_D(QCanIsoTpChannel);
+    d->m_paddingByte = padding < 0 ? -1 : (padding & 0xff);
+    d->applyKernelConfiguration();
+}
+
+/*!
+    Returns the padding byte, or \c -1 if frames are not padded.
+*/
+int QCanIsoTpChannel::paddingByte() const
+{
+    Q_D(const QCanIsoTpChannel);
+    return d->m_paddingByte;
+}
+
+/*!
+    Sets the time the channel waits for the next flow control or consecutive
+    frame from its peer to \a msecs milliseconds. The default is 1000 ms.
+*/
+void QCanIsoTpChannel::setTimeout(int msecs)
+{
+    Q_D(QCanIsoTpChannel);
+    d->m_timeout = qMax(0, msecs);
+}
+
+/*!
+    Returns the time in milliseconds the channel waits for frames of its peer.
+*/
+int QCanIsoTpChannel::timeout() const
+{
+    Q_D(const QCanIsoTpChannel);
+    return d->m_timeout;
+}
+
+/*!
+    Sets the size of the longest message the channel accepts to \a size
+    bytes. Longer messages are refused with a flow control overflow. The
+    default is 4095 bytes, the maximum message size of classic ISO-TP.
+*/
+void QCanIsoTpChannel::setMaximumMessageSize(qsizetype size)
+{
+    Q_D(QCanIsoTpChannel);
+    d->m_maximumMessageSize = qBound(qsizetype(1), size, qsizetype(0xffffffffLL));
+    d->applyKernelConfiguration();
+}
+
+/*!
+    Returns the size of the longest message the channel accepts.
+*/
+qsizetype QCanIsoTpChannel::maximumMessageSize() const
+{
+    Q_D(const QCanIsoTpChannel);
+    return d->m_maximumMessageSize;
+}
+
+/*!
+    Returns \c true if the device exchanges whole messages because its
+    \l QCanBusDevice::ProtocolKey is set to \l KernelIsoTpProtocol.
+*/
+bool QCanIsoTpChannel::isKernelOffloaded() const
+{
+    Q_D(const QCanIsoTpChannel);
+    return d->m_device && d->m_device->configurationParameter(QCanBusDevice::ProtocolKey)
+        .toInt() == KernelIsoTpProtocol;
+}
+
+void QCanIsoTpChannelPrivate::applyKernelConfiguration()
+{
+    Q_Q(QCanIsoTpChannel);
+    if (!q->isKernelOffloaded())
+        return;
+    // The device refuses the keys while it is connected. Changes made meanwhile are passed
+    // on when it connects the next time.
+    const QCanBusDevice::CanBusDeviceState state = m_device->state();
+    if (state != QCanBusDevice::UnconnectedState && state != QCanBusDevice::ConnectingState)
+        return;
+
+    const auto setKey = [this](QCanIsoTpChannel::ConfigurationKey key, const QVariant &value) {
+        m_device->setConfigurationParameter(QCanBusDevice::ConfigurationKey(key), value);
+    };
+    setKey(QCanIsoTpChannel::TransmitIdKey, m_transmitId);
+    setKey(QCanIsoTpChannel::ReceiveIdKey, m_receiveId);
+    setKey(QCanIsoTpChannel::BlockSizeKey, m_blockSize);
+    setKey(QCanIsoTpChannel::SeparationTimeKey, m_separationTime);
+    setKey(QCanIsoTpChannel::PaddingByteKey, m_paddingByte);
+    setKey(QCanIsoTpChannel::MaximumMessageSizeKey, m_maximumMessageSize);
+    setKey(QCanIsoTpChannel::ExtendedFrameFormatKey, m_extendedFrameFormat);
+    setKey(QCanIsoTpChannel::BitrateSwitchKey, m_bitrateSwitch);
+}
+
+/*!
+    Starts sending \a message. Returns \c false if another message is still
+    being sent, \a message is empty or the first frame could not be written.
+
+    Messages that fit into one frame are written immediately. Longer
+    messages are sent as the peer's flow control frames permit; the channel
+    emits messageSent() once the last frame was written.
+*/
+bool QCanIsoTpChannel::sendMessage(const QByteArray &message)
+{
+    Q_D(QCanIsoTpChannel);
+    if (d->m_transmitState != QCanIsoTpChannelPrivate::TransmitState::Idle) {
+        d->setError(BusyError, tr("A message is already being sent."));
+        return false;
+    }
+    if (message.isEmpty() || quint64(message.size()) > 0xffffffffULL) {
+        d->setError(MessageSizeError, tr("Invalid message size %1.").arg(message.size()));
+        return false;
+    }
+    if (!d->m_device) {
+        d->setError(WriteError, tr("The channel has no device."));
+        return false;
+    }
+
+    if (isKernelOffloaded()) {
+        QCanBusFrame frame(d->m_transmitId, message);
+        frame.setExtendedFrameFormat(d->m_extendedFrameFormat);
+        if (!d->m_device->writeFrame(frame)) {
+            d->setError(WriteError, d->m_device->errorString());
+            return false;
+        }
+        emit messageSent();
+        return true;
+    }
+
+    const qsizetype size = message.size();
+    const int dataLength = d->transmitDataLength();
+    const uchar *source = reinterpret_cast<const uchar *>(message.constData());
+
+    if (size <= 7 || (dataLength > 8 && size <= FlexibleDataRateSingleFrameLength)) {
+        const qsizetype headerLength = size <= 7 ? 1 : 2;
+        QByteArray payload = d->framePayload(headerLength + size);
+        uchar *data = reinterpret_cast<uchar *>(payload.data());
+        if (headerLength == 1) {
+            data[0] = uchar(QCanIsoTpChannelPrivate::SingleFrame << 4) | uchar(size);
+        } else {
+            data[0] = QCanIsoTpChannelPrivate::SingleFrame << 4;
+            data[1] = uchar(size);
+        }
+        std::memcpy(data + headerLength, source, size_t(size));
+        if (!d->writeFrame(std::move(payload)))
+            return false;
+        emit messageSent();
+        return true;
+    }
+
+    QByteArray payload = d->framePayload(dataLength);
+    uchar *data = reinterpret_cast<uchar *>(payload.data());
+    qsizetype headerLength = 2;
+    if (size <= MaximumClassicLength) {
+        data[0] = uchar(QCanIsoTpChannelPrivate::FirstFrame << 4) | uchar(size >> 8);
+        data[1] = uchar(size);
+    } else {
+        headerLength = 6;
+        data[0] = QCanIsoTpChannelPrivate::FirstFrame << 4;
+        data[1] = 0;
+        qToBigEndian(quint32(size), data + 2);
+    }
+    const qsizetype firstLength = dataLength - headerLength;
+    std::memcpy(data + headerLength, source, size_t(firstLength));
+
+    // The flow control frame may arrive while the first frame is being written.
+    d->m_transmitMessage = message;
+    d->m_transmitOffset = firstLength;
+    d->m_transmitSequence = 1;
+    d->m_transmitState = QCanIsoTpChannelPrivate::TransmitState::WaitForFlowControl;
+    d->m_flowControlTimer.start(d->m_timeout);
+    return d->writeFrame(std::move(payload));
+}
+
+/*!
+    Returns \c true while a message is being sent.
+*/
+bool QCanIsoTpChannel::isSending() const
+{
+    Q_D(const QCanIsoTpChannel);
+    return d->m_transmitState != QCanIsoTpChannelPrivate::TransmitState::Idle;
+}
+
+/*
+    Returns a frame payload of the length a frame carrying \a usedLength bytes must
+    have. Bytes beyond \a usedLength are set to the padding byte.
+*/
+QByteArray QCanIsoTpChannelPrivate::framePayload(qsizetype usedLength) const
+{
+    qsizetype length = usedLength;
+    char padding = char(0xcc);
+    if (m_paddingByte >= 0) {
+        padding = char(m_paddingByte);
+        length = qMax(length, qsizetype(8));
+    }
+    if (length > 8)
+        length = flexibleDataRateLength(length);
+
+    QByteArray payload(length, Qt::Uninitialized);
+    if (length > usedLength)
+        std::memset(payload.data() + usedLength, padding, size_t(length - usedLength));
+    return payload;
+}
+
+bool QCanIsoTpChannelPrivate::writeFrame(QByteArray payload)
+{
+    QCanBusFrame frame(m_transmitId, payload);
+    frame.setExtendedFrameFormat(m_extendedFrameFormat);
+    if (m_flexibleDataRate) {
+        frame.setFlexibleDataRateFormat(true);
+        frame.setBitrateSwitch(m_bitrateSwitch);
+    }
+
+    if (m_device && m_device->writeFrame(frame))
+        return true;
+
+    const QString errorString = m_device ? m_device->errorString()
+                                         : QCanIsoTpChannel::tr("The channel has no device.");
+    if (m_transmitState != TransmitState::Idle)
+        abortTransmission(QCanIsoTpChannel::WriteError, errorString);
+    else
+        setError(QCanIsoTpChannel::WriteError, errorString);
+    return false;
+}
+
+void QCanIsoTpChannelPrivate::transmitConsecutiveFrames()
+{
+    Q_Q(QCanIsoTpChannel);
+
+    const qsizetype size = m_transmitMessage.size();
+    const qsizetype dataLength = transmitDataLength() - 1;
+    const uchar *source = reinterpret_cast<const uchar *>(m_transmitMessage.constData());
+
+    while (m_transmitOffset < size) {
+        const qsizetype length = qMin(dataLength, size - m_transmitOffset);
+        QByteArray payload = framePayload(1 + length);
+        uchar *data = reinterpret_cast<uchar *>(payload.data());
+        data[0] = uchar(ConsecutiveFrame << 4) | (m_transmitSequence & 0x0f);
+        std::memcpy(data + 1, source + m_transmitOffset, size_t(length));
+
+        // Update the state before writing, the peer's reaction may arrive while the
+        // frame is being written.
+        m_transmitOffset += length;
+        m_transmitSequence = (m_transmitSequence + 1) & 0x0f;
+        if (m_transmitBlockRemaining > 0)
+            --m_transmitBlockRemaining;
+
+        const bool last = m_transmitOffset == size;
+        const bool endOfBlock = !last && m_transmitBlockRemaining == 0;
+        if (last) {
+            m_transmitState = TransmitState::Idle;
+        } else if (endOfBlock) {
+            m_transmitState = TransmitState::WaitForFlowControl;
+            m_flowControlTimer.start(m_timeout);
+        }
+
+        if (!writeFrame(std::move(payload)))
+            return;
+
+        if (last) {
+            m_transmitMessage.clear();
+            emit q->messageSent();
+            return;
+        }
+        if (endOfBlock)
+            return;
+
+        if (m_transmitSeparationTime > 0) {
+            // Timers have millisecond resolution, round up to stay above the minimum.
+            m_separationTimer.start((m_transmitSeparationTime + 999) / 1000);
+            return;
+        }
+    }
+}
+
+void QCanIsoTpChannelPrivate::processFlowControl(const uchar *data, qsizetype size)
+{
+    if (m_transmitState != TransmitState::WaitForFlowControl || size < 3)
+        return;
+
+    switch (data[0] & 0x0f) {
+    case ContinueToSend:
+        m_flowControlTimer.stop();
+        m_transmitBlockRemaining = data[1] == 0 ? -1 : data[1];
+        m_transmitSeparationTime = decodeSeparationTime(data[2]);
+        m_transmitState = TransmitState::SendConsecutiveFrames;
+        transmitConsecutiveFrames();
+        break;
+    case Wait:
+        m_flowControlTimer.start(m_timeout);
+        break;
+    case Overflow:
+        abortTransmission(QCanIsoTpChannel::OverflowError,
+                          QCanIsoTpChannel::tr("The message is too large for the receiver."));
+        break;
+    default:
+        abortTransmission(QCanIsoTpChannel::SequenceError,
+                          QCanIsoTpChannel::tr("Invalid flow status %1.").arg(data[0] & 0x0f));
+        break;
+    }
+}
+
+bool QCanIsoTpChannelPrivate::sendFlowControl(FlowStatus status)
+{
+    QByteArray payload = framePayload(3);
+    uchar *data = reinterpret_cast<uchar *>(payload.data());
+    data[0] = uchar(FlowControl << 4) | status;
+    data[1] = uchar(m_blockSize);
+    data[2] = encodeSeparationTime(m_separationTime);
+    return writeFrame(std::move(payload));
+}
+
+/*!
+    Processes \a frame if it belongs to the channel, that is if it is a data
+    frame with the receive identifier. Returns \c true if the frame was
+    processed; otherwise returns \c false so the application can process it
+    itself.
+*/
+bool QCanIsoTpChannel::processFrame(const QCanBusFrame &frame)
+{
+    Q_D(QCanIsoTpChannel);
+    if (frame.frameType() != QCanBusFrame::DataFrame || frame.frameId() != d->m_receiveId
+            || frame.hasExtendedFrameFormat() != d->m_extendedFrameFormat
+            || frame.hasLocalEcho()) {
+        return false;
+    }
+
+    const QByteArray payload = frame.payload();
+    if (payload.isEmpty())
+        return true;
+
+    if (isKernelOffloaded()) {
+        d->m_messages.push_back(payload);
+        emit messageReceived();
+        return true;
+    }
+
+    const uchar *data = reinterpret_cast<const uchar *>(payload.constData());
+    const qsizetype size = payload.size();
+
+    switch (data[0] >> 4) {
+    case QCanIsoTpChannelPrivate::SingleFrame: {
+        qsizetype length = data[0] & 0x0f;
+        qsizetype offset = 1;
+        if (length == 0 && size > 8) {
+            length = data[1];
+            offset = 2;
+        }
+        if (length == 0 || offset + length > size)
+            break;
+        if (d->m_receiving)
+            d->abortReception(SequenceError, tr("Single frame during a segmented reception."));
+        d->startReception(length, data + offset, length);
+        d->completeReception();
+        break;
+    }
+    case QCanIsoTpChannelPrivate::FirstFrame: {
+        if (size < 8)
+            break;
+        qsizetype length = qsizetype(data[0] & 0x0f) << 8 | data[1];
+        qsizetype offset = 2;
+        if (length == 0) {
+            length = qFromBigEndian<quint32>(data + 2);
+            offset = 6;
+        }
+        if (length < size - offset)
+            break;
+        if (d->m_receiving)
+            d->abortReception(SequenceError, tr("First frame during a segmented reception."));
+        if (length > d->m_maximumMessageSize) {
+            d->sendFlowControl(QCanIsoTpChannelPrivate::Overflow);
+            d->setError(OverflowError, tr("Refused a message of %1 bytes.").arg(length));
+            break;
+        }
+        d->startReception(length, data + offset, size - offset);
+        d->m_receiveSequence = 1;
+        d->m_receiveBlockCount = 0;
+        d->m_receiving = true;
+        // The consecutive frames may arrive while the flow control frame is being written.
+        d->m_consecutiveFrameTimer.start(d->m_timeout);
+        if (!d->sendFlowControl(QCanIsoTpChannelPrivate::ContinueToSend)) {
+            d->m_consecutiveFrameTimer.stop();
+            d->m_receiving = false;
+        }
+        break;
+    }
+    case QCanIsoTpChannelPrivate::ConsecutiveFrame:
+        d->processConsecutiveFrame(data, size);
+        break;
+    case QCanIsoTpChannelPrivate::FlowControl:
+        d->processFlowControl(data, size);
+        break;
+    default:
+        break;
+    }
+    return true;
+}
+
+/*
+    Prepares the receive buffer for a message of \a length bytes and copies the first
+    \a size bytes from \a data into it.
+*/
+void QCanIsoTpChannelPrivate::startReception(qsizetype length, const uchar *data, qsizetype size)
+{
+    // Reuse the buffer of the previous message unless the application still holds it.
+    if (!m_receiveBuffer.isDetached() || m_receiveBuffer.capacity() < length)
+        m_receiveBuffer = QByteArray();
+    m_receiveBuffer.resize(length);
+    std::memcpy(m_receiveBuffer.data(), data, size_t(size));
+    m_receiveOffset = size;
+}
+
+void QCanIsoTpChannelPrivate::processConsecutiveFrame(const uchar *data, qsizetype size)
+{
+    if (!m_receiving)
+        return;
+
+    if ((data[0] & 0x0f) != m_receiveSequence) {
+        abortReception(QCanIsoTpChannel::SequenceError,
+                       QCanIsoTpChannel::tr("Expected consecutive frame %1, received %2.")
+                           .arg(m_receiveSequence).arg(data[0] & 0x0f));
+        return;
+    }
+    m_receiveSequence = (m_receiveSequence + 1) & 0x0f;
+
+    const qsizetype length = qMin(size - 1, m_receiveBuffer.size() - m_receiveOffset);
+    std::memcpy(m_receiveBuffer.data() + m_receiveOffset, data + 1, size_t(length));
+    m_receiveOffset += length;
+
+    if (m_receiveOffset == m_receiveBuffer.size()) {
+        m_consecutiveFrameTimer.stop();
+        m_receiving = false;
+        completeReception();
+        return;
+    }
+
+    m_consecutiveFrameTimer.start(m_timeout);
+    if (m_blockSize > 0 && ++m_receiveBlockCount == m_blockSize) {
+        m_receiveBlockCount = 0;
+        if (!sendFlowControl(ContinueToSend)) {
+            m_consecutiveFrameTimer.stop();
+            m_receiving = false;
+        }
+    }
+}
+
+void QCanIsoTpChannelPrivate::completeReception()
+{
+    Q_Q(QCanIsoTpChannel);
+    // Shares the buffer with the queue; startReception() detaches if it is still held.
+    m_messages.push_back(m_receiveBuffer);
+    emit q->messageReceived();
+}
+
+/*!
+    Returns the number of received messages that were not read yet.
+*/
+qsizetype QCanIsoTpChannel::messagesAvailable() const
+{
+    Q_D(const QCanIsoTpChannel);
+    return qsizetype(d->m_messages.size());
+}
+
+/*!
+    Returns the oldest received message and removes it from the channel, or
+    an empty byte array if no message is available.
+*/
+QByteArray QCanIsoTpChannel::readMessage()
+{
+    Q_D(QCanIsoTpChannel);
+    if (d->m_messages.empty())
+        return QByteArray();
+    QByteArray message = std::move(d->m_messages.front());
+    d->m_messages.pop_front();
+    return message;
+}
+
+/*!
+    Returns the last error that occurred.
+*/
+QCanIsoTpChannel::Error QCanIsoTpChannel::error() const
+{
+    Q_D(const QCanIsoTpChannel);
+    return d->m_error;
+}
+
+/*!
+    Returns a description of the last error that occurred.
+*/
+QString QCanIsoTpChannel::errorString() const
+{
+    Q_D(const QCanIsoTpChannel);
+    return d->m_errorString;
+}
+
+void QCanIsoTpChannelPrivate::setError(QCanIsoTpChannel::Error error, const QString &errorString)
+{
+    Q_Q(QCanIsoTpChannel);
+    m_error = error;
+    m_errorString = errorString;
+    qCDebug(QT_CANBUS) << "(ISO-TP)" << errorString;
+    emit q->errorOccurred(error);
+}
+
+void QCanIsoTpChannelPrivate::abortTransmission(QCanIsoTpChannel::Error error,
+                                                const QString &errorString)
+{
+    m_flowControlTimer.stop();
+    m_separationTimer.stop();
+    m_transmitState = TransmitState::Idle;
+    m_transmitMessage.clear();
+    setError(error, errorString);
+}
+
+void QCanIsoTpChannelPrivate::abortReception(QCanIsoTpChannel::Error error,
+                                             const QString &errorString)
+{
+    m_consecutiveFrameTimer.stop();
+    m_receiving = false;
+    setError(error, errorString);
+}
+
+quint8 QCanIsoTpChannelPrivate::encodeSeparationTime(int usecs)
+{
+    if (usecs <= 0)
+        return 0x00;
+    if (usecs <= 900)
+        return quint8(0xf0 + (usecs + 99) / 100);
+    return quint8(qMin((usecs + 999) / 1000, 127));
+}
+
+int QCanIsoTpChannelPrivate::decodeSeparationTime(quint8 value)
+{
+    if (value <= 0x7f)
+        return value * 1000;
+    if (value >= 0xf1 && value <= 0xf9)
+        return (value - 0xf0) * 100;
+    // Reserved values are to be treated as the maximum.
+    return 127000;
+}
+
+int QCanIsoTpChannelPrivate::flexibleDataRateLength(qsizetype length)
+{
+    static constexpr int lengths[] = { 8, 12, 16, 20, 24, 32, 48, 64 };
+    for (int valid : lengths) {
+        if (length <= valid)
+            return valid;
+    }
+    return 64;
+}
+
+QT_END_NAMESPACE
@@ -0,0 +1,129 @@
+/****************************************************************************
+**
+** Copyright (C) 2021 The Qt Company Ltd.
+** Contact: http://www.qt.io/licensing/
+**
+** This file is part of the QtSerialBus module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL3$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see http://www.qt.io/terms-conditions. For further
+** information use the contact form at http://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPLv3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or later as published by the Free
+** Software Foundation and appearing in the file LICENSE.GPL included in
+** the packaging of this file. Please review the following information to
+** ensure the GNU General Public License version 2.0 requirements will be
+** met: http://www.gnu.org/licenses/gpl-2.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#ifndef QCANISOTPCHANNEL_H
+#define QCANISOTPCHANNEL_H
+
+#include <QtCore/qobject.h>
+#include <QtSerialBus/qcanbusdevice.h>
+#include <QtSerialBus/qcanbusframe.h>
+
+QT_BEGIN_NAMESPACE
+
+class QCanIsoTpChannelPrivate;
+
+class Q_SERIALBUS_EXPORT QCanIsoTpChannel : public QObject
+{
+    Q_OBJECT
+    Q_DECLARE_PRIVATE(QCanIsoTpChannel)
+
+public:
+    enum Error {
+        NoError,
+        TimeoutError,
+        SequenceError,
+        OverflowError,
+        BusyError,
+        WriteError,
+        MessageSizeError
+    };
+    Q_ENUM(Error)
+
+    enum { KernelIsoTpProtocol = 6 };
+
+    enum ConfigurationKey {
+        TransmitIdKey = QCanBusDevice::UserKey,
+        ReceiveIdKey,
+        BlockSizeKey,
+        SeparationTimeKey,
+        PaddingByteKey,
+        MaximumMessageSizeKey,
+        ExtendedFrameFormatKey,
+        BitrateSwitchKey
+    };
+    Q_ENUM(ConfigurationKey)
+
+    explicit QCanIsoTpChannel(QCanBusDevice *device, quint32 transmitId, quint32 receiveId,
+                              QObject *parent = nullptr);
+    ~QCanIsoTpChannel();
+
+    QCanBusDevice *device() const;
+    quint32 transmitId() const;
+    quint32 receiveId() const;
+
+    void setExtendedFrameFormat(bool extended);
+    bool hasExtendedFrameFormat() const;
+
+    void setFlexibleDataRateFormat(bool flexibleDataRate);
+    bool hasFlexibleDataRateFormat() const;
+    void setBitrateSwitch(bool bitrateSwitch);
+    bool hasBitrateSwitch() const;
+
+    void setBlockSize(int blockSize);
+    int blockSize() const;
+    void setSeparationTime(int usecs);
+    int separationTime() const;
+    void setPaddingByte(int padding);
+    int paddingByte() const;
+    void setTimeout(int msecs);
+    int timeout() const;
+    void setMaximumMessageSize(qsizetype size);
+    qsizetype maximumMessageSize() const;
+
+    bool isKernelOffloaded() const;
+
+    bool sendMessage(const QByteArray &message);
+    bool isSending() const;
+
+    bool processFrame(const QCanBusFrame &frame);
+    qsizetype messagesAvailable() const;
+    QByteArray readMessage();
+
+    Error error() const;
+    QString errorString() const;
+
+Q_SIGNALS:
+    void messageReceived();
+    void messageSent();
+    void errorOccurred(QCanIsoTpChannel::Error error);
+
+private:
+    Q_DISABLE_COPY(QCanIsoTpChannel)
+};
+
+QT_END_NAMESPACE
+
+#endif // QCANISOTPCHANNEL_H
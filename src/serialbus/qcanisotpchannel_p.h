@@ -0,0 +1,150 @@
+/****************************************************************************
+**
+** Copyright (C) 2021 The Qt Company Ltd.
+** Contact: http://www.qt.io/licensing/
+**
+** This file is part of the QtSerialBus module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL3$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see http://www.qt.io/terms-conditions. For further
+** information use the contact form at http://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPLv3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or later as published by the Free
+** Software Foundation and appearing in the file LICENSE.GPL included in
+** the packaging of this file. Please review the following information to
+** ensure the GNU General Public License version 2.0 requirements will be
+** met: http://www.gnu.org/licenses/gpl-2.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#ifndef QCANISOTPCHANNEL_P_H
+#define QCANISOTPCHANNEL_P_H
+
+#include <QtCore/qpointer.h>
+#include <QtCore/qtimer.h>
+#include <QtSerialBus/qcanbusdevice.h>
+#include <QtSerialBus/qcanisotpchannel.h>
+
+#include <private/qobject_p.h>
+
+#include <deque>
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API. It exists purely as an
+// implementation detail. This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+//
+
+QT_BEGIN_NAMESPACE
+
+class QCanIsoTpChannelPrivate : public QObjectPrivate
+{
+    Q_DECLARE_PUBLIC(QCanIsoTpChannel)
+
+public:
+    // Protocol control information, the high nibble of the first payload byte.
+    enum FrameType : quint8 {
+        SingleFrame = 0x0,
+        FirstFrame = 0x1,
+        ConsecutiveFrame = 0x2,
+        FlowControl = 0x3
+    };
+
+    enum FlowStatus : quint8 {
+        ContinueToSend = 0x0,
+        Wait = 0x1,
+        Overflow = 0x2
+    };
+
+    enum class TransmitState {
+        Idle,
+        WaitForFlowControl,
+        SendConsecutiveFrames
+    };
+
+    void setup();
+
+    int transmitDataLength() const { return m_flexibleDataRate ? 64 : 8; }
+    QByteArray framePayload(qsizetype usedLength) const;
+    bool writeFrame(QByteArray payload);
+
+    void transmitConsecutiveFrames();
+    void processFlowControl(const uchar *data, qsizetype size);
+    bool sendFlowControl(FlowStatus status);
+
+    void startReception(qsizetype length, const uchar *data, qsizetype size);
+    void processConsecutiveFrame(const uchar *data, qsizetype size);
+    void completeReception();
+
+    void setError(QCanIsoTpChannel::Error error, const QString &errorString);
+    void abortTransmission(QCanIsoTpChannel::Error error, const QString &errorString);
+    void abortReception(QCanIsoTpChannel::Error error, const QString &errorString);
+
+    void applyKernelConfiguration();
+
+    static quint8 encodeSeparationTime(int usecs);
+    static int decodeSeparationTime(quint8 value);
+    static int flexibleDataRateLength(qsizetype length);
+
+    QPointer<QCanBusDevice> m_device;
+    quint32 m_transmitId = 0;
+    quint32 m_receiveId = 0;
+    bool m_extendedFrameFormat = false;
+    bool m_flexibleDataRate = false;
+    bool m_bitrateSwitch = false;
+    int m_blockSize = 0;
+    int m_separationTime = 0;
+    int m_paddingByte = -1;
+    int m_timeout = 1000;
+    qsizetype m_maximumMessageSize = 4095;
+
+    // Transmission of a segmented message.
+    TransmitState m_transmitState = TransmitState::Idle;
+    QByteArray m_transmitMessage;
+    qsizetype m_transmitOffset = 0;
+    quint8 m_transmitSequence = 0;
+    int m_transmitBlockRemaining = 0;
+    int m_transmitSeparationTime = 0;
+    QTimer m_flowControlTimer;
+    QTimer m_separationTimer;
+
+    // Reception of a segmented message. m_receiveBuffer is reused for the next message
+    // once the application has released the previous one.
+    bool m_receiving = false;
+    QByteArray m_receiveBuffer;
+    qsizetype m_receiveOffset = 0;
+    quint8 m_receiveSequence = 0;
+    int m_receiveBlockCount = 0;
+    QTimer m_consecutiveFrameTimer;
+
+    std::deque<QByteArray> m_messages;
+
+    QCanIsoTpChannel::Error m_error = QCanIsoTpChannel::NoError;
+    QString m_errorString;
+};
+
+QT_END_NAMESPACE
+
+#endif // QCANISOTPCHANNEL_P_H
@@ -0,0 +1,960 @@
+/****************************************************************************
+**
+** Copyright (C) 2021 The Qt Company Ltd.
+** Contact: http://www.qt.io/licensing/
+**
+** This file is part of the QtSerialBus module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL3$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see http://www.qt.io/terms-conditions. For further
+** information use the contact form at http://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPLv3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or later as published by the Free
+** Software Foundation and appearing in the file LICENSE.GPL included in
+** the packaging of this file. Please review the following information to
+** ensure the GNU General Public License version 2.0 requirements will be
+** met: http://www.gnu.org/licenses/gpl-2.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include "qcanj1939channel.h"
+#include "qcanj1939channel_p.h"
+
+#include <QtCore/qendian.h>
+#include <QtCore/qloggingcategory.h>
+
+#include <algorithm>
+#include <cstring>
+
+QT_BEGIN_NAMESPACE
+
+Q_DECLARE_LOGGING_CATEGORY(QT_CANBUS)
+
+/*!
+    \class QCanJ1939Channel
+    \inmodule QtSerialBus
+    \since 6.1
+
+    \brief The QCanJ1939Channel class exchanges SAE J1939 messages over a CAN
+    bus.
+
+    J1939 is the higher layer protocol of commercial vehicles. Its 29 bit
+    CAN identifiers carry a priority, a parameter group number (PGN) and the
+    source and destination addresses. Messages longer than 8 bytes are sent
+    with the transport protocol of J1939-21, either broadcast (TP.BAM) or to
+    a single node with flow control (TP.CMDT). Every node claims its address
+    on the bus with its 64 bit NAME (J1939-81).
+
+    A channel is one node on the bus. It writes its frames to the
+    \l QCanBusDevice it was created for. The application passes the frames it
+    reads from the device to processFrame(), and reads the decoded messages
+    addressed to the node, or broadcast, with readMessage():
+
+    \code
+        auto channel = new QCanJ1939Channel(device, name, 0x80, this);
+        connect(device, &QCanBusDevice::framesReceived, this, [device, channel]() {
+            while (device->framesAvailable())
+                channel->processFrame(device->readFrame());
+        });
+        connect(channel, &QCanJ1939Channel::messageReceived, this, [channel]() {
+            while (channel->messagesAvailable())
+                handleMessage(channel->readMessage());
+        });
+        channel->claimAddress();
+    \endcode
+
+    Multi-packet messages are reassembled into one buffer per source address
+    and transfer type. The buffer is allocated with the maximum message size
+    of 1785 bytes when a source first sends a multi-packet message and is
+    reused for all later ones, unless the application still holds the
+    previous message.
+
+    If the NAME has the arbitrary address capable bit set, the channel claims
+    another address from the range 128 to 247 when it loses the preferred
+    address to a node with a higher priority NAME. Otherwise it gives up and
+    announces that it cannot claim an address.
+
+    \section1 Kernel offload
+
+    On Linux, the SocketCAN plugin can leave the transport protocol to the
+    kernel's J1939 sockets. Set the device's \l QCanBusDevice::ProtocolKey
+    to \l KernelJ1939Protocol and create the channel before connecting the
+    device. The channel then passes its NAME and preferred address to the
+    device with the configuration keys below, and the device exchanges whole
+    messages: each one is carried by a QCanBusFrame with the J1939 identifier
+    and the message as its payload. Address claiming still happens in the
+    channel. Since the device's socket is bound to the preferred address, an
+    offloaded channel never moves to an arbitrary address; if it loses the
+    preferred address, it announces that it cannot claim an address.
+
+    \value NameKey      The NAME the device binds its socket to.
+    \value AddressKey   The address the device binds its socket to.
+
+    \sa isKernelOffloaded()
+*/
+
+/*!
+    \enum QCanJ1939Channel::Error
+
+    This enum describes the errors that may occur.
+
+    \value NoError              No errors have occurred.
+    \value AddressClaimError    No address could be claimed.
+    \value TimeoutError         A transfer timed out.
+    \value AbortError           The peer aborted a transfer.
+    \value BusyError            A multi-packet message is already being sent,
+                                or no address has been claimed yet.
+    \value WriteError           The device could not write a frame.
+    \value MessageSizeError     The message is longer than 1785 bytes.
+*/
+
+/*!
+    \enum QCanJ1939Channel::AddressState
+
+    This enum describes the state of the address claim.
+
+    \value NoAddress            claimAddress() was not called yet.
+    \value ClaimingAddress      The channel waits whether another node
+                                contends the claimed address.
+    \value AddressClaimed       The channel owns address().
+    \value CannotClaimAddress   The channel lost its address and has no other
+                                one to claim.
+*/
+
+/*!
+    \class QCanJ1939Channel::Message
+    \inmodule QtSerialBus
+    \since 6.1
+
+    \brief The Message struct holds one J1939 message.
+
+    \c pgn is the parameter group number and \c priority the priority from
+    0, the highest, to 7. \c source and \c destination are node addresses,
+    \c destination is \l GlobalAddress for broadcasts. \c data holds the
+    payload and \c timeStamp the time stamp of the frame that started the
+    message.
+*/
+
+/*!
+    \fn void QCanJ1939Channel::messageReceived()
+
+    This signal is emitted when a message was received. Read it with
+    readMessage().
+*/
+
+/*!
+    \fn void QCanJ1939Channel::messageSent()
+
+    This signal is emitted when the last frame of a message passed to
+    sendMessage() was written, or when the peer acknowledged a connection
+    mode transfer.
+*/
+
+/*!
+    \fn void QCanJ1939Channel::addressStateChanged(QCanJ1939Channel::AddressState state)
+
+    This signal is emitted when the address claim changes to \a state.
+*/
+
+/*!
+    \fn void QCanJ1939Channel::errorOccurred(QCanJ1939Channel::Error error)
+
+    This signal is emitted when \a error occurred.
+*/
+
+static constexpr quint64 ArbitraryAddressCapable = Q_UINT64_C(1) << 63;
+static constexpr quint8 FirstArbitraryAddress = 128;
+static constexpr quint8 LastArbitraryAddress = 247;
+
+static quint32 readPgn(const uchar *data)
+{
+    return quint32(data[0]) | quint32(data[1]) << 8 | quint32(data[2]) << 16;
+}
+
+static void writePgn(quint32 pgn, uchar *data)
+{
+    data[0] = uchar(pgn);
+    data[1] = uchar(pgn >> 8);
+    data[2] = uchar(pgn >> 16);
+}
+
+/*!
+    Constructs a J1939 node on \a device with the 64 bit \a name that claims
+    \a preferredAddress once claimAddress() is called. The \a parent is
+    passed to the QObject constructor.
+
+    The channel does not take ownership of \a device.
+*/
+QCanJ1939Channel::QCanJ1939Channel(QCanBusDevice *device, quint64 name, quint8 preferredAddress,
+                                   QObject *parent)
+    : QObject(*new QCanJ1939ChannelPrivate, parent)
+{
+    Q_D(QCanJ1939Channel);
+    d->m_device = device;
+    d->m_name = name;
+    d->m_preferredAddress = preferredAddress;
+    d->setup();
+}
+
+/*!
+    Destroys the channel. Transfers in progress are abandoned.
+*/
+QCanJ1939Channel::~QCanJ1939Channel() = default;
+
+void QCanJ1939ChannelPrivate::setup()
+{
+    Q_Q(QCanJ1939Channel);
+
+    m_clock.start();
+
+    m_addressClaimTimer.setSingleShot(true);
+    QObject::connect(&m_addressClaimTimer, &QTimer::timeout, q, [this]() {
+        m_address = m_claimedCandidate;
+        setAddressState(QCanJ1939Channel::AddressClaimed);
+    });
+
+    m_transmitTimer.setSingleShot(true);
+    QObject::connect(&m_transmitTimer, &QTimer::timeout, q, [this]() {
+        if (m_transmitState == TransmitState::Broadcast) {
+            transmitNextBroadcastPacket();
+            return;
+        }
+        writeAbort(m_transmitMessage.destination, m_transmitMessage.pgn, SessionTimeout);
+        abortTransmission(QCanJ1939Channel::TimeoutError,
+                          QCanJ1939Channel::tr("The receiver did not respond."));
+    });
+
+    m_sessionTimer.setInterval(BroadcastPacketInterval);
+    QObject::connect(&m_sessionTimer, &QTimer::timeout, q, [this]() {
+        checkReceiveSessions();
+    });
+
+    applyKernelConfiguration();
+}
+
+/*!
+    Returns the device the channel sends its frames to.
+*/
+QCanBusDevice *QCanJ1939Channel::device() const
+{
+    Q_D(const QCanJ1939Channel);
+    return d->m_device;
+}
+
+/*!
+    Returns the NAME of the node.
+*/
+quint64 QCanJ1939Channel::name() const
+{
+    Q_D(const QCanJ1939Channel);
+    return d->m_name;
+}
+
+/*!
+    Returns the address the node claims first.
+*/
+quint8 QCanJ1939Channel::preferredAddress() const
+{
+    Q_D(const QCanJ1939Channel);
+    return d->m_preferredAddress;
+}
+
+/*!
+    Returns \c true if the device exchanges whole messages because its
+    \l QCanBusDevice::ProtocolKey is set to \l KernelJ1939Protocol.
+*/
+bool QCanJ1939Channel::isKernelOffloaded() const
+{
+    Q_D(const QCanJ1939Channel);
+    return d->m_device && d->m_device->configurationParameter(QCanBusDevice::ProtocolKey)
+        .toInt() == KernelJ1939Protocol;
+}
+
+void QCanJ1939ChannelPrivate::applyKernelConfiguration()
+{
+    Q_Q(QCanJ1939Channel);
+    if (!q->isKernelOffloaded())
+        return;
+
+    m_device->setConfigurationParameter(
+        QCanBusDevice::ConfigurationKey(QCanJ1939Channel::NameKey), m_name);
+    m_device->setConfigurationParameter(
+        QCanBusDevice::ConfigurationKey(QCanJ1939Channel::AddressKey), m_preferredAddress);
+}
+
+/*!
+    Starts claiming the preferred address. The claim succeeds if no node
+    with a higher priority NAME contends it within 250 ms, see
+    addressStateChanged(). Returns \c false if the address claim could not
+    be written.
+*/
+bool QCanJ1939Channel::claimAddress()
+{
+    Q_D(QCanJ1939Channel);
+    if (d->m_preferredAddress > 0xfd) {
+        d->setError(AddressClaimError, tr("Invalid preferred address %1.")
+                                           .arg(d->m_preferredAddress));
+        return false;
+    }
+    d->startAddressClaim(d->m_preferredAddress);
+    return d->m_addressState == ClaimingAddress;
+}
+
+/*!
+    Returns the state of the address claim.
+*/
+QCanJ1939Channel::AddressState QCanJ1939Channel::addressState() const
+{
+    Q_D(const QCanJ1939Channel);
+    return d->m_addressState;
+}
+
+/*!
+    Returns the address the node owns, or \l NullAddress if it has not
+    claimed one.
+*/
+quint8 QCanJ1939Channel::address() const
+{
+    Q_D(const QCanJ1939Channel);
+    return d->m_address;
+}
+
+void QCanJ1939ChannelPrivate::startAddressClaim(quint8 address)
+{
+    m_claimedCandidate = address;
+    m_address = QCanJ1939Channel::NullAddress;
+
+    // A contending claim may arrive while ours is being written.
+    setAddressState(QCanJ1939Channel::ClaimingAddress);
+    m_addressClaimTimer.start(AddressClaimTimeout);
+    if (!sendAddressClaim()) {
+        m_addressClaimTimer.stop();
+        setAddressState(QCanJ1939Channel::NoAddress);
+    }
+}
+
+bool QCanJ1939ChannelPrivate::sendAddressClaim()
+{
+    uchar name[8];
+    qToLittleEndian(m_name, name);
+    return writeFrame(AddressClaimedPgn, 6, QCanJ1939Channel::GlobalAddress, name, 8);
+}
+
+void QCanJ1939ChannelPrivate::processAddressClaim(quint8 source, const uchar *data,
+                                                  qsizetype size)
+{
+    if (size < 8)
+        return;
+    const quint64 name = qFromLittleEndian<quint64>(data);
+    if (source <= 0xfd)
+        m_usedAddresses.set(source);
+
+    const bool claiming = m_addressState == QCanJ1939Channel::ClaimingAddress
+        || m_addressState == QCanJ1939Channel::AddressClaimed;
+    if (!claiming || name == m_name || source != m_claimedCandidate)
+        return;
+
+    // The lower NAME has the higher priority and keeps the address.
+    if (m_name < name)
+        sendAddressClaim();
+    else
+        loseAddress(source);
+}
+
+void QCanJ1939ChannelPrivate::loseAddress(quint8 address)
+{
+    m_addressClaimTimer.stop();
+    m_address = QCanJ1939Channel::NullAddress;
+
+    // A kernel J1939 socket stays bound to the preferred address, so moving to
+    // another one would send from an address the node does not own.
+    Q_Q(QCanJ1939Channel);
+    if ((m_name & ArbitraryAddressCapable) && !q->isKernelOffloaded()) {
+        for (int candidate = FirstArbitraryAddress; candidate <= LastArbitraryAddress;
+             ++candidate) {
+            if (candidate != address && !m_usedAddresses.test(candidate)) {
+                startAddressClaim(quint8(candidate));
+                return;
+            }
+        }
+    }
+
+    // Announce the failure with the null address.
+    m_claimedCandidate = QCanJ1939Channel::NullAddress;
+    sendAddressClaim();
+    setAddressState(QCanJ1939Channel::CannotClaimAddress);
+    setError(QCanJ1939Channel::AddressClaimError,
+             QCanJ1939Channel::tr("Lost address %1 and cannot claim another one.").arg(address));
+}
+
+void QCanJ1939ChannelPrivate::setAddressState(QCanJ1939Channel::AddressState state)
+{
+    Q_Q(QCanJ1939Channel);
+    if (m_addressState == state)
+        return;
+    m_addressState = state;
+    emit q->addressStateChanged(state);
+}
+
+/*
+    Writes a single frame. The source address is the claimed one, or the candidate while
+    an address claim is in progress.
+*/
+bool QCanJ1939ChannelPrivate::writeFrame(quint32 pgn, quint8 priority, quint8 destination,
+                                         const uchar *data, qsizetype size)
+{
+    const quint8 source = pgn == AddressClaimedPgn ? m_claimedCandidate : m_address;
+    QCanBusFrame frame(QCanJ1939Channel::frameId(pgn, priority, source, destination),
+                       QByteArray(reinterpret_cast<const char *>(data), size));
+    frame.setExtendedFrameFormat(true);
+
+    if (m_device && m_device->writeFrame(frame))
+        return true;
+
+    setError(QCanJ1939Channel::WriteError, m_device
+             ? m_device->errorString() : QCanJ1939Channel::tr("The channel has no device."));
+    return false;
+}
+
+bool QCanJ1939ChannelPrivate::writeControl(quint8 destination, const std::array<uchar, 8> &data)
+{
+    return writeFrame(TransportControlPgn, TransportPriority, destination, data.data(), 8);
+}
+
+bool QCanJ1939ChannelPrivate::writeAbort(quint8 destination, quint32 pgn, AbortReason reason)
+{
+    std::array<uchar, 8> data = { ConnectionAbort, reason, 0xff, 0xff, 0xff };
+    writePgn(pgn, data.data() + 5);
+    return writeControl(destination, data);
+}
+
+/*!
+    Sends \a message from the claimed address. The source address of
+    \a message is ignored. Messages of up to 8 bytes are written immediately;
+    longer ones are sent with the transport protocol, broadcast if the
+    destination is \l GlobalAddress and with flow control otherwise.
+
+    Returns \c false if no address was claimed, a multi-packet message is
+    still being sent, \a message is longer than 1785 bytes or its first frame
+    could not be written.
+*/
+bool QCanJ1939Channel::sendMessage(const Message &message)
+{
+    Q_D(QCanJ1939Channel);
+    const qsizetype size = message.data.size();
+    if (size > QCanJ1939ChannelPrivate::MaximumMessageSize) {
+        d->setError(MessageSizeError, tr("Invalid message size %1.").arg(size));
+        return false;
+    }
+    if (d->m_addressState != AddressClaimed) {
+        d->setError(BusyError, tr("No address has been claimed."));
+        return false;
+    }
+
+    const uchar *data = reinterpret_cast<const uchar *>(message.data.constData());
+    if (size <= 8 || isKernelOffloaded()) {
+        // The kernel segments long messages itself.
+        if (!d->writeFrame(message.pgn, message.priority, message.destination, data, size))
+            return false;
+        emit messageSent();
+        return true;
+    }
+
+    if (d->m_transmitState != QCanJ1939ChannelPrivate::TransmitState::Idle) {
+        d->setError(BusyError, tr("A message is already being sent."));
+        return false;
+    }
+
+    d->m_transmitMessage = message;
+    d->m_transmitPackets = int((size + 6) / 7);
+    d->m_transmitNextPacket = 1;
+
+    const bool broadcast = message.destination == GlobalAddress;
+    std::array<uchar, 8> control = {
+        broadcast ? QCanJ1939ChannelPrivate::BroadcastAnnounce
+                  : QCanJ1939ChannelPrivate::RequestToSend,
+        uchar(size), uchar(size >> 8), uchar(d->m_transmitPackets), 0xff
+    };
+    QCanJ1939ChannelPrivate::TransmitState state
+        = QCanJ1939ChannelPrivate::TransmitState::WaitForClearToSend;
+    int timeout = QCanJ1939ChannelPrivate::ClearToSendTimeout;
+    if (broadcast) {
+        state = QCanJ1939ChannelPrivate::TransmitState::Broadcast;
+        timeout = QCanJ1939ChannelPrivate::BroadcastPacketInterval;
+    }
+    writePgn(message.pgn, control.data() + 5);
+
+    // The peer's clear to send may arrive while the request is being written.
+    d->m_transmitState = state;
+    d->m_transmitTimer.start(timeout);
+    if (!d->writeControl(message.destination, control)) {
+        d->m_transmitTimer.stop();
+        d->m_transmitState = QCanJ1939ChannelPrivate::TransmitState::Idle;
+        return false;
+    }
+    return true;
+}
+
+/*!
+    Returns \c true while a multi-packet message is being sent.
+*/
+bool QCanJ1939Channel::isSending() const
+{
+    Q_D(const QCanJ1939Channel);
+    return d->m_transmitState != QCanJ1939ChannelPrivate::TransmitState::Idle;
+}
+
+void QCanJ1939ChannelPrivate::transmitPackets(int first, int last)
+{
+    const QByteArray &message = m_transmitMessage.data;
+    const quint8 destination = m_transmitMessage.destination;
+
+    // Wait for the next clear to send or the acknowledge once the window was written.
+    m_transmitState = last == m_transmitPackets ? TransmitState::WaitForAcknowledge
+                                                : TransmitState::WaitForClearToSend;
+    m_transmitTimer.start(ClearToSendTimeout);
+
+    for (int packet = first; packet <= last; ++packet) {
+        std::array<uchar, 8> data;
+        data.fill(0xff);
+        data[0] = uchar(packet);
+        const qsizetype offset = qsizetype(packet - 1) * 7;
+        std::memcpy(data.data() + 1, message.constData() + offset,
+                    size_t(qMin(qsizetype(7), message.size() - offset)));
+        if (!writeFrame(TransportDataPgn, TransportPriority, destination, data.data(), 8)) {
+            resetTransmission();
+            return;
+        }
+    }
+}
+
+void QCanJ1939ChannelPrivate::transmitNextBroadcastPacket()
+{
+    const int packet = m_transmitNextPacket++;
+    std::array<uchar, 8> data;
+    data.fill(0xff);
+    data[0] = uchar(packet);
+    const QByteArray &message = m_transmitMessage.data;
+    const qsizetype offset = qsizetype(packet - 1) * 7;
+    std::memcpy(data.data() + 1, message.constData() + offset,
+                size_t(qMin(qsizetype(7), message.size() - offset)));
+
+    if (!writeFrame(TransportDataPgn, TransportPriority, QCanJ1939Channel::GlobalAddress,
+                    data.data(), 8)) {
+        resetTransmission();
+        return;
+    }
+
+    if (packet == m_transmitPackets)
+        finishTransmission();
+    else
+        m_transmitTimer.start(BroadcastPacketInterval);
+}
+
+void QCanJ1939ChannelPrivate::resetTransmission()
+{
+    m_transmitTimer.stop();
+    m_transmitState = TransmitState::Idle;
+    m_transmitMessage.data.clear();
+}
+
+void QCanJ1939ChannelPrivate::finishTransmission()
+{
+    Q_Q(QCanJ1939Channel);
+    resetTransmission();
+    emit q->messageSent();
+}
+
+void QCanJ1939ChannelPrivate::abortTransmission(QCanJ1939Channel::Error error,
+                                                const QString &errorString)
+{
+    resetTransmission();
+    setError(error, errorString);
+}
+
+/*!
+    Processes \a frame if it is a J1939 frame for this node, that is an
+    extended data frame that is broadcast or addressed to address(). Returns
+    \c true if the frame was processed; otherwise returns \c false so the
+    application can process it itself.
+
+    Frames of the address claim and transport protocols are consumed by the
+    channel, all other frames are decoded into messages.
+*/
+bool QCanJ1939Channel::processFrame(const QCanBusFrame &frame)
+{
+    Q_D(QCanJ1939Channel);
+    if (frame.frameType() != QCanBusFrame::DataFrame || !frame.hasExtendedFrameFormat()
+            || frame.hasLocalEcho()) {
+        return false;
+    }
+
+    const quint32 id = frame.frameId();
+    const quint8 source = sourceAddress(id);
+    const quint8 destination = destinationAddress(id);
+    if (destination != GlobalAddress && (destination != d->m_address || d->m_address > 0xfd))
+        return false;
+
+    const quint32 pgn = parameterGroupNumber(id);
+    const QByteArray payload = frame.payload();
+    const uchar *data = reinterpret_cast<const uchar *>(payload.constData());
+    const qsizetype size = payload.size();
+
+    switch (pgn) {
+    case QCanJ1939ChannelPrivate::AddressClaimedPgn:
+        d->processAddressClaim(source, data, size);
+        return true;
+    case QCanJ1939ChannelPrivate::RequestPgn:
+        if (size >= 3 && readPgn(data) == QCanJ1939ChannelPrivate::AddressClaimedPgn) {
+            if (d->m_addressState == AddressClaimed || d->m_addressState == CannotClaimAddress)
+                d->sendAddressClaim();
+            return true;
+        }
+        break;
+    case QCanJ1939ChannelPrivate::TransportControlPgn:
+        if (size >= 8 && !isKernelOffloaded())
+            d->processTransportControl(source, destination, data, frame.timeStamp());
+        return true;
+    case QCanJ1939ChannelPrivate::TransportDataPgn:
+        if (size >= 2 && !isKernelOffloaded())
+            d->processTransportData(source, destination, data, size);
+        return true;
+    default:
+        break;
+    }
+
+    Message message;
+    message.pgn = pgn;
+    message.priority = priority(id);
+    message.source = source;
+    message.destination = destination;
+    message.data = payload;
+    message.timeStamp = frame.timeStamp();
+    d->deliver(std::move(message));
+    return true;
+}
+
+void QCanJ1939ChannelPrivate::processTransportControl(quint8 source, quint8 destination,
+                                                      const uchar *data,
+                                                      QCanBusFrame::TimeStamp timeStamp)
+{
+    const quint32 pgn = readPgn(data + 5);
+    const bool broadcast = destination == QCanJ1939Channel::GlobalAddress;
+
+    switch (data[0]) {
+    case BroadcastAnnounce:
+        if (broadcast)
+            startReceiveSession(true, source, destination, data, timeStamp);
+        break;
+    case RequestToSend:
+        if (broadcast)
+            break;
+        if (m_connectionSessions[source] && m_connectionSessions[source]->active) {
+            // A new request from the same source replaces the stale session.
+            closeReceiveSession(m_connectionSessions[source].get());
+        }
+        if (ReceiveSession *session = startReceiveSession(false, source, destination, data,
+                                                          timeStamp)) {
+            session->maximumPacketsPerWindow = data[4] == 0 ? 0xff : data[4];
+            sendClearToSend(session);
+        } else {
+            writeAbort(source, pgn, ResourcesNeeded);
+        }
+        break;
+    case ClearToSend: {
+        if (broadcast || m_transmitState != TransmitState::WaitForClearToSend
+                || m_transmitMessage.destination != source || m_transmitMessage.pgn != pgn) {
+            break;
+        }
+        const int count = data[1];
+        if (count == 0) {
+            // The receiver holds the connection open.
+            m_transmitTimer.start(HoldTimeout);
+            break;
+        }
+        const int first = qMax(1, int(data[2]));
+        transmitPackets(first, qMin(m_transmitPackets, first + count - 1));
+        break;
+    }
+    case EndOfMessageAcknowledge:
+        if (m_transmitState == TransmitState::WaitForAcknowledge
+                && m_transmitMessage.destination == source && m_transmitMessage.pgn == pgn) {
+            finishTransmission();
+        }
+        break;
+    case ConnectionAbort:
+        if (m_transmitState != TransmitState::Idle && m_transmitMessage.destination == source
+                && m_transmitMessage.pgn == pgn) {
+            abortTransmission(QCanJ1939Channel::AbortError,
+                              QCanJ1939Channel::tr("Node %1 aborted the transfer, reason %2.")
+                                  .arg(source).arg(data[1]));
+        }
+        if (m_connectionSessions[source] && m_connectionSessions[source]->active
+                && m_connectionSessions[source]->pgn == pgn) {
+            closeReceiveSession(m_connectionSessions[source].get());
+        }
+        break;
+    default:
+        break;
+    }
+}
+
+QCanJ1939ChannelPrivate::ReceiveSession *
+QCanJ1939ChannelPrivate::startReceiveSession(bool broadcast, quint8 source, quint8 destination,
+                                             const uchar *data,
+                                             QCanBusFrame::TimeStamp timeStamp)
+{
+    const qsizetype size = qsizetype(data[1]) | qsizetype(data[2]) << 8;
+    const int packets = data[3];
+    if (size <= 8 || size > MaximumMessageSize || packets != (size + 6) / 7)
+        return nullptr;
+
+    auto &slot = broadcast ? m_broadcastSessions[source] : m_connectionSessions[source];
+    if (!slot) {
+        slot = std::make_unique<ReceiveSession>();
+        slot->buffer.reserve(MaximumMessageSize);
+    }
+    ReceiveSession *session = slot.get();
+    if (session->active)
+        closeReceiveSession(session);
+
+    // Reuse the buffer of the previous message unless the application still holds it.
+    if (!session->buffer.isDetached()) {
+        session->buffer = QByteArray();
+        session->buffer.reserve(MaximumMessageSize);
+    }
+    session->buffer.resize(size);
+
+    session->active = true;
+    session->broadcast = broadcast;
+    session->source = source;
+    session->destination = destination;
+    session->pgn = readPgn(data + 5);
+    session->size = size;
+    session->packets = packets;
+    session->nextPacket = 1;
+    session->lastPacketOfWindow = packets;
+    session->deadline = m_clock.elapsed() + PacketTimeout;
+    session->timeStamp = timeStamp;
+
+    m_activeSessions.push_back(session);
+    if (!m_sessionTimer.isActive())
+        m_sessionTimer.start();
+    return session;
+}
+
+bool QCanJ1939ChannelPrivate::sendClearToSend(ReceiveSession *session)
+{
+    const int count = std::min({ session->packets - session->nextPacket + 1,
+                                 session->maximumPacketsPerWindow, int(PacketsPerClearToSend) });
+    session->lastPacketOfWindow = session->nextPacket + count - 1;
+    session->deadline = m_clock.elapsed() + ClearToSendTimeout;
+
+    std::array<uchar, 8> data = { ClearToSend, uchar(count), uchar(session->nextPacket),
+                                  0xff, 0xff };
+    writePgn(session->pgn, data.data() + 5);
+    return writeControl(session->source, data);
+}
+
+void QCanJ1939ChannelPrivate::processTransportData(quint8 source, quint8 destination,
+                                                   const uchar *data, qsizetype size)
+{
+    const bool broadcast = destination == QCanJ1939Channel::GlobalAddress;
+    ReceiveSession *session = broadcast ? m_broadcastSessions[source].get()
+                                        : m_connectionSessions[source].get();
+    if (!session || !session->active)
+        return;
+
+    const int packet = data[0];
+    if (packet != session->nextPacket) {
+        if (!broadcast)
+            writeAbort(source, session->pgn, BadSequence);
+        closeReceiveSession(session);
+        setError(QCanJ1939Channel::AbortError,
+                 QCanJ1939Channel::tr("Expected packet %1 from node %2, received %3.")
+                     .arg(session->nextPacket).arg(source).arg(packet));
+        return;
+    }
+
+    const qsizetype offset = qsizetype(packet - 1) * 7;
+    const qsizetype length = qMin(qMin(qsizetype(7), size - 1), session->size - offset);
+    std::memcpy(session->buffer.data() + offset, data + 1, size_t(length));
+    ++session->nextPacket;
+    session->deadline = m_clock.elapsed() + PacketTimeout;
+
+    if (packet == session->packets) {
+        if (!broadcast) {
+            std::array<uchar, 8> acknowledge = { EndOfMessageAcknowledge, uchar(session->size),
+                                                 uchar(session->size >> 8),
+                                                 uchar(session->packets), 0xff };
+            writePgn(session->pgn, acknowledge.data() + 5);
+            writeControl(source, acknowledge);
+        }
+
+        QCanJ1939Channel::Message message;
+        message.pgn = session->pgn;
+        message.priority = TransportPriority;
+        message.source = source;
+        message.destination = session->destination;
+        // Shares the session buffer; startReceiveSession() detaches if it is still held.
+        message.data = session->buffer;
+        message.timeStamp = session->timeStamp;
+        closeReceiveSession(session);
+        deliver(std::move(message));
+        return;
+    }
+
+    if (!broadcast && packet == session->lastPacketOfWindow)
+        sendClearToSend(session);
+}
+
+void QCanJ1939ChannelPrivate::closeReceiveSession(ReceiveSession *session)
+{
+    session->active = false;
+    m_activeSessions.erase(std::remove(m_activeSessions.begin(), m_activeSessions.end(),
+                                       session), m_activeSessions.end());
+    if (m_activeSessions.empty())
+        m_sessionTimer.stop();
+}
+
+void QCanJ1939ChannelPrivate::checkReceiveSessions()
+{
+    const qint64 now = m_clock.elapsed();
+    const std::vector<ReceiveSession *> sessions = m_activeSessions;
+    for (ReceiveSession *session : sessions) {
+        if (session->deadline > now)
+            continue;
+        if (!session->broadcast)
+            writeAbort(session->source, session->pgn, SessionTimeout);
+        closeReceiveSession(session);
+        setError(QCanJ1939Channel::TimeoutError,
+                 QCanJ1939Channel::tr("Transfer of PGN %1 from node %2 timed out.")
+                     .arg(session->pgn).arg(session->source));
+    }
+}
+
+void QCanJ1939ChannelPrivate::deliver(QCanJ1939Channel::Message &&message)
+{
+    Q_Q(QCanJ1939Channel);
+    m_messages.push_back(std::move(message));
+    emit q->messageReceived();
+}
+
+/*!
+    Returns the number of received messages that were not read yet.
+*/
+qsizetype QCanJ1939Channel::messagesAvailable() const
+{
+    Q_D(const QCanJ1939Channel);
+    return qsizetype(d->m_messages.size());
+}
+
+/*!
+    Returns the oldest received message and removes it from the channel, or
+    a default constructed message if no message is available.
+*/
+QCanJ1939Channel::Message QCanJ1939Channel::readMessage()
+{
+    Q_D(QCanJ1939Channel);
+    if (d->m_messages.empty())
+        return Message();
+    Message message = std::move(d->m_messages.front());
+    d->m_messages.pop_front();
+    return message;
+}
+
+/*!
+    Returns the last error that occurred.
+*/
+QCanJ1939Channel::Error QCanJ1939Channel::error() const
+{
+    Q_D(const QCanJ1939Channel);
+    return d->m_error;
+}
+
+/*!
+    Returns a description of the last error that occurred.
+*/
+QString QCanJ1939Channel::errorString() const
+{
+    Q_D(const QCanJ1939Channel);
+    return d->m_errorString;
+}
+
+void QCanJ1939ChannelPrivate::setError(QCanJ1939Channel::Error error, const QString &errorString)
+{
+    Q_Q(QCanJ1939Channel);
+    m_error = error;
+    m_errorString = errorString;
+    qCDebug(QT_CANBUS) << "(J1939)" << errorString;
+    emit q->errorOccurred(error);
+}
+
+/*!
+    Returns the parameter group number encoded in the 29 bit \a frameId. For
+    destination specific PGNs (PDU1 format) the destination address is
+    masked out.
+*/
+quint32 QCanJ1939Channel::parameterGroupNumber(quint32 frameId)
+{
+    const quint32 pgn = (frameId >> 8) & 0x3ffff;
+    return ((pgn >> 8) & 0xff) < 240 ? (pgn & 0x3ff00) : pgn;
+}
+
+/*!
+    Returns the source address encoded in \a frameId.
+*/
+quint8 QCanJ1939Channel::sourceAddress(quint32 frameId)
+{
+    return quint8(frameId);
+}
+
+/*!
+    Returns the destination address encoded in \a frameId, or
+    \l GlobalAddress for PGNs that are always broadcast (PDU2 format).
+*/
+quint8 QCanJ1939Channel::destinationAddress(quint32 frameId)
+{
+    return ((frameId >> 16) & 0xff) < 240 ? quint8(frameId >> 8) : quint8(GlobalAddress);
+}
+
+/*!
+    Returns the priority encoded in \a frameId.
+*/
+quint8 QCanJ1939Channel::priority(quint32 frameId)
+{
+    return quint8((frameId >> 26) & 0x7);
+}
+
+/*!
+    Returns the 29 bit CAN identifier for a message with \a pgn and
+    \a priority sent from \a source to \a destination. The destination is
+    ignored for PGNs that are always broadcast.
+*/
+quint32 QCanJ1939Channel::frameId(quint32 pgn, quint8 priority, quint8 source,
+                                  quint8 destination)
+{
+    quint32 id = quint32(priority & 0x7) << 26 | (pgn & 0x3ffff) << 8 | source;
+    if (((pgn >> 8) & 0xff) < 240)
+        id = (id & ~quint32(0xff00)) | quint32(destination) << 8;
+    return id;
+}
+
+QT_END_NAMESPACE
@@ -0,0 +1,141 @@
+/****************************************************************************
+**
+** Copyright (C) 2021 The Qt Company Ltd.
+** Contact: http://www.qt.io/licensing/
+**
+** This file is part of the QtSerialBus module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL3$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see http://www.qt.io/terms-conditions. For further
+** information use the contact form at http://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPLv3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or later as published by the Free
+** Software Foundation and appearing in the file LICENSE.GPL included in
+** the packaging of this file. Please review the following information to
+** ensure the GNU General Public License version 2.0 requirements will be
+** met: http://www.gnu.org/licenses/gpl-2.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#ifndef QCANJ1939CHANNEL_H
+#define QCANJ1939CHANNEL_H
+
+#include <QtCore/qobject.h>
+#include <QtSerialBus/qcanbusdevice.h>
+#include <QtSerialBus/qcanbusframe.h>
+
+QT_BEGIN_NAMESPACE
+
+class QCanJ1939ChannelPrivate;
+
+class Q_SERIALBUS_EXPORT QCanJ1939Channel : public QObject
+{
+    Q_OBJECT
+    Q_DECLARE_PRIVATE(QCanJ1939Channel)
+
+public:
+    enum Error {
+        NoError,
+        AddressClaimError,
+        TimeoutError,
+        AbortError,
+        BusyError,
+        WriteError,
+        MessageSizeError
+    };
+    Q_ENUM(Error)
+
+    enum AddressState {
+        NoAddress,
+        ClaimingAddress,
+        AddressClaimed,
+        CannotClaimAddress
+    };
+    Q_ENUM(AddressState)
+
+    enum { KernelJ1939Protocol = 7 };
+
+    enum ConfigurationKey {
+        NameKey = QCanBusDevice::UserKey + 10,
+        AddressKey
+    };
+    Q_ENUM(ConfigurationKey)
+
+    enum : quint8 {
+        NullAddress = 0xfe,
+        GlobalAddress = 0xff
+    };
+
+    struct Message
+    {
+        quint32 pgn = 0;
+        quint8 priority = 6;
+        quint8 source = NullAddress;
+        quint8 destination = GlobalAddress;
+        QByteArray data;
+        QCanBusFrame::TimeStamp timeStamp;
+    };
+
+    explicit QCanJ1939Channel(QCanBusDevice *device, quint64 name, quint8 preferredAddress,
+                              QObject *parent = nullptr);
+    ~QCanJ1939Channel();
+
+    QCanBusDevice *device() const;
+    quint64 name() const;
+    quint8 preferredAddress() const;
+
+    bool claimAddress();
+    AddressState addressState() const;
+    quint8 address() const;
+
+    bool isKernelOffloaded() const;
+
+    bool sendMessage(const Message &message);
+    bool isSending() const;
+
+    bool processFrame(const QCanBusFrame &frame);
+    qsizetype messagesAvailable() const;
+    Message readMessage();
+
+    Error error() const;
+    QString errorString() const;
+
+    static quint32 parameterGroupNumber(quint32 frameId);
+    static quint8 sourceAddress(quint32 frameId);
+    static quint8 destinationAddress(quint32 frameId);
+    static quint8 priority(quint32 frameId);
+    static quint32 frameId(quint32 pgn, quint8 priority, quint8 source,
+                           quint8 destination = GlobalAddress);
+
+Q_SIGNALS:
+    void messageReceived();
+    void messageSent();
+    void addressStateChanged(QCanJ1939Channel::AddressState state);
+    void errorOccurred(QCanJ1939Channel::Error error);
+
+private:
+    Q_DISABLE_COPY(QCanJ1939Channel)
+};
+
+Q_DECLARE_TYPEINFO(QCanJ1939Channel::Message, Q_RELOCATABLE_TYPE);
+
+QT_END_NAMESPACE
+
+#endif // QCANJ1939CHANNEL_H
@@ -0,0 +1,205 @@
+/****************************************************************************
+**
+** Copyright (C) 2021 The Qt Company Ltd.
+** Contact: http://www.qt.io/licensing/
+**
+** This file is part of the QtSerialBus module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL3$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see http://www.qt.io/terms-conditions. For further
+** information use the contact form at http://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPLv3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or later as published by the Free
+** Software Foundation and appearing in the file LICENSE.GPL included in
+** the packaging of this file. Please review the following information to
+** ensure the GNU General Public License version 2.0 requirements will be
+** met: http://www.gnu.org/licenses/gpl-2.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#ifndef QCANJ1939CHANNEL_P_H
+#define QCANJ1939CHANNEL_P_H
+
+#include <QtCore/qelapsedtimer.h>
+#include <QtCore/qpointer.h>
+#include <QtCore/qtimer.h>
+#include <QtSerialBus/qcanbusdevice.h>
+#include <QtSerialBus/qcanj1939channel.h>
+
+#include <private/qobject_p.h>
+
+#include <array>
+#include <bitset>
+#include <deque>
+#include <memory>
+#include <vector>
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API. It exists purely as an
+// implementation detail. This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+//
+
+QT_BEGIN_NAMESPACE
+
+class QCanJ1939ChannelPrivate : public QObjectPrivate
+{
+    Q_DECLARE_PUBLIC(QCanJ1939Channel)
+
+public:
+    enum : quint32 {
+        RequestPgn = 0xea00,
+        TransportDataPgn = 0xeb00,
+        TransportControlPgn = 0xec00,
+        AddressClaimedPgn = 0xee00
+    };
+
+    // First byte of a transport protocol connection management (TP.CM) frame.
+    enum ControlByte : quint8 {
+        RequestToSend = 16,
+        ClearToSend = 17,
+        EndOfMessageAcknowledge = 19,
+        BroadcastAnnounce = 32,
+        ConnectionAbort = 255
+    };
+
+    enum AbortReason : quint8 {
+        AlreadyInSession = 1,
+        ResourcesNeeded = 2,
+        SessionTimeout = 3,
+        BadSequence = 7
+    };
+
+    // Timeouts of SAE J1939-21 in milliseconds.
+    enum Timing {
+        PacketTimeout = 750,            // T1
+        ClearToSendTimeout = 1250,      // T2 and T3
+        HoldTimeout = 1050,             // T4
+        AddressClaimTimeout = 250,
+        BroadcastPacketInterval = 50
+    };
+
+    enum {
+        MaximumMessageSize = 1785,
+        PacketsPerClearToSend = 16,
+        TransportPriority = 7
+    };
+
+    /*
+        One multi-packet transfer received from a source address. Its buffer is allocated
+        with the maximum message size when the session is first used and then reused for
+        every later transfer from the same source.
+    */
+    struct ReceiveSession
+    {
+        bool active = false;
+        bool broadcast = false;
+        quint8 source = 0;
+        quint8 destination = 0;
+        quint32 pgn = 0;
+        qsizetype size = 0;
+        int packets = 0;
+        int nextPacket = 1;
+        int lastPacketOfWindow = 0;
+        int maximumPacketsPerWindow = 0;
+        qint64 deadline = 0;
+        QCanBusFrame::TimeStamp timeStamp;
+        QByteArray buffer;
+    };
+
+    enum class TransmitState {
+        Idle,
+        Broadcast,
+        WaitForClearToSend,
+        WaitForAcknowledge
+    };
+
+    void setup();
+
+    bool writeFrame(quint32 pgn, quint8 priority, quint8 destination, const uchar *data,
+                    qsizetype size);
+    bool writeControl(quint8 destination, const std::array<uchar, 8> &data);
+    bool writeAbort(quint8 destination, quint32 pgn, AbortReason reason);
+
+    void startAddressClaim(quint8 address);
+    bool sendAddressClaim();
+    void processAddressClaim(quint8 source, const uchar *data, qsizetype size);
+    void loseAddress(quint8 address);
+    void setAddressState(QCanJ1939Channel::AddressState state);
+
+    void processTransportControl(quint8 source, quint8 destination, const uchar *data,
+                                 QCanBusFrame::TimeStamp timeStamp);
+    void processTransportData(quint8 source, quint8 destination, const uchar *data,
+                              qsizetype size);
+    ReceiveSession *startReceiveSession(bool broadcast, quint8 source, quint8 destination,
+                                        const uchar *data, QCanBusFrame::TimeStamp timeStamp);
+    bool sendClearToSend(ReceiveSession *session);
+    void closeReceiveSession(ReceiveSession *session);
+    void checkReceiveSessions();
+
+    void transmitPackets(int first, int last);
+    void transmitNextBroadcastPacket();
+    void resetTransmission();
+    void finishTransmission();
+    void abortTransmission(QCanJ1939Channel::Error error, const QString &errorString);
+
+    void deliver(QCanJ1939Channel::Message &&message);
+    void setError(QCanJ1939Channel::Error error, const QString &errorString);
+    void applyKernelConfiguration();
+
+    QPointer<QCanBusDevice> m_device;
+    quint64 m_name = 0;
+    quint8 m_preferredAddress = QCanJ1939Channel::NullAddress;
+
+    // Address claiming.
+    quint8 m_address = QCanJ1939Channel::NullAddress;
+    quint8 m_claimedCandidate = QCanJ1939Channel::NullAddress;
+    QCanJ1939Channel::AddressState m_addressState = QCanJ1939Channel::NoAddress;
+    std::bitset<256> m_usedAddresses;
+    QTimer m_addressClaimTimer;
+
+    // Transmission of one multi-packet message at a time.
+    TransmitState m_transmitState = TransmitState::Idle;
+    QCanJ1939Channel::Message m_transmitMessage;
+    int m_transmitPackets = 0;
+    int m_transmitNextPacket = 1;
+    QTimer m_transmitTimer;
+
+    // Reception sessions, indexed by source address.
+    std::array<std::unique_ptr<ReceiveSession>, 256> m_broadcastSessions;
+    std::array<std::unique_ptr<ReceiveSession>, 256> m_connectionSessions;
+    std::vector<ReceiveSession *> m_activeSessions;
+    QTimer m_sessionTimer;
+    QElapsedTimer m_clock;
+
+    std::deque<QCanJ1939Channel::Message> m_messages;
+
+    QCanJ1939Channel::Error m_error = QCanJ1939Channel::NoError;
+    QString m_errorString;
+};
+
+QT_END_NAMESPACE
+
+#endif // QCANJ1939CHANNEL_P_H
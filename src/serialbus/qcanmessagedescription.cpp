@@ -0,0 +1,158 @@
+/****************************************************************************
+**
+** Copyright (C) 2021 The Qt Company Ltd.
+** Contact: http://www.qt.io/licensing/
+**
+** This file is part of the QtSerialBus module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL3$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see http://www.qt.io/terms-conditions. For further
+** information use the contact form at http://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPLv3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or later as published by the Free
+** Software Foundation and appearing in the file LICENSE.GPL included in
+** the packaging of this file. Please review the following information to
+** ensure the GNU General Public License version 2.0 requirements will be
+** met: http://www.gnu.org/licenses/gpl-2.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include "qcanmessagedescription.h"
+
+QT_BEGIN_NAMESPACE
+
+/*!
+    \class QCanMessageDescription
+    \inmodule QtSerialBus
+    \since 6.1
+
+    \brief The QCanMessageDescription class describes the signals carried by
+    the CAN frames with one frame identifier.
+
+    Message descriptions are usually loaded from a DBC file with
+    QCanDbcFileParser and compiled into a QCanSignalDecoder.
+
+    \sa QCanSignalDescription
+*/
+
+/*!
+    \fn QCanMessageDescription::QCanMessageDescription()
+
+    Constructs an invalid message description.
+*/
+
+/*!
+    \fn QCanMessageDescription::QCanMessageDescription(quint32 frameId, const QString &name, int size)
+
+    Constructs a description of the message \a name with \a size payload
+    bytes carried by frames with \a frameId. Identifiers above \c 0x7ff use
+    the extended frame format.
+*/
+
+/*!
+    \fn quint32 QCanMessageDescription::frameId() const
+
+    Returns the frame identifier of the message.
+*/
+
+/*!
+    \fn void QCanMessageDescription::setFrameId(quint32 frameId)
+
+    Sets the frame identifier of the message to \a frameId.
+*/
+
+/*!
+    \fn bool QCanMessageDescription::hasExtendedFrameFormat() const
+
+    Returns \c true if the message is sent with a 29 bit identifier.
+*/
+
+/*!
+    \fn void QCanMessageDescription::setExtendedFrameFormat(bool extended)
+
+    Sets whether the message is sent with a 29 bit identifier to \a extended.
+*/
+
+/*!
+    \fn QString QCanMessageDescription::name() const
+
+    Returns the name of the message.
+*/
+
+/*!
+    \fn void QCanMessageDescription::setName(const QString &name)
+
+    Sets the name of the message to \a name.
+*/
+
+/*!
+    \fn int QCanMessageDescription::size() const
+
+    Returns the number of payload bytes of the message.
+*/
+
+/*!
+    \fn void QCanMessageDescription::setSize(int size)
+
+    Sets the number of payload bytes of the message to \a size.
+*/
+
+/*!
+    \fn QString QCanMessageDescription::transmitter() const
+
+    Returns the name of the node that sends the message.
+*/
+
+/*!
+    \fn void QCanMessageDescription::setTransmitter(const QString &transmitter)
+
+    Sets the name of the node that sends the message to \a transmitter.
+*/
+
+/*!
+    \fn QList<QCanSignalDescription> QCanMessageDescription::signalDescriptions() const
+
+    Returns the signals of the message.
+*/
+
+/*!
+    \fn void QCanMessageDescription::setSignalDescriptions(const QList<QCanSignalDescription> &descriptions)
+
+    Sets the signals of the message to \a descriptions.
+*/
+
+/*!
+    \fn void QCanMessageDescription::addSignalDescription(const QCanSignalDescription &description)
+
+    Appends \a description to the signals of the message.
+*/
+
+/*!
+    Returns \c true if the message has a name, a valid frame identifier and
+    a payload size of at most 64 bytes.
+*/
+bool QCanMessageDescription::isValid() const
+{
+    if (m_name.isEmpty() || m_size < 0 || m_size > 64)
+        return false;
+    return m_frameId <= (m_extendedFrameFormat ? 0x1fffffffU : 0x7ffU);
+}
+
+QT_END_NAMESPACE
@@ -0,0 +1,98 @@
+/****************************************************************************
+**
+** Copyright (C) 2021 The Qt Company Ltd.
+** Contact: http://www.qt.io/licensing/
+**
+** This file is part of the QtSerialBus module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL3$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see http://www.qt.io/terms-conditions. For further
+** information use the contact form at http://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPLv3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or later as published by the Free
+** Software Foundation and appearing in the file LICENSE.GPL included in
+** the packaging of this file. Please review the following information to
+** ensure the GNU General Public License version 2.0 requirements will be
+** met: http://www.gnu.org/licenses/gpl-2.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#ifndef QCANMESSAGEDESCRIPTION_H
+#define QCANMESSAGEDESCRIPTION_H
+
+#include <QtCore/qlist.h>
+#include <QtCore/qstring.h>
+#include <QtSerialBus/qcansignaldescription.h>
+
+QT_BEGIN_NAMESPACE
+
+class QCanMessageDescription
+{
+public:
+    QCanMessageDescription() = default;
+
+    QCanMessageDescription(quint32 frameId, const QString &name, int size)
+        : m_name(name)
+        , m_frameId(frameId)
+        , m_size(size)
+        , m_extendedFrameFormat(frameId > 0x7ff)
+    {}
+
+    quint32 frameId() const { return m_frameId; }
+    void setFrameId(quint32 frameId) { m_frameId = frameId; }
+
+    bool hasExtendedFrameFormat() const { return m_extendedFrameFormat; }
+    void setExtendedFrameFormat(bool extended) { m_extendedFrameFormat = extended; }
+
+    QString name() const { return m_name; }
+    void setName(const QString &name) { m_name = name; }
+
+    int size() const { return m_size; }
+    void setSize(int size) { m_size = size; }
+
+    QString transmitter() const { return m_transmitter; }
+    void setTransmitter(const QString &transmitter) { m_transmitter = transmitter; }
+
+    QList<QCanSignalDescription> signalDescriptions() const { return m_signals; }
+    void setSignalDescriptions(const QList<QCanSignalDescription> &descriptions)
+    {
+        m_signals = descriptions;
+    }
+    void addSignalDescription(const QCanSignalDescription &description)
+    {
+        m_signals.append(description);
+    }
+
+    Q_SERIALBUS_EXPORT bool isValid() const;
+
+private:
+    QString m_name;
+    QString m_transmitter;
+    QList<QCanSignalDescription> m_signals;
+    quint32 m_frameId = 0;
+    int m_size = 0;
+    bool m_extendedFrameFormat = false;
+};
+
+Q_DECLARE_TYPEINFO(QCanMessageDescription, Q_RELOCATABLE_TYPE);
+
+QT_END_NAMESPACE
+
+#endif // QCANMESSAGEDESCRIPTION_H
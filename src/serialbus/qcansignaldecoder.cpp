@@ -0,0 +1,596 @@
+/****************************************************************************
+**
+** Copyright (C) 2021 The Qt Company Ltd.
+** Contact: http://www.qt.io/licensing/
+**
+** This file is part of the QtSerialBus module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL3$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see http://www.qt.io/terms-conditions. For further
+** information use the contact form at http://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPLv3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or later as published by the Free
+** Software Foundation and appearing in the file LICENSE.GPL included in
+** the packaging of this file. Please review the following information to
+** ensure the GNU General Public License version 2.0 requirements will be
+** met: http://www.gnu.org/licenses/gpl-2.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include "qcansignaldecoder.h"
+#include "qcansignaldecoder_p.h"
+
+#include <QtCore/qendian.h>
+#include <QtCore/qloggingcategory.h>
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+
+QT_BEGIN_NAMESPACE
+
+Q_DECLARE_LOGGING_CATEGORY(QT_CANBUS)
+
+/*!
+    \class QCanSignalDecoder
+    \inmodule QtSerialBus
+    \since 6.1
+
+    \brief The QCanSignalDecoder class decodes the signals of CAN frames
+    with compiled message layouts.
+
+    The decoder compiles every QCanMessageDescription into a decode plan
+    when it is constructed: the payload bytes each signal spans, the shift
+    and mask that isolate its raw value, its byte order and its scaling.
+    Decoding a frame then only looks up the plan by frame identifier and
+    extracts each signal with a few integer operations, without interpreting
+    the descriptions again and without allocating memory.
+
+    Each signal of the decoder has an index. The signals of a message have
+    consecutive indexes starting at firstSignal(), in the order of
+    QCanMessageDescription::signalDescriptions().
+
+    A single frame is decoded into an array of physical values:
+
+    \code
+        QCanDbcFileParser parser;
+        if (!parser.parse(QStringLiteral("vehicle.dbc")))
+            return;
+        const QCanSignalDecoder decoder(parser.messageDescriptions());
+        const int speed = decoder.signalIndex(QStringLiteral("Wheels"), QStringLiteral("Speed"));
+        const int wheels = decoder.messageOfSignal(speed);
+        QList<double> values(decoder.signalCount(wheels));
+
+        // for every received frame
+        if (decoder.messageIndex(frame) == wheels && decoder.decode(frame, values.data()) > 0)
+            qDebug() << values.at(speed - decoder.firstSignal(wheels));
+    \endcode
+
+    For bulk processing, decode() also accepts an array of frames and
+    appends the results to a QCanSignalBatch, which stores one contiguous
+    column of values per signal. The raw values are extracted frame by frame
+    and then scaled column by column in a loop the compiler can vectorize.
+
+    Signals that are not present in a frame, because the payload is too
+    short, the description is invalid or a multiplexed signal is not
+    selected by the multiplexor switch, are decoded as NaN.
+
+    \sa QCanDbcFileParser
+*/
+
+QCanSignalPlan QCanSignalDecoderPrivate::compile(const QCanSignalDescription &description)
+{
+    QCanSignalPlan plan;
+    plan.factor = description.factor();
+    plan.offset = description.offset();
+    plan.scaled = plan.factor != 1.0 || plan.offset != 0.0;
+    plan.valueType = description.valueType();
+    plan.multiplexing = description.multiplexing();
+    plan.multiplexValue = description.multiplexValue();
+    plan.bigEndian = description.byteOrder() == QSysInfo::BigEndian;
+    plan.bitLength = description.bitLength();
+    if (!description.isValid())
+        return plan;
+
+    const int startBit = description.startBit();
+    const int length = description.bitLength();
+    plan.mask = length == 64 ? ~quint64(0) : (quint64(1) << length) - 1;
+
+    int lastByte = 0;
+    if (plan.bigEndian) {
+        // Count the bits in transmission order, the start bit is the most significant one.
+        const int msb = (startBit / 8) * 8 + (7 - startBit % 8);
+        const int lsb = msb + length - 1;
+        plan.firstByte = msb / 8;
+        lastByte = lsb / 8;
+        plan.shift = 7 - lsb % 8;
+    } else {
+        plan.firstByte = startBit / 8;
+        lastByte = (startBit + length - 1) / 8;
+        plan.shift = startBit % 8;
+    }
+    plan.byteCount = lastByte - plan.firstByte + 1;
+    plan.requiredSize = lastByte + 1;
+    return plan;
+}
+
+quint64 QCanSignalDecoderPrivate::extract(const QCanSignalPlan &plan, const uchar *payload)
+{
+    const uchar *bytes = payload + plan.firstByte;
+    uchar word[8] = {};
+    quint64 raw = 0;
+
+    if (plan.bigEndian) {
+        if (plan.byteCount > 8) {
+            std::memcpy(word, bytes + 1, 8);
+            raw = qFromBigEndian<quint64>(word) >> plan.shift
+                | quint64(bytes[0]) << (64 - plan.shift);
+        } else {
+            std::memcpy(word + 8 - plan.byteCount, bytes, size_t(plan.byteCount));
+            raw = qFromBigEndian<quint64>(word) >> plan.shift;
+        }
+    } else {
+        std::memcpy(word, bytes, size_t(qMin(plan.byteCount, 8)));
+        raw = qFromLittleEndian<quint64>(word) >> plan.shift;
+        if (plan.byteCount > 8)
+            raw |= quint64(bytes[8]) << (64 - plan.shift);
+    }
+    return raw & plan.mask;
+}
+
+double QCanSignalDecoderPrivate::toDouble(const QCanSignalPlan &plan, quint64 raw)
+{
+    switch (plan.valueType) {
+    case QCanSignalDescription::Signed:
+        if (plan.bitLength < 64 && (raw >> (plan.bitLength - 1)) & 1)
+            raw |= ~plan.mask;
+        return double(qint64(raw));
+    case QCanSignalDescription::Float: {
+        const quint32 bits = quint32(raw);
+        float value;
+        std::memcpy(&value, &bits, sizeof(value));
+        return double(value);
+    }
+    case QCanSignalDescription::Double: {
+        double value;
+        std::memcpy(&value, &raw, sizeof(value));
+        return value;
+    }
+    case QCanSignalDescription::Unsigned:
+        break;
+    }
+    return double(raw);
+}
+
+void QCanSignalDecoderPrivate::decodeRaw(const QCanMessagePlan &message, const uchar *payload,
+                                         qsizetype size, double *values) const
+{
+    bool switched = false;
+    quint64 switchValue = 0;
+    if (message.multiplexor >= 0) {
+        const QCanSignalPlan &plan = m_signals[size_t(message.multiplexor)];
+        switched = plan.requiredSize > 0 && size >= plan.requiredSize;
+        if (switched)
+            switchValue = extract(plan, payload);
+    }
+
+    const QCanSignalPlan *plans = m_signals.data() + message.firstSignal;
+    for (int i = 0; i < message.signalCount; ++i) {
+        const QCanSignalPlan &plan = plans[i];
+        const bool present = plan.requiredSize > 0 && size >= plan.requiredSize
+            && (plan.multiplexing != QCanSignalDescription::MultiplexedSignal
+                || (switched && switchValue == plan.multiplexValue));
+        values[i] = present ? toDouble(plan, extract(plan, payload))
+                            : std::numeric_limits<double>::quiet_NaN();
+    }
+}
+
+/*!
+    Constructs a decoder and compiles the decode plans of \a messages.
+
+    Invalid messages and signals are kept so the signal indexes match the
+    descriptions, but are never decoded. If several messages have the same
+    frame identifier, frames are decoded with the first one.
+*/
+QCanSignalDecoder::QCanSignalDecoder(const QList<QCanMessageDescription> &messages)
+    : d_ptr(new QCanSignalDecoderPrivate)
+{
+    Q_D(QCanSignalDecoder);
+    d->m_descriptions = messages;
+    d->m_messages.reserve(size_t(messages.size()));
+    d->m_messageIndex.reserve(messages.size());
+
+    for (int index = 0; index < messages.size(); ++index) {
+        const QCanMessageDescription &message = messages.at(index);
+        const QList<QCanSignalDescription> descriptions = message.signalDescriptions();
+
+        QCanMessagePlan plan;
+        plan.firstSignal = int(d->m_signals.size());
+        plan.signalCount = int(descriptions.size());
+        for (const QCanSignalDescription &description : descriptions) {
+            if (!description.isValid()) {
+                qCWarning(QT_CANBUS, "Signal %ls of message %ls is invalid and not decoded.",
+                          qUtf16Printable(description.name()), qUtf16Printable(message.name()));
+            }
+            if (plan.multiplexor < 0
+                    && description.multiplexing() == QCanSignalDescription::MultiplexorSwitch) {
+                plan.multiplexor = int(d->m_signals.size());
+            }
+            d->m_signals.push_back(QCanSignalDecoderPrivate::compile(description));
+            d->m_signalMessage.push_back(index);
+        }
+        d->m_messages.push_back(plan);
+        if (!d->m_messageNames.contains(message.name()))
+            d->m_messageNames.insert(message.name(), index);
+
+        if (!message.isValid()) {
+            qCWarning(QT_CANBUS, "Message %ls is invalid and not decoded.",
+                      qUtf16Printable(message.name()));
+            continue;
+        }
+        const quint32 key = QCanSignalDecoderPrivate::key(message.frameId(),
+                                                          message.hasExtendedFrameFormat());
+        if (d->m_messageIndex.contains(key)) {
+            qCWarning(QT_CANBUS, "Message %ls reuses frame identifier 0x%x and is not decoded.",
+                      qUtf16Printable(message.name()), message.frameId());
+            continue;
+        }
+        d->m_messageIndex.insert(key, index);
+    }
+}
+
+/*!
+    Destroys the decoder.
+*/
+QCanSignalDecoder::~QCanSignalDecoder() = default;
+
+/*!
+    Returns the message descriptions the decoder was constructed with.
+*/
+QList<QCanMessageDescription> QCanSignalDecoder::messageDescriptions() const
+{
+    Q_D(const QCanSignalDecoder);
+    return d->m_descriptions;
+}
+
+/*!
+    Returns the number of messages of the decoder.
+*/
+int QCanSignalDecoder::messageCount() const
+{
+    Q_D(const QCanSignalDecoder);
+    return int(d->m_messages.size());
+}
+
+/*!
+    Returns the number of signals of all messages of the decoder.
+*/
+int QCanSignalDecoder::signalCount() const
+{
+    Q_D(const QCanSignalDecoder);
+    return int(d->m_signals.size());
+}
+
+/*!
+    Returns the index of the message that describes \a frame, or \c -1 if
+    \a frame is not a data frame or no message has its frame identifier.
+*/
+int QCanSignalDecoder::messageIndex(const QCanBusFrame &frame) const
+{
+    Q_D(const QCanSignalDecoder);
+    if (frame.frameType() != QCanBusFrame::DataFrame)
+        return -1;
+    return d->m_messageIndex.value(
+        QCanSignalDecoderPrivate::key(frame.frameId(), frame.hasExtendedFrameFormat()), -1);
+}
+
+/*!
+    Returns the index of the first message named \a messageName, or \c -1 if
+    there is none.
+*/
+int QCanSignalDecoder::messageIndex(const QString &messageName) const
+{
+    Q_D(const QCanSignalDecoder);
+    return d->m_messageNames.value(messageName, -1);
+}
+
+/*!
+    Returns the index of the signal \a signalName of the message
+    \a messageName, or \c -1 if there is none.
+*/
+int QCanSignalDecoder::signalIndex(const QString &messageName, const QString &signalName) const
+{
+    Q_D(const QCanSignalDecoder);
+    const int message = messageIndex(messageName);
+    if (message < 0)
+        return -1;
+
+    const QList<QCanSignalDescription> descriptions
+        = d->m_descriptions.at(message).signalDescriptions();
+    for (int i = 0; i < descriptions.size(); ++i) {
+        if (descriptions.at(i).name() == signalName)
+            return d->m_messages[size_t(message)].firstSignal + i;
+    }
+    return -1;
+}
+
+/*!
+    Returns the index of the first signal of the message at \a messageIndex,
+    or \c -1 if the index is out of range.
+*/
+int QCanSignalDecoder::firstSignal(int messageIndex) const
+{
+    Q_D(const QCanSignalDecoder);
+    if (messageIndex < 0 || messageIndex >= messageCount())
+        return -1;
+    return d->m_messages[size_t(messageIndex)].firstSignal;
+}
+
+/*!
+    Returns the number of signals of the message at \a messageIndex.
+*/
+int QCanSignalDecoder::signalCount(int messageIndex) const
+{
+    Q_D(const QCanSignalDecoder);
+    if (messageIndex < 0 || messageIndex >= messageCount())
+        return 0;
+    return d->m_messages[size_t(messageIndex)].signalCount;
+}
+
+/*!
+    Returns the index of the message the signal at \a signalIndex belongs
+    to, or \c -1 if the index is out of range.
+*/
+int QCanSignalDecoder::messageOfSignal(int signalIndex) const
+{
+    Q_D(const QCanSignalDecoder);
+    if (signalIndex < 0 || signalIndex >= signalCount())
+        return -1;
+    return d->m_signalMessage[size_t(signalIndex)];
+}
+
+/*!
+    Decodes the signals of \a frame into \a values, which must have room for
+    the signals of the largest message. The physical value of each signal of
+    the message is written in the order of its signal descriptions.
+
+    Returns the number of values written, or \c -1 if \a frame is not
+    described by any message.
+*/
+int QCanSignalDecoder::decode(const QCanBusFrame &frame, double *values) const
+{
+    Q_D(const QCanSignalDecoder);
+    const int index = messageIndex(frame);
+    if (index < 0)
+        return -1;
+
+    const QCanMessagePlan &message = d->m_messages[size_t(index)];
+    const QByteArray payload = frame.payload();
+    d->decodeRaw(message, reinterpret_cast<const uchar *>(payload.constData()), payload.size(),
+                 values);
+
+    const QCanSignalPlan *plans = d->m_signals.data() + message.firstSignal;
+    for (int i = 0; i < message.signalCount; ++i) {
+        if (plans[i].scaled)
+            values[i] = values[i] * plans[i].factor + plans[i].offset;
+    }
+    return message.signalCount;
+}
+
+/*!
+    Decodes \a count frames starting at \a frames and appends one row per
+    decoded frame to \a batch, which must have been created for this
+    decoder. Frames that are not described by any message are skipped.
+
+    Returns the number of decoded frames. Once the batch has reserved enough
+    rows, decoding does not allocate memory.
+*/
+qsizetype QCanSignalDecoder::decode(const QCanBusFrame *frames, qsizetype count,
+                                    QCanSignalBatch *batch) const
+{
+    Q_D(const QCanSignalDecoder);
+    if (!batch || batch->d_func()->m_decoder != d) {
+        qCWarning(QT_CANBUS, "The signal batch was not created for this decoder.");
+        return 0;
+    }
+
+    QCanSignalBatchPrivate *b = batch->d_func();
+    double *row = b->m_row.data();
+    qsizetype decoded = 0;
+
+    for (qsizetype i = 0; i < count; ++i) {
+        const QCanBusFrame &frame = frames[i];
+        const int index = messageIndex(frame);
+        if (index < 0)
+            continue;
+
+        const QCanMessagePlan &message = d->m_messages[size_t(index)];
+        const QByteArray payload = frame.payload();
+        d->decodeRaw(message, reinterpret_cast<const uchar *>(payload.constData()),
+                     payload.size(), row);
+
+        std::vector<qint64> &timeStamps = b->m_timeStamps[size_t(index)];
+        if (qsizetype(timeStamps.size()) == b->m_scaledRows[size_t(index)])
+            b->m_touched.push_back(index);
+        const QCanBusFrame::TimeStamp stamp = frame.timeStamp();
+        timeStamps.push_back(stamp.seconds() * 1000000 + stamp.microSeconds());
+
+        for (int s = 0; s < message.signalCount; ++s)
+            b->m_columns[size_t(message.firstSignal + s)].push_back(row[s]);
+        ++decoded;
+    }
+
+    // Scale the new rows column by column.
+    for (const int index : b->m_touched) {
+        const QCanMessagePlan &message = d->m_messages[size_t(index)];
+        const qsizetype first = b->m_scaledRows[size_t(index)];
+        const qsizetype rows = qsizetype(b->m_timeStamps[size_t(index)].size());
+        for (int s = message.firstSignal; s < message.firstSignal + message.signalCount; ++s) {
+            const QCanSignalPlan &plan = d->m_signals[size_t(s)];
+            if (!plan.scaled)
+                continue;
+            double *values = b->m_columns[size_t(s)].data();
+            const double factor = plan.factor;
+            const double offset = plan.offset;
+            for (qsizetype r = first; r < rows; ++r)
+                values[r] = values[r] * factor + offset;
+        }
+        b->m_scaledRows[size_t(index)] = rows;
+    }
+    b->m_touched.clear();
+    return decoded;
+}
+
+/*!
+    \fn qsizetype QCanSignalDecoder::decode(const QList<QCanBusFrame> &frames, QCanSignalBatch *batch) const
+    \overload
+
+    Decodes \a frames and appends one row per decoded frame to \a batch.
+*/
+
+/*!
+    \class QCanSignalBatch
+    \inmodule QtSerialBus
+    \since 6.1
+
+    \brief The QCanSignalBatch class stores decoded signal values in columns.
+
+    A batch holds one contiguous array of physical values per signal of a
+    QCanSignalDecoder, and one array of time stamps per message. Every frame
+    decoded into the batch adds one row to the arrays of its message, so
+    all columns of a message have rowCount() entries and row \c n of each
+    column belongs to the same frame.
+
+    The columns keep their capacity when the batch is cleared. Reserving the
+    expected number of rows up front therefore makes repeated decoding free
+    of memory allocations.
+
+    \code
+        QCanSignalBatch batch(decoder, 1024);
+        decoder.decode(device->readAllFrames(), &batch);
+
+        const int rpm = decoder.signalIndex(QStringLiteral("Engine"), QStringLiteral("Rpm"));
+        const qsizetype rows = batch.rowCount(decoder.messageOfSignal(rpm));
+        const double *values = batch.column(rpm);
+        const double peak = rows ? *std::max_element(values, values + rows) : 0.0;
+    \endcode
+*/
+
+/*!
+    Constructs an empty batch for the signals of \a decoder, with room for
+    \a reservedRows rows per message.
+*/
+QCanSignalBatch::QCanSignalBatch(const QCanSignalDecoder &decoder, qsizetype reservedRows)
+    : d_ptr(new QCanSignalBatchPrivate)
+{
+    Q_D(QCanSignalBatch);
+    const QCanSignalDecoderPrivate *decoderPrivate = decoder.d_func();
+    d->m_decoder = decoderPrivate;
+    d->m_columns.resize(decoderPrivate->m_signals.size());
+    d->m_timeStamps.resize(decoderPrivate->m_messages.size());
+    d->m_scaledRows.assign(decoderPrivate->m_messages.size(), 0);
+    d->m_touched.reserve(decoderPrivate->m_messages.size());
+
+    int widest = 0;
+    for (const QCanMessagePlan &message : decoderPrivate->m_messages)
+        widest = qMax(widest, message.signalCount);
+    d->m_row.resize(size_t(widest));
+
+    reserve(reservedRows);
+}
+
+/*!
+    Destroys the batch.
+*/
+QCanSignalBatch::~QCanSignalBatch() = default;
+
+/*!
+    Reserves room for \a rows rows per message.
+*/
+void QCanSignalBatch::reserve(qsizetype rows)
+{
+    Q_D(QCanSignalBatch);
+    if (rows <= 0)
+        return;
+    for (std::vector<double> &column : d->m_columns)
+        column.reserve(size_t(rows));
+    for (std::vector<qint64> &timeStamps : d->m_timeStamps)
+        timeStamps.reserve(size_t(rows));
+}
+
+/*!
+    Removes all rows and keeps the reserved memory.
+*/
+void QCanSignalBatch::clear()
+{
+    Q_D(QCanSignalBatch);
+    for (std::vector<double> &column : d->m_columns)
+        column.clear();
+    for (std::vector<qint64> &timeStamps : d->m_timeStamps)
+        timeStamps.clear();
+    std::fill(d->m_scaledRows.begin(), d->m_scaledRows.end(), 0);
+}
+
+/*!
+    Returns the number of decoded frames of the message at \a messageIndex.
+*/
+qsizetype QCanSignalBatch::rowCount(int messageIndex) const
+{
+    Q_D(const QCanSignalBatch);
+    if (messageIndex < 0 || size_t(messageIndex) >= d->m_timeStamps.size())
+        return 0;
+    return qsizetype(d->m_timeStamps[size_t(messageIndex)].size());
+}
+
+/*!
+    Returns the time stamps in microseconds of the decoded frames of the
+    message at \a messageIndex. The array has rowCount() entries.
+*/
+const qint64 *QCanSignalBatch::timeStamps(int messageIndex) const
+{
+    Q_D(const QCanSignalBatch);
+    if (messageIndex < 0 || size_t(messageIndex) >= d->m_timeStamps.size())
+        return nullptr;
+    return d->m_timeStamps[size_t(messageIndex)].data();
+}
+
+/*!
+    Returns the physical values of the signal at \a signalIndex. The array
+    has as many entries as the message of the signal has rows, signals that
+    were not present in a frame are NaN.
+
+    \sa QCanSignalDecoder::messageOfSignal()
+*/
+const double *QCanSignalBatch::column(int signalIndex) const
+{
+    Q_D(const QCanSignalBatch);
+    if (signalIndex < 0 || size_t(signalIndex) >= d->m_columns.size())
+        return nullptr;
+    return d->m_columns[size_t(signalIndex)].data();
+}
+
+/*!
+    \fn double QCanSignalBatch::value(int signalIndex, qsizetype row) const
+
+    Returns the physical value of the signal at \a signalIndex in \a row.
+    Both must be in range.
+*/
+
+QT_END_NAMESPACE
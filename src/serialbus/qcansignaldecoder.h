@@ -0,0 +1,107 @@
+/****************************************************************************
+**
+** Copyright (C) 2021 The Qt Company Ltd.
+** Contact: http://www.qt.io/licensing/
+**
+** This file is part of the QtSerialBus module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL3$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see http://www.qt.io/terms-conditions. For further
+** information use the contact form at http://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPLv3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or later as published by the Free
+** Software Foundation and appearing in the file LICENSE.GPL included in
+** the packaging of this file. Please review the following information to
+** ensure the GNU General Public License version 2.0 requirements will be
+** met: http://www.gnu.org/licenses/gpl-2.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#ifndef QCANSIGNALDECODER_H
+#define QCANSIGNALDECODER_H
+
+#include <QtCore/qlist.h>
+#include <QtCore/qscopedpointer.h>
+#include <QtSerialBus/qcanbusframe.h>
+#include <QtSerialBus/qcanmessagedescription.h>
+
+QT_BEGIN_NAMESPACE
+
+class QCanSignalBatch;
+class QCanSignalBatchPrivate;
+class QCanSignalDecoderPrivate;
+
+class Q_SERIALBUS_EXPORT QCanSignalDecoder
+{
+    Q_DECLARE_PRIVATE(QCanSignalDecoder)
+
+public:
+    explicit QCanSignalDecoder(const QList<QCanMessageDescription> &messages);
+    ~QCanSignalDecoder();
+
+    QList<QCanMessageDescription> messageDescriptions() const;
+    int messageCount() const;
+    int signalCount() const;
+
+    int messageIndex(const QCanBusFrame &frame) const;
+    int messageIndex(const QString &messageName) const;
+    int signalIndex(const QString &messageName, const QString &signalName) const;
+    int firstSignal(int messageIndex) const;
+    int signalCount(int messageIndex) const;
+    int messageOfSignal(int signalIndex) const;
+
+    int decode(const QCanBusFrame &frame, double *values) const;
+    qsizetype decode(const QCanBusFrame *frames, qsizetype count, QCanSignalBatch *batch) const;
+    qsizetype decode(const QList<QCanBusFrame> &frames, QCanSignalBatch *batch) const
+    {
+        return decode(frames.constData(), frames.size(), batch);
+    }
+
+private:
+    friend class QCanSignalBatch;
+    Q_DISABLE_COPY(QCanSignalDecoder)
+    QScopedPointer<QCanSignalDecoderPrivate> d_ptr;
+};
+
+class Q_SERIALBUS_EXPORT QCanSignalBatch
+{
+    Q_DECLARE_PRIVATE(QCanSignalBatch)
+
+public:
+    explicit QCanSignalBatch(const QCanSignalDecoder &decoder, qsizetype reservedRows = 0);
+    ~QCanSignalBatch();
+
+    void reserve(qsizetype rows);
+    void clear();
+
+    qsizetype rowCount(int messageIndex) const;
+    const qint64 *timeStamps(int messageIndex) const;
+    const double *column(int signalIndex) const;
+    double value(int signalIndex, qsizetype row) const { return column(signalIndex)[row]; }
+
+private:
+    friend class QCanSignalDecoder;
+    Q_DISABLE_COPY(QCanSignalBatch)
+    QScopedPointer<QCanSignalBatchPrivate> d_ptr;
+};
+
+QT_END_NAMESPACE
+
+#endif // QCANSIGNALDECODER_H
@@ -0,0 +1,125 @@
+/****************************************************************************
+**
+** Copyright (C) 2021 The Qt Company Ltd.
+** Contact: http://www.qt.io/licensing/
+**
+** This file is part of the QtSerialBus module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL3$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see http://www.qt.io/terms-conditions. For further
+** information use the contact form at http://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPLv3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or later as published by the Free
+** Software Foundation and appearing in the file LICENSE.GPL included in
+** the packaging of this file. Please review the following information to
+** ensure the GNU General Public License version 2.0 requirements will be
+** met: http://www.gnu.org/licenses/gpl-2.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#ifndef QCANSIGNALDECODER_P_H
+#define QCANSIGNALDECODER_P_H
+
+#include <QtCore/qhash.h>
+#include <QtSerialBus/qcansignaldecoder.h>
+
+#include <vector>
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API. It exists purely as an
+// implementation detail. This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+//
+
+QT_BEGIN_NAMESPACE
+
+/*
+    The decode plan of one signal. The bytes the signal spans are loaded into a 64 bit word
+    in the signal's byte order, the raw value is then one shift and one mask away. A signal
+    of 64 bits that does not start on a byte boundary spans nine bytes; the ninth byte is
+    merged in separately.
+*/
+struct QCanSignalPlan
+{
+    quint64 mask = 0;
+    double factor = 1.0;
+    double offset = 0.0;
+    quint64 multiplexValue = 0;
+    int firstByte = 0;
+    int byteCount = 0;
+    int requiredSize = 0;   // payload bytes needed, 0 if the signal is invalid
+    int shift = 0;
+    int bitLength = 0;
+    QCanSignalDescription::ValueType valueType = QCanSignalDescription::Unsigned;
+    QCanSignalDescription::Multiplexing multiplexing = QCanSignalDescription::NotMultiplexed;
+    bool bigEndian = false;
+    bool scaled = false;    // factor or offset change the raw value
+};
+
+struct QCanMessagePlan
+{
+    int firstSignal = 0;
+    int signalCount = 0;
+    int multiplexor = -1;   // index of the switch signal in the decoder, or -1
+};
+
+class QCanSignalDecoderPrivate
+{
+public:
+    static quint32 key(quint32 frameId, bool extended)
+    {
+        return frameId | (extended ? 0x80000000U : 0U);
+    }
+
+    static QCanSignalPlan compile(const QCanSignalDescription &description);
+    static quint64 extract(const QCanSignalPlan &plan, const uchar *payload);
+    static double toDouble(const QCanSignalPlan &plan, quint64 raw);
+
+    // Decodes the raw values of a message into values, NaN for signals not in the frame.
+    void decodeRaw(const QCanMessagePlan &message, const uchar *payload, qsizetype size,
+                   double *values) const;
+
+    QList<QCanMessageDescription> m_descriptions;
+    QHash<quint32, int> m_messageIndex;
+    QHash<QString, int> m_messageNames;
+    std::vector<QCanMessagePlan> m_messages;
+    std::vector<QCanSignalPlan> m_signals;
+    std::vector<int> m_signalMessage;
+};
+
+class QCanSignalBatchPrivate
+{
+public:
+    std::vector<std::vector<double>> m_columns;     // one per signal
+    std::vector<std::vector<qint64>> m_timeStamps;  // one per message
+    std::vector<qsizetype> m_scaledRows;            // rows of each message already scaled
+    std::vector<int> m_touched;                     // messages with rows to scale
+    std::vector<double> m_row;                      // scratch row of the widest message
+    const QCanSignalDecoderPrivate *m_decoder = nullptr;
+};
+
+QT_END_NAMESPACE
+
+#endif // QCANSIGNALDECODER_P_H
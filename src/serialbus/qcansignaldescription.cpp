@@ -0,0 +1,262 @@
+/****************************************************************************
+**
+** Copyright (C) 2021 The Qt Company Ltd.
+** Contact: http://www.qt.io/licensing/
+**
+** This file is part of the QtSerialBus module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL3$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see http://www.qt.io/terms-conditions. For further
+** information use the contact form at http://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPLv3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or later as published by the Free
+** Software Foundation and appearing in the file LICENSE.GPL included in
+** the packaging of this file. Please review the following information to
+** ensure the GNU General Public License version 2.0 requirements will be
+** met: http://www.gnu.org/licenses/gpl-2.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include "qcansignaldescription.h"
+
+QT_BEGIN_NAMESPACE
+
+/*!
+    \class QCanSignalDescription
+    \inmodule QtSerialBus
+    \since 6.1
+
+    \brief The QCanSignalDescription class describes how a signal is encoded
+    in the payload of a CAN frame.
+
+    A signal occupies bitLength() bits of the payload, starting at
+    startBit(). Its raw value is converted to the physical value with
+    \c {raw * factor() + offset()}.
+
+    The bit numbering follows the DBC file format: bit \c n is bit \c {n % 8}
+    of payload byte \c {n / 8}. For little endian (Intel) signals startBit()
+    is the least significant bit of the value, for big endian (Motorola)
+    signals it is the most significant bit.
+
+    \sa QCanMessageDescription, QCanSignalDecoder
+*/
+
+/*!
+    \enum QCanSignalDescription::ValueType
+
+    This enum describes how the raw bits of a signal are interpreted.
+
+    \value Unsigned     An unsigned integer.
+    \value Signed       A two's complement signed integer.
+    \value Float        An IEEE 754 single precision value, the bit length is 32.
+    \value Double       An IEEE 754 double precision value, the bit length is 64.
+*/
+
+/*!
+    \enum QCanSignalDescription::Multiplexing
+
+    This enum describes the role of a signal in a multiplexed message.
+
+    \value NotMultiplexed       The signal is present in every frame.
+    \value MultiplexorSwitch    The raw value of the signal selects which
+                                multiplexed signals are present.
+    \value MultiplexedSignal    The signal is only present if the raw value of
+                                the multiplexor switch equals multiplexValue().
+*/
+
+/*!
+    \fn QCanSignalDescription::QCanSignalDescription()
+
+    Constructs an invalid signal description.
+*/
+
+/*!
+    \fn QCanSignalDescription::QCanSignalDescription(const QString &name, int startBit, int bitLength, QSysInfo::Endian byteOrder, ValueType valueType)
+
+    Constructs a description of the signal \a name with \a bitLength bits
+    starting at \a startBit, encoded in \a byteOrder as \a valueType.
+*/
+
+/*!
+    \fn QString QCanSignalDescription::name() const
+
+    Returns the name of the signal.
+*/
+
+/*!
+    \fn void QCanSignalDescription::setName(const QString &name)
+
+    Sets the name of the signal to \a name.
+*/
+
+/*!
+    \fn QString QCanSignalDescription::unit() const
+
+    Returns the unit of the physical value.
+*/
+
+/*!
+    \fn void QCanSignalDescription::setUnit(const QString &unit)
+
+    Sets the unit of the physical value to \a unit.
+*/
+
+/*!
+    \fn int QCanSignalDescription::startBit() const
+
+    Returns the position of the first bit of the signal in DBC numbering.
+*/
+
+/*!
+    \fn void QCanSignalDescription::setStartBit(int bit)
+
+    Sets the position of the first bit of the signal to \a bit.
+*/
+
+/*!
+    \fn int QCanSignalDescription::bitLength() const
+
+    Returns the number of bits of the signal.
+*/
+
+/*!
+    \fn void QCanSignalDescription::setBitLength(int length)
+
+    Sets the number of bits of the signal to \a length.
+*/
+
+/*!
+    \fn QSysInfo::Endian QCanSignalDescription::byteOrder() const
+
+    Returns the byte order of the signal.
+*/
+
+/*!
+    \fn void QCanSignalDescription::setByteOrder(QSysInfo::Endian order)
+
+    Sets the byte order of the signal to \a order.
+*/
+
+/*!
+    \fn QCanSignalDescription::ValueType QCanSignalDescription::valueType() const
+
+    Returns how the raw bits of the signal are interpreted.
+*/
+
+/*!
+    \fn void QCanSignalDescription::setValueType(ValueType type)
+
+    Sets how the raw bits of the signal are interpreted to \a type.
+*/
+
+/*!
+    \fn double QCanSignalDescription::factor() const
+
+    Returns the factor the raw value is multiplied with.
+*/
+
+/*!
+    \fn void QCanSignalDescription::setFactor(double factor)
+
+    Sets the factor the raw value is multiplied with to \a factor.
+*/
+
+/*!
+    \fn double QCanSignalDescription::offset() const
+
+    Returns the offset added to the scaled raw value.
+*/
+
+/*!
+    \fn void QCanSignalDescription::setOffset(double offset)
+
+    Sets the offset added to the scaled raw value to \a offset.
+*/
+
+/*!
+    \fn double QCanSignalDescription::minimum() const
+
+    Returns the smallest physical value of the signal.
+*/
+
+/*!
+    \fn double QCanSignalDescription::maximum() const
+
+    Returns the largest physical value of the signal.
+*/
+
+/*!
+    \fn void QCanSignalDescription::setRange(double minimum, double maximum)
+
+    Sets the range of the physical value to \a minimum and \a maximum. The
+    range is informational only, decoded values are not clamped.
+*/
+
+/*!
+    \fn QCanSignalDescription::Multiplexing QCanSignalDescription::multiplexing() const
+
+    Returns the role of the signal in a multiplexed message.
+*/
+
+/*!
+    \fn void QCanSignalDescription::setMultiplexing(Multiplexing multiplexing)
+
+    Sets the role of the signal in a multiplexed message to \a multiplexing.
+*/
+
+/*!
+    \fn quint64 QCanSignalDescription::multiplexValue() const
+
+    Returns the raw value of the multiplexor switch for which a
+    \l MultiplexedSignal is present.
+*/
+
+/*!
+    \fn void QCanSignalDescription::setMultiplexValue(quint64 value)
+
+    Sets the raw value of the multiplexor switch for which a
+    \l MultiplexedSignal is present to \a value.
+*/
+
+/*!
+    Returns \c true if the signal has a name and fits into a CAN FD payload
+    of 64 bytes, and its bit length is between 1 and 64 bits, exactly 32 bits
+    for \l Float and exactly 64 bits for \l Double signals.
+*/
+bool QCanSignalDescription::isValid() const
+{
+    if (m_name.isEmpty() || m_bitLength < 1 || m_bitLength > 64)
+        return false;
+    if (m_valueType == Float && m_bitLength != 32)
+        return false;
+    if (m_valueType == Double && m_bitLength != 64)
+        return false;
+    if (m_startBit < 0 || m_startBit >= 512)
+        return false;
+
+    if (m_byteOrder == QSysInfo::LittleEndian)
+        return m_startBit + m_bitLength <= 512;
+
+    // The most significant bit is given, the value continues towards higher bytes.
+    const int msb = (m_startBit / 8) * 8 + (7 - m_startBit % 8);
+    return msb + m_bitLength <= 512;
+}
+
+QT_END_NAMESPACE
@@ -0,0 +1,133 @@
+/****************************************************************************
+**
+** Copyright (C) 2021 The Qt Company Ltd.
+** Contact: http://www.qt.io/licensing/
+**
+** This file is part of the QtSerialBus module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL3$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see http://www.qt.io/terms-conditions. For further
+** information use the contact form at http://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPLv3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or later as published by the Free
+** Software Foundation and appearing in the file LICENSE.GPL included in
+** the packaging of this file. Please review the following information to
+** ensure the GNU General Public License version 2.0 requirements will be
+** met: http://www.gnu.org/licenses/gpl-2.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#ifndef QCANSIGNALDESCRIPTION_H
+#define QCANSIGNALDESCRIPTION_H
+
+#include <QtCore/qstring.h>
+#include <QtCore/qsysinfo.h>
+#include <QtSerialBus/qtserialbusglobal.h>
+
+QT_BEGIN_NAMESPACE
+
+class QCanSignalDescription
+{
+public:
+    enum ValueType {
+        Unsigned,
+        Signed,
+        Float,
+        Double
+    };
+
+    enum Multiplexing {
+        NotMultiplexed,
+        MultiplexorSwitch,
+        MultiplexedSignal
+    };
+
+    QCanSignalDescription() = default;
+
+    QCanSignalDescription(const QString &name, int startBit, int bitLength,
+                          QSysInfo::Endian byteOrder = QSysInfo::LittleEndian,
+                          ValueType valueType = Unsigned)
+        : m_name(name)
+        , m_startBit(startBit)
+        , m_bitLength(bitLength)
+        , m_byteOrder(byteOrder)
+        , m_valueType(valueType)
+    {}
+
+    QString name() const { return m_name; }
+    void setName(const QString &name) { m_name = name; }
+
+    QString unit() const { return m_unit; }
+    void setUnit(const QString &unit) { m_unit = unit; }
+
+    int startBit() const { return m_startBit; }
+    void setStartBit(int bit) { m_startBit = bit; }
+
+    int bitLength() const { return m_bitLength; }
+    void setBitLength(int length) { m_bitLength = length; }
+
+    QSysInfo::Endian byteOrder() const { return m_byteOrder; }
+    void setByteOrder(QSysInfo::Endian order) { m_byteOrder = order; }
+
+    ValueType valueType() const { return m_valueType; }
+    void setValueType(ValueType type) { m_valueType = type; }
+
+    double factor() const { return m_factor; }
+    void setFactor(double factor) { m_factor = factor; }
+
+    double offset() const { return m_offset; }
+    void setOffset(double offset) { m_offset = offset; }
+
+    double minimum() const { return m_minimum; }
+    double maximum() const { return m_maximum; }
+    void setRange(double minimum, double maximum)
+    {
+        m_minimum = minimum;
+        m_maximum = maximum;
+    }
+
+    Multiplexing multiplexing() const { return m_multiplexing; }
+    void setMultiplexing(Multiplexing multiplexing) { m_multiplexing = multiplexing; }
+
+    quint64 multiplexValue() const { return m_multiplexValue; }
+    void setMultiplexValue(quint64 value) { m_multiplexValue = value; }
+
+    Q_SERIALBUS_EXPORT bool isValid() const;
+
+private:
+    QString m_name;
+    QString m_unit;
+    int m_startBit = 0;
+    int m_bitLength = 0;
+    QSysInfo::Endian m_byteOrder = QSysInfo::LittleEndian;
+    ValueType m_valueType = Unsigned;
+    double m_factor = 1.0;
+    double m_offset = 0.0;
+    double m_minimum = 0.0;
+    double m_maximum = 0.0;
+    Multiplexing m_multiplexing = NotMultiplexed;
+    quint64 m_multiplexValue = 0;
+};
+
+Q_DECLARE_TYPEINFO(QCanSignalDescription, Q_RELOCATABLE_TYPE);
+
+QT_END_NAMESPACE
+
+#endif // QCANSIGNALDESCRIPTION_H
@@ -39,6 +39,8 @@
 
 #include <QtSerialBus/qmodbuspdu.h>
 
+#include <array>
+
 //
 //  W A R N I N G
 //  -------------
@@ -63,8 +65,15 @@ public:
     inline QModbusSerialAdu(Type type, const QByteArray &data)
         : m_type(type), m_data(data), m_rawData(data)
     {
-        if (m_type == Ascii)
-            m_data = QByteArray::fromHex(m_data.mid(1, m_data.size() - 3));
+        if (m_type == Ascii) {
+            // Skip the leading colon and the trailing CR LF pair.
+            const int pairs = qMax(0, (data.size() - 3) / 2);
+            m_data = QByteArray(pairs, Qt::Uninitialized);
+            const char *in = data.constData() + 1;
+            char *out = m_data.data();
+            for (int i = 0; i < pairs; ++i, in += 2)
+                out[i] = char(qMax(0, hexValue(in[0])) << 4 | qMax(0, hexValue(in[1])));
+        }
     }
 
     inline int size() const {
@@ -121,63 +130,132 @@ public:
         \internal
         \fn quint16 QModbusSerialAdu::calculateCRC(const char *data, qint32 len) const
 
-        Returns the CRC checksum of the first \a len bytes of \a data.
-
-        \note The code used by the function was generated with pycrc. There is no copyright assigned
-        to the generated code, however, the author of the script requests to show the line stating
-        that the code was generated by pycrc (see implementation).
+        Returns the CRC checksum of the first \a len bytes of \a data. The bytes of the
+        checksum are swapped, so it compares equal to \l checksum().
     */
     inline static quint16 calculateCRC(const char *data, qint32 len)
     {
-        // Generated by pycrc v0.8.3, https://pycrc.org
-        // Width = 16, Poly = 0x8005, XorIn = 0xffff, ReflectIn = True,
-        // XorOut = 0x0000, ReflectOut = True, Algorithm = bit-by-bit-fast
-
-        quint16 crc = 0xFFFF;
-        while (len--) {
-            const quint8 c = *data++;
-            for (qint32 i = 0x01; i & 0xFF; i <<= 1) {
-                bool bit = crc & 0x8000;
-                if (c & i)
-                    bit = !bit;
-                crc <<= 1;
-                if (bit)
-                    crc ^= 0x8005;
-            }
-            crc &= 0xFFFF;
-        }
-        crc = crc_reflect(crc & 0xFFFF, 16) ^ 0x0000;
+        const quint16 crc = updateCRC(0xffff, data, len);
         return (crc >> 8) | (crc << 8); // swap bytes
     }
 
+    /*!
+        \internal
+        \fn quint16 QModbusSerialAdu::updateCRC(quint16 crc, const char *data, qint32 len)
+
+        Continues the CRC-16/MODBUS computation \a crc over the first \a len bytes of \a data
+        and returns the updated, not byte swapped, value. A computation starts from \c 0xffff.
+        Running it over a complete RTU frame, including the transmitted checksum, yields \c 0
+        for an intact frame.
+    */
+    inline static quint16 updateCRC(quint16 crc, const char *data, qint32 len)
+    {
+        const auto &table = crcTable();
+        while (len--)
+            crc = (crc >> 8) ^ table[(crc ^ quint8(*data++)) & 0xff];
+        return crc;
+    }
+
     inline static QByteArray create(Type type, int serverAddress, const QModbusPdu &pdu,
                                     char delimiter = '\n') {
-        QByteArray result;
-        QDataStream out(&result, QIODevice::WriteOnly);
-        out << quint8(serverAddress) << pdu;
+        const QByteArray data = pdu.data();
+        const quint8 code = quint8(pdu.functionCode())
+            | (pdu.isException() ? quint8(QModbusPdu::ExceptionByte) : quint8(0));
 
         if (type == Ascii) {
-            out << calculateLRC(result, result.size());
-            return ":" + result.toHex() + "\r" + delimiter;
-        } else {
-            out << calculateCRC(result, result.size());
+            // colon + hex encoded server address, function code, data and LRC + CR + delimiter
+            QByteArray result(1 + 2 * (2 + data.size() + 1) + 2, Qt::Uninitialized);
+            char *out = result.data();
+            quint8 lrc = 0;
+            const auto put = [&out](quint8 byte) {
+                *out++ = hexDigit(byte >> 4);
+                *out++ = hexDigit(byte & 0x0f);
+            };
+
+            *out++ = ':';
+            put(quint8(serverAddress));
+            put(code);
+            lrc = quint8(serverAddress) + code;
+            for (const char byte : data) {
+                put(quint8(byte));
+                lrc += quint8(byte);
+            }
+            put(quint8(-lrc));
+            *out++ = '\r';
+            *out++ = delimiter;
+            return result;
         }
+
+        QByteArray result(2 + data.size() + 2, Qt::Uninitialized);
+        char *out = result.data();
+        out[0] = char(serverAddress);
+        out[1] = char(code);
+        memcpy(out + 2, data.constData(), size_t(data.size()));
+        const quint16 crc = calculateCRC(out, 2 + data.size());
+        out[2 + data.size()] = char(crc >> 8);
+        out[3 + data.size()] = char(crc & 0xff);
         return result;
     }
 
-private:
-    inline static quint16 crc_reflect(quint16 data, qint32 len)
+    /*!
+        \internal
+        \fn char QModbusSerialAdu::hexDigit(quint8 nibble)
+
+        Returns the ASCII hex digit for the lower four bits of \a nibble.
+    */
+    inline static char hexDigit(quint8 nibble)
     {
-        // Generated by pycrc v0.8.3, https://pycrc.org
-        // Width = 16, Poly = 0x8005, XorIn = 0xffff, ReflectIn = True,
-        // XorOut = 0x0000, ReflectOut = True, Algorithm = bit-by-bit-fast
+        return "0123456789abcdef"[nibble & 0x0f];
+    }
+
+    /*!
+        \internal
+        \fn int QModbusSerialAdu::hexValue(char digit)
 
-        quint16 ret = data & 0x01;
-        for (qint32 i = 1; i < len; i++) {
-            data >>= 1;
-            ret = (ret << 1) | (data & 0x01);
+        Returns the value of the ASCII hex \a digit, in either case, or \c -1 if \a digit is
+        not a hex digit.
+    */
+    inline static int hexValue(char digit)
+    {
+        return hexTable()[quint8(digit)];
+    }
+
+private:
+    static constexpr std::array<quint16, 256> makeCrcTable()
+    {
+        // Width = 16, Poly = 0x8005 (reflected 0xa001), ReflectIn = True, ReflectOut = True
+        std::array<quint16, 256> table {};
+        for (int i = 0; i < 256; ++i) {
+            quint16 crc = quint16(i);
+            for (int bit = 0; bit < 8; ++bit)
+                crc = (crc & 0x0001) ? quint16((crc >> 1) ^ 0xa001) : quint16(crc >> 1);
+            table[i] = crc;
         }
-        return ret;
+        return table;
+    }
+
+    inline static const std::array<quint16, 256> &crcTable()
+    {
+        static constexpr std::array<quint16, 256> table = makeCrcTable();
+        return table;
+    }
+
+    static constexpr std::array<qint8, 256> makeHexTable()
+    {
+        std::array<qint8, 256> table {};
+        for (int i = 0; i < 256; ++i)
+            table[i] = -1;
+        for (int i = 0; i < 10; ++i)
+            table['0' + i] = qint8(i);
+        for (int i = 0; i < 6; ++i)
+            table['a' + i] = table['A' + i] = qint8(10 + i);
+        return table;
+    }
+
+    inline static const std::array<qint8, 256> &hexTable()
+    {
+        static constexpr std::array<qint8, 256> table = makeHexTable();
+        return table;
     }
 
 private:
@@ -186,6 +264,296 @@ private:
     QByteArray m_rawData;
 };
 
+/*!
+    \internal
+
+    Assembles one RTU frame from the chunks read off the serial line. Every byte is copied and
+    checksummed once. The expected frame size is derived through \c Pdu::calculateDataSize() as
+    soon as the leading bytes are known, and verified again on the complete frame.
+
+    \c Pdu is either QModbusRequest or QModbusResponse, depending on which side of the line the
+    frames are assembled.
+*/
+template <typename Pdu>
+class QModbusRtuFrameAssembler
+{
+public:
+    enum State {
+        Incomplete,
+        Complete,
+        Overrun
+    };
+
+    // Server address + 253 bytes PDU + 2 bytes CRC, see MODBUS over Serial Line, chapter 2.5.1.
+    static constexpr qsizetype MaxFrameSize = 256;
+
+    QModbusRtuFrameAssembler() { m_frame.reserve(MaxFrameSize); }
+
+    void reset()
+    {
+        m_frame.resize(0);
+        m_received = 0;
+        m_expected = -1;
+        m_crc = 0xffff;
+        m_state = Incomplete;
+    }
+
+    // Consumes bytes up to the end of the current frame and returns how many were consumed, the
+    // remaining ones belong to the next frame. Once the frame overran, all bytes are consumed and
+    // dropped until reset() is called.
+    qsizetype append(const char *data, qsizetype size)
+    {
+        if (m_state == Complete)
+            return 0;
+        if (m_state == Overrun) {
+            m_received += size;
+            return size;
+        }
+
+        const qsizetype start = m_frame.size();
+        m_frame.append(data, size);
+        const qsizetype end = m_frame.size();
+
+        if (m_expected < 0 && end >= 2) {
+            // The bytes after the function code may already include the checksum, but the size
+            // calculation only looks at the leading ones.
+            const int dataSize = calculateDataSize(end);
+            if (dataSize >= 0)
+                m_expected = 2 + dataSize + 2;
+        }
+
+        while (m_expected >= 0 && end >= m_expected) {
+            // Verify on the exact frame, some sizes are only known once more data is present.
+            const int dataSize = calculateDataSize(m_expected - 2);
+            if (dataSize >= 0 && 2 + dataSize + 2 > m_expected) {
+                m_expected = 2 + dataSize + 2;
+                continue;
+            }
+            m_state = (dataSize >= 0 && 2 + dataSize + 2 == m_expected) ? Complete : Overrun;
+            break;
+        }
+
+        if (m_state == Incomplete && m_expected < 0 && end > MaxFrameSize)
+            m_state = Overrun;
+
+        qsizetype consumed = size;
+        if (m_state == Complete) {
+            consumed = m_expected - start;
+            m_frame.resize(m_expected);
+            m_crc = QModbusSerialAdu::updateCRC(m_crc, m_frame.constData() + start, consumed);
+        } else if (m_state == Incomplete) {
+            m_crc = QModbusSerialAdu::updateCRC(m_crc, m_frame.constData() + start, consumed);
+        }
+        m_received += consumed;
+        return consumed;
+    }
+
+    void setOverrun() { m_state = Overrun; }
+
+    // Sizes frames that echo the request, such as Diagnostics Return Query Data. Applies to frames
+    // from the server address with the request's function code and two leading data bytes (the
+    // sub-function code). Pass an invalid request to disable.
+    void setEcho(int serverAddress, const QModbusRequest &request)
+    {
+        m_echoServerAddress = serverAddress;
+        m_echo = request;
+    }
+
+    State state() const { return m_state; }
+    qsizetype size() const { return m_received; }
+    const QByteArray &rawData() const { return m_frame; }
+
+    int serverAddress() const
+    {
+        Q_ASSERT_X(!m_frame.isEmpty(), "QModbusRtuFrameAssembler::serverAddress()", "Empty ADU.");
+        return quint8(m_frame.at(0));
+    }
+
+    Pdu pdu() const
+    {
+        Q_ASSERT_X(m_state == Complete, "QModbusRtuFrameAssembler::pdu()", "Incomplete ADU.");
+        return Pdu(QModbusPdu::FunctionCode(quint8(m_frame.at(1))),
+                   QByteArray(m_frame.constData() + 2, m_frame.size() - 4));
+    }
+
+    // The transmitted checksum, bytes in the order of QModbusSerialAdu::calculateCRC().
+    quint16 checksum() const
+    {
+        Q_ASSERT_X(m_state == Complete, "QModbusRtuFrameAssembler::checksum()", "Incomplete ADU.");
+        const qsizetype size = m_frame.size();
+        return quint16(quint8(m_frame[size - 2]) << 8 | quint8(m_frame[size - 1]));
+    }
+
+    quint16 calculatedChecksum() const
+    {
+        return QModbusSerialAdu::calculateCRC(m_frame.constData(), m_frame.size() - 2);
+    }
+
+    // The CRC over a frame including its own checksum is zero.
+    bool matchingChecksum() const { return m_state == Complete && m_crc == 0; }
+
+private:
+    // Returns the PDU data size, calculated from the bytes between the function code and end.
+    int calculateDataSize(qsizetype end) const
+    {
+        if (end < 2)
+            return -1;
+
+        const char *frame = m_frame.constData();
+        const auto code = QModbusPdu::FunctionCode(quint8(frame[1]));
+        const QByteArray data = QByteArray::fromRawData(frame + 2, end - 2);
+
+        if (m_echo.isValid() && code == m_echo.functionCode()
+                && quint8(frame[0]) == m_echoServerAddress
+                && data.size() >= 2 && m_echo.dataSize() >= 2
+                && memcmp(data.constData(), m_echo.data().constData(), 2) == 0) {
+            return m_echo.dataSize();
+        }
+        return Pdu::calculateDataSize(Pdu(code, data));
+    }
+
+    QByteArray m_frame;
+    qsizetype m_received = 0;
+    qsizetype m_expected = -1;
+    quint16 m_crc = 0xffff;
+    State m_state = Incomplete;
+
+    QModbusRequest m_echo;
+    int m_echoServerAddress = -1;
+};
+
+/*!
+    \internal
+
+    Decodes one ASCII frame from the characters read off the serial line. The hex pairs are
+    converted through a lookup table straight into the binary frame, and the LRC is summed as the
+    bytes are decoded. A colon starts a new frame at any time, characters before it are skipped.
+
+    The public interface mirrors QModbusRtuFrameAssembler, so both can drive the same request and
+    response handling.
+*/
+template <typename Pdu>
+class QModbusAsciiFrameAssembler
+{
+public:
+    enum State {
+        Incomplete,
+        Complete,
+        Overrun
+    };
+
+    // Server address + 253 bytes PDU + LRC, see MODBUS over Serial Line, chapter 2.5.2.
+    static constexpr qsizetype MaxFrameSize = 255;
+
+    QModbusAsciiFrameAssembler() { m_frame.reserve(MaxFrameSize); }
+
+    void reset()
+    {
+        m_frame.resize(0);
+        m_received = 0;
+        m_highNibble = -1;
+        m_lrc = 0;
+        m_started = false;
+        m_carriageReturn = false;
+        m_state = Incomplete;
+    }
+
+    // Consumes characters up to the end of the current frame and returns how many were consumed,
+    // the remaining ones belong to the next frame. A malformed frame ends at the offending
+    // character with the state set to Overrun.
+    qsizetype append(const char *data, qsizetype size)
+    {
+        if (m_state != Incomplete)
+            return 0;
+
+        qsizetype i = 0;
+        while (i < size && m_state == Incomplete) {
+            const char c = data[i++];
+            if (c == ':') {
+                reset();
+                m_started = true;
+                m_received = 1;
+                continue;
+            }
+            if (!m_started)
+                continue;
+
+            ++m_received;
+            if (m_carriageReturn) {
+                m_state = (c == m_delimiter && m_frame.size() >= 3) ? Complete : Overrun;
+                continue;
+            }
+            if (c == '\r') {
+                m_carriageReturn = true;
+                if (m_highNibble >= 0)
+                    m_state = Overrun; // odd number of hex digits
+                continue;
+            }
+
+            const int nibble = QModbusSerialAdu::hexValue(c);
+            if (nibble < 0 || m_frame.size() >= MaxFrameSize) {
+                m_state = Overrun;
+                continue;
+            }
+            if (m_highNibble < 0) {
+                m_highNibble = nibble;
+                continue;
+            }
+            const quint8 byte = quint8(m_highNibble << 4 | nibble);
+            m_highNibble = -1;
+            m_lrc += byte;
+            m_frame.append(char(byte));
+        }
+        return i;
+    }
+
+    void setOverrun() { m_state = Overrun; }
+
+    // The character ending a frame after the carriage return, see Diagnostics sub-function 0x03.
+    void setDelimiter(char delimiter) { m_delimiter = delimiter; }
+
+    State state() const { return m_state; }
+    qsizetype size() const { return m_received; }
+    const QByteArray &rawData() const { return m_frame; }
+
+    int serverAddress() const
+    {
+        Q_ASSERT_X(!m_frame.isEmpty(), "QModbusAsciiFrameAssembler::serverAddress()", "Empty ADU.");
+        return quint8(m_frame.at(0));
+    }
+
+    Pdu pdu() const
+    {
+        Q_ASSERT_X(m_state == Complete, "QModbusAsciiFrameAssembler::pdu()", "Incomplete ADU.");
+        return Pdu(QModbusPdu::FunctionCode(quint8(m_frame.at(1))),
+                   QByteArray(m_frame.constData() + 2, m_frame.size() - 3));
+    }
+
+    quint8 checksum() const
+    {
+        Q_ASSERT_X(m_state == Complete, "QModbusAsciiFrameAssembler::checksum()", "Incomplete ADU.");
+        return quint8(m_frame.at(m_frame.size() - 1));
+    }
+
+    quint8 calculatedChecksum() const
+    {
+        return QModbusSerialAdu::calculateLRC(m_frame.constData(), m_frame.size() - 1);
+    }
+
+    // The byte sum over a frame including its own LRC is zero.
+    bool matchingChecksum() const { return m_state == Complete && m_lrc == 0; }
+
+private:
+    QByteArray m_frame;
+    qsizetype m_received = 0;
+    int m_highNibble = -1;
+    quint8 m_lrc = 0;
+    char m_delimiter = '\n';
+    bool m_started = false;
+    bool m_carriageReturn = false;
+    State m_state = Incomplete;
+};
+
 QT_END_NAMESPACE
 
 #endif // QMODBUSADU_P_H
@@ -39,6 +39,7 @@
 #include "qmodbus_symbols_p.h"
 
 #include <QtCore/qdebug.h>
+#include <QtCore/qendian.h>
 #include <QtCore/qloggingcategory.h>
 
 QT_BEGIN_NAMESPACE
@@ -351,6 +352,12 @@ QModbusRequest QModbusClientPrivate::createRWRequest(const QModbusDataUnit &read
 void QModbusClientPrivate::processQueueElement(const QModbusResponse &pdu,
                                                const QueueElement &element)
 {
+    if (pdu.isValid()) {
+        m_statistics.addResponse(pdu);
+        if (element.sent.isValid())
+            m_statistics.addLatency(pdu.functionCode(), element.sent.nsecsElapsed());
+    }
+
     if (element.reply.isNull())
         return;
 
@@ -499,14 +506,13 @@ bool QModbusClientPrivate::collateBytes(const QModbusPdu &response,
         return false;
 
     if (data) {
-        QDataStream stream(response.data().remove(0, 1));
-
-        QList<quint16> values;
-        const quint8 itemCount = byteCount / 2;
-        for (int i = 0; i < itemCount; i++) {
-            quint16 tmp;
-            stream >> tmp;
-            values.append(tmp);
+        const QByteArray payload = response.data();
+        const char *in = payload.constData() + 1;
+
+        QList<quint16> values(byteCount / 2);
+        for (quint16 &value : values) {
+            value = qFromBigEndian<quint16>(in);
+            in += sizeof(quint16);
         }
         data->setValues(values);
         data->setRegisterType(type);
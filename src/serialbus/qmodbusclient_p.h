@@ -37,6 +37,7 @@
 #ifndef QMODBUSCLIENT_P_H
 #define QMODBUSCLIENT_P_H
 
+#include <QtCore/qelapsedtimer.h>
 #include <QtCore/qtimer.h>
 #include <QtSerialBus/qmodbusclient.h>
 #include <QtSerialBus/qmodbuspdu.h>
@@ -128,6 +129,7 @@ public:
         QByteArray adu;
         qint64 bytesWritten = 0;
         qint32 m_timerId = INT_MIN;
+        QElapsedTimer sent; // started on every transmission, drives the round-trip histogram
     };
     void processQueueElement(const QModbusResponse &pdu, const QueueElement &element);
 };
@@ -36,6 +36,10 @@
 
 #include "qmodbusdataunit.h"
 
+#include <QtCore/private/qsimd_p.h>
+
+#include <cstring>
+
 QT_BEGIN_NAMESPACE
 
 /*!
@@ -203,6 +207,201 @@ QT_BEGIN_NAMESPACE
     equal to \c 0.
 */
 
+/*!
+    \enum QModbusDataUnit::ValueOrder
+    \since 6.1
+
+    This enum describes how a value wider than a single register is laid out
+    across consecutive registers. The letters name the bytes of a 32 bit value
+    from the most significant byte \c A to the least significant byte \c D,
+    in the order they are transferred. 64 bit values follow the same scheme
+    over four registers.
+
+    \value BigEndian               \c ABCD, the most significant register and
+                                   byte first. This is the Modbus byte order.
+    \value BigEndianByteSwap       \c BADC, the most significant register first,
+                                   with the bytes of each register swapped.
+    \value LittleEndianByteSwap    \c CDAB, the least significant register
+                                   first, the bytes of each register in Modbus
+                                   byte order.
+    \value LittleEndian            \c DCBA, the least significant register and
+                                   byte first.
+
+    \sa valuesAs(), setValuesFrom()
+*/
+
+/*!
+    \fn template <typename T> QList<T> QModbusDataUnit::valuesAs(ValueOrder order) const
+    \since 6.1
+
+    Returns the register \l values() converted to values of type \c T, laid
+    out across the registers in \a order. \c T is a 16, 32 or 64 bit integer
+    or floating point type, such as \c float, \c qint32, \c quint64 or
+    \c double. Each value consumes \c {sizeof(T) / 2} registers, registers
+    left over at the end are ignored.
+
+    All values are converted in one pass. On platforms that support it the
+    conversion uses SIMD instructions.
+
+    \code
+        const QModbusDataUnit unit = reply->result();
+        const QList<float> temperatures = unit.valuesAs<float>(QModbusDataUnit::LittleEndianByteSwap);
+    \endcode
+
+    \sa setValuesFrom(), toString()
+*/
+
+/*!
+    \fn template <typename T> void QModbusDataUnit::setValuesFrom(const QList<T> &values, ValueOrder order)
+    \since 6.1
+
+    Sets the register \l values() to \a values of type \c T, laid out across
+    the registers in \a order. This is the reverse of \l valuesAs() and can be
+    used to prepare a unit for \l QModbusClient::sendWriteRequest(). The value
+    count is adjusted to the number of registers written.
+
+    \code
+        QModbusDataUnit unit(QModbusDataUnit::HoldingRegisters, 100, 0);
+        unit.setValuesFrom(QList<double> { 21.5, 22.25 });
+        client->sendWriteRequest(unit, serverAddress);
+    \endcode
+
+    \sa valuesAs(), setString()
+*/
+
+/*!
+    \since 6.1
+
+    Returns the register \l values() interpreted as a Latin-1 string with two
+    characters per register. The string ends at the first \c NUL character.
+    With \l BigEndian or \l LittleEndianByteSwap \a order the high byte of a
+    register holds the first character, with \l BigEndianByteSwap or
+    \l LittleEndian the low byte does.
+
+    \sa setString(), valuesAs()
+*/
+QString QModbusDataUnit::toString(ValueOrder order) const
+{
+    const bool swapBytes = (order == BigEndianByteSwap || order == LittleEndian);
+
+    QByteArray latin1(m_values.size() * 2, Qt::Uninitialized);
+    char *out = latin1.data();
+    for (const quint16 value : m_values) {
+        *out++ = char(swapBytes ? value & 0xff : value >> 8);
+        *out++ = char(swapBytes ? value >> 8 : value & 0xff);
+    }
+
+    const qsizetype end = latin1.indexOf('\0');
+    if (end >= 0)
+        latin1.truncate(end);
+    return QString::fromLatin1(latin1);
+}
+
+/*!
+    \since 6.1
+
+    Sets the register \l values() to \a text, encoded as Latin-1 with two
+    characters per register in \a order. An odd length is padded with a
+    \c NUL character. The value count is adjusted to the number of registers
+    written.
+
+    \sa toString(), setValuesFrom()
+*/
+void QModbusDataUnit::setString(const QString &text, ValueOrder order)
+{
+    const bool swapBytes = (order == BigEndianByteSwap || order == LittleEndian);
+
+    const QByteArray latin1 = text.toLatin1();
+    QList<quint16> registers((latin1.size() + 1) / 2);
+    for (qsizetype i = 0; i < registers.size(); ++i) {
+        const quint8 first = quint8(latin1.at(2 * i));
+        const quint8 second = (2 * i + 1 < latin1.size()) ? quint8(latin1.at(2 * i + 1)) : 0;
+        registers[i] = swapBytes ? quint16(second << 8 | first) : quint16(first << 8 | second);
+    }
+    setValues(registers);
+}
+
+/*!
+    \internal
+
+    Reverses the order of the 16 bit words inside each group of \a width words,
+    if \a reverseWords is set, and swaps the bytes of each word, if \a swapBytes
+    is set. Both steps are their own inverse, so the same permutation converts
+    registers to values and back.
+*/
+static void permuteWords(const uchar *from, uchar *to, qsizetype words, int width,
+                         bool reverseWords, bool swapBytes)
+{
+    qsizetype i = 0;
+
+    // Eight words per vector, a multiple of every width, so the tail starts on a value boundary.
+#if defined(__SSE2__)
+    for (; i + 8 <= words; i += 8) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(from + 2 * i));
+        if (reverseWords && width == 2) {
+            v = _mm_shufflelo_epi16(v, _MM_SHUFFLE(2, 3, 0, 1));
+            v = _mm_shufflehi_epi16(v, _MM_SHUFFLE(2, 3, 0, 1));
+        } else if (reverseWords && width == 4) {
+            v = _mm_shufflelo_epi16(v, _MM_SHUFFLE(0, 1, 2, 3));
+            v = _mm_shufflehi_epi16(v, _MM_SHUFFLE(0, 1, 2, 3));
+        }
+        if (swapBytes)
+            v = _mm_or_si128(_mm_slli_epi16(v, 8), _mm_srli_epi16(v, 8));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(to + 2 * i), v);
+    }
+#elif defined(__ARM_NEON__) || defined(__ARM_NEON)
+    for (; i + 8 <= words; i += 8) {
+        uint8x16_t v = vld1q_u8(from + 2 * i);
+        if (reverseWords && width == 2)
+            v = vreinterpretq_u8_u16(vrev32q_u16(vreinterpretq_u16_u8(v)));
+        else if (reverseWords && width == 4)
+            v = vreinterpretq_u8_u16(vrev64q_u16(vreinterpretq_u16_u8(v)));
+        if (swapBytes)
+            v = vrev16q_u8(v);
+        vst1q_u8(to + 2 * i, v);
+    }
+#endif
+
+    for (; i < words; i += width) {
+        for (int w = 0; w < width; ++w) {
+            const uchar *in = from + 2 * (i + (reverseWords ? width - 1 - w : w));
+            uchar *out = to + 2 * (i + w);
+            out[0] = in[swapBytes ? 1 : 0];
+            out[1] = in[swapBytes ? 0 : 1];
+        }
+    }
+}
+
+/*!
+    \internal
+
+    Converts \a words registers at \a from into values of \a width registers
+    each at \a to, or the other way round, for the given \a order.
+*/
+void QModbusDataUnit::convertRegisters(const void *from, void *to, qsizetype words, int width,
+                                       ValueOrder order)
+{
+    if (words <= 0)
+        return;
+
+    const bool wordSwap = (order == LittleEndianByteSwap || order == LittleEndian);
+    const bool swapBytes = (order == BigEndianByteSwap || order == LittleEndian);
+    // Register values are host order 16 bit words. Values are host order as a whole, so on
+    // little endian hosts the most significant register is the last word in memory.
+#if Q_BYTE_ORDER == Q_LITTLE_ENDIAN
+    const bool reverseWords = width > 1 && !wordSwap;
+#else
+    const bool reverseWords = width > 1 && wordSwap;
+#endif
+
+    if (!reverseWords && !swapBytes) {
+        memcpy(to, from, size_t(words) * sizeof(quint16));
+        return;
+    }
+    permuteWords(static_cast<const uchar *>(from), static_cast<uchar *>(to), words, width,
+                 reverseWords, swapBytes);
+}
+
 /*!
     \typedef QModbusDataUnitMap
     \relates QModbusDataUnit
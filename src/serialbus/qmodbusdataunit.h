@@ -40,6 +40,10 @@
 #include <QtCore/qlist.h>
 #include <QtCore/qmap.h>
 #include <QtCore/qmetatype.h>
+#include <QtCore/qstring.h>
+#include <QtSerialBus/qtserialbusglobal.h>
+
+#include <type_traits>
 
 QT_BEGIN_NAMESPACE
 
@@ -54,6 +58,13 @@ public:
         HoldingRegisters
     };
 
+    enum ValueOrder {
+        BigEndian,
+        BigEndianByteSwap,
+        LittleEndianByteSwap,
+        LittleEndian
+    };
+
     QModbusDataUnit() = default;
 
     explicit QModbusDataUnit(RegisterType type)
@@ -97,7 +108,35 @@ public:
 
     bool isValid() const { return m_type != Invalid && m_startAddress != -1; }
 
+    template <typename T>
+    QList<T> valuesAs(ValueOrder order = BigEndian) const
+    {
+        static_assert(std::is_arithmetic_v<T> && sizeof(T) % sizeof(quint16) == 0,
+                      "Register values convert to 16, 32 or 64 bit integer or floating point types.");
+        constexpr int width = int(sizeof(T) / sizeof(quint16));
+        QList<T> result(m_values.size() / width);
+        convertRegisters(m_values.constData(), result.data(), result.size() * width, width, order);
+        return result;
+    }
+
+    template <typename T>
+    void setValuesFrom(const QList<T> &newValues, ValueOrder order = BigEndian)
+    {
+        static_assert(std::is_arithmetic_v<T> && sizeof(T) % sizeof(quint16) == 0,
+                      "Register values convert from 16, 32 or 64 bit integer or floating point types.");
+        constexpr int width = int(sizeof(T) / sizeof(quint16));
+        QList<quint16> registers(newValues.size() * width);
+        convertRegisters(newValues.constData(), registers.data(), registers.size(), width, order);
+        setValues(registers);
+    }
+
+    Q_SERIALBUS_EXPORT QString toString(ValueOrder order = BigEndian) const;
+    Q_SERIALBUS_EXPORT void setString(const QString &text, ValueOrder order = BigEndian);
+
 private:
+    Q_SERIALBUS_EXPORT static void convertRegisters(const void *from, void *to, qsizetype words,
+                                                    int width, ValueOrder order);
+
     RegisterType m_type = Invalid;
     int m_startAddress = -1;
     QList<quint16> m_values;
@@ -107,9 +146,11 @@ typedef QMap<QModbusDataUnit::RegisterType, QModbusDataUnit> QModbusDataUnitMap;
 
 Q_DECLARE_TYPEINFO(QModbusDataUnit, Q_RELOCATABLE_TYPE);
 Q_DECLARE_TYPEINFO(QModbusDataUnit::RegisterType, Q_PRIMITIVE_TYPE);
+Q_DECLARE_TYPEINFO(QModbusDataUnit::ValueOrder, Q_PRIMITIVE_TYPE);
 
 QT_END_NAMESPACE
 
 Q_DECLARE_METATYPE(QModbusDataUnit::RegisterType)
+Q_DECLARE_METATYPE(QModbusDataUnit::ValueOrder)
 
 #endif // QMODBUSDATAUNIT_H
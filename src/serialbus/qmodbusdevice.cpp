@@ -38,8 +38,11 @@
 #include "qmodbusdevice_p.h"
 #include "qmodbusdataunit.h"
 
+#include <QtCore/qalgorithms.h>
 #include <QtCore/qloggingcategory.h>
 
+#include <cmath>
+
 QT_BEGIN_NAMESPACE
 
 /*!
@@ -95,6 +98,24 @@ QModbusDevice::~QModbusDevice()
     \value NetworkPortParameter      This parameter holds the network port. \c int
     \value NetworkAddressParameter   This parameter holds the host address for network
                                      communication. \c QString
+    \value SerialTransmissionModeParameter
+                                     This parameter holds the framing used on the serial
+                                     line. This enum value has been added in Qt 6.1.
+                                     \c QModbusDevice::SerialTransmissionMode
+*/
+
+/*!
+    \enum QModbusDevice::SerialTransmissionMode
+    \since 6.1
+
+    This enum describes the transmission modes a Modbus device can use on a
+    serial line, see \l SerialTransmissionModeParameter.
+
+    \value RtuTransmissionMode    Binary frames separated by silent intervals and
+                                  protected by a CRC. This is the default.
+    \value AsciiTransmissionMode  Frames of hex encoded characters, started by a colon,
+                                  terminated by a carriage return and line feed and
+                                  protected by an LRC.
 */
 
 /*!
@@ -103,7 +124,7 @@ QModbusDevice::~QModbusDevice()
 
     By default the \c QModbusDevice is initialized with some common values. The
     serial port settings are even parity, a baud rate of 19200 bits per second,
-    eight data bits and one stop bit. The network settings for the host address
+    eight data bits, one stop bit and RTU transmission mode. The network settings for the host address
     is set to local host and port to 502.
 
     \note For a serial connection to succeed, the \l SerialPortNameParameter
@@ -130,6 +151,8 @@ QVariant QModbusDevice::connectionParameter(ConnectionParameter parameter) const
         return d->m_stopBits;
     case SerialBaudRateParameter:
         return d->m_baudRate;
+    case SerialTransmissionModeParameter:
+        return d->m_transmissionMode;
 #endif
     case NetworkPortParameter:
         return d->m_networkPort;
@@ -169,6 +192,9 @@ void QModbusDevice::setConnectionParameter(ConnectionParameter parameter, const
     case SerialBaudRateParameter:
         d->m_baudRate = QSerialPort::BaudRate(value.toInt());
         break;
+    case SerialTransmissionModeParameter:
+        d->m_transmissionMode = SerialTransmissionMode(value.toInt());
+        break;
 #endif
     case NetworkPortParameter:
         d->m_networkPort = value.toInt();
@@ -366,6 +392,211 @@ QIODevice *QModbusDevice::device() const
     return d_func()->device();
 }
 
+/*!
+    \since 6.1
+
+    Returns the statistics gathered for all function codes since the device was
+    created or resetStatistics() was last called.
+
+    A Modbus client counts the requests it sends and measures the round-trip time
+    from writing a request until the matching response arrives. A Modbus server
+    counts the requests it receives and measures the time spent processing each
+    of them.
+
+    Updating the statistics does not take a lock, so this function may be called
+    from any thread. Each counter is read atomically, but the counters of a
+    snapshot taken while the device is busy can be slightly out of step.
+
+    \sa QModbusDeviceStatistics
+*/
+QModbusDeviceStatistics QModbusDevice::statistics() const
+{
+    return d_func()->m_statistics.snapshot();
+}
+
+/*!
+    \since 6.1
+    \overload
+
+    Returns the statistics gathered for the function \a code. Exception responses
+    are accounted to the function code of the request they answer.
+*/
+QModbusDeviceStatistics QModbusDevice::statistics(QModbusPdu::FunctionCode code) const
+{
+    return d_func()->m_statistics.snapshot(code);
+}
+
+/*!
+    \since 6.1
+
+    Sets all statistics of the device back to zero. This function must be called
+    from the thread the device lives in.
+
+    \sa statistics()
+*/
+void QModbusDevice::resetStatistics()
+{
+    d_func()->m_statistics.reset();
+}
+
+/*!
+    \class QModbusDeviceStatistics
+    \inmodule QtSerialBus
+    \since 6.1
+
+    \brief The QModbusDeviceStatistics struct holds the traffic counters and the
+    latency histogram of a \l QModbusDevice.
+
+    The latency histogram uses buckets of exponentially growing width, similar
+    to an HDR histogram. Latencies below 16 microseconds get a bucket each;
+    beyond that every power of two is split into eight buckets, which keeps the
+    relative error of a recorded value below 12.5 percent. Latencies above about
+    268 seconds end up in the last bucket.
+
+    \sa QModbusDevice::statistics()
+*/
+
+/*!
+    \variable QModbusDeviceStatistics::LatencyBucketCount
+
+    The number of buckets in \l latencyHistogram.
+*/
+
+/*!
+    \variable QModbusDeviceStatistics::requests
+
+    The number of requests sent by a client or received by a server. Requests
+    sent again after a timeout are not included.
+*/
+
+/*!
+    \variable QModbusDeviceStatistics::responses
+
+    The number of responses received by a client or sent by a server, including
+    exception responses.
+*/
+
+/*!
+    \variable QModbusDeviceStatistics::exceptionResponses
+
+    The number of exception responses received by a client or sent by a server.
+*/
+
+/*!
+    \variable QModbusDeviceStatistics::timeouts
+
+    The number of client requests that failed because no response arrived after
+    the last retry.
+*/
+
+/*!
+    \variable QModbusDeviceStatistics::retries
+
+    The number of times a client sent a request again after a response timeout.
+*/
+
+/*!
+    \variable QModbusDeviceStatistics::bytesSent
+
+    The number of ADU bytes sent, including requests sent again after a timeout.
+*/
+
+/*!
+    \variable QModbusDeviceStatistics::bytesReceived
+
+    The number of ADU bytes of complete requests or responses read from the
+    transport.
+*/
+
+/*!
+    \variable QModbusDeviceStatistics::latencySamples
+
+    The number of latencies recorded in \l latencyHistogram.
+*/
+
+/*!
+    \variable QModbusDeviceStatistics::latencySumUSecs
+
+    The sum of all recorded latencies in microseconds. Divided by
+    \l latencySamples it gives the mean latency.
+*/
+
+/*!
+    \variable QModbusDeviceStatistics::latencyMaxUSecs
+
+    The largest recorded latency in microseconds.
+*/
+
+/*!
+    \variable QModbusDeviceStatistics::latencyHistogram
+
+    The number of recorded latencies per bucket. Use latencyBucketLowerBound()
+    and latencyBucketUpperBound() to get the range covered by a bucket.
+*/
+
+/*!
+    Returns an upper bound in microseconds for the latency below which
+    \a percentile percent of the recorded latencies fall, or \c 0 if no
+    latency was recorded. For example, \c 99.9 returns the 99.9th percentile.
+*/
+qint64 QModbusDeviceStatistics::latencyPercentile(double percentile) const
+{
+    if (latencySamples == 0)
+        return 0;
+
+    const double clamped = qBound(0.0, percentile, 100.0);
+    const quint64 rank = qMax<quint64>(1, quint64(std::ceil(clamped / 100.0 * latencySamples)));
+
+    quint64 seen = 0;
+    for (int bucket = 0; bucket < LatencyBucketCount; ++bucket) {
+        seen += latencyHistogram[bucket];
+        if (seen >= rank)
+            return qMin<qint64>(latencyBucketUpperBound(bucket), qint64(latencyMaxUSecs));
+    }
+    return qint64(latencyMaxUSecs);
+}
+
+/*!
+    Returns the index of the histogram bucket that counts a latency of
+    \a usecs microseconds.
+*/
+int QModbusDeviceStatistics::latencyBucket(qint64 usecs)
+{
+    if (usecs < 16)
+        return int(qMax<qint64>(0, usecs));
+
+    const int exponent = 63 - qCountLeadingZeroBits(quint64(usecs));
+    const int bucket = 16 + (exponent - 4) * 8 + int((usecs >> (exponent - 3)) & 7);
+    return qMin(bucket, LatencyBucketCount - 1);
+}
+
+/*!
+    Returns the smallest latency in microseconds that is counted in \a bucket.
+*/
+qint64 QModbusDeviceStatistics::latencyBucketLowerBound(int bucket)
+{
+    bucket = qBound(0, bucket, LatencyBucketCount - 1);
+    if (bucket < 16)
+        return bucket;
+
+    const int exponent = 4 + (bucket - 16) / 8;
+    return qint64(8 + (bucket - 16) % 8) << (exponent - 3);
+}
+
+/*!
+    Returns the largest latency in microseconds that is counted in \a bucket.
+    The last bucket also counts all latencies beyond its upper bound.
+*/
+qint64 QModbusDeviceStatistics::latencyBucketUpperBound(int bucket)
+{
+    bucket = qBound(0, bucket, LatencyBucketCount - 1);
+    if (bucket < 16)
+        return bucket;
+
+    const int exponent = 4 + (bucket - 16) / 8;
+    return latencyBucketLowerBound(bucket) + (qint64(1) << (exponent - 3)) - 1;
+}
+
 /*!
     \fn bool QModbusDevice::open()
 
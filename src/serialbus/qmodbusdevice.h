@@ -38,12 +38,39 @@
 
 #include <QtCore/qobject.h>
 #include <QtCore/qiodevice.h>
+#include <QtSerialBus/qmodbuspdu.h>
 #include <QtSerialBus/qtserialbusglobal.h>
 
+#include <array>
+
 QT_BEGIN_NAMESPACE
 
 class QModbusDevicePrivate;
 
+struct Q_SERIALBUS_EXPORT QModbusDeviceStatistics
+{
+    static constexpr int LatencyBucketCount = 208;
+
+    quint64 requests = 0;
+    quint64 responses = 0;
+    quint64 exceptionResponses = 0;
+    quint64 timeouts = 0;
+    quint64 retries = 0;
+    quint64 bytesSent = 0;
+    quint64 bytesReceived = 0;
+
+    quint64 latencySamples = 0;
+    quint64 latencySumUSecs = 0;
+    quint64 latencyMaxUSecs = 0;
+    std::array<quint64, LatencyBucketCount> latencyHistogram = {};
+
+    qint64 latencyPercentile(double percentile) const;
+
+    static int latencyBucket(qint64 usecs);
+    static qint64 latencyBucketLowerBound(int bucket);
+    static qint64 latencyBucketUpperBound(int bucket);
+};
+
 class Q_SERIALBUS_EXPORT QModbusDevice : public QObject
 {
     Q_OBJECT
@@ -79,10 +106,18 @@ public:
         SerialStopBitsParameter,
 
         NetworkPortParameter,
-        NetworkAddressParameter
+        NetworkAddressParameter,
+
+        SerialTransmissionModeParameter
     };
     Q_ENUM(ConnectionParameter)
 
+    enum SerialTransmissionMode {
+        RtuTransmissionMode,
+        AsciiTransmissionMode
+    };
+    Q_ENUM(SerialTransmissionMode)
+
     enum IntermediateError
     {
         ResponseCrcError,
@@ -106,6 +141,10 @@ public:
 
     QIODevice *device() const;
 
+    QModbusDeviceStatistics statistics() const;
+    QModbusDeviceStatistics statistics(QModbusPdu::FunctionCode code) const;
+    void resetStatistics();
+
 Q_SIGNALS:
     void errorOccurred(QModbusDevice::Error error);
     void stateChanged(QModbusDevice::State state);
@@ -123,6 +162,7 @@ Q_DECLARE_TYPEINFO(QModbusDevice::Error, Q_PRIMITIVE_TYPE);
 Q_DECLARE_TYPEINFO(QModbusDevice::State, Q_PRIMITIVE_TYPE);
 Q_DECLARE_TYPEINFO(QModbusDevice::ConnectionParameter, Q_PRIMITIVE_TYPE);
 Q_DECLARE_TYPEINFO(QModbusDevice::IntermediateError, Q_PRIMITIVE_TYPE);
+Q_DECLARE_TYPEINFO(QModbusDeviceStatistics, Q_PRIMITIVE_TYPE);
 
 QT_END_NAMESPACE
 
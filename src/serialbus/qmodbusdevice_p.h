@@ -45,6 +45,9 @@
 
 #include <private/qobject_p.h>
 
+#include <atomic>
+#include <memory>
+
 //
 //  W A R N I N G
 //  -------------
@@ -58,6 +61,151 @@
 
 QT_BEGIN_NAMESPACE
 
+/*
+    Collects the per function code counters behind QModbusDevice::statistics().
+
+    All updates happen on the thread the device lives in, so a relaxed load and store is
+    enough to bump a counter and the hot path never takes a lock or issues a locked read,
+    modify, write instruction. Readers on other threads see each counter atomically, a
+    snapshot as a whole is not guaranteed to be consistent though.
+*/
+class QModbusStatisticsRecorder
+{
+    Q_DISABLE_COPY_MOVE(QModbusStatisticsRecorder)
+
+public:
+    QModbusStatisticsRecorder() = default;
+    ~QModbusStatisticsRecorder()
+    {
+        for (auto &slot : m_slots)
+            delete slot.load(std::memory_order_relaxed);
+    }
+
+    void addRequest(QModbusPdu::FunctionCode code) { add(slot(code)->requests); }
+    void addRetry(QModbusPdu::FunctionCode code) { add(slot(code)->retries); }
+    void addTimeout(QModbusPdu::FunctionCode code) { add(slot(code)->timeouts); }
+    void addBytesSent(QModbusPdu::FunctionCode code, qint64 bytes)
+    {
+        if (bytes > 0)
+            add(slot(code)->bytesSent, quint64(bytes));
+    }
+    void addBytesReceived(QModbusPdu::FunctionCode code, qint64 bytes)
+    {
+        if (bytes > 0)
+            add(slot(code)->bytesReceived, quint64(bytes));
+    }
+    void addResponse(const QModbusPdu &response)
+    {
+        Slot *s = slot(response.functionCode());
+        add(s->responses);
+        if (response.isException())
+            add(s->exceptionResponses);
+    }
+    void addLatency(QModbusPdu::FunctionCode code, qint64 nsecs)
+    {
+        const quint64 usecs = quint64(qMax<qint64>(0, nsecs) / 1000);
+        Slot *s = slot(code);
+        add(s->latencySamples);
+        add(s->latencySumUSecs, usecs);
+        if (usecs > s->latencyMaxUSecs.load(std::memory_order_relaxed))
+            s->latencyMaxUSecs.store(usecs, std::memory_order_relaxed);
+        add(s->latencyHistogram[QModbusDeviceStatistics::latencyBucket(qint64(usecs))]);
+    }
+
+    QModbusDeviceStatistics snapshot(QModbusPdu::FunctionCode code) const
+    {
+        QModbusDeviceStatistics result;
+        if (const Slot *s = m_slots[index(code)].load(std::memory_order_acquire))
+            accumulate(*s, &result);
+        return result;
+    }
+
+    QModbusDeviceStatistics snapshot() const
+    {
+        QModbusDeviceStatistics result;
+        for (const auto &slot : m_slots) {
+            if (const Slot *s = slot.load(std::memory_order_acquire))
+                accumulate(*s, &result);
+        }
+        return result;
+    }
+
+    void reset()
+    {
+        for (auto &slot : m_slots) {
+            Slot *s = slot.load(std::memory_order_relaxed);
+            if (!s)
+                continue;
+            for (auto *counter : { &s->requests, &s->responses, &s->exceptionResponses,
+                                   &s->timeouts, &s->retries, &s->bytesSent, &s->bytesReceived,
+                                   &s->latencySamples, &s->latencySumUSecs,
+                                   &s->latencyMaxUSecs }) {
+                counter->store(0, std::memory_order_relaxed);
+            }
+            for (auto &bucket : s->latencyHistogram)
+                bucket.store(0, std::memory_order_relaxed);
+        }
+    }
+
+private:
+    using Counter = std::atomic<quint64>;
+
+    struct Slot
+    {
+        Counter requests { 0 };
+        Counter responses { 0 };
+        Counter exceptionResponses { 0 };
+        Counter timeouts { 0 };
+        Counter retries { 0 };
+        Counter bytesSent { 0 };
+        Counter bytesReceived { 0 };
+        Counter latencySamples { 0 };
+        Counter latencySumUSecs { 0 };
+        Counter latencyMaxUSecs { 0 };
+        std::array<Counter, QModbusDeviceStatistics::LatencyBucketCount> latencyHistogram {};
+    };
+
+    // Function codes are 7 bit wide, the exception bit is stripped by QModbusPdu.
+    static int index(QModbusPdu::FunctionCode code) { return int(code) & 0x7f; }
+
+    static void add(Counter &counter, quint64 value = 1)
+    {
+        counter.store(counter.load(std::memory_order_relaxed) + value,
+                      std::memory_order_relaxed);
+    }
+
+    static void accumulate(const Slot &s, QModbusDeviceStatistics *result)
+    {
+        result->requests += s.requests.load(std::memory_order_relaxed);
+        result->responses += s.responses.load(std::memory_order_relaxed);
+        result->exceptionResponses += s.exceptionResponses.load(std::memory_order_relaxed);
+        result->timeouts += s.timeouts.load(std::memory_order_relaxed);
+        result->retries += s.retries.load(std::memory_order_relaxed);
+        result->bytesSent += s.bytesSent.load(std::memory_order_relaxed);
+        result->bytesReceived += s.bytesReceived.load(std::memory_order_relaxed);
+        result->latencySamples += s.latencySamples.load(std::memory_order_relaxed);
+        result->latencySumUSecs += s.latencySumUSecs.load(std::memory_order_relaxed);
+        result->latencyMaxUSecs = qMax(result->latencyMaxUSecs,
+                                       s.latencyMaxUSecs.load(std::memory_order_relaxed));
+        for (int i = 0; i < QModbusDeviceStatistics::LatencyBucketCount; ++i)
+            result->latencyHistogram[i] += s.latencyHistogram[i].load(std::memory_order_relaxed);
+    }
+
+    // Slots are allocated on first use, most devices only ever see a handful of function codes.
+    Slot *slot(QModbusPdu::FunctionCode code)
+    {
+        auto &entry = m_slots[index(code)];
+        Slot *s = entry.load(std::memory_order_relaxed);
+        if (Q_UNLIKELY(!s)) {
+            s = new Slot;
+            entry.store(s, std::memory_order_release);
+        }
+        return s;
+    }
+
+    std::array<std::atomic<Slot *>, 128> m_slots {};
+};
+
 class QModbusDevicePrivate : public QObjectPrivate
 {
     Q_DECLARE_PUBLIC(QModbusDevice)
@@ -73,6 +221,7 @@ public:
     QSerialPort::Parity m_parity = QSerialPort::EvenParity;
     QSerialPort::StopBits m_stopBits = QSerialPort::OneStop;
     QSerialPort::BaudRate m_baudRate = QSerialPort::Baud19200;
+    QModbusDevice::SerialTransmissionMode m_transmissionMode = QModbusDevice::RtuTransmissionMode;
 
     /*!
         According to the Modbus specification, in RTU mode message frames
@@ -102,6 +251,8 @@ public:
     int m_networkPort = 502;
     QString m_networkAddress = QStringLiteral("127.0.0.1");
 
+    QModbusStatisticsRecorder m_statistics;
+
     virtual QIODevice *device() const { return nullptr; }
 };
 
@@ -0,0 +1,266 @@
+/****************************************************************************
+**
+** Copyright (C) 2021 The Qt Company Ltd.
+** Contact: http://www.qt.io/licensing/
+**
+** This file is part of the QtSerialBus module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL3$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see http://www.qt.io/terms-conditions. For further
+** information use the contact form at http://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPLv3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or later as published by the Free
+** Software Foundation and appearing in the file LICENSE.GPL included in
+** the packaging of this file. Please review the following information to
+** ensure the GNU General Public License version 2.0 requirements will be
+** met: http://www.gnu.org/licenses/gpl-2.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include "qmodbusfifoqueue.h"
+#include "qmodbusfifoqueue_p.h"
+
+#include <QtCore/qalgorithms.h>
+
+QT_BEGIN_NAMESPACE
+
+/*!
+    \class QModbusFifoQueue
+    \inmodule QtSerialBus
+    \since 6.1
+
+    \brief The QModbusFifoQueue class is a bounded queue of register values
+    served by the Read FIFO Queue function code.
+
+    A QModbusServer answers \l QModbusPdu::ReadFifoQueue requests from its
+    holding registers by default, which requires the application to stage the
+    queue contents in the register map. A QModbusFifoQueue installed with
+    \l QModbusServer::setFifoQueue() replaces this for one FIFO pointer
+    address: every request removes up to 31 values from the front of the
+    queue and returns them.
+
+    Values can be pushed from any thread and by several producers at once
+    without locking. If the queue is full, the value is dropped and counted in
+    overflowCount(). Values are only removed by the thread the server lives in,
+    or by a single other consumer if the queue is not installed in a server.
+
+    \code
+        QModbusFifoQueue samples(256);
+        server->setFifoQueue(0x04de, &samples);
+
+        // in the acquisition thread
+        if (!samples.push(sample))
+            qWarning() << "Sample dropped," << samples.overflowCount() << "so far";
+    \endcode
+
+    \sa QModbusServer::setFifoQueue()
+*/
+
+QModbusFifoQueuePrivate::QModbusFifoQueuePrivate(size_t capacity)
+    : m_cells(new Cell[capacity])
+    , m_mask(capacity - 1)
+{
+    for (size_t i = 0; i < capacity; ++i)
+        m_cells[i].sequence.store(i, std::memory_order_relaxed);
+}
+
+bool QModbusFifoQueuePrivate::push(quint16 value)
+{
+    size_t position = m_enqueuePosition.load(std::memory_order_relaxed);
+    for (;;) {
+        Cell &cell = m_cells[position & m_mask];
+        const size_t sequence = cell.sequence.load(std::memory_order_acquire);
+        const auto difference = qptrdiff(sequence) - qptrdiff(position);
+        if (difference == 0) {
+            // The cell is free in this lap, claim it.
+            if (m_enqueuePosition.compare_exchange_weak(position, position + 1,
+                                                        std::memory_order_relaxed)) {
+                cell.value = value;
+                cell.sequence.store(position + 1, std::memory_order_release);
+                return true;
+            }
+        } else if (difference < 0) {
+            // The cell still holds a value from the previous lap, the queue is full.
+            m_overflows.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        } else {
+            position = m_enqueuePosition.load(std::memory_order_relaxed);
+        }
+    }
+}
+
+bool QModbusFifoQueuePrivate::pop(quint16 *value)
+{
+    size_t position = m_dequeuePosition.load(std::memory_order_relaxed);
+    for (;;) {
+        Cell &cell = m_cells[position & m_mask];
+        const size_t sequence = cell.sequence.load(std::memory_order_acquire);
+        const auto difference = qptrdiff(sequence) - qptrdiff(position + 1);
+        if (difference == 0) {
+            if (m_dequeuePosition.compare_exchange_weak(position, position + 1,
+                                                        std::memory_order_relaxed)) {
+                *value = cell.value;
+                // Hand the cell to the producers of the next lap.
+                cell.sequence.store(position + m_mask + 1, std::memory_order_release);
+                return true;
+            }
+        } else if (difference < 0) {
+            return false; // empty
+        } else {
+            position = m_dequeuePosition.load(std::memory_order_relaxed);
+        }
+    }
+}
+
+static size_t roundedCapacity(qsizetype capacity)
+{
+    size_t rounded = 2;
+    while (rounded < size_t(qMax<qsizetype>(capacity, 2)))
+        rounded <<= 1;
+    return rounded;
+}
+
+/*!
+    Constructs an empty queue that holds at least \a capacity values. The
+    capacity is rounded up to the next power of two, and is at least two.
+*/
+QModbusFifoQueue::QModbusFifoQueue(qsizetype capacity)
+    : d_ptr(new QModbusFifoQueuePrivate(roundedCapacity(capacity)))
+{
+}
+
+/*!
+    Destroys the queue. It must not be installed in a QModbusServer anymore.
+*/
+QModbusFifoQueue::~QModbusFifoQueue() = default;
+
+/*!
+    Returns the number of values the queue can hold.
+*/
+qsizetype QModbusFifoQueue::capacity() const
+{
+    Q_D(const QModbusFifoQueue);
+    return qsizetype(d->m_mask + 1);
+}
+
+/*!
+    Returns the number of values in the queue. While other threads push or pop
+    values the result is only a snapshot.
+*/
+qsizetype QModbusFifoQueue::size() const
+{
+    Q_D(const QModbusFifoQueue);
+    const size_t dequeued = d->m_dequeuePosition.load(std::memory_order_acquire);
+    const size_t enqueued = d->m_enqueuePosition.load(std::memory_order_acquire);
+    const qptrdiff size = qptrdiff(enqueued - dequeued);
+    return qBound<qsizetype>(0, size, capacity());
+}
+
+/*!
+    \fn bool QModbusFifoQueue::isEmpty() const
+
+    Returns \c true if the queue holds no values; otherwise returns \c false.
+*/
+
+/*!
+    Appends \a value to the queue. Returns \c false and increments
+    overflowCount() if the queue is full.
+
+    This function is thread-safe and lock-free.
+*/
+bool QModbusFifoQueue::push(quint16 value)
+{
+    Q_D(QModbusFifoQueue);
+    return d->push(value);
+}
+
+/*!
+    \overload
+
+    Appends \a values to the queue and returns the number of values that fit.
+    Values of a single call are kept in order, but may be interleaved with
+    values pushed by other threads at the same time.
+*/
+qsizetype QModbusFifoQueue::push(const QList<quint16> &values)
+{
+    Q_D(QModbusFifoQueue);
+    qsizetype pushed = 0;
+    for (quint16 value : values) {
+        if (!d->push(value)) {
+            d->m_overflows.fetch_add(quint64(values.size() - pushed - 1),
+                                     std::memory_order_relaxed);
+            break;
+        }
+        ++pushed;
+    }
+    return pushed;
+}
+
+/*!
+    Removes up to \a maxCount values from the front of the queue, copies them
+    to \a values and returns their number.
+
+    Only one thread at a time may remove values from the queue.
+*/
+qsizetype QModbusFifoQueue::pop(quint16 *values, qsizetype maxCount)
+{
+    Q_D(QModbusFifoQueue);
+    qsizetype count = 0;
+    while (count < maxCount && d->pop(values + count))
+        ++count;
+    return count;
+}
+
+/*!
+    \overload
+
+    Removes up to \a maxCount values from the front of the queue and returns
+    them.
+*/
+QList<quint16> QModbusFifoQueue::pop(qsizetype maxCount)
+{
+    QList<quint16> values(qBound<qsizetype>(0, maxCount, capacity()));
+    values.resize(pop(values.data(), values.size()));
+    return values;
+}
+
+/*!
+    Returns the number of values dropped because the queue was full.
+
+    \sa resetOverflowCount()
+*/
+quint64 QModbusFifoQueue::overflowCount() const
+{
+    Q_D(const QModbusFifoQueue);
+    return d->m_overflows.load(std::memory_order_relaxed);
+}
+
+/*!
+    Resets the overflow counter to zero.
+
+    \sa overflowCount()
+*/
+void QModbusFifoQueue::resetOverflowCount()
+{
+    Q_D(QModbusFifoQueue);
+    d->m_overflows.store(0, std::memory_order_relaxed);
+}
+
+QT_END_NAMESPACE
@@ -0,0 +1,76 @@
+/****************************************************************************
+**
+** Copyright (C) 2021 The Qt Company Ltd.
+** Contact: http://www.qt.io/licensing/
+**
+** This file is part of the QtSerialBus module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL3$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see http://www.qt.io/terms-conditions. For further
+** information use the contact form at http://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPLv3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or later as published by the Free
+** Software Foundation and appearing in the file LICENSE.GPL included in
+** the packaging of this file. Please review the following information to
+** ensure the GNU General Public License version 2.0 requirements will be
+** met: http://www.gnu.org/licenses/gpl-2.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#ifndef QMODBUSFIFOQUEUE_H
+#define QMODBUSFIFOQUEUE_H
+
+#include <QtCore/qlist.h>
+#include <QtCore/qscopedpointer.h>
+#include <QtSerialBus/qtserialbusglobal.h>
+
+QT_BEGIN_NAMESPACE
+
+class QModbusFifoQueuePrivate;
+
+class Q_SERIALBUS_EXPORT QModbusFifoQueue
+{
+    Q_DECLARE_PRIVATE(QModbusFifoQueue)
+
+public:
+    explicit QModbusFifoQueue(qsizetype capacity = 32);
+    ~QModbusFifoQueue();
+
+    qsizetype capacity() const;
+    qsizetype size() const;
+    bool isEmpty() const { return size() == 0; }
+
+    bool push(quint16 value);
+    qsizetype push(const QList<quint16> &values);
+
+    qsizetype pop(quint16 *values, qsizetype maxCount);
+    QList<quint16> pop(qsizetype maxCount);
+
+    quint64 overflowCount() const;
+    void resetOverflowCount();
+
+private:
+    Q_DISABLE_COPY(QModbusFifoQueue)
+    QScopedPointer<QModbusFifoQueuePrivate> d_ptr;
+};
+
+QT_END_NAMESPACE
+
+#endif // QMODBUSFIFOQUEUE_H
@@ -0,0 +1,87 @@
+/****************************************************************************
+**
+** Copyright (C) 2021 The Qt Company Ltd.
+** Contact: http://www.qt.io/licensing/
+**
+** This file is part of the QtSerialBus module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL3$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see http://www.qt.io/terms-conditions. For further
+** information use the contact form at http://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPLv3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or later as published by the Free
+** Software Foundation and appearing in the file LICENSE.GPL included in
+** the packaging of this file. Please review the following information to
+** ensure the GNU General Public License version 2.0 requirements will be
+** met: http://www.gnu.org/licenses/gpl-2.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#ifndef QMODBUSFIFOQUEUE_P_H
+#define QMODBUSFIFOQUEUE_P_H
+
+#include <QtSerialBus/qmodbusfifoqueue.h>
+
+#include <atomic>
+#include <memory>
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API. It exists purely as an
+// implementation detail. This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+//
+
+QT_BEGIN_NAMESPACE
+
+/*
+    A bounded multi-producer queue after Dmitry Vyukov. Every cell carries a sequence number
+    that tells producers and consumers whether the cell is free for the current lap of the
+    ring, so neither side needs a lock and a push or pop only contends on one index.
+*/
+class QModbusFifoQueuePrivate
+{
+public:
+    struct Cell
+    {
+        std::atomic<size_t> sequence { 0 };
+        quint16 value = 0;
+    };
+
+    explicit QModbusFifoQueuePrivate(size_t capacity);
+
+    bool push(quint16 value);
+    bool pop(quint16 *value);
+
+    std::unique_ptr<Cell[]> m_cells;
+    size_t m_mask = 0;
+
+    alignas(64) std::atomic<size_t> m_enqueuePosition { 0 };
+    alignas(64) std::atomic<size_t> m_dequeuePosition { 0 };
+    alignas(64) std::atomic<quint64> m_overflows { 0 };
+};
+
+QT_END_NAMESPACE
+
+#endif // QMODBUSFIFOQUEUE_P_H
@@ -318,9 +318,9 @@ static QDataStream &pduFromStream(QDataStream &stream, QModbusPdu &pdu, Type typ
     Constructs a QModbusPdu with function code set to \a code and payload set to \a data.
     The data is converted and stored in big-endian byte order.
 
-    \note Usage is limited \c quint8 and \c quint16 only. This is because
-    \c QDataStream stream operators will not only append raw data, but also
-    e.g. size, count, etc. for complex types.
+    \note Usage is limited \c quint8 and \c quint16, and lists of those, only.
+    The values are written as raw big-endian data without any size or count
+    information.
 */
 
 /*!
@@ -410,9 +410,9 @@ static QDataStream &pduFromStream(QDataStream &stream, QModbusPdu &pdu, Type typ
         response.decodeData(&count, &id, &run);
     \endcode
 
-    \note Usage is limited \c quint8 and \c quint16 only. This is because
-    \c QDataStream stream operators will not only append raw data, but also
-    e.g. size, count, etc. for complex types.
+    \note Usage is limited \c quint8 and \c quint16, and lists of those, only.
+    The values are written as raw big-endian data without any size or count
+    information.
 */
 
 /*!
@@ -426,9 +426,9 @@ static QDataStream &pduFromStream(QDataStream &stream, QModbusPdu &pdu, Type typ
         request.encodeData(quint16(0x0c), quint16(0x0a));
     \endcode
 
-    \note Usage is limited \c quint8 and \c quint16 only. This is because
-    \c QDataStream stream operators will not only append raw data, but also
-    e.g. size, count, etc. for complex types.
+    \note Usage is limited \c quint8 and \c quint16, and lists of those, only.
+    The values are written as raw big-endian data without any size or count
+    information.
 */
 
 /*!
@@ -515,9 +515,9 @@ QDataStream &operator<<(QDataStream &stream, const QModbusPdu &pdu)
     Constructs a QModbusRequest with function code set to \a code and payload set to \a data.
     The data is converted and stored in big-endian byte order.
 
-    \note Usage is limited \c quint8 and \c quint16 only. This is because
-    \c QDataStream stream operators will not only append raw data, but also
-    e.g. size, count, etc. for complex types.
+    \note Usage is limited \c quint8 and \c quint16, and lists of those, only.
+    The values are written as raw big-endian data without any size or count
+    information.
 */
 
 /*!
@@ -671,9 +671,9 @@ QDataStream &operator>>(QDataStream &stream, QModbusRequest &pdu)
     Constructs a QModbusResponse with function code set to \a code and payload set to \a data.
     The data is converted and stored in big-endian byte order.
 
-    \note Usage is limited \c quint8 and \c quint16 only. This is because
-    \c QDataStream stream operators will not only append raw data, but also
-    e.g. size, count, etc. for complex types.
+    \note Usage is limited \c quint8 and \c quint16, and lists of those, only.
+    The values are written as raw big-endian data without any size or count
+    information.
 */
 
 /*!
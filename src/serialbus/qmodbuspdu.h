@@ -37,6 +37,7 @@
 #define QMODBUSPDU_H
 
 #include <QtCore/qdatastream.h>
+#include <QtCore/qendian.h>
 #include <QtCore/qiodevice.h>
 #include <QtCore/qlist.h>
 #include <QtCore/qmetatype.h>
@@ -145,40 +146,56 @@ private:
     template <typename T>
     using is_pod = std::integral_constant<bool, std::is_trivial<T>::value && std::is_standard_layout<T>::value>;
 
-    template <typename T> void encode(QDataStream *stream, const T &t) {
+    template <typename T> static constexpr int encodedSize(const T &) {
+        return int(sizeof(T));
+    }
+    template <typename T> static int encodedSize(const QList<T> &list) {
+        return int(list.size() * sizeof(T));
+    }
+
+    template <typename T> static char *encodeValue(char *out, const T &t) {
         static_assert(is_pod<T>::value, "Only POD types supported.");
         static_assert(IsType<T, quint8, quint16>::value, "Only quint8 and quint16 supported.");
-        (*stream) << t;
+        qToBigEndian<T>(t, out);
+        return out + sizeof(T);
     }
-    template <typename T> void decode(QDataStream *stream, T &t) const {
+    template <typename T> static char *encodeValue(char *out, const QList<T> &list) {
         static_assert(is_pod<T>::value, "Only POD types supported.");
-        static_assert(IsType<T, quint8 *, quint16 *>::value, "Only quint8* and quint16* supported.");
-        (*stream) >> *t;
+        static_assert(IsType<T, quint8, quint16>::value, "Only quint8 and quint16 supported.");
+        for (const T &t : list) {
+            qToBigEndian<T>(t, out);
+            out += sizeof(T);
+        }
+        return out;
     }
-    template<typename T>
-    void encode(QDataStream *stream, const QList<T> &vector)
-    {
+    template <typename T> static const char *decodeValue(const char *in, const char *end, T t) {
         static_assert(is_pod<T>::value, "Only POD types supported.");
-        static_assert(IsType<T, quint8, quint16>::value, "Only quint8 and quint16 supported.");
-        for (int i = 0; i < vector.count(); ++i)
-            (*stream) << vector[i];
+        static_assert(IsType<T, quint8 *, quint16 *>::value, "Only quint8* and quint16* supported.");
+        using Value = typename std::remove_pointer<T>::type;
+        if (end - in < qptrdiff(sizeof(Value))) {
+            *t = 0; // same as reading past the end of a QDataStream
+            return end;
+        }
+        *t = qFromBigEndian<Value>(in);
+        return in + sizeof(Value);
     }
 
     template<typename ... Args> void encode(Args ... newData) {
-        m_data.clear();
-        Q_CONSTEXPR quint32 argCount = sizeof...(Args);
-        if (argCount > 0) {
-            QDataStream stream(&m_data, QIODevice::WriteOnly);
-            char tmp[argCount] = { (encode(&stream, newData), void(), '0')... };
-            Q_UNUSED(tmp);
+        // The size is a constant expression unless one of the arguments is a list.
+        const int size = (0 + ... + encodedSize(newData));
+        if (size <= 0) {
+            m_data.clear();
+            return;
         }
+        m_data.resize(size);
+        char *out = m_data.data();
+        ((out = encodeValue(out, newData)), ...);
     }
     template<typename ... Args> void decode(Args ... newData) const {
-        Q_CONSTEXPR quint32 argCount = sizeof...(Args);
-        if (argCount > 0 && !m_data.isEmpty()) {
-            QDataStream stream(m_data);
-            char tmp[argCount] = { (decode(&stream, newData), void(), '0')... };
-            Q_UNUSED(tmp);
+        if (sizeof...(Args) > 0 && !m_data.isEmpty()) {
+            const char *in = m_data.constData();
+            const char *end = in + m_data.size();
+            ((in = decodeValue(in, end, newData)), ...);
         }
     }
 
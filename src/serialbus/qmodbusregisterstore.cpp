@@ -0,0 +1,690 @@
+/****************************************************************************
+**
+** Copyright (C) 2021 The Qt Company Ltd.
+** Contact: http://www.qt.io/licensing/
+**
+** This file is part of the QtSerialBus module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL3$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see http://www.qt.io/terms-conditions. For further
+** information use the contact form at http://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPLv3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or later as published by the Free
+** Software Foundation and appearing in the file LICENSE.GPL included in
+** the packaging of this file. Please review the following information to
+** ensure the GNU General Public License version 2.0 requirements will be
+** met: http://www.gnu.org/licenses/gpl-2.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include "qmodbusregisterstore.h"
+#include "qmodbusregisterstore_p.h"
+
+#include <QtCore/qbytearrayview.h>
+#include <QtCore/qloggingcategory.h>
+#include <QtCore/qsysinfo.h>
+#include <QtCore/qthread.h>
+
+#include <cstring>
+
+#if defined(Q_OS_UNIX)
+#include <sys/mman.h>
+#include <unistd.h>
+#elif defined(Q_OS_WIN)
+#include <qt_windows.h>
+#endif
+
+QT_BEGIN_NAMESPACE
+
+Q_DECLARE_LOGGING_CATEGORY(QT_MODBUS)
+
+/*!
+    \class QModbusRegisterStore
+    \inmodule QtSerialBus
+    \since 6.1
+
+    \brief The QModbusRegisterStore class is a register map that can be
+    accessed from several threads at once.
+
+    A QModbusServer keeps its registers in a plain \l QModbusDataUnitMap that
+    may only be accessed from the thread the server lives in. Applications that
+    acquire their process values in a separate thread can instead create a
+    QModbusRegisterStore, install it with \l QModbusServer::setRegisterStore(),
+    and write to it directly from the acquisition thread:
+
+    \code
+        QModbusDataUnitMap map;
+        map.insert(QModbusDataUnit::HoldingRegisters, { QModbusDataUnit::HoldingRegisters, 0, 100 });
+        QModbusRegisterStore store(map);
+        server->setRegisterStore(&store);
+
+        // in the acquisition thread
+        QModbusDataUnit unit(QModbusDataUnit::HoldingRegisters, 10, 2);
+        unit.setValuesFrom(QList<float> { temperature });
+        store.setData(unit);
+    \endcode
+
+    Each register table is protected by a sequence lock. Writers never block
+    readers: a reader copies the requested registers and retries if a write to
+    the same table happened meanwhile. Every read therefore returns a
+    consistent snapshot of the whole requested range, so a value spread over
+    several registers is never returned half updated. Readers do not lock at
+    all; concurrent writers to the same table are serialized with a short
+    spin.
+
+    The layout of the tables is fixed when the store is constructed.
+
+    A store constructed with a file name keeps its values in that file and
+    continues with them after the application restarts, see
+    \l {QModbusRegisterStore::}{QModbusRegisterStore(const QModbusDataUnitMap &, const QString &)}.
+
+    \note Writes made directly to the store do not emit
+    \l QModbusServer::dataWritten(). Writes made by a Modbus client through the
+    server do.
+
+    \sa QModbusServer::setRegisterStore()
+*/
+
+static void backOff(int spins)
+{
+    // Writers only hold a table for the time needed to copy a few registers.
+    if (spins >= 64)
+        QThread::yieldCurrentThread();
+}
+
+quint32 QModbusRegisterStorePrivate::Table::lockForWrite()
+{
+    quint32 current = sequence.load(std::memory_order_relaxed);
+    for (int spins = 0; ; ++spins) {
+        if (!(current & 1) && sequence.compare_exchange_weak(current, current + 1,
+                std::memory_order_acquire, std::memory_order_relaxed)) {
+            if (writeMarker)
+                writeMarker->store(1, std::memory_order_relaxed);
+            // Keep the stores to the values from being reordered before the odd sequence
+            // and the write marker.
+            std::atomic_thread_fence(std::memory_order_release);
+            return current + 1;
+        }
+        backOff(spins);
+        current = sequence.load(std::memory_order_relaxed);
+    }
+}
+
+static_assert(sizeof(std::atomic<quint16>) == sizeof(quint16)
+              && std::atomic<quint16>::is_always_lock_free,
+              "Persistent register stores map the register values directly.");
+static_assert(sizeof(std::atomic<quint32>) == sizeof(quint32)
+              && std::atomic<quint32>::is_always_lock_free,
+              "Persistent register stores map the write markers directly.");
+
+static bool flushMapping(const uchar *address, qint64 length)
+{
+#if defined(Q_OS_UNIX)
+    // msync() requires a page aligned address, the mapping itself starts on a page.
+    static const quintptr pageSize = quintptr(sysconf(_SC_PAGESIZE));
+    const quintptr start = quintptr(address) & ~(pageSize - 1);
+    return msync(reinterpret_cast<void *>(start), size_t(quintptr(address) - start + length),
+                 MS_SYNC) == 0;
+#elif defined(Q_OS_WIN)
+    return FlushViewOfFile(address, SIZE_T(length));
+#else
+    Q_UNUSED(address);
+    Q_UNUSED(length);
+    return true;
+#endif
+}
+
+void QModbusRegisterStorePrivate::setupTables(const QModbusDataUnitMap &map)
+{
+    for (auto it = map.cbegin(); it != map.cend(); ++it) {
+        const QModbusDataUnit::RegisterType type = it.key();
+        const QModbusDataUnit &unit = it.value();
+        if (type <= QModbusDataUnit::Invalid || type > QModbusDataUnit::HoldingRegisters
+                || !unit.isValid()) {
+            continue;
+        }
+        m_tables[type].startAddress = unit.startAddress();
+        m_tables[type].valueCount = unit.valueCount();
+    }
+}
+
+/*
+    Points the tables at consecutive values starting at \a base, or at separately
+    allocated values if \a base is \c nullptr.
+*/
+void QModbusRegisterStorePrivate::assignValues(uchar *base)
+{
+    auto values = reinterpret_cast<std::atomic<quint16> *>(base);
+    for (Table &t : m_tables) {
+        if (!t.isValid())
+            continue;
+        if (values) {
+            t.heapValues.reset();
+            t.values = values;
+            values += t.valueCount;
+        } else {
+            t.heapValues.reset(new std::atomic<quint16>[t.valueCount]);
+            t.values = t.heapValues.get();
+            t.writeMarker = nullptr;
+        }
+    }
+}
+
+void QModbusRegisterStorePrivate::loadValues(const QModbusDataUnitMap &map)
+{
+    for (auto it = map.cbegin(); it != map.cend(); ++it) {
+        Table *t = table(it.key());
+        if (!t)
+            continue;
+        const QList<quint16> values = it.value().values();
+        for (qsizetype i = 0; i < t->valueCount; ++i)
+            t->values[i].store(i < values.size() ? values.at(i) : 0, std::memory_order_relaxed);
+    }
+}
+
+qsizetype QModbusRegisterStorePrivate::totalValueCount() const
+{
+    qsizetype count = 0;
+    for (const Table &t : m_tables)
+        count += t.valueCount;
+    return count;
+}
+
+QModbusRegisterStorePrivate::CheckpointHeader *
+QModbusRegisterStorePrivate::checkpointHeader(int slot) const
+{
+    return reinterpret_cast<CheckpointHeader *>(liveValues() + valuesSize()
+        + slot * (qint64(sizeof(CheckpointHeader)) + valuesSize()));
+}
+
+quint16 *QModbusRegisterStorePrivate::checkpointValues(int slot) const
+{
+    return reinterpret_cast<quint16 *>(checkpointHeader(slot) + 1);
+}
+
+quint16 QModbusRegisterStorePrivate::checkpointChecksum(int slot) const
+{
+    return qChecksum(QByteArrayView(reinterpret_cast<const char *>(checkpointValues(slot)),
+                                    totalValueCount() * 2));
+}
+
+/*
+    Returns the slot holding the newest intact checkpoint, or -1 if there is none.
+*/
+int QModbusRegisterStorePrivate::newestCheckpoint() const
+{
+    int newest = -1;
+    for (int slot = 0; slot < 2; ++slot) {
+        const CheckpointHeader *header = checkpointHeader(slot);
+        if (header->generation == 0 || header->checksum != checkpointChecksum(slot))
+            continue;
+        if (newest < 0 || header->generation > checkpointHeader(newest)->generation)
+            newest = slot;
+    }
+    return newest;
+}
+
+/*
+    Copies the tables whose write marker is set back from the newest intact checkpoint,
+    or every table if \a all is \c true. The other tables keep their live values, which
+    are newer than any checkpoint.
+*/
+void QModbusRegisterStorePrivate::restoreTables(bool all)
+{
+    FileHeader *header = fileHeader();
+    const int slot = newestCheckpoint();
+    const quint16 *source = slot >= 0 ? checkpointValues(slot) : nullptr;
+    for (int type = QModbusDataUnit::DiscreteInputs; type < int(m_tables.size()); ++type) {
+        const Table &t = m_tables[type];
+        if (t.isValid() && (all || header->writeMarker[type - 1])) {
+            const char *reason = all ? "was not closed cleanly before the system restarted, table"
+                                     : "was not closed cleanly during a write to table";
+            if (source) {
+                qCWarning(QT_MODBUS) << "(Register store)" << m_file.fileName() << reason << type
+                                     << "- restoring it from checkpoint"
+                                     << checkpointHeader(slot)->generation;
+                std::memcpy(t.values, source, size_t(t.valueCount * 2));
+            } else {
+                qCWarning(QT_MODBUS) << "(Register store)" << m_file.fileName() << reason << type
+                                     << "and has no intact checkpoint";
+            }
+        }
+        header->writeMarker[type - 1] = 0;
+        if (source)
+            source += t.valueCount;
+    }
+}
+
+/*
+    Returns the identifier of the running system boot, truncated to fit the file header.
+    It is empty if the platform does not provide one.
+*/
+static QByteArray currentBootId()
+{
+    using FileHeader = QModbusRegisterStorePrivate::FileHeader;
+    return QSysInfo::bootUniqueId().left(int(sizeof(FileHeader::bootId)));
+}
+
+bool QModbusRegisterStorePrivate::openFile(const QString &fileName,
+                                           const QModbusDataUnitMap &map)
+{
+    if (totalValueCount() == 0)
+        return failOpen(QModbusRegisterStore::tr("The register map is empty."));
+
+    m_file.setFileName(fileName);
+    const bool created = !m_file.exists() || m_file.size() == 0;
+    if (!m_file.open(QIODevice::ReadWrite))
+        return failOpen(m_file.errorString());
+
+    const qint64 size = fileSize();
+    if (created && !m_file.resize(size))
+        return failOpen(m_file.errorString());
+    if (m_file.size() != size)
+        return failOpen(QModbusRegisterStore::tr("The file does not match the register map."));
+
+    m_mapping = m_file.map(0, size);
+    if (!m_mapping)
+        return failOpen(m_file.errorString());
+
+    FileHeader *header = fileHeader();
+    const QByteArray bootId = currentBootId();
+    if (created) {
+        std::memset(m_mapping, 0, size_t(size));
+        header->magic = FileMagic;
+        header->version = FileVersion;
+        for (int type = QModbusDataUnit::DiscreteInputs; type < int(m_tables.size()); ++type) {
+            header->startAddress[type - 1] = m_tables[type].startAddress;
+            header->valueCount[type - 1] = qint32(m_tables[type].valueCount);
+        }
+        assignValues(liveValues());
+        loadValues(map);
+        if (!checkpoint())
+            return failOpen(QModbusRegisterStore::tr("Cannot write the initial checkpoint."));
+    } else {
+        if (header->magic != FileMagic || header->version != FileVersion)
+            return failOpen(QModbusRegisterStore::tr("The file is not a register store."));
+        for (int type = QModbusDataUnit::DiscreteInputs; type < int(m_tables.size()); ++type) {
+            if (header->startAddress[type - 1] != m_tables[type].startAddress
+                    || header->valueCount[type - 1] != m_tables[type].valueCount) {
+                return failOpen(QModbusRegisterStore::tr("The file does not match the register "
+                                                         "map."));
+            }
+        }
+        assignValues(liveValues());
+
+        // The mapped values survive a crash of the process. Only a table that was being
+        // written at that moment may be inconsistent and falls back to the checkpoint. After
+        // a crash of the system, the live values may be torn or stale anywhere. Without a
+        // boot identifier the two cannot be told apart.
+        if (!header->cleanShutdown) {
+            const QByteArray fileBootId(header->bootId,
+                                        int(qstrnlen(header->bootId, sizeof(header->bootId))));
+            restoreTables(bootId.isEmpty() || fileBootId != bootId);
+        }
+    }
+
+    std::memset(header->bootId, 0, sizeof(header->bootId));
+    std::memcpy(header->bootId, bootId.constData(), size_t(bootId.size()));
+
+    for (int type = QModbusDataUnit::DiscreteInputs; type < int(m_tables.size()); ++type) {
+        m_tables[type].writeMarker =
+                reinterpret_cast<std::atomic<quint32> *>(&header->writeMarker[type - 1]);
+    }
+    header->cleanShutdown = 0;
+    flushMapping(m_mapping, size);
+    return true;
+}
+
+bool QModbusRegisterStorePrivate::failOpen(const QString &errorString)
+{
+    m_errorString = errorString;
+    if (m_mapping)
+        m_file.unmap(m_mapping);
+    m_mapping = nullptr;
+    m_file.close();
+    return false;
+}
+
+void QModbusRegisterStorePrivate::closeFile()
+{
+    if (!m_mapping)
+        return;
+
+    flushMapping(liveValues(), valuesSize());
+    fileHeader()->cleanShutdown = 1;
+    flushMapping(m_mapping, sizeof(FileHeader));
+
+    m_file.unmap(m_mapping);
+    m_mapping = nullptr;
+    m_file.close();
+}
+
+bool QModbusRegisterStorePrivate::checkpoint()
+{
+    if (!m_mapping)
+        return false;
+
+    const int newest = newestCheckpoint();
+    const int slot = newest == 0 ? 1 : 0;
+    const quint64 generation = newest < 0 ? 1 : checkpointHeader(newest)->generation + 1;
+
+    // Invalidate the slot first, so that a torn copy is never mistaken for a checkpoint.
+    CheckpointHeader *header = checkpointHeader(slot);
+    header->generation = 0;
+    if (!flushMapping(reinterpret_cast<uchar *>(header), sizeof(CheckpointHeader)))
+        return false;
+
+    quint16 *target = checkpointValues(slot);
+    for (const Table &t : m_tables) {
+        if (!t.isValid())
+            continue;
+        readRange(t, 0, t.valueCount, target);
+        target += t.valueCount;
+    }
+    if (!flushMapping(reinterpret_cast<uchar *>(checkpointValues(slot)), valuesSize()))
+        return false;
+
+    header->checksum = checkpointChecksum(slot);
+    header->generation = generation;
+    return flushMapping(reinterpret_cast<uchar *>(header), sizeof(CheckpointHeader));
+}
+
+const QModbusRegisterStorePrivate::Table *
+QModbusRegisterStorePrivate::table(QModbusDataUnit::RegisterType type) const
+{
+    if (type <= QModbusDataUnit::Invalid || type > QModbusDataUnit::HoldingRegisters)
+        return nullptr;
+    const Table &t = m_tables[type];
+    return t.isValid() ? &t : nullptr;
+}
+
+QModbusRegisterStorePrivate::Table *
+QModbusRegisterStorePrivate::table(QModbusDataUnit::RegisterType type)
+{
+    return const_cast<Table *>(qAsConst(*this).table(type));
+}
+
+bool QModbusRegisterStorePrivate::write(const QModbusDataUnit &newData, bool *changed)
+{
+    Table *t = table(newData.registerType());
+    const qsizetype count = newData.valueCount();
+    if (!t || !t->contains(newData.startAddress(), count))
+        return false;
+
+    const QList<quint16> values = newData.values();
+    if (values.size() < count)
+        return false;
+
+    const quint16 *source = values.constData();
+    std::atomic<quint16> *target = t->values + (newData.startAddress() - t->startAddress);
+
+    bool changeRequired = false;
+    const quint32 locked = t->lockForWrite();
+    for (qsizetype i = 0; i < count; ++i) {
+        changeRequired |= target[i].load(std::memory_order_relaxed) != source[i];
+        target[i].store(source[i], std::memory_order_relaxed);
+    }
+    t->unlock(locked);
+
+    if (changed)
+        *changed = changeRequired;
+    return true;
+}
+
+bool QModbusRegisterStorePrivate::read(QModbusDataUnit *newData) const
+{
+    if (!newData)
+        return false;
+
+    const Table *t = table(newData->registerType());
+    if (!t)
+        return false;
+
+    // Return the entire table for a negative start address.
+    int address = newData->startAddress();
+    qsizetype count = newData->valueCount();
+    if (address < 0) {
+        address = t->startAddress;
+        count = t->valueCount;
+    } else if (!t->contains(address, count)) {
+        return false;
+    }
+
+    QList<quint16> values(count);
+    readRange(*t, address - t->startAddress, count, values.data());
+
+    newData->setStartAddress(address);
+    newData->setValues(values);
+    return true;
+}
+
+void QModbusRegisterStorePrivate::readRange(const Table &t, qsizetype offset, qsizetype count,
+                                            quint16 *target)
+{
+    const std::atomic<quint16> *source = t.values + offset;
+    for (int spins = 0; ; ++spins) {
+        const quint32 before = t.sequence.load(std::memory_order_acquire);
+        if (before & 1) {
+            backOff(spins);
+            continue;
+        }
+        for (qsizetype i = 0; i < count; ++i)
+            target[i] = source[i].load(std::memory_order_relaxed);
+        // Keep the loads above from being reordered after the second sequence check.
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (t.sequence.load(std::memory_order_relaxed) == before)
+            return;
+        backOff(spins);
+    }
+}
+
+/*!
+    Constructs a register store with the tables described by \a map. Each
+    table covers the start address and value count of its data unit and is
+    initialized with the unit's values.
+
+    Tables that are not part of \a map, or whose unit is invalid, cannot be
+    read or written.
+*/
+QModbusRegisterStore::QModbusRegisterStore(const QModbusDataUnitMap &map)
+    : d_ptr(new QModbusRegisterStorePrivate)
+{
+    Q_D(QModbusRegisterStore);
+    d->setupTables(map);
+    d->assignValues(nullptr);
+    d->loadValues(map);
+}
+
+/*!
+    Constructs a persistent register store with the tables described by \a map
+    whose values are kept in the file \a fileName.
+
+    If the file does not exist, it is created and initialized with the values
+    of \a map. Otherwise the values stored in the file are used and the values
+    of \a map are ignored; the file must have been created for the same table
+    layout. If the file cannot be used, the store falls back to memory only
+    storage initialized from \a map, isPersistent() returns \c false and
+    errorString() describes the problem.
+
+    The file is memory mapped, so writes to the store reach the operating
+    system's page cache without any system call and survive a crash of the
+    application. To survive a power loss or operating system crash as well,
+    call checkpoint() periodically. The file keeps the two most recent
+    checkpoints. If the store was not destroyed cleanly, for example because
+    the process was killed, the next store opening the file continues with the
+    values that were written last. Only a table that was being written at the
+    moment of the crash restarts from the newest intact checkpoint. If the
+    system was restarted since the file was opened, or the platform cannot tell
+    (see QSysInfo::bootUniqueId()), every table restarts from the newest
+    intact checkpoint, because the values written since then may not have
+    reached the disk completely. Each table
+    of a checkpoint is a consistent snapshot on its own, tables are not
+    synchronized with each other.
+
+    Only one store may use a file at a time. The file is written in host byte
+    order and cannot be moved between machines of different endianness.
+
+    \since 6.1
+    \sa checkpoint(), QModbusServer::setMap()
+*/
+QModbusRegisterStore::QModbusRegisterStore(const QModbusDataUnitMap &map, const QString &fileName)
+    : d_ptr(new QModbusRegisterStorePrivate)
+{
+    Q_D(QModbusRegisterStore);
+    d->setupTables(map);
+    if (!d->openFile(fileName, map)) {
+        qCWarning(QT_MODBUS) << "(Register store) Cannot use" << fileName << "for persistence:"
+                             << d->m_errorString;
+        d->assignValues(nullptr);
+        d->loadValues(map);
+    }
+}
+
+/*!
+    Destroys the register store. No thread may access the store anymore, and
+    it must not be installed in a QModbusServer.
+
+    A persistent store flushes its values and marks the file as cleanly
+    closed.
+*/
+QModbusRegisterStore::~QModbusRegisterStore() = default;
+
+/*!
+    Returns \c true if the store has a \a table; otherwise returns \c false.
+*/
+bool QModbusRegisterStore::contains(QModbusDataUnit::RegisterType table) const
+{
+    Q_D(const QModbusRegisterStore);
+    return d->table(table) != nullptr;
+}
+
+/*!
+    Writes \a newData to the store. Returns \c false if the register type does
+    not exist in the store or the range of \a newData is outside of the table.
+
+    All registers of \a newData become visible to readers at once. This
+    function is thread-safe.
+*/
+bool QModbusRegisterStore::setData(const QModbusDataUnit &newData)
+{
+    Q_D(QModbusRegisterStore);
+    return d->write(newData, nullptr);
+}
+
+/*!
+    \overload
+
+    Writes \a data to the register at \a address of \a table.
+*/
+bool QModbusRegisterStore::setData(QModbusDataUnit::RegisterType table, quint16 address,
+                                   quint16 data)
+{
+    Q_D(QModbusRegisterStore);
+    return d->write(QModbusDataUnit(table, address, QList<quint16> { data }), nullptr);
+}
+
+/*!
+    Reads the register range given by \a newData and writes the values back to
+    \a newData. A negative start address returns the entire table. Returns
+    \c false if \a newData is \c nullptr, the register type does not exist in
+    the store or the range is outside of the table.
+
+    The values are a consistent snapshot, they never mix registers from before
+    and after a concurrent write. This function is thread-safe.
+*/
+bool QModbusRegisterStore::data(QModbusDataUnit *newData) const
+{
+    Q_D(const QModbusRegisterStore);
+    return d->read(newData);
+}
+
+/*!
+    \overload
+
+    Reads the register at \a address of \a table into \a data.
+*/
+bool QModbusRegisterStore::data(QModbusDataUnit::RegisterType table, quint16 address,
+                                quint16 *data) const
+{
+    Q_D(const QModbusRegisterStore);
+    QModbusDataUnit unit(table, address, 1u);
+    if (data && d->read(&unit)) {
+        *data = unit.value(0);
+        return true;
+    }
+    return false;
+}
+
+/*!
+    Returns \c true if the values of the store are kept in a file; otherwise
+    returns \c false.
+
+    \since 6.1
+    \sa fileName(), errorString()
+*/
+bool QModbusRegisterStore::isPersistent() const
+{
+    Q_D(const QModbusRegisterStore);
+    return d->m_mapping != nullptr;
+}
+
+/*!
+    Returns the name of the file the store was constructed with, or an empty
+    string for a memory only store.
+
+    \since 6.1
+*/
+QString QModbusRegisterStore::fileName() const
+{
+    Q_D(const QModbusRegisterStore);
+    return d->m_file.fileName();
+}
+
+/*!
+    Returns a description of why the file given to the constructor could not
+    be used, or an empty string if no error occurred.
+
+    \since 6.1
+*/
+QString QModbusRegisterStore::errorString() const
+{
+    Q_D(const QModbusRegisterStore);
+    return d->m_errorString;
+}
+
+/*!
+    Takes a snapshot of all tables and writes it to the file, replacing the
+    older of the two checkpoints kept in the file. The function returns once
+    the snapshot is stored durably. Returns \c false if the store is not
+    persistent or the file could not be flushed.
+
+    Writers are only held up for the time needed to copy a table. This
+    function may be called from any thread, but not from several threads at
+    once.
+
+    \since 6.1
+*/
+bool QModbusRegisterStore::checkpoint()
+{
+    Q_D(QModbusRegisterStore);
+    return d->checkpoint();
+}
+
+QT_END_NAMESPACE
@@ -0,0 +1,78 @@
+/****************************************************************************
+**
+** Copyright (C) 2021 The Qt Company Ltd.
+** Contact: http://www.qt.io/licensing/
+**
+** This file is part of the QtSerialBus module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL3$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see http://www.qt.io/terms-conditions. For further
+** information use the contact form at http://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPLv3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or later as published by the Free
+** Software Foundation and appearing in the file LICENSE.GPL included in
+** the packaging of this file. Please review the following information to
+** ensure the GNU General Public License version 2.0 requirements will be
+** met: http://www.gnu.org/licenses/gpl-2.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#ifndef QMODBUSREGISTERSTORE_H
+#define QMODBUSREGISTERSTORE_H
+
+#include <QtCore/qcoreapplication.h>
+#include <QtCore/qscopedpointer.h>
+#include <QtSerialBus/qmodbusdataunit.h>
+
+QT_BEGIN_NAMESPACE
+
+class QModbusRegisterStorePrivate;
+
+class Q_SERIALBUS_EXPORT QModbusRegisterStore
+{
+    Q_DECLARE_PRIVATE(QModbusRegisterStore)
+    Q_DECLARE_TR_FUNCTIONS(QModbusRegisterStore)
+
+public:
+    explicit QModbusRegisterStore(const QModbusDataUnitMap &map);
+    QModbusRegisterStore(const QModbusDataUnitMap &map, const QString &fileName);
+    ~QModbusRegisterStore();
+
+    bool contains(QModbusDataUnit::RegisterType table) const;
+
+    bool setData(const QModbusDataUnit &newData);
+    bool setData(QModbusDataUnit::RegisterType table, quint16 address, quint16 data);
+
+    bool data(QModbusDataUnit *newData) const;
+    bool data(QModbusDataUnit::RegisterType table, quint16 address, quint16 *data) const;
+
+    bool isPersistent() const;
+    QString fileName() const;
+    QString errorString() const;
+    bool checkpoint();
+
+private:
+    Q_DISABLE_COPY(QModbusRegisterStore)
+    QScopedPointer<QModbusRegisterStorePrivate> d_ptr;
+};
+
+QT_END_NAMESPACE
+
+#endif // QMODBUSREGISTERSTORE_H
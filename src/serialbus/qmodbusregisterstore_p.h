@@ -0,0 +1,177 @@
+/****************************************************************************
+**
+** Copyright (C) 2021 The Qt Company Ltd.
+** Contact: http://www.qt.io/licensing/
+**
+** This file is part of the QtSerialBus module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL3$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see http://www.qt.io/terms-conditions. For further
+** information use the contact form at http://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPLv3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or later as published by the Free
+** Software Foundation and appearing in the file LICENSE.GPL included in
+** the packaging of this file. Please review the following information to
+** ensure the GNU General Public License version 2.0 requirements will be
+** met: http://www.gnu.org/licenses/gpl-2.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#ifndef QMODBUSREGISTERSTORE_P_H
+#define QMODBUSREGISTERSTORE_P_H
+
+#include <QtCore/qfile.h>
+#include <QtSerialBus/qmodbusregisterstore.h>
+
+#include <array>
+#include <atomic>
+#include <memory>
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API. It exists purely as an
+// implementation detail. This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+//
+
+QT_BEGIN_NAMESPACE
+
+class QModbusRegisterStorePrivate
+{
+public:
+    /*
+        One register table guarded by a sequence lock. The sequence is odd while a
+        writer updates the values; readers copy the values and retry if the sequence
+        was odd or changed meanwhile. Writers exclude each other by moving the sequence
+        from even to odd with a compare and swap, readers never write shared state.
+    */
+    struct Table
+    {
+        alignas(64) std::atomic<quint32> sequence { 0 };
+        int startAddress = 0;
+        qsizetype valueCount = 0;
+        // Points into heapValues, or into the file mapping of a persistent store.
+        std::atomic<quint16> *values = nullptr;
+        std::unique_ptr<std::atomic<quint16>[]> heapValues;
+        // Points into the file header of a persistent store, nonzero while a write is
+        // in progress so that a torn write can be told apart after a crash.
+        std::atomic<quint32> *writeMarker = nullptr;
+
+        bool isValid() const { return valueCount > 0; }
+        bool contains(int address, qsizetype count) const
+        {
+            return address >= startAddress && count > 0
+                && address - startAddress + count <= valueCount;
+        }
+
+        quint32 lockForWrite();
+        void unlock(quint32 locked)
+        {
+            if (writeMarker)
+                writeMarker->store(0, std::memory_order_release);
+            sequence.store(locked + 1, std::memory_order_release);
+        }
+    };
+
+    ~QModbusRegisterStorePrivate() { closeFile(); }
+
+    static QModbusRegisterStorePrivate *get(QModbusRegisterStore *store) { return store->d_func(); }
+
+    const Table *table(QModbusDataUnit::RegisterType type) const;
+    Table *table(QModbusDataUnit::RegisterType type);
+
+    bool write(const QModbusDataUnit &newData, bool *changed);
+    bool read(QModbusDataUnit *newData) const;
+    static void readRange(const Table &t, qsizetype offset, qsizetype count, quint16 *target);
+
+    /*
+        A persistent store maps a file with this layout, all fields in host byte order:
+
+            FileHeader
+            live values of all tables, in RegisterType order
+            two CheckpointHeader and values pairs
+
+        The live values are the ones readers and writers use. A checkpoint copies them
+        into the older of the two slots and only then stamps the slot with a higher
+        generation, so at least one slot always holds a complete snapshot. A store that
+        was not closed cleanly keeps its live values if the system is still running since
+        the file was opened, except for tables whose write marker shows that a write was
+        cut short; those restart from the newest intact checkpoint. After a restart of the
+        system the mapped pages may have reached the disk in any order, so every table
+        restarts from the newest intact checkpoint.
+    */
+    struct FileHeader
+    {
+        quint32 magic;
+        quint32 version;
+        quint32 cleanShutdown;
+        quint32 reserved;
+        qint32 startAddress[4];
+        qint32 valueCount[4];
+        quint32 writeMarker[4];
+        char bootId[40]; // QSysInfo::bootUniqueId() when the file was opened
+    };
+    struct CheckpointHeader
+    {
+        quint64 generation; // 0 marks a slot that never held a checkpoint
+        quint16 checksum;
+        quint8 padding[6];
+    };
+    static constexpr quint32 FileMagic = 0x51524d53; // "QRMS"
+    static constexpr quint32 FileVersion = 2;
+
+    void setupTables(const QModbusDataUnitMap &map);
+    void assignValues(uchar *base);
+    void loadValues(const QModbusDataUnitMap &map);
+
+    bool openFile(const QString &fileName, const QModbusDataUnitMap &map);
+    bool failOpen(const QString &errorString);
+    void closeFile();
+    bool checkpoint();
+
+    qsizetype totalValueCount() const;
+    qint64 valuesSize() const { return (qint64(totalValueCount()) * 2 + 7) & ~qint64(7); }
+    qint64 fileSize() const
+    {
+        return qint64(sizeof(FileHeader)) + 3 * valuesSize() + 2 * qint64(sizeof(CheckpointHeader));
+    }
+    FileHeader *fileHeader() const { return reinterpret_cast<FileHeader *>(m_mapping); }
+    uchar *liveValues() const { return m_mapping + sizeof(FileHeader); }
+    CheckpointHeader *checkpointHeader(int slot) const;
+    quint16 *checkpointValues(int slot) const;
+    quint16 checkpointChecksum(int slot) const;
+    int newestCheckpoint() const;
+    void restoreTables(bool all);
+
+    // Indexed by QModbusDataUnit::RegisterType, the Invalid slot stays unused.
+    std::array<Table, QModbusDataUnit::HoldingRegisters + 1> m_tables;
+
+    QFile m_file;
+    uchar *m_mapping = nullptr;
+    QString m_errorString;
+};
+
+QT_END_NAMESPACE
+
+#endif // QMODBUSREGISTERSTORE_P_H
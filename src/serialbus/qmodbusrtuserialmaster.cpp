@@ -55,6 +55,11 @@ Q_DECLARE_LOGGING_CATEGORY(QT_MODBUS_LOW)
     Communication via Modbus requires the interaction between a single
     Modbus client instance and multiple Modbus servers. This class
     provides the client implementation via a serial port.
+
+    Frames are exchanged in RTU transmission mode by default. Since Qt 6.1 the
+    ASCII transmission mode can be selected by setting the
+    \l {QModbusDevice::}{SerialTransmissionModeParameter} connection parameter
+    to \l {QModbusDevice::}{AsciiTransmissionMode}.
 */
 
 /*!
@@ -189,7 +194,7 @@ void QModbusRtuSerialMaster::close()
     }
 
     if (numberOfAborts > 0)
-        qCDebug(QT_MODBUS_LOW) << "(RTU client) Aborted replies:" << numberOfAborts;
+        qCDebug(QT_MODBUS_LOW) << d->logPrefix() << "Aborted replies:" << numberOfAborts;
 
     setState(QModbusDevice::UnconnectedState);
 }
@@ -108,73 +108,96 @@ class QModbusRtuSerialMasterPrivate : public QModbusClientPrivate
 public:
     void onReadyRead()
     {
-        m_responseBuffer += m_serialPort->read(m_serialPort->bytesAvailable());
-        qCDebug(QT_MODBUS_LOW) << "(RTU client) Response buffer:" << m_responseBuffer.toHex();
+        const qint64 size = m_serialPort->bytesAvailable();
+        m_readBuffer.resize(size);
+        const qint64 read = qMax<qint64>(0, m_serialPort->read(m_readBuffer.data(), size));
+        qCDebug(QT_MODBUS_LOW) << logPrefix() << "Response buffer:"
+                               << QByteArray::fromRawData(m_readBuffer.constData(), read).toHex();
+
+        if (m_asciiMode)
+            onAsciiReadyRead(read);
+        else
+            onRtuReadyRead(read);
+    }
 
-        if (m_responseBuffer.size() < 2) {
-            qCDebug(QT_MODBUS) << "(RTU client) Modbus ADU not complete";
-            return;
+    void onRtuReadyRead(qint64 read)
+    {
+        qint64 offset = 0;
+        while (offset < read) {
+            // The assembler stops at the end of the frame, so a complete response is handled
+            // right away, without waiting for more data or the response timeout.
+            offset += m_responseFrame.append(m_readBuffer.constData() + offset, read - offset);
+
+            if (m_responseFrame.state() == QModbusRtuFrameAssembler<QModbusResponse>::Overrun) {
+                qCDebug(QT_MODBUS) << logPrefix() << "Cannot calculate ADU size, dropping pending"
+                                      " bytes";
+                return;
+            }
+            if (m_responseFrame.state() != QModbusRtuFrameAssembler<QModbusResponse>::Complete) {
+                qCDebug(QT_MODBUS) << logPrefix() << "Modbus ADU not complete";
+                return;
+            }
+            if (processResponseFrame(m_responseFrame))
+                return; // any further bytes are cleared before the next request is sent
         }
+    }
 
-        const QModbusSerialAdu tmpAdu(QModbusSerialAdu::Rtu, m_responseBuffer);
-        int pduSizeWithoutFcode = QModbusResponse::calculateDataSize(tmpAdu.pdu());
-        if (pduSizeWithoutFcode < 0) {
-            // wait for more data
-            qCDebug(QT_MODBUS) << "(RTU client) Cannot calculate PDU size for function code:"
-                << tmpAdu.pdu().functionCode() << ", delaying pending frame";
-            return;
+    void onAsciiReadyRead(qint64 read)
+    {
+        qint64 offset = 0;
+        while (offset < read) {
+            offset += m_asciiResponseFrame.append(m_readBuffer.constData() + offset, read - offset);
+
+            if (m_asciiResponseFrame.state() == QModbusAsciiFrameAssembler<QModbusResponse>::Overrun) {
+                // The next colon starts a new frame, keep decoding from there.
+                qCDebug(QT_MODBUS) << "(ASCII client) Malformed ADU received, ignoring";
+                m_asciiResponseFrame.reset();
+                continue;
+            }
+            if (m_asciiResponseFrame.state() != QModbusAsciiFrameAssembler<QModbusResponse>::Complete) {
+                qCDebug(QT_MODBUS) << "(ASCII client) Modbus ADU not complete";
+                return;
+            }
+            if (processResponseFrame(m_asciiResponseFrame))
+                return; // any further bytes are cleared before the next request is sent
         }
+    }
 
-        // server address byte + function code byte + PDU size + 2 bytes CRC
-        int aduSize = 2 + pduSizeWithoutFcode + 2;
-        if (tmpAdu.rawSize() < aduSize) {
-            qCDebug(QT_MODBUS) << "(RTU client) Incomplete ADU received, ignoring";
-            return;
-        }
+    // Returns true if the response finished the current request.
+    template <typename Frame>
+    bool processResponseFrame(Frame &frame)
+    {
+        qCDebug(QT_MODBUS) << logPrefix() << "Received ADU:" << frame.rawData().toHex();
+
+        const int serverAddress = frame.serverAddress();
+        const bool matchingChecksum = frame.matchingChecksum();
+        const uint checksum = frame.checksum();
+        const uint calculatedChecksum = matchingChecksum ? checksum : frame.calculatedChecksum();
+        const QModbusResponse response = frame.pdu();
+        m_statistics.addBytesReceived(response.functionCode(), frame.rawData().size());
+        frame.reset();
 
         if (m_queue.isEmpty())
-            return;
+            return true;
         auto &current = m_queue.first();
 
-        // Special case for Diagnostics:ReturnQueryData. The response has no
-        // length indicator and is just a simple echo of what we have send.
-        if (tmpAdu.pdu().functionCode() == QModbusPdu::Diagnostics) {
-            const QModbusResponse response = tmpAdu.pdu();
-            if (canMatchRequestAndResponse(response, tmpAdu.serverAddress())) {
-                quint16 subCode = 0xffff;
-                response.decodeData(&subCode);
-                if (subCode == Diagnostics::ReturnQueryData) {
-                    if (response.data() != current.requestPdu.data())
-                        return; // echo does not match request yet
-                    aduSize = 2 + response.dataSize() + 2;
-                    if (tmpAdu.rawSize() < aduSize)
-                        return; // echo matches, probably checksum missing
-                }
-            }
-        }
-
-        const QModbusSerialAdu adu(QModbusSerialAdu::Rtu, m_responseBuffer.left(aduSize));
-        m_responseBuffer.remove(0, aduSize);
-
-        qCDebug(QT_MODBUS) << "(RTU client) Received ADU:" << adu.rawData().toHex();
-        if (QT_MODBUS().isDebugEnabled() && !m_responseBuffer.isEmpty())
-            qCDebug(QT_MODBUS_LOW) << "(RTU client) Pending buffer:" << m_responseBuffer.toHex();
-
-        // check CRC
-        if (!adu.matchingChecksum()) {
-            qCWarning(QT_MODBUS) << "(RTU client) Discarding response with wrong CRC, received:"
-                << adu.checksum<quint16>() << ", calculated CRC:"
-                << QModbusSerialAdu::calculateCRC(adu.data(), adu.size());
-            m_queue.first().reply->addIntermediateError(QModbusClient::ResponseCrcError);
-            return;
+        // check CRC or LRC
+        if (!matchingChecksum) {
+            qCWarning(QT_MODBUS) << logPrefix() << "Discarding response with wrong checksum, received:"
+                << checksum << ", calculated:" << calculatedChecksum;
+            current.reply->addIntermediateError(QModbusClient::ResponseCrcError);
+            return false;
         }
 
-        const QModbusResponse response = adu.pdu();
-        if (!canMatchRequestAndResponse(response, adu.serverAddress())) {
-            qCWarning(QT_MODBUS) << "(RTU client) Cannot match response with open request, "
+        // Special case for Diagnostics:ReturnQueryData. The response has no length indicator
+        // and is just a simple echo of what we have send, the frame was sized after the request.
+        const bool mismatchingEcho = isReturnQueryData(current.requestPdu)
+            && isReturnQueryData(response) && response.data() != current.requestPdu.data();
+        if (mismatchingEcho || !canMatchRequestAndResponse(response, serverAddress)) {
+            qCWarning(QT_MODBUS) << logPrefix() << "Cannot match response with open request, "
                 "ignoring";
-            m_queue.first().reply->addIntermediateError(QModbusClient::ResponseRequestMismatch);
-            return;
+            current.reply->addIntermediateError(QModbusClient::ResponseRequestMismatch);
+            return false;
         }
 
         m_state = ProcessReply;
@@ -185,6 +208,16 @@ public:
 
         m_state = Idle;
         scheduleNextRequest(m_interFrameDelayMilliseconds);
+        return true;
+    }
+
+    static bool isReturnQueryData(const QModbusPdu &pdu)
+    {
+        if (pdu.isException() || pdu.functionCode() != QModbusPdu::Diagnostics)
+            return false;
+        quint16 subCode = 0xffff;
+        pdu.decodeData(&subCode);
+        return subCode == Diagnostics::ReturnQueryData;
     }
 
     void onAboutToClose()
@@ -206,9 +239,10 @@ public:
         if (current.m_timerId != timerId)
             return;
 
-        qCDebug(QT_MODBUS) << "(RTU client) Receive timeout:" << current.requestPdu;
+        qCDebug(QT_MODBUS) << logPrefix() << "Receive timeout:" << current.requestPdu;
 
         if (current.numberOfRetries <= 0) {
+            m_statistics.addTimeout(current.requestPdu.functionCode());
             auto item = m_queue.dequeue();
             if (item.reply) {
                 item.reply->setError(QModbusDevice::TimeoutError,
@@ -227,10 +261,11 @@ public:
         auto &current = m_queue.first();
 
         current.bytesWritten += bytes;
+        m_statistics.addBytesSent(current.requestPdu.functionCode(), bytes);
         if (current.bytesWritten != current.adu.size())
             return;
 
-        qCDebug(QT_MODBUS) << "(RTU client) Send successful:" << current.requestPdu;
+        qCDebug(QT_MODBUS) << logPrefix() << "Send successful:" << current.requestPdu;
 
         if (!current.reply.isNull() && current.reply->type() == QModbusReply::Broadcast) {
             m_state = ProcessReply;
@@ -247,7 +282,7 @@ public:
         if (error == QSerialPort::NoError)
             return;
 
-        qCDebug(QT_MODBUS) << "(RTU server) QSerialPort error:" << error
+        qCDebug(QT_MODBUS) << logPrefix() << "QSerialPort error:" << error
             << (m_serialPort ? m_serialPort->errorString() : QString());
 
         Q_Q(QModbusRtuSerialMaster);
@@ -286,7 +321,7 @@ public:
             q->setError(QModbusDevice::tr("Unknown error."), QModbusDevice::UnknownError);
             break;
         default:
-            qCDebug(QT_MODBUS) << "(RTU server) Unhandled QSerialPort error" << error;
+            qCDebug(QT_MODBUS) << logPrefix() << "Unhandled QSerialPort error" << error;
             break;
         }
     }
@@ -330,7 +365,9 @@ public:
 
         calculateInterFrameDelay();
 
-        m_responseBuffer.clear();
+        m_asciiMode = (m_transmissionMode == QModbusDevice::AsciiTransmissionMode);
+        m_responseFrame.reset();
+        m_asciiResponseFrame.reset();
         m_state = QModbusRtuSerialMasterPrivate::Idle;
     }
 
@@ -342,7 +379,9 @@ public:
         auto reply = new QModbusReply(serverAddress == 0 ? QModbusReply::Broadcast : type,
             serverAddress, q);
         QueueElement element(reply, request, unit, m_numberOfRetries + 1);
-        element.adu = QModbusSerialAdu::create(QModbusSerialAdu::Rtu, serverAddress, request);
+        element.adu = QModbusSerialAdu::create(m_asciiMode ? QModbusSerialAdu::Ascii
+                                                           : QModbusSerialAdu::Rtu,
+                                               serverAddress, request);
         m_queue.enqueue(element);
 
         scheduleNextRequest(m_interFrameDelayMilliseconds);
@@ -362,12 +401,15 @@ public:
 
     void processQueue()
     {
-        m_responseBuffer.clear();
+        m_responseFrame.reset();
+        m_asciiResponseFrame.reset();
         m_serialPort->clear(QSerialPort::AllDirections);
 
         if (m_queue.isEmpty())
             return;
         auto &current = m_queue.first();
+        m_responseFrame.setEcho(current.reply ? current.reply->serverAddress() : -1,
+            isReturnQueryData(current.requestPdu) ? current.requestPdu : QModbusRequest());
 
         if (current.reply.isNull()) {
             m_queue.dequeue();
@@ -378,8 +420,16 @@ public:
             current.numberOfRetries--;
             m_serialPort->write(current.adu);
 
-            qCDebug(QT_MODBUS) << "(RTU client) Sent Serial PDU:" << current.requestPdu;
-            qCDebug(QT_MODBUS_LOW).noquote() << "(RTU client) Sent Serial ADU: 0x" + current.adu
+            // The elapsed timer is only valid if the request was sent before, so this is a retry.
+            const QModbusPdu::FunctionCode code = current.requestPdu.functionCode();
+            if (current.sent.isValid())
+                m_statistics.addRetry(code);
+            else
+                m_statistics.addRequest(code);
+            current.sent.start();
+
+            qCDebug(QT_MODBUS) << logPrefix() << "Sent Serial PDU:" << current.requestPdu;
+            qCDebug(QT_MODBUS_LOW).noquote() << logPrefix() << "Sent Serial ADU: 0x" + current.adu
                 .toHex();
         }
     }
@@ -409,7 +459,13 @@ public:
     QIODevice *device() const override { return m_serialPort; }
 
     Timer m_responseTimer;
-    QByteArray m_responseBuffer;
+    QModbusRtuFrameAssembler<QModbusResponse> m_responseFrame;
+    QModbusAsciiFrameAssembler<QModbusResponse> m_asciiResponseFrame;
+    bool m_asciiMode = false;
+
+    // Log messages name the transmission mode in use.
+    const char *logPrefix() const { return m_asciiMode ? "(ASCII client)" : "(RTU client)"; }
+    QByteArray m_readBuffer;
 
     QQueue<QueueElement> m_queue;
     QSerialPort *m_serialPort = nullptr;
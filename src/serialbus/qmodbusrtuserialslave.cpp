@@ -56,6 +56,11 @@ QT_BEGIN_NAMESPACE
     Since multiple Modbus server instances can interact with a Modbus client
     at the same time (using a serial bus), servers are identified by their
     \l serverAddress().
+
+    Frames are exchanged in RTU transmission mode by default. Since Qt 6.1 the
+    ASCII transmission mode can be selected by setting the
+    \l {QModbusDevice::}{SerialTransmissionModeParameter} connection parameter
+    to \l {QModbusDevice::}{AsciiTransmissionMode}.
 */
 
 /*!
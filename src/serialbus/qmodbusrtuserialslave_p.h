@@ -75,209 +75,10 @@ public:
 
         m_serialPort = new QSerialPort(q);
         QObject::connect(m_serialPort, &QSerialPort::readyRead, q, [this]() {
-
-            if (m_interFrameTimer.isValid()
-                    && m_interFrameTimer.elapsed() > m_interFrameDelayMilliseconds
-                    && !m_requestBuffer.isEmpty()) {
-                // This permits response buffer clearing if it contains garbage
-                // but still permits cases where very slow baud rates can cause
-                // chunked and delayed packets
-                qCDebug(QT_MODBUS_LOW) << "(RTU server) Dropping older ADU fragments due to larger than 3.5 char delay (expected:"
-                                       << m_interFrameDelayMilliseconds << ", max:"
-                                       << m_interFrameTimer.elapsed() << ")";
-                m_requestBuffer.clear();
-            }
-
-            m_interFrameTimer.start();
-
-            const qint64 size = m_serialPort->size();
-            m_requestBuffer += m_serialPort->read(size);
-
-            const QModbusSerialAdu adu(QModbusSerialAdu::Rtu, m_requestBuffer);
-            qCDebug(QT_MODBUS_LOW) << "(RTU server) Received ADU:" << adu.rawData().toHex();
-
-            // Index                         -> description
-            // Server address                -> 1 byte
-            // FunctionCode                  -> 1 byte
-            // FunctionCode specific content -> 0-252 bytes
-            // CRC                           -> 2 bytes
-            Q_Q(QModbusRtuSerialSlave);
-            QModbusCommEvent event = QModbusCommEvent::ReceiveEvent;
-            if (q->value(QModbusServer::ListenOnlyMode).toBool())
-                event |= QModbusCommEvent::ReceiveFlag::CurrentlyInListenOnlyMode;
-
-            // We expect at least the server address, function code and CRC.
-            if (adu.rawSize() < 4) { // TODO: LRC should be 3 bytes.
-                qCWarning(QT_MODBUS) << "(RTU server) Incomplete ADU received, ignoring";
-
-                // The quantity of CRC errors encountered by the remote device since its last
-                // restart, clear counters operation, or power-up. In case of a message
-                // length < 4 bytes, the receiving device is not able to calculate the CRC.
-                incrementCounter(QModbusServerPrivate::Counter::BusCommunicationError);
-                storeModbusCommEvent(event | QModbusCommEvent::ReceiveFlag::CommunicationError);
-                return;
-            }
-
-            // Server address is set to 0, this is a broadcast.
-            m_processesBroadcast = (adu.serverAddress() == 0);
-            if (q->processesBroadcast())
-                event |= QModbusCommEvent::ReceiveFlag::BroadcastReceived;
-
-            const int pduSizeWithoutFcode = QModbusRequest::calculateDataSize(adu.pdu());
-
-            // server address byte + function code byte + PDU size + 2 bytes CRC
-            if ((pduSizeWithoutFcode < 0) || ((2 + pduSizeWithoutFcode + 2) != adu.rawSize())) {
-                qCWarning(QT_MODBUS) << "(RTU server) ADU does not match expected size, ignoring";
-                // The quantity of messages addressed to the remote device that it could not
-                // handle due to a character overrun condition, since its last restart, clear
-                // counters operation, or power-up. A character overrun is caused by data
-                // characters arriving at the port faster than they can be stored, or by the loss
-                // of a character due to a hardware malfunction.
-                incrementCounter(QModbusServerPrivate::Counter::BusCharacterOverrun);
-                storeModbusCommEvent(event | QModbusCommEvent::ReceiveFlag::CharacterOverrun);
-                return;
-            }
-
-            // We received the full message, including checksum. We do not expect more bytes to
-            // arrive, so clear the buffer. All new bytes are considered part of the next message.
-            m_requestBuffer.resize(0);
-
-            if (!adu.matchingChecksum()) {
-                qCWarning(QT_MODBUS) << "(RTU server) Discarding request with wrong CRC, received:"
-                                     << adu.checksum<quint16>() << ", calculated CRC:"
-                                     << QModbusSerialAdu::calculateCRC(adu.data(), adu.size());
-                // The quantity of CRC errors encountered by the remote device since its last
-                // restart, clear counters operation, or power-up.
-                incrementCounter(QModbusServerPrivate::Counter::BusCommunicationError);
-                storeModbusCommEvent(event | QModbusCommEvent::ReceiveFlag::CommunicationError);
-                return;
-            }
-
-            // The quantity of messages that the remote device has detected on the communications
-            // system since its last restart, clear counters operation, or power-up.
-            incrementCounter(QModbusServerPrivate::Counter::BusMessage);
-
-            // If we do not process a Broadcast ...
-            if (!q->processesBroadcast()) {
-                // check if the server address matches ...
-                if (q->serverAddress() != adu.serverAddress()) {
-                    // no, not our address! Ignore!
-                    qCDebug(QT_MODBUS) << "(RTU server) Wrong server address, expected"
-                        << q->serverAddress() << "got" << adu.serverAddress();
-                    return;
-                }
-            } // else { Broadcast -> Server address will never match, deliberately ignore }
-
-            storeModbusCommEvent(event); // store the final event before processing
-
-            const QModbusRequest req = adu.pdu();
-            qCDebug(QT_MODBUS) << "(RTU server) Request PDU:" << req;
-            QModbusResponse response; // If the device ...
-            if (q->value(QModbusServer::DeviceBusy).value<quint16>() == 0xffff) {
-                // is busy, update the quantity of messages addressed to the remote device for
-                // which it returned a Server Device Busy exception response, since its last
-                // restart, clear counters operation, or power-up.
-                incrementCounter(QModbusServerPrivate::Counter::ServerBusy);
-                response = QModbusExceptionResponse(req.functionCode(),
-                    QModbusExceptionResponse::ServerDeviceBusy);
-            } else {
-                // is not busy, update the quantity of messages addressed to the remote device,
-                // or broadcast, that the remote device has processed since its last restart,
-                // clear counters operation, or power-up.
-                incrementCounter(QModbusServerPrivate::Counter::ServerMessage);
-                response = q->processRequest(req);
-            }
-            qCDebug(QT_MODBUS) << "(RTU server) Response PDU:" << response;
-
-            event = QModbusCommEvent::SentEvent; // reset event after processing
-            if (q->value(QModbusServer::ListenOnlyMode).toBool())
-                event |= QModbusCommEvent::SendFlag::CurrentlyInListenOnlyMode;
-
-            if ((!response.isValid())
-                || q->processesBroadcast()
-                || q->value(QModbusServer::ListenOnlyMode).toBool()) {
-                // The quantity of messages addressed to the remote device for which it has
-                // returned no response (neither a normal response nor an exception response),
-                // since its last restart, clear counters operation, or power-up.
-                incrementCounter(QModbusServerPrivate::Counter::ServerNoResponse);
-                storeModbusCommEvent(event);
-                return;
-            }
-
-            const QByteArray result = QModbusSerialAdu::create(QModbusSerialAdu::Rtu,
-                                                               q->serverAddress(), response);
-
-            qCDebug(QT_MODBUS_LOW) << "(RTU server) Response ADU:" << result.toHex();
-
-            if (!m_serialPort->isOpen()) {
-                qCDebug(QT_MODBUS) << "(RTU server) Requesting serial port has closed.";
-                q->setError(QModbusRtuSerialSlave::tr("Requesting serial port is closed"),
-                            QModbusDevice::WriteError);
-                incrementCounter(QModbusServerPrivate::Counter::ServerNoResponse);
-                storeModbusCommEvent(event);
-                return;
-            }
-
-            qint64 writtenBytes = m_serialPort->write(result);
-            if ((writtenBytes == -1) || (writtenBytes < result.size())) {
-                qCDebug(QT_MODBUS) << "(RTU server) Cannot write requested response to serial port.";
-                q->setError(QModbusRtuSerialSlave::tr("Could not write response to client"),
-                            QModbusDevice::WriteError);
-                incrementCounter(QModbusServerPrivate::Counter::ServerNoResponse);
-                storeModbusCommEvent(event);
-                m_serialPort->clear(QSerialPort::Output);
-                return;
-            }
-
-            if (response.isException()) {
-                switch (response.exceptionCode()) {
-                case QModbusExceptionResponse::IllegalFunction:
-                case QModbusExceptionResponse::IllegalDataAddress:
-                case QModbusExceptionResponse::IllegalDataValue:
-                    event |= QModbusCommEvent::SendFlag::ReadExceptionSent;
-                    break;
-
-                case QModbusExceptionResponse::ServerDeviceFailure:
-                    event |= QModbusCommEvent::SendFlag::ServerAbortExceptionSent;
-                    break;
-
-                case QModbusExceptionResponse::ServerDeviceBusy:
-                    // The quantity of messages addressed to the remote device for which it
-                    // returned a server device busy exception response, since its last restart,
-                    // clear counters operation, or power-up.
-                    incrementCounter(QModbusServerPrivate::Counter::ServerBusy);
-                    event |= QModbusCommEvent::SendFlag::ServerBusyExceptionSent;
-                    break;
-
-                case  QModbusExceptionResponse::NegativeAcknowledge:
-                    // The quantity of messages addressed to the remote device for which it
-                    // returned a negative acknowledge (NAK) exception response, since its last
-                    // restart, clear counters operation, or power-up.
-                    incrementCounter(QModbusServerPrivate::Counter::ServerNAK);
-                    event |= QModbusCommEvent::SendFlag::ServerProgramNAKExceptionSent;
-                    break;
-
-                default:
-                    break;
-                }
-                // The quantity of Modbus exception responses returned by the remote device since
-                // its last restart, clear counters operation, or power-up.
-                incrementCounter(QModbusServerPrivate::Counter::BusExceptionError);
-            } else {
-                switch (quint16(req.functionCode())) {
-                case 0x0a: // Poll 484 (not in the official Modbus specification) *1
-                case 0x0e: // Poll Controller (not in the official Modbus specification) *1
-                case QModbusRequest::GetCommEventCounter: // fall through and bail out
-                    break;
-                default:
-                    // The device's event counter is incremented once for each successful message
-                    // completion. Do not increment for exception responses, poll commands, or fetch
-                    // event counter commands.            *1 but mentioned here ^^^
-                    incrementCounter(QModbusServerPrivate::Counter::CommEvent);
-                    break;
-                }
-            }
-            storeModbusCommEvent(event); // store the final event after processing
+            if (m_asciiMode)
+                onAsciiReadyRead();
+            else
+                onRtuReadyRead();
         });
 
         QObject::connect(m_serialPort, &QSerialPort::errorOccurred, q,
@@ -285,7 +86,7 @@ public:
             if (error == QSerialPort::NoError)
                 return;
 
-            qCDebug(QT_MODBUS) << "(RTU server) QSerialPort error:" << error
+            qCDebug(QT_MODBUS) << logPrefix() << "QSerialPort error:" << error
                                << (m_serialPort ? m_serialPort->errorString() : QString());
 
             Q_Q(QModbusRtuSerialSlave);
@@ -324,7 +125,7 @@ public:
                 q->setError(QModbusDevice::tr("Unknown error."), QModbusDevice::UnknownError);
                 break;
             default:
-                qCDebug(QT_MODBUS) << "(RTU server) Unhandled QSerialPort error" << error;
+                qCDebug(QT_MODBUS) << logPrefix() << "Unhandled QSerialPort error" << error;
                 break;
             }
         });
@@ -337,6 +138,274 @@ public:
         });
     }
 
+    void onRtuReadyRead()
+    {
+        if (m_interFrameTimer.isValid()
+                && m_interFrameTimer.elapsed() > m_interFrameDelayMilliseconds
+                && m_requestFrame.size() > 0) {
+            // This permits response buffer clearing if it contains garbage
+            // but still permits cases where very slow baud rates can cause
+            // chunked and delayed packets
+            qCDebug(QT_MODBUS_LOW) << logPrefix() << "Dropping older ADU fragments due to larger than 3.5 char delay (expected:"
+                                   << m_interFrameDelayMilliseconds << ", max:"
+                                   << m_interFrameTimer.elapsed() << ")";
+            m_requestFrame.reset();
+        }
+
+        m_interFrameTimer.start();
+
+        const qint64 size = m_serialPort->size();
+        m_readBuffer.resize(size);
+        const qint64 read = qMax<qint64>(0, m_serialPort->read(m_readBuffer.data(), size));
+
+        // Every byte is consumed once, the frame size and CRC are tracked as bytes arrive.
+        const qsizetype consumed = m_requestFrame.append(m_readBuffer.constData(), read);
+        if (consumed < read) {
+            // More bytes than the request spans, the same size mismatch as a short frame.
+            m_requestFrame.setOverrun();
+            m_requestFrame.append(m_readBuffer.constData() + consumed, read - consumed);
+        }
+        qCDebug(QT_MODBUS_LOW) << logPrefix() << "Received ADU:" << m_requestFrame.rawData().toHex();
+
+        // Index                         -> description
+        // Server address                -> 1 byte
+        // FunctionCode                  -> 1 byte
+        // FunctionCode specific content -> 0-252 bytes
+        // CRC                           -> 2 bytes
+        const QModbusCommEvent event = receiveEvent();
+
+        // We expect at least the server address, function code and CRC.
+        if (m_requestFrame.size() < 4) {
+            qCWarning(QT_MODBUS) << logPrefix() << "Incomplete ADU received, ignoring";
+
+            // The quantity of CRC errors encountered by the remote device since its last
+            // restart, clear counters operation, or power-up. In case of a message
+            // length < 4 bytes, the receiving device is not able to calculate the CRC.
+            incrementCounter(QModbusServerPrivate::Counter::BusCommunicationError);
+            storeModbusCommEvent(event | QModbusCommEvent::ReceiveFlag::CommunicationError);
+            return;
+        }
+
+        processRequestFrame(m_requestFrame, event);
+    }
+
+    void onAsciiReadyRead()
+    {
+        const qint64 size = m_serialPort->size();
+        m_readBuffer.resize(size);
+        const qint64 read = qMax<qint64>(0, m_serialPort->read(m_readBuffer.data(), size));
+
+        // Frames are delimited by a colon and CR LF, decode as many as the read holds. The line
+        // feed can be changed by the client, see Diagnostics: Change ASCII Input Delimiter.
+        Q_Q(QModbusRtuSerialSlave);
+        m_asciiRequestFrame.setDelimiter(char(q->value(QModbusServer::AsciiInputDelimiter).toUInt()));
+        qint64 offset = 0;
+        while (offset < read) {
+            offset += m_asciiRequestFrame.append(m_readBuffer.constData() + offset, read - offset);
+            if (m_asciiRequestFrame.state() == QModbusAsciiFrameAssembler<QModbusRequest>::Incomplete)
+                break;
+
+            const QModbusCommEvent event = receiveEvent();
+            if (m_asciiRequestFrame.state() == QModbusAsciiFrameAssembler<QModbusRequest>::Overrun) {
+                qCWarning(QT_MODBUS) << "(ASCII server) Malformed ADU received, ignoring";
+                // A frame with invalid characters is counted like one with a wrong checksum.
+                incrementCounter(QModbusServerPrivate::Counter::BusCommunicationError);
+                storeModbusCommEvent(event | QModbusCommEvent::ReceiveFlag::CommunicationError);
+                m_asciiRequestFrame.reset();
+                continue;
+            }
+
+            qCDebug(QT_MODBUS_LOW) << "(ASCII server) Received ADU:"
+                                   << m_asciiRequestFrame.rawData().toHex();
+            processRequestFrame(m_asciiRequestFrame, event);
+        }
+    }
+
+    QModbusCommEvent receiveEvent() const
+    {
+        Q_Q(const QModbusRtuSerialSlave);
+        QModbusCommEvent event = QModbusCommEvent::ReceiveEvent;
+        if (q->value(QModbusServer::ListenOnlyMode).toBool())
+            event |= QModbusCommEvent::ReceiveFlag::CurrentlyInListenOnlyMode;
+        return event;
+    }
+
+    template <typename Frame>
+    void processRequestFrame(Frame &frame, QModbusCommEvent event)
+    {
+        // Server address is set to 0, this is a broadcast.
+        Q_Q(QModbusRtuSerialSlave);
+        const int serverAddress = frame.serverAddress();
+        m_processesBroadcast = (serverAddress == 0);
+        if (q->processesBroadcast())
+            event |= QModbusCommEvent::ReceiveFlag::BroadcastReceived;
+
+        // server address byte + function code byte + PDU size + 2 bytes CRC
+        if (frame.state() != Frame::Complete) {
+            qCWarning(QT_MODBUS) << logPrefix() << "ADU does not match expected size, ignoring";
+            // The quantity of messages addressed to the remote device that it could not
+            // handle due to a character overrun condition, since its last restart, clear
+            // counters operation, or power-up. A character overrun is caused by data
+            // characters arriving at the port faster than they can be stored, or by the loss
+            // of a character due to a hardware malfunction.
+            incrementCounter(QModbusServerPrivate::Counter::BusCharacterOverrun);
+            storeModbusCommEvent(event | QModbusCommEvent::ReceiveFlag::CharacterOverrun);
+            return;
+        }
+
+        // We received the full message, including checksum. We do not expect more bytes to
+        // arrive, so clear the buffer. All new bytes are considered part of the next message.
+        const bool matchingChecksum = frame.matchingChecksum();
+        const uint checksum = frame.checksum();
+        const uint calculatedChecksum = matchingChecksum ? checksum : frame.calculatedChecksum();
+        const QModbusRequest req = frame.pdu();
+        const qsizetype requestSize = frame.rawData().size();
+        frame.reset();
+
+        if (!matchingChecksum) {
+            qCWarning(QT_MODBUS) << logPrefix() << "Discarding request with wrong checksum, received:"
+                                 << checksum << ", calculated:" << calculatedChecksum;
+            // The quantity of CRC errors encountered by the remote device since its last
+            // restart, clear counters operation, or power-up.
+            incrementCounter(QModbusServerPrivate::Counter::BusCommunicationError);
+            storeModbusCommEvent(event | QModbusCommEvent::ReceiveFlag::CommunicationError);
+            return;
+        }
+
+        // The quantity of messages that the remote device has detected on the communications
+        // system since its last restart, clear counters operation, or power-up.
+        incrementCounter(QModbusServerPrivate::Counter::BusMessage);
+        m_statistics.addBytesReceived(req.functionCode(), requestSize);
+
+        // If we do not process a Broadcast ...
+        if (!q->processesBroadcast()) {
+            // check if the server address matches ...
+            if (q->serverAddress() != serverAddress) {
+                // no, not our address! Ignore!
+                qCDebug(QT_MODBUS) << logPrefix() << "Wrong server address, expected"
+                    << q->serverAddress() << "got" << serverAddress;
+                return;
+            }
+        } // else { Broadcast -> Server address will never match, deliberately ignore }
+
+        storeModbusCommEvent(event); // store the final event before processing
+        m_statistics.addRequest(req.functionCode());
+
+        qCDebug(QT_MODBUS) << logPrefix() << "Request PDU:" << req;
+        QElapsedTimer processingTime;
+        processingTime.start();
+        QModbusResponse response; // If the device ...
+        if (q->value(QModbusServer::DeviceBusy).value<quint16>() == 0xffff) {
+            // is busy, update the quantity of messages addressed to the remote device for
+            // which it returned a Server Device Busy exception response, since its last
+            // restart, clear counters operation, or power-up.
+            incrementCounter(QModbusServerPrivate::Counter::ServerBusy);
+            response = QModbusExceptionResponse(req.functionCode(),
+                QModbusExceptionResponse::ServerDeviceBusy);
+        } else {
+            // is not busy, update the quantity of messages addressed to the remote device,
+            // or broadcast, that the remote device has processed since its last restart,
+            // clear counters operation, or power-up.
+            incrementCounter(QModbusServerPrivate::Counter::ServerMessage);
+            response = q->processRequest(req);
+        }
+        m_statistics.addLatency(req.functionCode(), processingTime.nsecsElapsed());
+        qCDebug(QT_MODBUS) << logPrefix() << "Response PDU:" << response;
+
+        event = QModbusCommEvent::SentEvent; // reset event after processing
+        if (q->value(QModbusServer::ListenOnlyMode).toBool())
+            event |= QModbusCommEvent::SendFlag::CurrentlyInListenOnlyMode;
+
+        if ((!response.isValid())
+            || q->processesBroadcast()
+            || q->value(QModbusServer::ListenOnlyMode).toBool()) {
+            // The quantity of messages addressed to the remote device for which it has
+            // returned no response (neither a normal response nor an exception response),
+            // since its last restart, clear counters operation, or power-up.
+            incrementCounter(QModbusServerPrivate::Counter::ServerNoResponse);
+            storeModbusCommEvent(event);
+            return;
+        }
+
+        const QByteArray result = QModbusSerialAdu::create(m_asciiMode ? QModbusSerialAdu::Ascii
+                                                                       : QModbusSerialAdu::Rtu,
+                                                           q->serverAddress(), response);
+
+        qCDebug(QT_MODBUS_LOW) << logPrefix() << "Response ADU:" << result.toHex();
+
+        if (!m_serialPort->isOpen()) {
+            qCDebug(QT_MODBUS) << logPrefix() << "Requesting serial port has closed.";
+            q->setError(QModbusRtuSerialSlave::tr("Requesting serial port is closed"),
+                        QModbusDevice::WriteError);
+            incrementCounter(QModbusServerPrivate::Counter::ServerNoResponse);
+            storeModbusCommEvent(event);
+            return;
+        }
+
+        qint64 writtenBytes = m_serialPort->write(result);
+        if ((writtenBytes == -1) || (writtenBytes < result.size())) {
+            qCDebug(QT_MODBUS) << logPrefix() << "Cannot write requested response to serial port.";
+            q->setError(QModbusRtuSerialSlave::tr("Could not write response to client"),
+                        QModbusDevice::WriteError);
+            incrementCounter(QModbusServerPrivate::Counter::ServerNoResponse);
+            storeModbusCommEvent(event);
+            m_serialPort->clear(QSerialPort::Output);
+            return;
+        }
+        m_statistics.addResponse(response);
+        m_statistics.addBytesSent(req.functionCode(), writtenBytes);
+
+        if (response.isException()) {
+            switch (response.exceptionCode()) {
+            case QModbusExceptionResponse::IllegalFunction:
+            case QModbusExceptionResponse::IllegalDataAddress:
+            case QModbusExceptionResponse::IllegalDataValue:
+                event |= QModbusCommEvent::SendFlag::ReadExceptionSent;
+                break;
+
+            case QModbusExceptionResponse::ServerDeviceFailure:
+                event |= QModbusCommEvent::SendFlag::ServerAbortExceptionSent;
+                break;
+
+            case QModbusExceptionResponse::ServerDeviceBusy:
+                // The quantity of messages addressed to the remote device for which it
+                // returned a server device busy exception response, since its last restart,
+                // clear counters operation, or power-up.
+                incrementCounter(QModbusServerPrivate::Counter::ServerBusy);
+                event |= QModbusCommEvent::SendFlag::ServerBusyExceptionSent;
+                break;
+
+            case  QModbusExceptionResponse::NegativeAcknowledge:
+                // The quantity of messages addressed to the remote device for which it
+                // returned a negative acknowledge (NAK) exception response, since its last
+                // restart, clear counters operation, or power-up.
+                incrementCounter(QModbusServerPrivate::Counter::ServerNAK);
+                event |= QModbusCommEvent::SendFlag::ServerProgramNAKExceptionSent;
+                break;
+
+            default:
+                break;
+            }
+            // The quantity of Modbus exception responses returned by the remote device since
+            // its last restart, clear counters operation, or power-up.
+            incrementCounter(QModbusServerPrivate::Counter::BusExceptionError);
+        } else {
+            switch (quint16(req.functionCode())) {
+            case 0x0a: // Poll 484 (not in the official Modbus specification) *1
+            case 0x0e: // Poll Controller (not in the official Modbus specification) *1
+            case QModbusRequest::GetCommEventCounter: // fall through and bail out
+                break;
+            default:
+                // The device's event counter is incremented once for each successful message
+                // completion. Do not increment for exception responses, poll commands, or fetch
+                // event counter commands.            *1 but mentioned here ^^^
+                incrementCounter(QModbusServerPrivate::Counter::CommEvent);
+                break;
+            }
+        }
+        storeModbusCommEvent(event); // store the final event after processing
+    }
+
     void setupEnvironment()
     {
         if (m_serialPort) {
@@ -349,12 +418,20 @@ public:
 
         calculateInterFrameDelay();
 
-        m_requestBuffer.clear();
+        m_asciiMode = (m_transmissionMode == QModbusDevice::AsciiTransmissionMode);
+        m_requestFrame.reset();
+        m_asciiRequestFrame.reset();
     }
 
     QIODevice *device() const override { return m_serialPort; }
 
-    QByteArray m_requestBuffer;
+    QModbusRtuFrameAssembler<QModbusRequest> m_requestFrame;
+    QModbusAsciiFrameAssembler<QModbusRequest> m_asciiRequestFrame;
+    bool m_asciiMode = false;
+
+    // Log messages name the transmission mode in use.
+    const char *logPrefix() const { return m_asciiMode ? "(ASCII server)" : "(RTU server)"; }
+    QByteArray m_readBuffer;
     bool m_processesBroadcast = false;
     QSerialPort *m_serialPort = nullptr;
     QElapsedTimer m_interFrameTimer;
@@ -35,12 +35,16 @@
 ****************************************************************************/
 
 #include "qmodbusdeviceidentification.h"
+#include "qmodbusfifoqueue.h"
+#include "qmodbusregisterstore.h"
+#include "qmodbusregisterstore_p.h"
 #include "qmodbusserver.h"
 #include "qmodbusserver_p.h"
 #include "qmodbus_symbols_p.h"
 
 #include <QtCore/qbitarray.h>
 #include <QtCore/qdebug.h>
+#include <QtCore/qendian.h>
 #include <QtCore/qlist.h>
 #include <QtCore/qloggingcategory.h>
 
@@ -90,6 +94,24 @@ Q_DECLARE_LOGGING_CATEGORY(QT_MODBUS)
     components use the correct types when accessing and setting values.
 */
 
+/*!
+    \enum QModbusServer::NotificationMode
+    \since 6.1
+
+    This enum describes how the \l dataWritten() signal is delivered by the
+    default \l writeData() implementation.
+
+    \value ImmediateNotification    The signal is emitted synchronously for every
+                                    write that changes the register content. This
+                                    is the default.
+    \value CoalescedNotification    Changed register ranges are collected and
+                                    merged. The signal is emitted once per merged
+                                    range and register table when control returns
+                                    to the event loop.
+
+    \sa setNotificationMode(), beginUpdate(), endUpdate()
+*/
+
 /*!
     Constructs a Modbus server with the specified \a parent.
 */
@@ -124,7 +146,43 @@ QModbusServer::QModbusServer(QModbusServerPrivate &dd, QObject *parent) :
 */
 bool QModbusServer::setMap(const QModbusDataUnitMap &map)
 {
-    return d_func()->setMap(map);
+    Q_D(QModbusServer);
+    if (d->m_ownedRegisterStore) {
+        d->m_registerStore = nullptr;
+        d->m_ownedRegisterStore.reset();
+    }
+    return d->setMap(map);
+}
+
+/*!
+    \since 6.1
+    \overload
+
+    Sets up the registers described by \a map and keeps their values in the
+    file \a fileName, so they survive a restart of the application. The server
+    creates and owns a \l QModbusRegisterStore for the file and installs it
+    with setRegisterStore(); see the QModbusRegisterStore documentation for
+    the file format and the crash guarantees. Call
+    \l QModbusRegisterStore::checkpoint() on registerStore() periodically to
+    make the values durable against power loss.
+
+    If the file exists, the register values stored in it are used instead of
+    the values of \a map. Returns \c false if the file cannot be used, in which
+    case the registers are kept in memory only and initialized from \a map.
+
+    Calling setMap() or setRegisterStore() again releases the file.
+*/
+bool QModbusServer::setMap(const QModbusDataUnitMap &map, const QString &fileName)
+{
+    Q_D(QModbusServer);
+    d->m_registerStore = nullptr;
+    d->m_ownedRegisterStore.reset();
+    if (!d->setMap(map))
+        return false;
+
+    d->m_ownedRegisterStore = std::make_unique<QModbusRegisterStore>(map, fileName);
+    d->m_registerStore = d->m_ownedRegisterStore.get();
+    return d->m_registerStore->isPersistent();
 }
 
 /*!
@@ -377,6 +435,8 @@ bool QModbusServer::setValue(int option, const QVariant &newValue)
         if (!newValue.canConvert<QModbusDeviceIdentification>())
             return false;
         d->m_serverOptions.insert(option, newValue);
+        d->m_deviceIdentification = QModbusServerPrivate::encodeDeviceIdentification(
+            newValue.value<QModbusDeviceIdentification>());
         return true;
     default:
         break;
@@ -467,11 +527,168 @@ bool QModbusServer::setData(const QModbusDataUnit &newData)
     return writeData(newData);
 }
 
+/*!
+    \since 6.1
+
+    Returns the register store installed with setRegisterStore(), or \c nullptr
+    if the server uses its own register map.
+*/
+QModbusRegisterStore *QModbusServer::registerStore() const
+{
+    Q_D(const QModbusServer);
+    return d->m_registerStore;
+}
+
+/*!
+    \since 6.1
+
+    Makes the default \l readData() and \l writeData() implementations use
+    \a store instead of the register map set with setMap(). Passing \c nullptr
+    switches back to the register map.
+
+    Other threads may write to \a store while the server processes requests
+    without any synchronization with the server's thread, and a request never
+    sees a partially applied write. The server does not take ownership of
+    \a store, which must stay alive until it is uninstalled or the server is
+    destroyed.
+
+    \sa QModbusRegisterStore
+*/
+void QModbusServer::setRegisterStore(QModbusRegisterStore *store)
+{
+    Q_D(QModbusServer);
+    d->m_registerStore = store;
+    if (d->m_ownedRegisterStore && d->m_ownedRegisterStore.get() != store)
+        d->m_ownedRegisterStore.reset();
+}
+
+/*!
+    \since 6.1
+
+    Returns the queue installed for the FIFO pointer \a address, or \c nullptr
+    if requests for \a address are answered from the holding registers.
+
+    \sa setFifoQueue()
+*/
+QModbusFifoQueue *QModbusServer::fifoQueue(quint16 address) const
+{
+    Q_D(const QModbusServer);
+    return d->m_fifoQueues.value(address, nullptr);
+}
+
+/*!
+    \since 6.1
+
+    Answers \l QModbusPdu::ReadFifoQueue requests for the FIFO pointer
+    \a address from \a queue. Every request removes up to 31 values from the
+    front of the queue and returns them; further values stay queued for the
+    next request. Passing \c nullptr switches back to reading the FIFO count
+    and values from the holding registers at \a address.
+
+    The server does not take ownership of \a queue, which must stay alive until
+    it is uninstalled or the server is destroyed.
+
+    \sa fifoQueue(), QModbusFifoQueue
+*/
+void QModbusServer::setFifoQueue(quint16 address, QModbusFifoQueue *queue)
+{
+    Q_D(QModbusServer);
+    if (queue)
+        d->m_fifoQueues.insert(address, queue);
+    else
+        d->m_fifoQueues.remove(address);
+}
+
+/*!
+    \since 6.1
+
+    Returns the way the \l dataWritten() signal is delivered. The default is
+    \l QModbusServer::ImmediateNotification.
+
+    \sa setNotificationMode()
+*/
+QModbusServer::NotificationMode QModbusServer::notificationMode() const
+{
+    Q_D(const QModbusServer);
+    return d->m_notificationMode;
+}
+
+/*!
+    \since 6.1
+
+    Sets the way the \l dataWritten() signal is delivered to \a mode.
+
+    In \l QModbusServer::CoalescedNotification mode, overlapping and adjacent
+    register ranges written during one event loop iteration are merged and
+    reported with a single \l dataWritten() signal per range. Switching back to
+    \l QModbusServer::ImmediateNotification delivers pending notifications
+    right away.
+
+    \sa notificationMode(), beginUpdate()
+*/
+void QModbusServer::setNotificationMode(NotificationMode mode)
+{
+    Q_D(QModbusServer);
+    if (d->m_notificationMode == mode)
+        return;
+    d->m_notificationMode = mode;
+    if (mode == ImmediateNotification && d->m_updateDepth == 0)
+        d->flushDataWritten();
+}
+
+/*!
+    \since 6.1
+
+    Starts a batch update of the register map. Until the matching call to
+    \l endUpdate(), writes through \l setData() do not emit \l dataWritten().
+    Instead the changed ranges are recorded and merged, and reported once the
+    outermost \l endUpdate() is called.
+
+    Calls to beginUpdate() and endUpdate() can be nested.
+
+    \code
+        server->beginUpdate();
+        for (quint16 i = 0; i < 5000; ++i)
+            server->setData(QModbusDataUnit::HoldingRegisters, i, values.at(i));
+        server->endUpdate(); // emits dataWritten(HoldingRegisters, 0, 5000) once
+    \endcode
+
+    \sa endUpdate(), setNotificationMode()
+*/
+void QModbusServer::beginUpdate()
+{
+    Q_D(QModbusServer);
+    ++d->m_updateDepth;
+}
+
+/*!
+    \since 6.1
+
+    Ends a batch update started with \l beginUpdate(). When the outermost batch
+    ends, one \l dataWritten() signal is emitted for every merged range that
+    changed during the batch.
+
+    \sa beginUpdate()
+*/
+void QModbusServer::endUpdate()
+{
+    Q_D(QModbusServer);
+    if (d->m_updateDepth <= 0) {
+        qCWarning(QT_MODBUS) << "(Server) endUpdate() called without matching beginUpdate()";
+        return;
+    }
+    if (--d->m_updateDepth == 0)
+        d->flushDataWritten();
+}
+
 /*!
     Writes \a newData to the Modbus server map. Returns \c true on success,
     or \c false if the \a newData range is outside of the map range or the
     registerType() does not exist.
 
+    If a register store is installed with setRegisterStore(), \a newData is
+    written to the store instead.
+
     \note Sub-classes that implement writing to a different backing store
     then default one, also need to implement setMap() and readData(). The
     dataWritten() signal needs to be emitted from within the functions
@@ -482,6 +699,17 @@ bool QModbusServer::setData(const QModbusDataUnit &newData)
 bool QModbusServer::writeData(const QModbusDataUnit &newData)
 {
     Q_D(QModbusServer);
+    if (d->m_registerStore) {
+        bool changed = false;
+        if (!QModbusRegisterStorePrivate::get(d->m_registerStore)->write(newData, &changed))
+            return false;
+        if (changed) {
+            d->notifyDataWritten(newData.registerType(), newData.startAddress(),
+                                 newData.valueCount());
+        }
+        return true;
+    }
+
     if (!d->m_modbusDataUnitMap.contains(newData.registerType()))
         return false;
 
@@ -510,7 +738,7 @@ bool QModbusServer::writeData(const QModbusDataUnit &newData)
     }
 
     if (changeRequired)
-        emit dataWritten(newData.registerType(), newData.startAddress(), newData.valueCount());
+        d->notifyDataWritten(newData.registerType(), newData.startAddress(), newData.valueCount());
     return true;
 }
 
@@ -520,6 +748,9 @@ bool QModbusServer::writeData(const QModbusDataUnit &newData)
     \a newData is \c 0, the \a newData range is outside of the map range or the
     registerType() does not exist.
 
+    If a register store is installed with setRegisterStore(), the values are
+    read from the store instead.
+
     \note Sub-classes that implement reading from a different backing store
     then default one, also need to implement setMap() and writeData().
 
@@ -529,6 +760,9 @@ bool QModbusServer::readData(QModbusDataUnit *newData) const
 {
     Q_D(const QModbusServer);
 
+    if (d->m_registerStore)
+        return d->m_registerStore->data(newData);
+
     if ((!newData) || (!d->m_modbusDataUnitMap.contains(newData->registerType())))
         return false;
 
@@ -571,6 +805,12 @@ bool QModbusServer::readData(QModbusDataUnit *newData) const
 
     The signal is not emitted when the to-be-written fields have not changed
     due to no change in value.
+
+    Between \l beginUpdate() and \l endUpdate(), or if the notification mode is
+    \l QModbusServer::CoalescedNotification, the signal reports merged ranges
+    that may span several individual writes.
+
+    \sa notificationMode(), beginUpdate()
 */
 
 /*!
@@ -1032,14 +1272,13 @@ QModbusResponse QModbusServerPrivate::processWriteMultipleRegistersRequest(
             QModbusExceptionResponse::IllegalDataAddress);
     }
 
-    const QByteArray pduData = request.data().remove(0,5);
-    QDataStream stream(pduData);
-
-    QList<quint16> values;
-    quint16 tmp;
-    for (int i = 0; i < numberOfRegisters; i++) {
-        stream >> tmp;
-        values.append(tmp);
+    // The byte count has been checked against the data size already.
+    const QByteArray pduData = request.data();
+    const char *in = pduData.constData() + 5;
+    QList<quint16> values(numberOfRegisters);
+    for (quint16 &value : values) {
+        value = qFromBigEndian<quint16>(in);
+        in += sizeof(quint16);
     }
 
     registers.setValues(values);
@@ -1131,14 +1370,13 @@ QModbusResponse QModbusServerPrivate::processReadWriteMultipleRegistersRequest(
             QModbusExceptionResponse::IllegalDataAddress);
     }
 
-    const QByteArray pduData = request.data().remove(0,9);
-    QDataStream stream(pduData);
-
-    QList<quint16> values;
-    quint16 tmp;
-    for (int i = 0; i < writeQuantity; i++) {
-        stream >> tmp;
-        values.append(tmp);
+    // The byte count has been checked against the data size already.
+    const QByteArray pduData = request.data();
+    const char *in = pduData.constData() + 9;
+    QList<quint16> values(writeQuantity);
+    for (quint16 &value : values) {
+        value = qFromBigEndian<quint16>(in);
+        in += sizeof(quint16);
     }
 
     writeRegisters.setValues(values);
@@ -1166,6 +1404,15 @@ QModbusResponse QModbusServerPrivate::processReadFifoQueueRequest(const QModbusR
     quint16 address;
     request.decodeData(&address);
 
+    if (QModbusFifoQueue *queue = m_fifoQueues.value(address, nullptr)) {
+        // The response carries at most 31 values, the rest waits for the next request.
+        std::array<quint16, 31> values;
+        const qsizetype fifoCount = queue->pop(values.data(), qsizetype(values.size()));
+        return QModbusResponse(request.functionCode(), quint16((fifoCount * 2) + 2u),
+                               quint16(fifoCount),
+                               QList<quint16>(values.cbegin(), values.cbegin() + fifoCount));
+    }
+
     quint16 fifoCount;
     if (!q_func()->data(QModbusDataUnit::HoldingRegisters, address, &fifoCount)) {
         return QModbusExceptionResponse(request.functionCode(),
@@ -1203,15 +1450,18 @@ QModbusResponse QModbusServerPrivate::processEncapsulatedInterfaceTransportReque
                     QModbusExceptionResponse::IllegalDataValue);
             }
 
-            const QVariant tmp = q_func()->value(QModbusServer::DeviceIdentification);
-            if (tmp.isNull() || (!tmp.isValid())) {
-                // TODO: Is this correct?
-                return QModbusExceptionResponse(request.functionCode(),
-                    QModbusExceptionResponse::ServerDeviceFailure);
+            // The pool is encoded by setValue(), subclasses that provide the option through
+            // a reimplemented value() have it encoded on every request instead.
+            EncodedDeviceIdentification fallback;
+            const EncodedDeviceIdentification *objectPool = &m_deviceIdentification;
+            if (!objectPool->isValid) {
+                const QVariant tmp = q_func()->value(QModbusServer::DeviceIdentification);
+                if (!tmp.isNull() && tmp.isValid()) {
+                    fallback = encodeDeviceIdentification(tmp.value<QModbusDeviceIdentification>());
+                    objectPool = &fallback;
+                }
             }
-
-            QModbusDeviceIdentification objectPool = tmp.value<QModbusDeviceIdentification>();
-            if (!objectPool.isValid()) {
+            if (!objectPool->isValid) {
                 // TODO: Is this correct?
                 return QModbusExceptionResponse(request.functionCode(),
                     QModbusExceptionResponse::ServerDeviceFailure);
@@ -1219,76 +1469,58 @@ QModbusResponse QModbusServerPrivate::processEncapsulatedInterfaceTransportReque
 
             quint8 readDeviceIdCode, objectId;
             request.decodeData(&MEIType, &readDeviceIdCode, &objectId);
-            if (!objectPool.contains(objectId)) {
+            int position = objectPool->index[objectId];
+            if (position < 0) {
                 // Individual access requires the object Id to be present, so we will always fail.
                 // For all other cases we will reevaluate object Id after we reset it as per spec.
-                objectId = QModbusDeviceIdentification::VendorNameObjectId;
+                position = objectPool->index[QModbusDeviceIdentification::VendorNameObjectId];
                 if (readDeviceIdCode == QModbusDeviceIdentification::IndividualReadDeviceIdCode
-                    || !objectPool.contains(objectId)) {
+                    || position < 0) {
                     return QModbusExceptionResponse(request.functionCode(),
                         QModbusExceptionResponse::IllegalDataAddress);
                 }
             }
 
-            auto payload = [MEIType, readDeviceIdCode, objectId, objectPool](int lastObjectId) {
+            auto response = [&](int end, int nextObjectId) {
                 // TODO: Take conformity level into account.
+                const int begin = objectPool->offsets.at(position);
+                const int size = objectPool->offsets.at(end) - begin;
                 QByteArray payload(6, Qt::Uninitialized);
+                payload.reserve(6 + size);
                 payload[0] = MEIType;
                 payload[1] = readDeviceIdCode;
-                payload[2] = quint8(objectPool.conformityLevel());
-                payload[3] = quint8(0x00); // no more follows
-                payload[4] = quint8(0x00); // next object id
-                payload[5] = quint8(0x00); // number of objects
-
-                const QList<int> objectIds = objectPool.objectIds();
-                for (int id : objectIds) {
-                    if (id < objectId)
-                        continue;
-                    if (id > lastObjectId)
-                        break;
-                    const QByteArray object = objectPool.value(id);
-                    QByteArray objectData(2, Qt::Uninitialized);
-                    objectData[0] = id;
-                    objectData[1] = quint8(object.size());
-                    objectData += object;
-                    if (payload.size() + objectData.size() > 253) {
-                        payload[3] = char(0xff); // more follows
-                        payload[4] = id; // next object id
-                        break;
-                    }
-                    payload.append(objectData);
-                    payload[5] = payload[5] + 1u; // number of objects
-                }
-                return payload;
+                payload[2] = objectPool->conformityLevel;
+                payload[3] = quint8(nextObjectId < 0 ? 0x00 : 0xff); // more follows
+                payload[4] = quint8(nextObjectId < 0 ? 0x00 : nextObjectId); // next object id
+                payload[5] = quint8(end - position); // number of objects
+                payload.append(objectPool->objects.constData() + begin, size);
+                return QModbusResponse(request.functionCode(), payload);
+            };
+
+            auto streamResponse = [&](EncodedDeviceIdentification::Category category,
+                                      int lastObjectId) {
+                const int end = objectPool->ends[category].at(position);
+                const bool moreFollows = end < objectPool->ids.size()
+                    && objectPool->ids.at(end) <= lastObjectId;
+                return response(end, moreFollows ? objectPool->ids.at(end) : -1);
             };
 
             switch (readDeviceIdCode) {
             case QModbusDeviceIdentification::BasicReadDeviceIdCode:
                 // TODO: How to handle a valid Id <> VendorName ... MajorMinorRevision
-                return QModbusResponse(request.functionCode(),
-                    payload(QModbusDeviceIdentification::MajorMinorRevisionObjectId));
+                return streamResponse(EncodedDeviceIdentification::Basic,
+                                      QModbusDeviceIdentification::MajorMinorRevisionObjectId);
             case QModbusDeviceIdentification::RegularReadDeviceIdCode:
                 // TODO: How to handle a valid Id <> VendorUrl ... UserApplicationName
-                return QModbusResponse(request.functionCode(),
-                    payload(QModbusDeviceIdentification::UserApplicationNameObjectId));
+                return streamResponse(EncodedDeviceIdentification::Regular,
+                                      QModbusDeviceIdentification::UserApplicationNameObjectId);
             case QModbusDeviceIdentification::ExtendedReadDeviceIdCode:
                 // TODO: How to handle a valid Id < ProductDependent
-                return QModbusResponse(request.functionCode(),
-                    payload(QModbusDeviceIdentification::UndefinedObjectId));
-            case QModbusDeviceIdentification::IndividualReadDeviceIdCode: {
+                return streamResponse(EncodedDeviceIdentification::Extended,
+                                      QModbusDeviceIdentification::UndefinedObjectId);
+            case QModbusDeviceIdentification::IndividualReadDeviceIdCode:
                 // TODO: Take conformity level into account.
-                const QByteArray object = objectPool.value(objectId);
-                QByteArray header(8, Qt::Uninitialized);
-                header[0] = MEIType;
-                header[1] = readDeviceIdCode;
-                header[2] = quint8(objectPool.conformityLevel());
-                header[3] = quint8(0x00); // no more follows
-                header[4] = quint8(0x00); // next object id
-                header[5] = quint8(0x01); // number of objects
-                header[6] = objectId;
-                header[7] = quint8(object.length());
-                return QModbusResponse(request.functionCode(), QByteArray(header + object));
-            }
+                return response(position + 1, -1);
             default:
                 return QModbusExceptionResponse(request.functionCode(),
                     QModbusExceptionResponse::IllegalDataValue);
@@ -1299,6 +1531,123 @@ QModbusResponse QModbusServerPrivate::processEncapsulatedInterfaceTransportReque
         QModbusExceptionResponse::IllegalFunction);
 }
 
+QModbusServerPrivate::EncodedDeviceIdentification
+QModbusServerPrivate::encodeDeviceIdentification(const QModbusDeviceIdentification &objectPool)
+{
+    EncodedDeviceIdentification encoded;
+    encoded.index.fill(-1);
+    encoded.isValid = objectPool.isValid();
+    if (!encoded.isValid)
+        return encoded;
+
+    encoded.conformityLevel = quint8(objectPool.conformityLevel());
+    encoded.ids = objectPool.objectIds();
+    encoded.offsets.reserve(encoded.ids.size() + 1);
+    for (int i = 0; i < encoded.ids.size(); ++i) {
+        const int id = encoded.ids.at(i);
+        const QByteArray object = objectPool.value(id);
+        encoded.index[id] = qint16(i);
+        encoded.offsets.append(encoded.objects.size());
+        encoded.objects.append(char(id));
+        encoded.objects.append(char(quint8(object.size())));
+        encoded.objects.append(object);
+    }
+    encoded.offsets.append(encoded.objects.size());
+
+    // A response holds at most 253 bytes, the header takes 6 of them. Objects that do not fit
+    // are announced with the more follows flag and the next object id.
+    const std::array<int, EncodedDeviceIdentification::CategoryCount> lastObjectIds = {
+        QModbusDeviceIdentification::MajorMinorRevisionObjectId,
+        QModbusDeviceIdentification::UserApplicationNameObjectId,
+        QModbusDeviceIdentification::UndefinedObjectId
+    };
+    for (int category = 0; category < EncodedDeviceIdentification::CategoryCount; ++category) {
+        QList<int> &ends = encoded.ends[category];
+        ends.reserve(encoded.ids.size());
+        for (int begin = 0; begin < encoded.ids.size(); ++begin) {
+            int end = begin;
+            while (end < encoded.ids.size() && encoded.ids.at(end) <= lastObjectIds[category]
+                   && 6 + encoded.offsets.at(end + 1) - encoded.offsets.at(begin) <= 253) {
+                ++end;
+            }
+            ends.append(end);
+        }
+    }
+    return encoded;
+}
+
+void QModbusServerPrivate::notifyDataWritten(QModbusDataUnit::RegisterType table, int address,
+                                             int size)
+{
+    Q_Q(QModbusServer);
+    if (m_updateDepth == 0 && m_notificationMode == QModbusServer::ImmediateNotification) {
+        emit q->dataWritten(table, address, size);
+        return;
+    }
+
+    if (table <= QModbusDataUnit::Invalid || size_t(table) >= m_dirtyRanges.size())
+        return;
+
+    // Writes in a loop usually walk the addresses in order, so extending the
+    // last recorded range keeps the list short; anything else is merged on flush.
+    auto &ranges = m_dirtyRanges[table];
+    const int last = address + size - 1;
+    if (!ranges.empty() && address <= ranges.back().last + 1 && last >= ranges.back().first - 1) {
+        ranges.back().first = qMin(ranges.back().first, address);
+        ranges.back().last = qMax(ranges.back().last, last);
+    } else {
+        ranges.push_back({ address, last });
+    }
+
+    if (m_updateDepth == 0)
+        scheduleDataWrittenFlush();
+}
+
+void QModbusServerPrivate::scheduleDataWrittenFlush()
+{
+    if (m_flushScheduled)
+        return;
+
+    Q_Q(QModbusServer);
+    m_flushScheduled = true;
+    QMetaObject::invokeMethod(q, [this]() {
+        m_flushScheduled = false;
+        if (m_updateDepth == 0)
+            flushDataWritten();
+    }, Qt::QueuedConnection);
+}
+
+void QModbusServerPrivate::flushDataWritten()
+{
+    Q_Q(QModbusServer);
+    for (size_t table = 0; table < m_dirtyRanges.size(); ++table) {
+        if (m_dirtyRanges[table].empty())
+            continue;
+
+        // Take the ranges out first, a connected slot might write to the server again.
+        std::vector<DirtyRange> ranges;
+        ranges.swap(m_dirtyRanges[table]);
+        std::sort(ranges.begin(), ranges.end(), [](const DirtyRange &l, const DirtyRange &r) {
+            return l.first < r.first;
+        });
+
+        auto merged = ranges.begin();
+        for (auto it = ranges.begin() + 1; it != ranges.end(); ++it) {
+            if (it->first <= merged->last + 1) {
+                merged->last = qMax(merged->last, it->last);
+            } else {
+                *(++merged) = *it;
+            }
+        }
+        ranges.erase(merged + 1, ranges.end());
+
+        for (const DirtyRange &range : ranges) {
+            emit q->dataWritten(QModbusDataUnit::RegisterType(table), range.first,
+                                range.last - range.first + 1);
+        }
+    }
+}
+
 void QModbusServerPrivate::storeModbusCommEvent(const QModbusCommEvent &eventByte)
 {
     // Inserts an event byte at the start of the event log. If the event log
@@ -45,6 +45,8 @@
 
 QT_BEGIN_NAMESPACE
 
+class QModbusFifoQueue;
+class QModbusRegisterStore;
 class QModbusServerPrivate;
 
 class Q_SERIALBUS_EXPORT QModbusServer : public QModbusDevice
@@ -68,6 +70,12 @@ public:
     };
     Q_ENUM(Option)
 
+    enum NotificationMode {
+        ImmediateNotification,
+        CoalescedNotification
+    };
+    Q_ENUM(NotificationMode)
+
     explicit QModbusServer(QObject *parent = nullptr);
     ~QModbusServer();
 
@@ -75,6 +83,7 @@ public:
     void setServerAddress(int serverAddress);
 
     virtual bool setMap(const QModbusDataUnitMap &map);
+    bool setMap(const QModbusDataUnitMap &map, const QString &fileName);
     virtual bool processesBroadcast() const { return false; }
 
     virtual QVariant value(int option) const;
@@ -86,6 +95,18 @@ public:
     bool setData(QModbusDataUnit::RegisterType table, quint16 address, quint16 data);
     bool data(QModbusDataUnit::RegisterType table, quint16 address, quint16 *data) const;
 
+    QModbusRegisterStore *registerStore() const;
+    void setRegisterStore(QModbusRegisterStore *store);
+
+    QModbusFifoQueue *fifoQueue(quint16 address) const;
+    void setFifoQueue(quint16 address, QModbusFifoQueue *queue);
+
+    NotificationMode notificationMode() const;
+    void setNotificationMode(NotificationMode mode);
+
+    void beginUpdate();
+    void endUpdate();
+
 Q_SIGNALS:
     void dataWritten(QModbusDataUnit::RegisterType table, int address, int size);
 
@@ -100,6 +121,7 @@ protected:
 };
 
 Q_DECLARE_TYPEINFO(QModbusServer::Option, Q_PRIMITIVE_TYPE);
+Q_DECLARE_TYPEINFO(QModbusServer::NotificationMode, Q_PRIMITIVE_TYPE);
 
 QT_END_NAMESPACE
 
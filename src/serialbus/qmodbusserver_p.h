@@ -38,6 +38,8 @@
 #define QMODBUSERVER_P_H
 
 #include <QtSerialBus/qmodbusdataunit.h>
+#include <QtSerialBus/qmodbusdeviceidentification.h>
+#include <QtSerialBus/qmodbusregisterstore.h>
 #include <QtSerialBus/qmodbusserver.h>
 
 #include <private/qmodbuscommevent_p.h>
@@ -46,6 +48,8 @@
 
 #include <array>
 #include <deque>
+#include <memory>
+#include <vector>
 
 //
 //  W A R N I N G
@@ -88,6 +92,12 @@ public:
     void incrementCounter(QModbusServerPrivate::Counter counter) { m_counters[counter]++; }
 
     QModbusResponse processRequest(const QModbusPdu &request);
+    // Lets the private classes of subclasses, such as a TCP server forwarding to virtual
+    // servers, call the protected processRequest() of another server.
+    static QModbusResponse invokeProcessRequest(QModbusServer *server, const QModbusPdu &request)
+    {
+        return server->processRequest(request);
+    }
 
     QModbusResponse processReadCoilsRequest(const QModbusRequest &request);
     QModbusResponse processReadDiscreteInputsRequest(const QModbusRequest &request);
@@ -115,11 +125,54 @@ public:
 
     void storeModbusCommEvent(const QModbusCommEvent &eventByte);
 
+    void notifyDataWritten(QModbusDataUnit::RegisterType table, int address, int size);
+    void scheduleDataWrittenFlush();
+    void flushDataWritten();
+
+    struct DirtyRange {
+        int first;
+        int last;
+    };
+
+    /*
+        The DeviceIdentification option, encoded once when the option is set. All objects are
+        stored as id, length and value back to back in ascending id order, so every Read Device
+        Identification response is a fixed header followed by a slice of the encoded objects.
+    */
+    struct EncodedDeviceIdentification {
+        enum Category { Basic, Regular, Extended, CategoryCount };
+
+        bool isValid = false;
+        quint8 conformityLevel = 0;
+        QByteArray objects;
+        QList<int> ids;
+        // The start of every object in objects, followed by the size of objects.
+        QList<int> offsets;
+        // For a stream access starting at the object with the given index, the index of the
+        // first object that is not part of the response.
+        std::array<QList<int>, CategoryCount> ends;
+        // The index of an object id in ids, -1 if the object is not part of the pool.
+        std::array<qint16, 256> index {};
+    };
+    static EncodedDeviceIdentification encodeDeviceIdentification(
+        const QModbusDeviceIdentification &objectPool);
+
     int m_serverAddress = 1;
     std::array<quint16, 20> m_counters;
     QHash<int, QVariant> m_serverOptions;
     QModbusDataUnitMap m_modbusDataUnitMap;
+    EncodedDeviceIdentification m_deviceIdentification;
+    QModbusRegisterStore *m_registerStore = nullptr;
+    // Set if m_registerStore was created by setMap() with a file name.
+    std::unique_ptr<QModbusRegisterStore> m_ownedRegisterStore;
+    QHash<quint16, QModbusFifoQueue *> m_fifoQueues;
     std::deque<quint8> m_commEventLog;
+
+    QModbusServer::NotificationMode m_notificationMode = QModbusServer::ImmediateNotification;
+    int m_updateDepth = 0;
+    bool m_flushScheduled = false;
+    // Indexed by QModbusDataUnit::RegisterType, the Invalid slot stays unused.
+    std::array<std::vector<DirtyRange>, QModbusDataUnit::HoldingRegisters + 1> m_dirtyRanges;
 };
 
 QT_END_NAMESPACE
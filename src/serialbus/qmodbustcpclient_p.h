@@ -139,6 +139,7 @@ public:
                                    << responsePdu.data().toHex();
 
                 responseBuffer.remove(0, tcpAduSize);
+                m_statistics.addBytesReceived(responsePdu.functionCode(), tcpAduSize);
 
                 if (!knownTransaction) {
                     qCDebug(QT_MODBUS) << "(TCP client) No pending request for response with "
@@ -167,6 +168,7 @@ public:
                             QModbusDevice::WriteError);
                 return false;
             }
+            m_statistics.addBytesSent(request.functionCode(), writtenBytes);
             qCDebug(QT_MODBUS_LOW) << "(TCP client) Sent TCP ADU:" << buffer.toHex();
             qCDebug(QT_MODBUS) << "(TCP client) Sent TCP PDU:" << request << "with tId:" <<Qt:: hex
                 << tId;
@@ -177,10 +179,13 @@ public:
         if (!writeToSocket(tId, request, serverAddress))
             return nullptr;
 
+        m_statistics.addRequest(request.functionCode());
+
         Q_Q(QModbusTcpClient);
         auto reply = new QModbusReply(type, serverAddress, q);
-        const auto element = QueueElement{ reply, request, unit, m_numberOfRetries,
+        auto element = QueueElement{ reply, request, unit, m_numberOfRetries,
             m_responseTimeoutDuration };
+        element.sent.start();
         m_transactionStore.insert(tId, element);
 
         q->connect(reply, &QObject::destroyed, q, [this, tId](QObject *) {
@@ -206,11 +211,14 @@ public:
                     elem.numberOfRetries--;
                     if (!writeToSocket(tId, elem.requestPdu, elem.reply->serverAddress()))
                         return;
+                    m_statistics.addRetry(elem.requestPdu.functionCode());
+                    elem.sent.start();
                     m_transactionStore.insert(tId, elem);
                     elem.timer->start();
                     qCDebug(QT_MODBUS) << "(TCP client) Resend request with tId:" << Qt::hex << tId;
                 } else {
                     qCDebug(QT_MODBUS) << "(TCP client) Timeout of request with tId:" <<Qt::hex << tId;
+                    m_statistics.addTimeout(elem.requestPdu.functionCode());
                     elem.reply->setError(QModbusDevice::TimeoutError,
                         QModbusClient::tr("Request timeout."));
                 }
@@ -55,6 +55,11 @@ QT_BEGIN_NAMESPACE
 
     Modbus TCP networks can have multiple servers. Servers are read/written by
     a client device represented by \l QModbusTcpClient.
+
+    A single QModbusTcpServer can also host many servers behind one listening
+    port, for example in gateways or simulations. Each additional server is
+    registered for its MBAP unit identifier with setVirtualServer(), and
+    requests are dispatched to it with a constant-time table lookup.
 */
 
 /*!
@@ -131,7 +136,9 @@ void QModbusTcpServer::close()
     if (d->m_tcpServer->isListening())
         d->m_tcpServer->close();
 
-    for (auto socket : qAsConst(d->connections))
+    // Disconnecting removes the connection, iterate over a copy.
+    const QList<QTcpSocket *> sockets = d->m_connections.keys();
+    for (auto socket : sockets)
         socket->disconnectFromHost();
 
     setState(QModbusDevice::UnconnectedState);
@@ -157,16 +164,9 @@ void QModbusTcpServer::close()
 */
 QModbusResponse QModbusTcpServer::processRequest(const QModbusPdu &request)
 {
-    switch (request.functionCode()) {
-    case QModbusRequest::ReadExceptionStatus:
-    case QModbusRequest::Diagnostics:
-    case QModbusRequest::GetCommEventCounter:
-    case QModbusRequest::GetCommEventLog:
-    case QModbusRequest::ReportServerId:
+    if (QModbusTcpServerPrivate::isSerialLineOnly(request.functionCode())) {
         return QModbusExceptionResponse(request.functionCode(),
             QModbusExceptionResponse::IllegalFunction);
-    default:
-        break;
     }
     return QModbusServer::processRequest(request);
 }
@@ -190,6 +190,248 @@ void QModbusTcpServer::installConnectionObserver(QModbusTcpConnectionObserver *o
     d->m_observer.reset(observer);
 }
 
+/*!
+    \since 6.1
+
+    Returns the maximum number of simultaneous client connections. The default
+    value \c 0 means the number of connections is not limited.
+
+    \sa setMaxConnections()
+*/
+int QModbusTcpServer::maxConnections() const
+{
+    Q_D(const QModbusTcpServer);
+    return d->m_maxConnections;
+}
+
+/*!
+    \since 6.1
+
+    Sets the maximum number of simultaneous client connections to
+    \a maxConnections. Once the limit is reached, further incoming connections
+    are closed right away, before the installed connection observer is asked.
+    Existing connections are not affected by lowering the limit. A value of
+    \c 0 removes the limit.
+
+    \sa maxConnections(), installConnectionObserver()
+*/
+void QModbusTcpServer::setMaxConnections(int maxConnections)
+{
+    Q_D(QModbusTcpServer);
+    d->m_maxConnections = qMax(0, maxConnections);
+}
+
+/*!
+    \since 6.1
+
+    Returns the time in milliseconds after which a client connection that did not
+    send any data is closed. The default value \c 0 disables idle eviction.
+
+    \sa setIdleTimeout()
+*/
+int QModbusTcpServer::idleTimeout() const
+{
+    Q_D(const QModbusTcpServer);
+    return d->m_idleTimeout;
+}
+
+/*!
+    \since 6.1
+
+    Sets the idle timeout to \a msecs milliseconds. Client connections that do
+    not send any data for that long are closed by the server. A value of \c 0
+    disables idle eviction.
+
+    A connection is not closed while the server stopped reading from it because
+    of the \l {setWriteBufferWaterMarks()}{write buffer high-water mark}. Its
+    idle time starts over once reading resumes.
+
+    \sa idleTimeout()
+*/
+void QModbusTcpServer::setIdleTimeout(int msecs)
+{
+    Q_D(QModbusTcpServer);
+    d->setIdleTimeout(msecs);
+}
+
+/*!
+    \since 6.1
+
+    Returns the amount of pending output, in bytes, below which the server resumes
+    reading from a client that was paused. The default value is 16 KiB.
+
+    \sa setWriteBufferWaterMarks(), writeBufferHighWaterMark()
+*/
+qint64 QModbusTcpServer::writeBufferLowWaterMark() const
+{
+    Q_D(const QModbusTcpServer);
+    return d->m_lowWaterMark;
+}
+
+/*!
+    \since 6.1
+
+    Returns the amount of pending output, in bytes, at which the server stops
+    reading requests from a client. The default value is 64 KiB.
+
+    \sa setWriteBufferWaterMarks(), writeBufferLowWaterMark()
+*/
+qint64 QModbusTcpServer::writeBufferHighWaterMark() const
+{
+    Q_D(const QModbusTcpServer);
+    return d->m_highWaterMark;
+}
+
+/*!
+    \since 6.1
+
+    Sets the write buffer water marks to \a lowWaterMark and \a highWaterMark
+    bytes.
+
+    The server answers all requests received with one read from a client using a
+    single write. Once the responses not yet written to a client reach
+    \a highWaterMark, the server stops processing and reading requests from that
+    client, which throttles it through TCP flow control. Reading resumes as soon
+    as the pending output drains to \a lowWaterMark or less.
+
+    A \a highWaterMark of \c 0 disables the backpressure. The \a lowWaterMark
+    is capped to \a highWaterMark.
+
+    \sa writeBufferLowWaterMark(), writeBufferHighWaterMark()
+*/
+void QModbusTcpServer::setWriteBufferWaterMarks(qint64 lowWaterMark, qint64 highWaterMark)
+{
+    Q_D(QModbusTcpServer);
+    d->setWaterMarks(lowWaterMark, highWaterMark);
+}
+
+/*!
+    \since 6.1
+
+    Returns the number of currently connected clients.
+*/
+int QModbusTcpServer::connectionCount() const
+{
+    Q_D(const QModbusTcpServer);
+    return int(d->m_connections.size());
+}
+
+/*!
+    \since 6.1
+
+    Returns the statistics gathered for the connected \a client. If \a client
+    is not connected to this server, default constructed statistics are returned.
+
+    \sa QModbusTcpConnectionStatistics, connectionClosed()
+*/
+QModbusTcpConnectionStatistics QModbusTcpServer::connectionStatistics(QTcpSocket *client) const
+{
+    Q_D(const QModbusTcpServer);
+    const auto it = d->m_connections.constFind(client);
+    if (it == d->m_connections.cend())
+        return {};
+    return d->snapshot(*it);
+}
+
+/*!
+    \since 6.1
+
+    Routes all requests carrying the MBAP unit identifier \a unitId to \a server,
+    which processes them with its \l {QModbusServer::}{processRequest()}
+    implementation and its own data map. Passing \c nullptr removes the route.
+
+    The \a server does not need to be connected, this server accepts the
+    connections and writes the responses. It must live in the same thread as
+    this server and is not owned by it; a deleted server is removed from the
+    routing table automatically. Options like \l QModbusServer::DeviceBusy are
+    taken from \a server.
+
+    A virtual server takes precedence over this server's own \l serverAddress().
+    Requests for unit identifiers without a route and not matching the server
+    address are ignored.
+
+    The function codes filtered by QModbusTcpServer::processRequest() are
+    answered with an exception response for every virtual server as well, since
+    they are serial line only.
+
+    \sa virtualServer()
+*/
+void QModbusTcpServer::setVirtualServer(int unitId, QModbusServer *server)
+{
+    if (unitId < 0 || unitId > 0xff) {
+        qCWarning(QT_MODBUS) << "(TCP server) Invalid unit identifier:" << unitId;
+        return;
+    }
+
+    Q_D(QModbusTcpServer);
+    d->m_virtualServers[unitId] = server;
+}
+
+/*!
+    \since 6.1
+
+    Returns the server that handles requests for the unit identifier \a unitId,
+    or \c nullptr if no virtual server is registered for it.
+
+    \sa setVirtualServer()
+*/
+QModbusServer *QModbusTcpServer::virtualServer(int unitId) const
+{
+    if (unitId < 0 || unitId > 0xff)
+        return nullptr;
+
+    Q_D(const QModbusTcpServer);
+    return d->m_virtualServers[unitId];
+}
+
+/*!
+    \class QModbusTcpConnectionStatistics
+    \inmodule QtSerialBus
+    \since 6.1
+
+    \brief The QModbusTcpConnectionStatistics struct holds the traffic counters
+    of a single client connection to a \l QModbusTcpServer.
+
+    \sa QModbusTcpServer::connectionStatistics(), QModbusTcpServer::connectionClosed()
+*/
+
+/*!
+    \variable QModbusTcpConnectionStatistics::bytesReceived
+
+    The number of bytes read from the client.
+*/
+
+/*!
+    \variable QModbusTcpConnectionStatistics::bytesSent
+
+    The number of response bytes written to the client.
+*/
+
+/*!
+    \variable QModbusTcpConnectionStatistics::requestsReceived
+
+    The number of complete Modbus ADUs received from the client, including those
+    addressed to a different unit identifier.
+*/
+
+/*!
+    \variable QModbusTcpConnectionStatistics::responsesSent
+
+    The number of responses written to the client.
+*/
+
+/*!
+    \variable QModbusTcpConnectionStatistics::connectedMSecs
+
+    The time in milliseconds since the connection was accepted.
+*/
+
+/*!
+    \variable QModbusTcpConnectionStatistics::idleMSecs
+
+    The time in milliseconds since the client last sent data.
+*/
+
 /*!
     \class QModbusTcpConnectionObserver
     \inmodule QtSerialBus
@@ -233,4 +475,16 @@ QModbusTcpConnectionObserver::~QModbusTcpConnectionObserver()
   \since 5.13
 */
 
+/*!
+  \fn void QModbusTcpServer::connectionClosed(QTcpSocket *modbusClient, const QModbusTcpConnectionStatistics &statistics)
+  \since 6.1
+
+  This signal is emitted when the connection to \a modbusClient has been
+  closed, either by the client or by the server, for example due to the idle
+  timeout. The final traffic counters of the connection are passed as
+  \a statistics. The signal is emitted right before modbusClientDisconnected().
+
+  \sa setIdleTimeout(), connectionStatistics()
+*/
+
 QT_END_NAMESPACE
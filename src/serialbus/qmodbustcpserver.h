@@ -45,6 +45,16 @@ QT_BEGIN_NAMESPACE
 class QModbusTcpServerPrivate;
 class QTcpSocket;
 
+struct QModbusTcpConnectionStatistics
+{
+    quint64 bytesReceived = 0;
+    quint64 bytesSent = 0;
+    quint64 requestsReceived = 0;
+    quint64 responsesSent = 0;
+    qint64 connectedMSecs = 0;
+    qint64 idleMSecs = 0;
+};
+
 class Q_SERIALBUS_EXPORT QModbusTcpConnectionObserver
 {
 public:
@@ -64,8 +74,26 @@ public:
 
     void installConnectionObserver(QModbusTcpConnectionObserver *observer);
 
+    int maxConnections() const;
+    void setMaxConnections(int maxConnections);
+
+    int idleTimeout() const;
+    void setIdleTimeout(int msecs);
+
+    qint64 writeBufferLowWaterMark() const;
+    qint64 writeBufferHighWaterMark() const;
+    void setWriteBufferWaterMarks(qint64 lowWaterMark, qint64 highWaterMark);
+
+    int connectionCount() const;
+    QModbusTcpConnectionStatistics connectionStatistics(QTcpSocket *client) const;
+
+    void setVirtualServer(int unitId, QModbusServer *server);
+    QModbusServer *virtualServer(int unitId) const;
+
 Q_SIGNALS:
     void modbusClientDisconnected(QTcpSocket *modbusClient);
+    void connectionClosed(QTcpSocket *modbusClient,
+                          const QModbusTcpConnectionStatistics &statistics);
 
 protected:
     QModbusTcpServer(QModbusTcpServerPrivate &dd, QObject *parent = nullptr);
@@ -76,6 +104,10 @@ protected:
     QModbusResponse processRequest(const QModbusPdu &request) override;
 };
 
+Q_DECLARE_TYPEINFO(QModbusTcpConnectionStatistics, Q_PRIMITIVE_TYPE);
+
 QT_END_NAMESPACE
 
+Q_DECLARE_METATYPE(QModbusTcpConnectionStatistics)
+
 #endif // QMODBUSTCPSERVER_H
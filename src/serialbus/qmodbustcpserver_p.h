@@ -39,8 +39,13 @@
 
 #include <QtCore/qdatastream.h>
 #include <QtCore/qdebug.h>
+#include <QtCore/qelapsedtimer.h>
+#include <QtCore/qendian.h>
+#include <QtCore/qhash.h>
 #include <QtCore/qloggingcategory.h>
 #include <QtCore/qobject.h>
+#include <QtCore/qpointer.h>
+#include <QtCore/qtimer.h>
 #include <QtNetwork/qhostaddress.h>
 #include <QtNetwork/qtcpserver.h>
 #include <QtNetwork/qtcpsocket.h>
@@ -48,7 +53,9 @@
 
 #include <private/qmodbusserver_p.h>
 
+#include <array>
 #include <memory>
+#include <vector>
 
 //
 //  W A R N I N G
@@ -72,19 +79,43 @@ class QModbusTcpServerPrivate : public QModbusServerPrivate
 
 public:
     /*
-        This function is a workaround since 2nd level lambda below cannot
-        call protected QModbusTcpServer::processRequest(..) function on VS2013.
+        Returns true for the function codes that the Modbus Application Protocol
+        Specification 1.1b defines for serial lines only.
     */
-    QModbusResponse forwardProcessRequest(const QModbusRequest &r)
+    static bool isSerialLineOnly(QModbusPdu::FunctionCode code)
     {
-        Q_Q(QModbusTcpServer);
-        if (q->value(QModbusServer::DeviceBusy).value<quint16>() == 0xffff) {
+        switch (code) {
+        case QModbusRequest::ReadExceptionStatus:
+        case QModbusRequest::Diagnostics:
+        case QModbusRequest::GetCommEventCounter:
+        case QModbusRequest::GetCommEventLog:
+        case QModbusRequest::ReportServerId:
+            return true;
+        default:
+            return false;
+        }
+    }
+
+    /*
+        Calls the protected QModbusServer::processRequest(..) function of either this
+        server or of a virtual server registered for the request's unit identifier.
+        Virtual servers of any type refuse serial line only requests like this server's
+        processRequest() does, since the requests arrived over TCP.
+    */
+    QModbusResponse forwardProcessRequest(QModbusServer *server, const QModbusRequest &r)
+    {
+        if (server != q_func() && isSerialLineOnly(r.functionCode())) {
+            return QModbusExceptionResponse(r.functionCode(),
+                QModbusExceptionResponse::IllegalFunction);
+        }
+        if (server->value(QModbusServer::DeviceBusy).value<quint16>() == 0xffff) {
             // If the device is busy, send an exception response without processing.
-            incrementCounter(QModbusServerPrivate::Counter::ServerBusy);
+            static_cast<QModbusServerPrivate *>(QObjectPrivate::get(server))
+                ->incrementCounter(QModbusServerPrivate::Counter::ServerBusy);
             return QModbusExceptionResponse(r.functionCode(),
                 QModbusExceptionResponse::ServerDeviceBusy);
         }
-        return q->processRequest(r);
+        return QModbusServerPrivate::invokeProcessRequest(server, r);
     }
 
     /*
@@ -98,23 +129,36 @@ public:
     }
 
     /*
-        This function is a workaround since 2nd level lambda below
-        cannot call QModbusServer::serverAddress(..) function on VS2013.
+        Returns the server that handles requests for the given unit identifier, a
+        registered virtual server takes precedence over this server's own address.
     */
-    bool matchingServerAddress(quint8 unitId) const
+    QModbusServer *serverForUnit(quint8 unitId)
     {
-        Q_Q(const QModbusTcpServer);
+        if (QModbusServer *server = m_virtualServers[unitId])
+            return server;
+
+        Q_Q(QModbusTcpServer);
         if (q->serverAddress() == unitId)
-            return true;
+            return q;
 
         // No, not our address! Ignore!
         qCDebug(QT_MODBUS) << "(TCP server) Wrong server unit identifier address, expected"
             << q->serverAddress() << "got" << unitId;
-        return false;
+        return nullptr;
     }
 
+    struct Connection
+    {
+        QByteArray buffer;
+        qint64 acceptedAt = 0;
+        qint64 lastActivity = 0;
+        QModbusTcpConnectionStatistics statistics;
+        bool paused = false;
+    };
+
     void setupTcpServer()
     {
+        m_clock.start();
         m_tcpServer = new QTcpServer(q_func());
         QObject::connect(m_tcpServer, &QTcpServer::newConnection, q_func(), [this]() {
             Q_Q(QModbusTcpServer);
@@ -125,6 +169,14 @@ public:
             qCDebug(QT_MODBUS) << "(TCP server) Incoming socket from" << socket->peerAddress()
                                << socket->peerName() << socket->peerPort();
 
+            if (m_maxConnections > 0 && m_connections.size() >= m_maxConnections) {
+                qCDebug(QT_MODBUS) << "(TCP server) Connection rejected, limit of"
+                                   << m_maxConnections << "connections reached";
+                socket->abort();
+                socket->deleteLater();
+                return;
+            }
+
             if (m_observer && !m_observer->acceptNewConnection(socket)) {
                 qCDebug(QT_MODBUS) << "(TCP server) Connection rejected by observer";
                 socket->close();
@@ -132,86 +184,29 @@ public:
                 return;
             }
 
-            connections.append(socket);
+            Connection &connection = m_connections[socket];
+            connection.buffer = acquireBuffer();
+            connection.acceptedAt = connection.lastActivity = m_clock.elapsed();
 
-            auto buffer = new QByteArray();
-
-            QObject::connect(socket, &QObject::destroyed, q, [buffer]() {
-                // cleanup buffer
-                delete buffer;
-            });
             QObject::connect(socket, &QTcpSocket::disconnected, q, [socket, this]() {
-                connections.removeAll(socket);
+                auto it = m_connections.find(socket);
+                if (it == m_connections.end())
+                    return;
+
+                const QModbusTcpConnectionStatistics statistics = snapshot(*it);
+                releaseBuffer(std::move(it->buffer));
+                m_connections.erase(it);
 
                 Q_Q(QModbusTcpServer);
+                emit q->connectionClosed(socket, statistics);
                 emit q->modbusClientDisconnected(socket);
                 socket->deleteLater();
             });
-            QObject::connect(socket, &QTcpSocket::readyRead, q, [buffer, socket, this]() {
-                if (!socket)
-                    return;
-
-                buffer->append(socket->readAll());
-                while (!buffer->isEmpty()) {
-                    qCDebug(QT_MODBUS_LOW).noquote() << "(TCP server) Read buffer: 0x"
-                        + buffer->toHex();
-
-                    if (buffer->size() < mbpaHeaderSize) {
-                        qCDebug(QT_MODBUS) << "(TCP server) ADU too short. Waiting for more data.";
-                        return;
-                    }
-
-                    quint8 unitId;
-                    quint16 transactionId, bytesPdu, protocolId;
-                    QDataStream input(*buffer);
-                    input >> transactionId >> protocolId >> bytesPdu >> unitId;
-
-                    qCDebug(QT_MODBUS_LOW) << "(TCP server) Request MBPA:" << "Transaction Id:"
-                        << Qt::hex << transactionId << "Protocol Id:" << protocolId << "PDU bytes:"
-                        << bytesPdu << "Unit Id:" << unitId;
-
-                    // The length field is the byte count of the following fields, including the Unit
-                    // Identifier and the PDU, so we remove on byte.
-                    bytesPdu--;
-
-                    if (buffer->size() < mbpaHeaderSize + bytesPdu) {
-                        qCDebug(QT_MODBUS) << "(TCP server) PDU too short. Waiting for more data";
-                        return;
-                    }
-
-                    QModbusRequest request;
-                    input >> request;
-
-                    buffer->remove(0, mbpaHeaderSize + bytesPdu);
-
-                    if (!matchingServerAddress(unitId))
-                        continue;
-
-                    qCDebug(QT_MODBUS) << "(TCP server) Request PDU:" << request;
-                    const QModbusResponse response = forwardProcessRequest(request);
-                    qCDebug(QT_MODBUS) << "(TCP server) Response PDU:" << response;
-
-                    QByteArray result;
-                    QDataStream output(&result, QIODevice::WriteOnly);
-                    // The length field is the byte count of the following fields, including the Unit
-                    // Identifier and PDU fields, so we add one byte to the response size.
-                    output << transactionId << protocolId << quint16(response.size() + 1)
-                           << unitId << response;
-
-                    if (!socket->isOpen()) {
-                        qCDebug(QT_MODBUS) << "(TCP server) Requesting socket has closed.";
-                        forwardError(QModbusTcpServer::tr("Requesting socket is closed"),
-                                     QModbusDevice::WriteError);
-                        return;
-                    }
-
-                    qint64 writtenBytes = socket->write(result);
-                    if (writtenBytes == -1 || writtenBytes < result.size()) {
-                        qCDebug(QT_MODBUS) << "(TCP server) Cannot write requested response to socket.";
-                        forwardError(QModbusTcpServer::tr("Could not write response to client"),
-                                     QModbusDevice::WriteError);
-                    }
-                }
+            QObject::connect(socket, &QTcpSocket::readyRead, q, [socket, this]() {
+                onReadyRead(socket);
+            });
+            QObject::connect(socket, &QTcpSocket::bytesWritten, q, [socket, this]() {
+                onBytesWritten(socket);
             });
         });
 
@@ -222,15 +217,268 @@ public:
             qCWarning(QT_MODBUS) << "(TCP server) Accept error";
             q->setError(m_tcpServer->errorString(), QModbusDevice::ConnectionError);
         });
+
+        m_idleTimer = new QTimer(q_func());
+        QObject::connect(m_idleTimer, &QTimer::timeout, q_func(), [this]() {
+            evictIdleConnections();
+        });
+    }
+
+    void onReadyRead(QTcpSocket *socket)
+    {
+        auto it = m_connections.find(socket);
+        if (it == m_connections.end() || it->paused)
+            return;
+
+        // Read straight into the pooled buffer, it keeps its capacity between reads.
+        QByteArray *buffer = &it->buffer;
+        const qint64 available = socket->bytesAvailable();
+        if (available > 0) {
+            const qsizetype previousSize = buffer->size();
+            buffer->resize(previousSize + available);
+            const qint64 read = qMax<qint64>(0,
+                socket->read(buffer->data() + previousSize, available));
+            buffer->resize(previousSize + read);
+
+            it->lastActivity = m_clock.elapsed();
+            it->statistics.bytesReceived += quint64(read);
+        }
+
+        // All responses to the requests of this read are sent with a single write.
+        QByteArray output;
+        QDataStream stream(&output, QIODevice::WriteOnly);
+        quint64 responses = 0;
+
+        qsizetype offset = 0;
+        while (offset < buffer->size()) {
+            if (m_highWaterMark > 0
+                    && socket->bytesToWrite() + output.size() >= m_highWaterMark) {
+                qCDebug(QT_MODBUS) << "(TCP server) Pending output exceeds the high-water mark,"
+                                      " pausing reads";
+                it->paused = true;
+                // Let the socket stop reading, so the TCP window throttles the client.
+                socket->setReadBufferSize(maxBytesModbusADU);
+                break;
+            }
+
+            const char *adu = buffer->constData() + offset;
+            const qsizetype left = buffer->size() - offset;
+            qCDebug(QT_MODBUS_LOW).noquote() << "(TCP server) Read buffer: 0x"
+                + QByteArray::fromRawData(adu, left).toHex();
+
+            if (left < mbpaHeaderSize) {
+                qCDebug(QT_MODBUS) << "(TCP server) ADU too short. Waiting for more data.";
+                break;
+            }
+
+            const quint16 transactionId = qFromBigEndian<quint16>(adu);
+            const quint16 protocolId = qFromBigEndian<quint16>(adu + 2);
+            quint16 bytesPdu = qFromBigEndian<quint16>(adu + 4);
+            const quint8 unitId = quint8(adu[6]);
+
+            qCDebug(QT_MODBUS_LOW) << "(TCP server) Request MBPA:" << "Transaction Id:"
+                << Qt::hex << transactionId << "Protocol Id:" << protocolId << "PDU bytes:"
+                << bytesPdu << "Unit Id:" << unitId;
+
+            // The length field is the byte count of the following fields, including the Unit
+            // Identifier and the PDU, so we remove on byte.
+            bytesPdu--;
+
+            if (left < mbpaHeaderSize + bytesPdu) {
+                qCDebug(QT_MODBUS) << "(TCP server) PDU too short. Waiting for more data";
+                break;
+            }
+
+            QModbusRequest request;
+            {
+                QDataStream input(QByteArray::fromRawData(adu + mbpaHeaderSize, bytesPdu));
+                input >> request;
+            }
+            offset += mbpaHeaderSize + bytesPdu;
+            ++it->statistics.requestsReceived;
+            m_statistics.addBytesReceived(request.functionCode(), mbpaHeaderSize + bytesPdu);
+
+            QModbusServer *server = serverForUnit(unitId);
+            if (!server)
+                continue;
+
+            qCDebug(QT_MODBUS) << "(TCP server) Request PDU:" << request;
+            m_statistics.addRequest(request.functionCode());
+            QElapsedTimer processingTime;
+            processingTime.start();
+            const QModbusResponse response = forwardProcessRequest(server, request);
+            m_statistics.addLatency(request.functionCode(), processingTime.nsecsElapsed());
+            qCDebug(QT_MODBUS) << "(TCP server) Response PDU:" << response;
+
+            // Processing the request may run user code that closes the connection, or
+            // accepts a new one, so the connection needs to be looked up again.
+            it = m_connections.find(socket);
+            if (it == m_connections.end())
+                return;
+            buffer = &it->buffer;
+
+            // The length field is the byte count of the following fields, including the Unit
+            // Identifier and PDU fields, so we add one byte to the response size.
+            stream << transactionId << protocolId << quint16(response.size() + 1)
+                   << unitId << response;
+            ++responses;
+            m_statistics.addResponse(response);
+            m_statistics.addBytesSent(request.functionCode(), mbpaHeaderSize + response.size());
+        }
+        buffer->remove(0, offset);
+
+        // What is left is at most a partial ADU, unless reading was paused. Anything larger
+        // comes from a bogus length field, so drop the client instead of buffering without bound.
+        if (!it->paused && buffer->size() > maxBytesModbusADU) {
+            qCWarning(QT_MODBUS) << "(TCP server) Pending request exceeds the maximum ADU size,"
+                                    " closing connection";
+            buffer->resize(0);
+            socket->abort();
+            return;
+        }
+
+        if (output.isEmpty())
+            return;
+
+        if (!socket->isOpen()) {
+            qCDebug(QT_MODBUS) << "(TCP server) Requesting socket has closed.";
+            forwardError(QModbusTcpServer::tr("Requesting socket is closed"),
+                         QModbusDevice::WriteError);
+            return;
+        }
+
+        const qint64 writtenBytes = socket->write(output);
+        if (writtenBytes == -1 || writtenBytes < output.size()) {
+            qCDebug(QT_MODBUS) << "(TCP server) Cannot write requested response to socket.";
+            forwardError(QModbusTcpServer::tr("Could not write response to client"),
+                         QModbusDevice::WriteError);
+        } else {
+            it->statistics.responsesSent += responses;
+            it->statistics.bytesSent += quint64(writtenBytes);
+        }
+    }
+
+    void onBytesWritten(QTcpSocket *socket)
+    {
+        auto it = m_connections.find(socket);
+        if (it == m_connections.end() || !it->paused)
+            return;
+        if (socket->bytesToWrite() > m_lowWaterMark)
+            return;
+
+        qCDebug(QT_MODBUS) << "(TCP server) Pending output below the low-water mark,"
+                              " resuming reads";
+        resumeReading(socket, it);
+    }
+
+    void resumeReading(QTcpSocket *socket, QHash<QTcpSocket *, Connection>::iterator it)
+    {
+        it->paused = false;
+        // The idle time starts over, the client could not be read while paused.
+        it->lastActivity = m_clock.elapsed();
+        socket->setReadBufferSize(0);
+        // Handle the requests still buffered, and whatever arrived while paused.
+        onReadyRead(socket);
+    }
+
+    void setWaterMarks(qint64 lowWaterMark, qint64 highWaterMark)
+    {
+        m_highWaterMark = qMax<qint64>(0, highWaterMark);
+        m_lowWaterMark = qBound<qint64>(0, lowWaterMark, m_highWaterMark);
+
+        // Resume any connection the new marks no longer hold back.
+        const QList<QTcpSocket *> sockets = m_connections.keys();
+        for (QTcpSocket *socket : sockets) {
+            auto it = m_connections.find(socket);
+            if (it == m_connections.end() || !it->paused)
+                continue;
+            if (m_highWaterMark == 0 || socket->bytesToWrite() <= m_lowWaterMark)
+                resumeReading(socket, it);
+        }
+    }
+
+    QByteArray acquireBuffer()
+    {
+        if (m_bufferPool.empty()) {
+            QByteArray buffer;
+            buffer.reserve(maxBytesModbusADU);
+            return buffer;
+        }
+        QByteArray buffer = std::move(m_bufferPool.back());
+        m_bufferPool.pop_back();
+        return buffer;
+    }
+
+    void releaseBuffer(QByteArray &&buffer)
+    {
+        // Keep a bounded number of buffers around, and none that grew unusually large.
+        if (m_bufferPool.size() >= maxPooledBuffers || buffer.capacity() > maxPooledBufferSize)
+            return;
+        buffer.resize(0);
+        m_bufferPool.push_back(std::move(buffer));
+    }
+
+    QModbusTcpConnectionStatistics snapshot(const Connection &connection) const
+    {
+        QModbusTcpConnectionStatistics statistics = connection.statistics;
+        const qint64 now = m_clock.elapsed();
+        statistics.connectedMSecs = now - connection.acceptedAt;
+        statistics.idleMSecs = now - connection.lastActivity;
+        return statistics;
+    }
+
+    void setIdleTimeout(int msecs)
+    {
+        m_idleTimeout = qMax(0, msecs);
+        if (m_idleTimeout == 0) {
+            m_idleTimer->stop();
+            return;
+        }
+        // Check a few times per timeout period, connections are closed at most a quarter late.
+        m_idleTimer->start(qMax(10, m_idleTimeout / 4));
+    }
+
+    void evictIdleConnections()
+    {
+        if (m_idleTimeout <= 0)
+            return;
+
+        const qint64 now = m_clock.elapsed();
+        QList<QTcpSocket *> idle;
+        for (auto it = m_connections.cbegin(); it != m_connections.cend(); ++it) {
+            // A paused client is waiting for its responses to drain, not idle.
+            if (!it->paused && now - it->lastActivity >= m_idleTimeout)
+                idle.append(it.key());
+        }
+
+        // Disconnecting may remove the connection synchronously, so do it outside the loop.
+        for (QTcpSocket *socket : qAsConst(idle)) {
+            qCDebug(QT_MODBUS) << "(TCP server) Closing idle connection from"
+                               << socket->peerAddress() << socket->peerPort();
+            socket->disconnectFromHost();
+        }
     }
 
     QTcpServer *m_tcpServer { nullptr };
-    QList<QTcpSocket *> connections;
+    QHash<QTcpSocket *, Connection> m_connections;
+    std::vector<QByteArray> m_bufferPool;
+
+    QElapsedTimer m_clock;
+    QTimer *m_idleTimer = nullptr;
+    int m_idleTimeout = 0;
+    int m_maxConnections = 0;
+    qint64 m_highWaterMark = 64 * 1024;
+    qint64 m_lowWaterMark = 16 * 1024;
 
     std::unique_ptr<QModbusTcpConnectionObserver> m_observer;
 
+    // Indexed by the MBAP unit identifier, QPointer drops servers deleted elsewhere.
+    std::array<QPointer<QModbusServer>, 256> m_virtualServers;
+
     static const qint8 mbpaHeaderSize = 7;
     static const qint16 maxBytesModbusADU = 260;
+    static const size_t maxPooledBuffers = 1024;
+    static const qsizetype maxPooledBufferSize = 4096;
 };
 
 QT_END_NAMESPACE
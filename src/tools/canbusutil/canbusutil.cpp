@@ -37,6 +37,7 @@
 #include "canbusutil.h"
 
 #include <QCoreApplication>
+#include <QFile>
 #include <QTextStream>
 
 CanBusUtil::CanBusUtil(QTextStream &output, QCoreApplication &app, QObject *parent) :
@@ -58,6 +59,18 @@ void CanBusUtil::setShowFlags(bool showFlags)
     m_readTask->setShowFlags(showFlags);
 }
 
+GenerateTask *CanBusUtil::generator()
+{
+    if (!m_generateTask)
+        m_generateTask = new GenerateTask(m_output, this);
+    return m_generateTask;
+}
+
+void CanBusUtil::setRecordFileName(const QString &fileName)
+{
+    m_recordFileName = fileName;
+}
+
 void CanBusUtil::setConfigurationParameter(QCanBusDevice::ConfigurationKey key,
                                            const QVariant &value)
 {
@@ -74,16 +87,21 @@ bool CanBusUtil::start(const QString &pluginName, const QString &deviceName, con
     m_pluginName = pluginName;
     m_deviceName = deviceName;
     m_data = data;
-    m_listening = data.isEmpty();
+    m_listening = data.isEmpty() && !m_generateTask;
 
     if (!connectCanDevice())
         return false;
 
     if (m_listening) {
+        if (!m_recordFileName.isEmpty() && !m_readTask->startRecording(m_recordFileName))
+            return false;
         if (m_readTask->isShowFlags())
              m_canDevice->setConfigurationParameter(QCanBusDevice::CanFdKey, true);
         connect(m_canDevice.data(), &QCanBusDevice::framesReceived,
                 m_readTask, &ReadTask::handleFrames);
+    } else if (m_generateTask) {
+        connect(m_generateTask, &GenerateTask::finished, &m_app, QCoreApplication::quit);
+        m_generateTask->start(m_canDevice.data());
     } else {
         if (!sendData())
             return false;
@@ -125,6 +143,106 @@ int CanBusUtil::printDevices(const QString &pluginName)
     return 0;
 }
 
+int CanBusUtil::convertLog(const QString &inputFileName, const QString &outputFileName)
+{
+    enum { RecorderFlushInterval = 65536 };     // frames, keeps the recorder from dropping
+
+    const QString standardStream = QStringLiteral("-");
+    QFile input(inputFileName);
+    const bool inputOpen = inputFileName == standardStream ? input.open(stdin, QIODevice::ReadOnly)
+                                                           : input.open(QIODevice::ReadOnly);
+    if (!inputOpen) {
+        m_output << tr("Cannot open '%1': %2").arg(inputFileName, input.errorString())
+                 << Qt::endl;
+        return 1;
+    }
+
+    // Binary frame logs start with their magic, candump lines with the time stamp.
+    const QByteArray head = input.peek(4096);
+    const bool binaryInput = head.startsWith("QtCanLog");
+    const bool candumpInput = head.trimmed().startsWith('(');
+
+    QCanBusFrameLogReader logReader;
+    QCanBusTextLogReader textReader(candumpInput ? QCanBusTextLogReader::CandumpFormat
+                                                 : QCanBusTextLogReader::AscFormat);
+    if (binaryInput) {
+        input.close();
+        if (!logReader.open(inputFileName)) {
+            m_output << tr("Cannot read '%1': %2").arg(inputFileName, logReader.errorString())
+                     << Qt::endl;
+            return 1;
+        }
+    } else {
+        textReader.setDevice(&input);
+    }
+
+    const bool binaryOutput = outputFileName.endsWith(QLatin1String(".qcanlog"),
+                                                      Qt::CaseInsensitive);
+    QFile output(outputFileName);
+    QCanBusFrameRecorder recorder;
+    QCanBusTextLogWriter textWriter(
+        outputFileName.endsWith(QLatin1String(".asc"), Qt::CaseInsensitive)
+            ? QCanBusTextLogReader::AscFormat : QCanBusTextLogReader::CandumpFormat);
+    if (binaryOutput) {
+        if (!recorder.open(outputFileName)) {
+            m_output << tr("Cannot open '%1': %2").arg(outputFileName, recorder.errorString())
+                     << Qt::endl;
+            return 1;
+        }
+    } else {
+        const bool outputOpen = outputFileName == standardStream
+                ? output.open(stdout, QIODevice::WriteOnly)
+                : output.open(QIODevice::WriteOnly);
+        if (!outputOpen) {
+            m_output << tr("Cannot open '%1': %2").arg(outputFileName, output.errorString())
+                     << Qt::endl;
+            return 1;
+        }
+        textWriter.setDevice(&output);
+    }
+
+    quint64 frames = 0;
+    bool written = true;
+    QCanBusFrame frame;
+    while (written && (binaryInput ? logReader.readFrame(&frame) : textReader.readFrame(&frame))) {
+        if (binaryOutput) {
+            written = recorder.record(frame);
+            if (written && (frames + 1) % RecorderFlushInterval == 0)
+                written = recorder.flush();
+        } else {
+            written = textWriter.writeFrame(frame);
+        }
+        if (written)
+            ++frames;
+    }
+
+    if (binaryOutput) {
+        written = recorder.close() && written;
+    } else {
+        written = textWriter.finish() && written;
+    }
+    if (!written) {
+        m_output << tr("Cannot write '%1': %2").arg(outputFileName, binaryOutput
+                                                    ? recorder.errorString()
+                                                    : textWriter.errorString()) << Qt::endl;
+        return 1;
+    }
+    if (!binaryInput && textReader.error() != QCanBusTextLogReader::NoError) {
+        m_output << tr("Cannot read '%1': %2").arg(inputFileName, textReader.errorString())
+                 << Qt::endl;
+        return 1;
+    }
+
+    if (outputFileName != standardStream) {
+        m_output << tr("Converted %1 frames.").arg(frames) << Qt::endl;
+        if (!binaryInput && textReader.skippedLines() > 0) {
+            m_output << tr("Skipped %1 lines without a frame.").arg(textReader.skippedLines())
+                     << Qt::endl;
+        }
+    }
+    return 0;
+}
+
 bool CanBusUtil::parseDataField(quint32 &id, QString &payload)
 {
     int hashMarkPos = m_data.indexOf('#');
@@ -212,7 +330,13 @@ bool CanBusUtil::connectCanDevice()
     for (auto i = m_configurationParameter.constBegin(); i != constEnd; ++i)
         m_canDevice->setConfigurationParameter(i.key(), i.value());
 
-    connect(m_canDevice.data(), &QCanBusDevice::errorOccurred, m_readTask, &ReadTask::handleError);
+    if (m_generateTask) {
+        connect(m_canDevice.data(), &QCanBusDevice::errorOccurred,
+                m_generateTask, &GenerateTask::handleError);
+    } else {
+        connect(m_canDevice.data(), &QCanBusDevice::errorOccurred,
+                m_readTask, &ReadTask::handleError);
+    }
     if (!m_canDevice->connectDevice()) {
         m_output << tr("Cannot create CAN bus device: '%1'").arg(m_deviceName) << Qt::endl;
         return false;
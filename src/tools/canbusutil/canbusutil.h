@@ -37,6 +37,7 @@
 #ifndef CANBUSUTIL_H
 #define CANBUSUTIL_H
 
+#include "generatetask.h"
 #include "readtask.h"
 
 #include <QObject>
@@ -58,10 +59,13 @@ public:
 
     void setShowTimeStamp(bool showTimeStamp);
     void setShowFlags(bool showFlags);
+    void setRecordFileName(const QString &fileName);
     void setConfigurationParameter(QCanBusDevice::ConfigurationKey key, const QVariant &value);
     bool start(const QString &pluginName, const QString &deviceName, const QString &data = QString());
     int  printPlugins();
     int  printDevices(const QString &pluginName);
+    GenerateTask *generator();
+    int  convertLog(const QString &inputFileName, const QString &outputFileName);
 
 private:
     bool parseDataField(quint32 &id, QString &payload);
@@ -77,8 +81,10 @@ private:
     QString m_pluginName;
     QString m_deviceName;
     QString m_data;
+    QString m_recordFileName;
     QScopedPointer<QCanBusDevice> m_canDevice;
     ReadTask *m_readTask = nullptr;
+    GenerateTask *m_generateTask = nullptr;
     using ConfigurationParameter = QHash<QCanBusDevice::ConfigurationKey, QVariant>;
     ConfigurationParameter m_configurationParameter;
 };
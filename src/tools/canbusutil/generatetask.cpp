@@ -0,0 +1,355 @@
+/****************************************************************************
+**
+** Copyright (C) 2021 The Qt Company Ltd.
+** Contact: http://www.qt.io/licensing/
+**
+** This file is part of the tools applications of the QtSerialBus module.
+**
+** $QT_BEGIN_LICENSE:LGPL3$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see http://www.qt.io/terms-conditions. For further
+** information use the contact form at http://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPLv3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or later as published by the Free
+** Software Foundation and appearing in the file LICENSE.GPL included in
+** the packaging of this file. Please review the following information to
+** ensure the GNU General Public License version 2.0 requirements will be
+** met: http://www.gnu.org/licenses/gpl-2.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include "generatetask.h"
+
+#include <QTextStream>
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstring>
+#include <iterator>
+
+namespace {
+
+// Valid CAN FD payload lengths, the first nine are the classic CAN lengths.
+constexpr qsizetype Lengths[] = { 0, 1, 2, 3, 4, 5, 6, 7, 8, 12, 16, 20, 24, 32, 48, 64 };
+constexpr qsizetype ClassicLengths = 9;
+constexpr qsizetype FlexibleDataRateLengths = sizeof(Lengths) / sizeof(Lengths[0]);
+
+} // namespace
+
+GenerateTask::GenerateTask(QTextStream &output, QObject *parent) :
+    QObject(parent),
+    m_output(output),
+    m_random(QRandomGenerator::global()->generate())
+{
+    m_timer.setSingleShot(true);
+    m_timer.setTimerType(Qt::PreciseTimer);
+    connect(&m_timer, &QTimer::timeout, this, &GenerateTask::generate);
+}
+
+GenerateTask::~GenerateTask()
+{
+    if (m_elapsed.isValid())
+        report(true);
+}
+
+bool GenerateTask::parsePattern(const QString &pattern, Pattern *mode)
+{
+    if (pattern == QLatin1String("i"))
+        *mode = Incrementing;
+    else if (pattern == QLatin1String("r"))
+        *mode = Random;
+    else
+        return false;
+    return true;
+}
+
+bool GenerateTask::setIdPattern(const QString &pattern)
+{
+    if (parsePattern(pattern, &m_idPattern))
+        return true;
+
+    bool ok = false;
+    const uint id = pattern.toUInt(&ok, 16);
+    if (!ok || id > 0x1FFFFFFF)
+        return false;
+    m_idPattern = Fixed;
+    m_fixedId = id;
+    return true;
+}
+
+bool GenerateTask::setLengthPattern(const QString &pattern)
+{
+    if (parsePattern(pattern, &m_lengthPattern))
+        return true;
+
+    bool ok = false;
+    const int length = pattern.toInt(&ok);
+    if (!ok || length < 0 || length > 64)
+        return false;
+    m_lengthPattern = Fixed;
+    // Round up to the next length a CAN FD frame can carry.
+    m_fixedLength = *std::lower_bound(std::begin(Lengths), std::end(Lengths), length);
+    if (m_fixedLength > 8)
+        m_flexibleDataRate = true;
+    return true;
+}
+
+bool GenerateTask::setPayloadPattern(const QString &pattern)
+{
+    if (parsePattern(pattern, &m_payloadPattern))
+        return true;
+
+    const QByteArray hex = pattern.toLatin1();
+    const auto isHexDigit = [](char c) { return std::isxdigit(uchar(c)) != 0; };
+    if (hex.size() % 2 != 0 || hex.size() > 128 || !std::all_of(hex.cbegin(), hex.cend(), isHexDigit))
+        return false;
+    m_payloadPattern = Fixed;
+    m_fixedPayload = QByteArray::fromHex(hex);
+    if (m_fixedPayload.size() > 8)
+        m_flexibleDataRate = true;
+    return true;
+}
+
+void GenerateTask::setRate(double framesPerSecond)
+{
+    m_rate = framesPerSecond;
+}
+
+void GenerateTask::setBurst(int frames)
+{
+    m_burst = qMax(frames, 1);
+}
+
+void GenerateTask::setCount(qint64 frames)
+{
+    m_count = frames;
+}
+
+void GenerateTask::setExtendedFrameFormat(bool extended)
+{
+    m_extended = extended;
+}
+
+void GenerateTask::setFlexibleDataRate(bool flexibleDataRate)
+{
+    m_flexibleDataRate = flexibleDataRate;
+}
+
+void GenerateTask::setBitrateSwitch(bool bitrateSwitch)
+{
+    m_bitrateSwitch = bitrateSwitch;
+    if (bitrateSwitch)
+        m_flexibleDataRate = true;
+}
+
+bool GenerateTask::isFlexibleDataRate() const
+{
+    return m_flexibleDataRate;
+}
+
+void GenerateTask::start(QCanBusDevice *device)
+{
+    m_device = device;
+    m_measureLatency = device->configurationParameter(QCanBusDevice::ReceiveOwnKey).toBool();
+    // Received frames are drained even without latency measurement, so they do not pile up.
+    connect(device, &QCanBusDevice::framesReceived, this, &GenerateTask::handleFrames);
+
+    m_elapsed.start();
+    m_nextBurst = 0;
+    m_nextReport = qint64(ReportInterval) * 1000000;
+    generate();
+}
+
+qsizetype GenerateTask::nextLength()
+{
+    const qsizetype count = m_flexibleDataRate ? FlexibleDataRateLengths : ClassicLengths;
+    switch (m_lengthPattern) {
+    case Fixed:
+        return m_fixedLength;
+    case Incrementing: {
+        const qsizetype length = Lengths[m_nextLengthIndex];
+        m_nextLengthIndex = (m_nextLengthIndex + 1) % count;
+        return length;
+    }
+    case Random:
+        break;
+    }
+    return Lengths[m_random.bounded(int(count))];
+}
+
+QCanBusFrame GenerateTask::nextFrame()
+{
+    const quint32 maximumId = m_extended ? 0x1FFFFFFF : 0x7FF;
+    quint32 id = m_fixedId;
+    if (m_idPattern == Incrementing) {
+        id = m_nextId;
+        m_nextId = m_nextId >= maximumId ? 0 : m_nextId + 1;
+    } else if (m_idPattern == Random) {
+        id = m_random.bounded(maximumId + 1);
+    }
+
+    QByteArray payload = m_fixedPayload;
+    if (m_payloadPattern != Fixed) {
+        const qsizetype length = nextLength();
+        payload = QByteArray(length, Qt::Uninitialized);
+        char *data = payload.data();
+        if (m_payloadPattern == Incrementing) {
+            for (qsizetype i = 0; i < length; ++i)
+                data[i] = char(m_payloadCounter >> (8 * (i % 8)));
+            ++m_payloadCounter;
+        } else {
+            for (qsizetype i = 0; i < length; i += 4) {
+                const quint32 value = m_random.generate();
+                std::memcpy(data + i, &value, size_t(qMin(qsizetype(4), length - i)));
+            }
+        }
+    }
+
+    QCanBusFrame frame(id, payload);
+    frame.setExtendedFrameFormat(m_extended || id > 0x7FF);
+    if (m_flexibleDataRate) {
+        frame.setFlexibleDataRateFormat(true);
+        frame.setBitrateSwitch(m_bitrateSwitch);
+    }
+    return frame;
+}
+
+void GenerateTask::generate()
+{
+    const qint64 now = m_elapsed.nsecsElapsed();
+
+    if (m_finishedAt >= 0) {
+        // Give the device time to send the queued frames and deliver their echoes.
+        const bool drained = m_device->framesToWrite() == 0
+                && (!m_measureLatency || m_sendTimes.empty());
+        if (drained || now - m_finishedAt > qint64(MaximumEchoWait) * 1000000)
+            emit finished();
+        else
+            m_timer.start(10);
+        return;
+    }
+
+    // Bursts are due at fixed points in time, so timer jitter does not change the average rate.
+    const bool unlimited = m_rate <= 0;
+    const double burstInterval = unlimited ? 0 : 1e9 * m_burst / m_rate;
+    bool queueFull = false;
+    int batch = 0;
+    while (batch < MaximumBatch && m_finishedAt < 0 && (unlimited || m_nextBurst <= now)) {
+        if (m_device->framesToWrite() >= MaximumQueuedFrames) {
+            queueFull = true;
+            break;
+        }
+        for (int i = 0; i < m_burst; ++i, ++batch) {
+            const QCanBusFrame frame = nextFrame();
+            if (m_device->writeFrame(frame)) {
+                ++m_sentFrames;
+                m_sentBytes += frame.payload().size();
+                if (m_measureLatency) {
+                    if (m_sendTimes.size() >= size_t(MaximumPendingEchoes))
+                        m_sendTimes.pop_front();
+                    m_sendTimes.push_back(m_elapsed.nsecsElapsed());
+                }
+            } else {
+                ++m_rejectedFrames;
+            }
+            if (m_count > 0 && m_sentFrames + m_rejectedFrames >= m_count) {
+                m_finishedAt = m_elapsed.nsecsElapsed();
+                break;
+            }
+        }
+        m_nextBurst += burstInterval;
+    }
+    // After a stall, continue at the configured rate instead of catching up.
+    if (!unlimited && now - m_nextBurst > qint64(MaximumLag) * 1000000)
+        m_nextBurst = now;
+
+    if (now >= m_nextReport) {
+        report(false);
+        m_nextReport = now + qint64(ReportInterval) * 1000000;
+    }
+
+    if (m_finishedAt >= 0 || queueFull) {
+        m_timer.start(queueFull ? 1 : 0);
+    } else if (unlimited || batch >= MaximumBatch) {
+        m_timer.start(0);
+    } else {
+        const double remaining = (m_nextBurst - m_elapsed.nsecsElapsed()) / 1e6;
+        m_timer.start(int(qBound(0.0, std::ceil(remaining), double(ReportInterval))));
+    }
+}
+
+void GenerateTask::handleFrames()
+{
+    const QList<QCanBusFrame> frames = m_device->readAllFrames();
+    if (!m_measureLatency)
+        return;
+
+    const qint64 now = m_elapsed.nsecsElapsed();
+    for (const QCanBusFrame &frame : frames) {
+        if (!frame.hasLocalEcho() || m_sendTimes.empty())
+            continue;
+        const qint64 latency = now - m_sendTimes.front();
+        m_sendTimes.pop_front();
+        if (m_echoes == 0 || latency < m_latencyMin)
+            m_latencyMin = latency;
+        m_latencyMax = qMax(m_latencyMax, latency);
+        m_latencySum += latency;
+        ++m_echoes;
+    }
+}
+
+void GenerateTask::handleError(QCanBusDevice::CanBusError error)
+{
+    if (error == QCanBusDevice::WriteError) {
+        ++m_writeErrors;
+        return;
+    }
+
+    auto canDevice = qobject_cast<QCanBusDevice *>(QObject::sender());
+    if (canDevice)
+        m_output << tr("Error: '%1'").arg(canDevice->errorString()) << Qt::endl;
+}
+
+void GenerateTask::report(bool final)
+{
+    const qint64 now = final && m_finishedAt >= 0 ? m_finishedAt : m_elapsed.nsecsElapsed();
+    QString line;
+    if (final) {
+        const double seconds = now / 1e9;
+        line = tr("Sent %1 frames in %2 s: %3 frames/s, %4 payload bytes/s")
+                .arg(m_sentFrames)
+                .arg(seconds, 0, 'f', 3)
+                .arg(seconds > 0 ? m_sentFrames / seconds : 0.0, 0, 'f', 0)
+                .arg(seconds > 0 ? m_sentBytes / seconds : 0.0, 0, 'f', 0);
+    } else {
+        const double seconds = (now - m_reportedAt) / 1e9;
+        line = tr("%1 frames/s").arg((m_sentFrames - m_reportedFrames) / seconds, 0, 'f', 0);
+        m_reportedAt = now;
+        m_reportedFrames = m_sentFrames;
+    }
+    line += tr(", %1 rejected, %2 write errors").arg(m_rejectedFrames).arg(m_writeErrors);
+    if (m_echoes > 0) {
+        line += tr(", echo latency min/avg/max %1/%2/%3 us")
+                .arg(m_latencyMin / 1000)
+                .arg(m_latencySum / m_echoes / 1000)
+                .arg(m_latencyMax / 1000);
+    }
+    m_output << line << Qt::endl;
+}
@@ -0,0 +1,142 @@
+/****************************************************************************
+**
+** Copyright (C) 2021 The Qt Company Ltd.
+** Contact: http://www.qt.io/licensing/
+**
+** This file is part of the tools applications of the QtSerialBus module.
+**
+** $QT_BEGIN_LICENSE:LGPL3$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see http://www.qt.io/terms-conditions. For further
+** information use the contact form at http://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPLv3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or later as published by the Free
+** Software Foundation and appearing in the file LICENSE.GPL included in
+** the packaging of this file. Please review the following information to
+** ensure the GNU General Public License version 2.0 requirements will be
+** met: http://www.gnu.org/licenses/gpl-2.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#ifndef GENERATETASK_H
+#define GENERATETASK_H
+
+#include <QCanBusDevice>
+#include <QCanBusFrame>
+#include <QElapsedTimer>
+#include <QObject>
+#include <QRandomGenerator>
+#include <QTimer>
+
+#include <deque>
+
+QT_BEGIN_NAMESPACE
+
+class QTextStream;
+
+QT_END_NAMESPACE
+
+class GenerateTask : public QObject
+{
+    Q_OBJECT
+public:
+    explicit GenerateTask(QTextStream &output, QObject *parent = nullptr);
+    ~GenerateTask();
+
+    bool setIdPattern(const QString &pattern);
+    bool setLengthPattern(const QString &pattern);
+    bool setPayloadPattern(const QString &pattern);
+    void setRate(double framesPerSecond);
+    void setBurst(int frames);
+    void setCount(qint64 frames);
+    void setExtendedFrameFormat(bool extended);
+    void setFlexibleDataRate(bool flexibleDataRate);
+    void setBitrateSwitch(bool bitrateSwitch);
+    bool isFlexibleDataRate() const;
+
+    void start(QCanBusDevice *device);
+
+signals:
+    void finished();
+
+public slots:
+    void handleFrames();
+    void handleError(QCanBusDevice::CanBusError error);
+
+private:
+    enum Pattern { Fixed, Incrementing, Random };
+    enum {
+        MaximumBatch = 4096,            // frames written per event loop iteration
+        MaximumQueuedFrames = 4096,     // frames waiting in the device before generating pauses
+        MaximumLag = 100,               // milliseconds the schedule may fall behind before it resets
+        MaximumEchoWait = 1000,         // milliseconds to wait for echoes and queued frames at the end
+        MaximumPendingEchoes = 1 << 20,
+        ReportInterval = 1000           // milliseconds
+    };
+
+    static bool parsePattern(const QString &pattern, Pattern *mode);
+    void generate();
+    QCanBusFrame nextFrame();
+    qsizetype nextLength();
+    void report(bool final);
+
+    QTextStream &m_output;
+    QCanBusDevice *m_device = nullptr;
+    QTimer m_timer;
+    QElapsedTimer m_elapsed;
+    QRandomGenerator m_random;
+
+    // Configuration
+    Pattern m_idPattern = Random;
+    Pattern m_lengthPattern = Random;
+    Pattern m_payloadPattern = Random;
+    quint32 m_fixedId = 0;
+    qsizetype m_fixedLength = 0;
+    QByteArray m_fixedPayload;
+    double m_rate = 100.0;              // frames per second, 0 means as fast as possible
+    int m_burst = 1;
+    qint64 m_count = 0;                 // 0 means until interrupted
+    bool m_extended = false;
+    bool m_flexibleDataRate = false;
+    bool m_bitrateSwitch = false;
+
+    // Generator state
+    quint32 m_nextId = 0;
+    qsizetype m_nextLengthIndex = 0;
+    quint64 m_payloadCounter = 0;
+    double m_nextBurst = 0;             // nanoseconds since start
+    qint64 m_finishedAt = -1;           // nanoseconds since start
+    qint64 m_nextReport = 0;
+
+    // Statistics
+    qint64 m_sentFrames = 0;
+    qint64 m_sentBytes = 0;
+    qint64 m_rejectedFrames = 0;       // writeFrame() returned false
+    qint64 m_writeErrors = 0;           // QCanBusDevice::WriteError reported
+    qint64 m_reportedFrames = 0;
+    qint64 m_reportedAt = 0;
+    bool m_measureLatency = false;
+    std::deque<qint64> m_sendTimes;     // of frames waiting for their echo
+    qint64 m_echoes = 0;
+    qint64 m_latencySum = 0;
+    qint64 m_latencyMin = 0;
+    qint64 m_latencyMax = 0;
+};
+
+#endif // GENERATETASK_H
@@ -61,7 +61,9 @@ int main(int argc, char *argv[])
     QCommandLineParser parser;
     parser.setApplicationDescription(CanBusUtil::tr(
         "Sends arbitrary CAN bus frames.\n"
-        "If the -l option is set, all received CAN bus frames are dumped."));
+        "If the -l option is set, all received CAN bus frames are dumped.\n"
+        "If the -g option is set, CAN bus frames are generated for load tests.\n"
+        "If the -C option is set, a CAN frame log is converted into another format."));
     parser.addHelpOption();
     parser.addVersionOption();
 
@@ -125,6 +127,68 @@ int main(int argc, char *argv[])
             QStringLiteral("bitrate"));
     parser.addOption(dataBitrateOption);
 
+    const QCommandLineOption recordOption({"r", "record"},
+            CanBusUtil::tr("Record the received CAN bus frames into the binary frame log "
+                           "<file> instead of printing them. Requires -l."),
+            QStringLiteral("file"));
+    parser.addOption(recordOption);
+
+    const QCommandLineOption generateOption({"g", "generate"},
+            CanBusUtil::tr("Generate CAN bus frames until interrupted or --count frames were "
+                           "sent. Throughput, write errors and, if -o is set, the latency until "
+                           "the echo of each frame arrives are reported every second."));
+    parser.addOption(generateOption);
+
+    const QCommandLineOption rateOption(QStringLiteral("rate"),
+            CanBusUtil::tr("Generate <rate> frames per second, 0 for as fast as possible "
+                           "(default: 100)."),
+            QStringLiteral("rate"));
+    parser.addOption(rateOption);
+
+    const QCommandLineOption burstOption(QStringLiteral("burst"),
+            CanBusUtil::tr("Generate frames in bursts of <count> back-to-back frames."),
+            QStringLiteral("count"));
+    parser.addOption(burstOption);
+
+    const QCommandLineOption countOption(QStringLiteral("count"),
+            CanBusUtil::tr("Stop after generating <count> frames."),
+            QStringLiteral("count"));
+    parser.addOption(countOption);
+
+    const QCommandLineOption idOption(QStringLiteral("id"),
+            CanBusUtil::tr("Identifier of generated frames: a hex value, i (incrementing) "
+                           "or r (random, default)."),
+            QStringLiteral("id|i|r"));
+    parser.addOption(idOption);
+
+    const QCommandLineOption lengthOption(QStringLiteral("length"),
+            CanBusUtil::tr("Payload length of generated frames: a decimal value, "
+                           "i (incrementing) or r (random, default)."),
+            QStringLiteral("length|i|r"));
+    parser.addOption(lengthOption);
+
+    const QCommandLineOption payloadOption(QStringLiteral("payload"),
+            CanBusUtil::tr("Payload of generated frames: hex value pairs, i (counter) "
+                           "or r (random, default)."),
+            QStringLiteral("payload|i|r"));
+    parser.addOption(payloadOption);
+
+    const QCommandLineOption extendedOption(QStringLiteral("extended"),
+            CanBusUtil::tr("Generate frames with 29 bit identifiers."));
+    parser.addOption(extendedOption);
+
+    const QCommandLineOption bitrateSwitchOption(QStringLiteral("bitrate-switch"),
+            CanBusUtil::tr("Generate CAN FD frames with bitrate switch."));
+    parser.addOption(bitrateSwitchOption);
+
+    const QCommandLineOption convertOption({"C", "convert"},
+            CanBusUtil::tr("Convert a CAN frame log. The first argument is the input log, "
+                           "the second the output log. The output format follows the file "
+                           "extension: .asc for Vector ASC, .qcanlog for binary frame logs, "
+                           "candump otherwise. The input format is detected. "
+                           "Use - for standard input or output."));
+    parser.addOption(convertOption);
+
     parser.process(app);
 
     if (parser.isSet(listOption))
@@ -133,6 +197,39 @@ int main(int argc, char *argv[])
     QString data;
     const QStringList args = parser.positionalArguments();
 
+    if (parser.isSet(convertOption)) {
+        if (args.size() != 2) {
+            output << CanBusUtil::tr("Invalid number of arguments (%1 given).").arg(args.size());
+            output << Qt::endl << Qt::endl << parser.helpText();
+            return 1;
+        }
+        return util.convertLog(args.at(0), args.at(1));
+    }
+
+    if (parser.isSet(generateOption)) {
+        GenerateTask *generator = util.generator();
+        generator->setFlexibleDataRate(parser.isSet(canFdOption));
+        generator->setBitrateSwitch(parser.isSet(bitrateSwitchOption));
+        generator->setExtendedFrameFormat(parser.isSet(extendedOption));
+        if (parser.isSet(rateOption))
+            generator->setRate(parser.value(rateOption).toDouble());
+        if (parser.isSet(burstOption))
+            generator->setBurst(parser.value(burstOption).toInt());
+        if (parser.isSet(countOption))
+            generator->setCount(parser.value(countOption).toLongLong());
+        if ((parser.isSet(idOption) && !generator->setIdPattern(parser.value(idOption)))
+                || (parser.isSet(lengthOption)
+                    && !generator->setLengthPattern(parser.value(lengthOption)))
+                || (parser.isSet(payloadOption)
+                    && !generator->setPayloadPattern(parser.value(payloadOption)))) {
+            output << CanBusUtil::tr("Invalid identifier, length or payload to generate.")
+                   << Qt::endl;
+            return 1;
+        }
+        if (generator->isFlexibleDataRate())
+            util.setConfigurationParameter(QCanBusDevice::CanFdKey, true);
+    }
+
     if (parser.isSet(canFdOption))
         util.setConfigurationParameter(QCanBusDevice::CanFdKey, true);
     if (parser.isSet(loopbackOption))
@@ -148,9 +245,15 @@ int main(int argc, char *argv[])
                                        parser.value(dataBitrateOption).toInt());
     }
 
+    if (parser.isSet(recordOption) && !parser.isSet(listeningOption)) {
+        output << CanBusUtil::tr("The -r option requires -l.") << Qt::endl;
+        return 1;
+    }
+
     if (parser.isSet(listeningOption)) {
         util.setShowTimeStamp(parser.isSet(showTimeStampOption));
         util.setShowFlags(parser.isSet(showFlagsOption));
+        util.setRecordFileName(parser.value(recordOption));
     } else if (args.size() == 3) {
         data = args.at(2);
     } else if (args.size() == 1 && parser.isSet(listDevicesOption)) {
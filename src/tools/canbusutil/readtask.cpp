@@ -36,9 +36,62 @@
 
 #include "readtask.h"
 
+#include <QFileDevice>
+
+#include <cstring>
+
+namespace {
+
+constexpr char HexDigits[] = "0123456789ABCDEF";
+
+char *writeDecimal(char *out, quint64 value, int width, char padding)
+{
+    char digits[20];
+    int count = 0;
+    do {
+        digits[count++] = char('0' + value % 10);
+        value /= 10;
+    } while (value);
+    for (int i = count; i < width; ++i)
+        *out++ = padding;
+    while (count)
+        *out++ = digits[--count];
+    return out;
+}
+
+char *writeHex(char *out, quint32 value, int digits)
+{
+    for (int i = digits - 1; i >= 0; --i, value >>= 4)
+        out[i] = HexDigits[value & 0xf];
+    return out + digits;
+}
+
+char *writeText(char *out, const char *text, qsizetype size)
+{
+    std::memcpy(out, text, size_t(size));
+    return out + size;
+}
+
+} // namespace
+
 ReadTask::ReadTask(QTextStream &output, QObject *parent) :
     QObject(parent),
-    m_output(output) { }
+    m_output(output)
+{
+    m_flushTimer.setSingleShot(true);
+    m_flushTimer.setInterval(FlushInterval);
+    connect(&m_flushTimer, &QTimer::timeout, this, &ReadTask::flushOutput);
+}
+
+ReadTask::~ReadTask()
+{
+    flushOutput();
+    if (m_recorder) {
+        m_recorder->close();
+        m_output << tr("Recorded %1 frames, %2 dropped.").arg(m_recorder->recordedFrames())
+                    .arg(m_recorder->droppedFrames()) << Qt::endl;
+    }
+}
 
 void ReadTask::setShowTimeStamp(bool showTimeStamp)
 {
@@ -55,6 +108,18 @@ void ReadTask::setShowFlags(bool showFlags)
     m_showFlags = showFlags;
 }
 
+bool ReadTask::startRecording(const QString &fileName)
+{
+    m_recorder.reset(new QCanBusFrameRecorder);
+    if (m_recorder->open(fileName))
+        return true;
+
+    m_output << tr("Cannot record to '%1': %2").arg(fileName, m_recorder->errorString())
+             << Qt::endl;
+    m_recorder.reset();
+    return false;
+}
+
 void ReadTask::handleFrames() {
     auto canDevice = qobject_cast<QCanBusDevice *>(QObject::sender());
     if (canDevice == nullptr) {
@@ -62,37 +127,110 @@ void ReadTask::handleFrames() {
         return;
     }
 
-    while (canDevice->framesAvailable()) {
-        const QCanBusFrame frame = canDevice->readFrame();
+    const QList<QCanBusFrame> frames = canDevice->readAllFrames();
+    if (m_recorder) {
+        m_recorder->record(frames);
+        return;
+    }
 
-        QString view;
+    for (const QCanBusFrame &frame : frames)
+        appendFrame(frame, canDevice);
 
-        if (m_showTimeStamp) {
-            view = QStringLiteral("%1.%2  ")
-                    .arg(frame.timeStamp().seconds(), 10, 10, QLatin1Char(' '))
-                    .arg(frame.timeStamp().microSeconds() / 100, 4, 10, QLatin1Char('0'));
-        }
+    // Lines are written in blocks, but never later than FlushInterval after they arrived.
+    if (m_size > 0 && !m_flushTimer.isActive())
+        m_flushTimer.start();
+}
 
-        if (m_showFlags) {
-            QLatin1String flags("- - -  ");
+void ReadTask::flushOutput()
+{
+    m_flushTimer.stop();
+    if (m_size == 0)
+        return;
 
-            if (frame.hasBitrateSwitch())
-                flags[0] = QLatin1Char('B');
-            if (frame.hasErrorStateIndicator())
-                flags[2] = QLatin1Char('E');
-            if (frame.hasLocalEcho())
-                flags[4] = QLatin1Char('L');
+    QIODevice *device = m_output.device();
+    if (device) {
+        m_output.flush();
+        device->write(m_buffer.constData(), m_size);
+        if (auto file = qobject_cast<QFileDevice *>(device))
+            file->flush();
+    }
+    m_size = 0;
+}
 
-            view += flags;
-        }
+char *ReadTask::reserve(qsizetype size)
+{
+    if (m_size + size > m_buffer.size())
+        flushOutput();
+    if (size > m_buffer.size())
+        m_buffer = QByteArray(qMax(size, qsizetype(BufferSize)), Qt::Uninitialized);
+    return m_buffer.data() + m_size;
+}
+
+// Formats the lines like QCanBusFrame::toString() without going through QString.
+void ReadTask::appendFrame(const QCanBusFrame &frame, QCanBusDevice *canDevice)
+{
+    const QCanBusFrame::FrameType type = frame.frameType();
+    const QByteArray errorText = type == QCanBusFrame::ErrorFrame
+            ? canDevice->interpretErrorFrame(frame).toUtf8() : QByteArray();
+
+    char *out = reserve(MaximumLineSize + errorText.size());
+    if (m_showTimeStamp) {
+        out = writeDecimal(out, quint64(frame.timeStamp().seconds()), 10, ' ');
+        *out++ = '.';
+        out = writeDecimal(out, quint64(frame.timeStamp().microSeconds() / 100), 4, '0');
+        out = writeText(out, "  ", 2);
+    }
 
-        if (frame.frameType() == QCanBusFrame::ErrorFrame)
-            view += canDevice->interpretErrorFrame(frame);
-        else
-            view += frame.toString();
+    if (m_showFlags) {
+        *out++ = frame.hasBitrateSwitch() ? 'B' : '-';
+        *out++ = ' ';
+        *out++ = frame.hasErrorStateIndicator() ? 'E' : '-';
+        *out++ = ' ';
+        *out++ = frame.hasLocalEcho() ? 'L' : '-';
+        out = writeText(out, "  ", 2);
+    }
+
+    switch (type) {
+    case QCanBusFrame::ErrorFrame:
+        out = writeText(out, errorText.constData(), errorText.size());
+        break;
+    case QCanBusFrame::InvalidFrame:
+        out = writeText(out, "(Invalid)", 9);
+        break;
+    case QCanBusFrame::UnknownFrame:
+        out = writeText(out, "(Unknown)", 9);
+        break;
+    default: {
+        if (frame.hasExtendedFrameFormat()) {
+            out = writeHex(out, frame.frameId(), 8);
+        } else {
+            out = writeText(out, "     ", 5);
+            out = writeHex(out, frame.frameId(), 3);
+        }
 
-        m_output << view << Qt::endl;
+        const QByteArray payload = frame.payload();
+        const qsizetype size = qMin(payload.size(), qsizetype(64));
+        const bool isFlexibleDataRate = frame.hasFlexibleDataRateFormat();
+        out = writeText(out, isFlexibleDataRate ? "  [" : "   [", isFlexibleDataRate ? 3 : 4);
+        out = writeDecimal(out, quint64(payload.size()), isFlexibleDataRate ? 2 : 1, '0');
+        *out++ = ']';
+
+        if (type == QCanBusFrame::RemoteRequestFrame) {
+            out = writeText(out, "  Remote Request", 16);
+        } else if (size > 0) {
+            *out++ = ' ';
+            for (qsizetype i = 0; i < size; ++i) {
+                *out++ = ' ';
+                out = writeHex(out, quint8(payload.at(i)), 2);
+            }
+        }
+        break;
+    }
     }
+    *out++ = '\n';
+    m_size = out - m_buffer.constData();
+    if (m_size > BufferSize - MaximumLineSize)
+        flushOutput();
 }
 
 void ReadTask::handleError(QCanBusDevice::CanBusError /*error*/)
@@ -103,5 +241,6 @@ void ReadTask::handleError(QCanBusDevice::CanBusError /*error*/)
         return;
     }
 
+    flushOutput();
     m_output << tr("Read error: '%1'").arg(canDevice->errorString()) << Qt::endl;
 }
@@ -40,24 +40,42 @@
 #include <QObject>
 #include <QtSerialBus>
 #include <QCanBusFrame>
+#include <QScopedPointer>
+#include <QTimer>
 
 class ReadTask : public QObject
 {
     Q_OBJECT
 public:
     explicit ReadTask(QTextStream &m_output, QObject *parent = nullptr);
+    ~ReadTask();
     void setShowTimeStamp(bool showStamp);
     bool isShowFlags() const;
     void setShowFlags(bool isShowFlags);
+    bool startRecording(const QString &fileName);
 
 public slots:
     void handleFrames();
     void handleError(QCanBusDevice::CanBusError /*error*/);
+    void flushOutput();
 
 private:
+    void appendFrame(const QCanBusFrame &frame, QCanBusDevice *canDevice);
+    char *reserve(qsizetype size);
+
+    enum {
+        BufferSize = 256 * 1024,
+        MaximumLineSize = 256,      // of a data frame
+        FlushInterval = 50          // milliseconds until buffered lines are written anyway
+    };
+
     QTextStream &m_output;
     bool m_showTimeStamp = false;
     bool m_showFlags = false;
+    QByteArray m_buffer;
+    qsizetype m_size = 0;
+    QTimer m_flushTimer;
+    QScopedPointer<QCanBusFrameRecorder> m_recorder;
 };
 
 #endif // READTASK_H
@@ -70,6 +70,15 @@ public:
         return true;
     }
 
+    void enqueueFrames(const QList<QCanBusFrame> &frames)
+    {
+        enqueueReceivedFrames(frames);
+    }
+
+    QThread *startThread() { return startReceiveThread(); }
+    void stopThread() { stopReceiveThread(); }
+    void runInThread(const std::function<void()> &function) { runInReceiveThread(function); }
+
     bool open()
     {
         if (firstOpen) {
@@ -161,6 +170,12 @@ private slots:
 
     void tst_waitForFramesReceived();
     void tst_waitForFramesWritten();
+
+    void statistics();
+    void statisticsTableFull();
+    void conflatedReceiveMode();
+    void conflatedWaitForFramesReceived();
+    void receiveThread();
 private:
     QScopedPointer<tst_Backend> device;
 };
@@ -715,6 +730,237 @@ void tst_QCanBusDevice::tst_waitForFramesWritten()
     device->setWriteBuffered(false);
 }
 
+void tst_QCanBusDevice::statistics()
+{
+    tst_Backend backend;
+    QVERIFY(!backend.isStatisticsEnabled());
+    QCOMPARE(backend.statistics().frames, quint64(0));
+    QVERIFY(backend.frameIdStatistics().isEmpty());
+
+    backend.setConfigurationParameter(QCanBusDevice::BitRateKey, 500000);
+    backend.setConfigurationParameter(QCanBusDevice::DataBitRateKey, 2000000);
+    backend.setStatisticsEnabled(true);
+    QVERIFY(backend.isStatisticsEnabled());
+
+    // 34 dominant bits in the stuffed part need 6 stuff bits: 47 + 6 bits
+    QCanBusFrame first(0, QByteArray());
+    first.setTimeStamp({ 1, 0 });
+    QCanBusFrame second = first;
+    second.setTimeStamp({ 1, 1000 });
+    QCanBusFrame third = first;
+    third.setTimeStamp({ 1, 3000 });
+
+    // 30 bits at the nominal bit rate, 517 + 1 stuff bit + 32 CRC field bits in the data phase
+    QCanBusFrame flexible(0x123, QByteArray(64, char(0xaa)));
+    flexible.setFlexibleDataRateFormat(true);
+    flexible.setBitrateSwitch(true);
+    flexible.setTimeStamp({ 2, 0 });
+
+    QCanBusFrame error(QCanBusFrame::ErrorFrame);
+    error.setError(QCanBusFrame::ControllerError | QCanBusFrame::BusOffError);
+
+    backend.enqueueFrames({ first, second, third, flexible, error });
+    QCOMPARE(backend.framesAvailable(), qint64(5));
+
+    const QCanBusDeviceStatistics total = backend.statistics();
+    QCOMPARE(total.frames, quint64(4));
+    QCOMPARE(total.remoteRequestFrames, quint64(0));
+    QCOMPARE(total.flexibleDataRateFrames, quint64(1));
+    QCOMPARE(total.untrackedFrames, quint64(0));
+    QCOMPARE(total.errorFrames, quint64(1));
+    QCOMPARE(total.errorFramesByClass[2], quint64(1));
+    QCOMPARE(total.errorFramesByClass[6], quint64(1));
+    QCOMPARE(total.errorFramesByClass[0], quint64(0));
+    QCOMPARE(total.nominalBits, quint64(3 * 53 + 30));
+    QCOMPARE(total.dataBits, quint64(550));
+    QCOMPARE(total.busTimeNSecs, quint64((3 * 53 + 30) * 2000 + 550 * 500));
+    QVERIFY(total.elapsedNSecs >= 0);
+    QVERIFY(total.busLoad() >= 0.0 && total.busLoad() <= 1.0);
+
+    const QList<QCanBusFrameIdStatistics> ids = backend.frameIdStatistics();
+    QCOMPARE(ids.size(), 2);
+    QCOMPARE(ids.at(0).frameId, QCanBusFrame::FrameId(0));
+    QCOMPARE(ids.at(0).frames, quint64(3));
+    QCOMPARE(ids.at(0).bits, quint64(3 * 53));
+    QCOMPARE(ids.at(0).firstSeenUSecs, qint64(1000000));
+    QCOMPARE(ids.at(0).lastSeenUSecs, qint64(1003000));
+    QCOMPARE(ids.at(0).minIntervalUSecs, qint64(1000));
+    QCOMPARE(ids.at(0).maxIntervalUSecs, qint64(2000));
+    QCOMPARE(ids.at(0).jitterUSecs, qint64(1000 / 16));
+    QCOMPARE(qRound(ids.at(0).frameRate()), 667);
+    QCOMPARE(ids.at(1).frameId, QCanBusFrame::FrameId(0x123));
+    QCOMPARE(ids.at(1).busTimeNSecs, quint64(30 * 2000 + 550 * 500));
+    QCOMPARE(ids.at(1).frameRate(), 0.0);
+
+    const QCanBusFrameIdStatistics single = backend.frameIdStatistics(0x123);
+    QCOMPARE(single.frames, quint64(1));
+    QCOMPARE(backend.frameIdStatistics(0x123, true).frames, quint64(0));
+
+    backend.resetStatistics();
+    QCOMPARE(backend.statistics().frames, quint64(0));
+    QVERIFY(backend.frameIdStatistics().isEmpty());
+
+    backend.setStatisticsEnabled(false);
+    QVERIFY(!backend.isStatisticsEnabled());
+    backend.enqueueFrames({ first });
+    QCOMPARE(backend.statistics().frames, quint64(0));
+}
+
+void tst_QCanBusDevice::statisticsTableFull()
+{
+    enum { FrameIds = 5000 };
+
+    tst_Backend backend;
+    backend.setStatisticsEnabled(true);
+
+    QList<QCanBusFrame> frames;
+    for (int i = 0; i < FrameIds; ++i) {
+        QCanBusFrame frame(QCanBusFrame::FrameId(i), QByteArray(1, 0));
+        frame.setExtendedFrameFormat(true);
+        frames.append(frame);
+    }
+    backend.enqueueFrames(frames);
+
+    const QCanBusDeviceStatistics total = backend.statistics();
+    QCOMPARE(total.frames, quint64(FrameIds));
+    QVERIFY(total.untrackedFrames > 0);
+    QCOMPARE(quint64(backend.frameIdStatistics().size()) + total.untrackedFrames,
+             quint64(FrameIds));
+    // no bit rate configured
+    QCOMPARE(total.busTimeNSecs, quint64(0));
+}
+
+void tst_QCanBusDevice::conflatedReceiveMode()
+{
+    tst_Backend backend;
+    QVERIFY(!backend.connectDevice()); // first connect triggered to fail
+    QVERIFY(backend.connectDevice());
+    QCOMPARE(backend.receiveMode(), QCanBusDevice::ReceiveMode::Queued);
+
+    const QCanBusFrame queued(0x100, QByteArray(1, 1));
+    backend.enqueueFrames({ queued, queued });
+    QCOMPARE(backend.framesAvailable(), qint64(2));
+    backend.setReceiveMode(QCanBusDevice::ReceiveMode::Conflated);
+    QCOMPARE(backend.receiveMode(), QCanBusDevice::ReceiveMode::Conflated);
+    QCOMPARE(backend.framesAvailable(), qint64(1));
+
+    QSignalSpy spy(&backend, &QCanBusDevice::framesReceived);
+
+    const QCanBusFrame first(0x100, QByteArray(1, 2));
+    const QCanBusFrame second(0x100, QByteArray(1, 3));
+    const QCanBusFrame other(0x200, QByteArray(1, 4));
+    QCanBusFrame extended(0x100, QByteArray(1, 5));
+    extended.setExtendedFrameFormat(true);
+    QCanBusFrame remote(0x100, QByteArray(1, 0));
+    remote.setFrameType(QCanBusFrame::RemoteRequestFrame);
+
+    backend.enqueueFrames({ first, other, second, extended, remote });
+    QCOMPARE(spy.count(), 0); // a changed frame was still waiting to be read
+    QCOMPARE(backend.framesAvailable(), qint64(4));
+    QCOMPARE(backend.latestFrame(0x100).payload(), QByteArray(1, 3));
+    QCOMPARE(backend.latestFrame(0x100, true).payload(), QByteArray(1, 5));
+    QVERIFY(!backend.latestFrame(0x300).isValid());
+
+    QCOMPARE(backend.readFrame().payload(), QByteArray(1, 3));
+    QCOMPARE(backend.framesAvailable(), qint64(3));
+
+    QList<QCanBusFrame> frames = backend.readAllFrames();
+    QCOMPARE(frames.size(), 3);
+    QCOMPARE(frames.at(0).frameId(), QCanBusFrame::FrameId(0x200));
+    QVERIFY(frames.at(1).hasExtendedFrameFormat());
+    QCOMPARE(frames.at(2).frameType(), QCanBusFrame::RemoteRequestFrame);
+    QCOMPARE(backend.framesAvailable(), qint64(0));
+    QVERIFY(backend.readAllFrames().isEmpty());
+    QCOMPARE(backend.latestFrame(0x200).payload(), QByteArray(1, 4));
+
+    backend.enqueueFrames({ other });
+    QCOMPARE(spy.count(), 1);
+    backend.enqueueFrames({ first });
+    QCOMPARE(spy.count(), 1);
+
+    backend.setReceiveMode(QCanBusDevice::ReceiveMode::Queued);
+    frames = backend.readAllFrames();
+    QCOMPARE(frames.size(), 2);
+    QCOMPARE(frames.at(0).frameId(), QCanBusFrame::FrameId(0x200));
+    QCOMPARE(frames.at(1).payload(), QByteArray(1, 2));
+    QVERIFY(!backend.latestFrame(0x200).isValid());
+
+    backend.enqueueFrames({ first, first });
+    QCOMPARE(spy.count(), 2);
+    QCOMPARE(backend.framesAvailable(), qint64(2));
+}
+
+void tst_QCanBusDevice::conflatedWaitForFramesReceived()
+{
+    tst_Backend backend;
+    QVERIFY(!backend.connectDevice()); // first connect triggered to fail
+    QVERIFY(backend.connectDevice());
+    backend.setReceiveMode(QCanBusDevice::ReceiveMode::Conflated);
+
+    const QCanBusFrame first(0x100, QByteArray(1, 1));
+    const QCanBusFrame second(0x200, QByteArray(1, 2));
+    QTimer::singleShot(100, &backend, [&backend, &first]() { backend.enqueueFrames({ first }); });
+    QVERIFY(backend.waitForFramesReceived(5000));
+    QCOMPARE(backend.error(), QCanBusDevice::NoError);
+
+    // The changed frame is still unread, so the next frame does not emit framesReceived().
+    QElapsedTimer elapsed;
+    elapsed.start();
+    QTimer::singleShot(100, &backend, [&backend, &second]() { backend.enqueueFrames({ second }); });
+    QVERIFY(backend.waitForFramesReceived(5000));
+    QVERIFY(!elapsed.hasExpired(4000));
+    QCOMPARE(backend.error(), QCanBusDevice::NoError);
+    QTRY_COMPARE(backend.framesAvailable(), qint64(2));
+
+    backend.readAllFrames();
+    QVERIFY(!backend.waitForFramesReceived(100));
+    QCOMPARE(backend.error(), QCanBusDevice::TimeoutError);
+}
+
+void tst_QCanBusDevice::receiveThread()
+{
+    tst_Backend backend;
+    QVERIFY(!backend.isReceiveThreadEnabled());
+    QVERIFY(!backend.startThread());
+    QVERIFY(!backend.hasReceiveThread());
+
+    backend.setReceiveThreadEnabled(true);
+    backend.setReceiveThreadPriority(QThread::HighPriority);
+    backend.setReceiveThreadAffinity({ 0 });
+    QVERIFY(backend.isReceiveThreadEnabled());
+    QCOMPARE(backend.receiveThreadPriority(), QThread::HighPriority);
+    QCOMPARE(backend.receiveThreadAffinity(), QList<int>({ 0 }));
+
+    QThread *thread = backend.startThread();
+    QVERIFY(thread);
+    QVERIFY(thread != QThread::currentThread());
+    QVERIFY(backend.hasReceiveThread());
+    QCOMPARE(backend.startThread(), thread);
+
+    QThread *calledIn = nullptr;
+    QThread *notifiedIn = nullptr;
+    connect(&backend, &QCanBusDevice::framesReceived, this, [&notifiedIn]() {
+        notifiedIn = QThread::currentThread();
+    });
+    QSignalSpy errorSpy(&backend, &QCanBusDevice::errorOccurred);
+
+    backend.runInThread([&]() {
+        calledIn = QThread::currentThread();
+        backend.enqueueFrames({ QCanBusFrame(0x100, QByteArray(1, 1)) });
+        backend.emulateError(QStringLiteral("read error"), QCanBusDevice::ReadError);
+    });
+    QCOMPARE(calledIn, thread);
+    QCOMPARE(backend.framesAvailable(), qint64(1));
+    QTRY_COMPARE(notifiedIn, QThread::currentThread());
+    QTRY_COMPARE(errorSpy.count(), 1);
+    QCOMPARE(backend.error(), QCanBusDevice::ReadError);
+
+    backend.stopThread();
+    QVERIFY(!backend.hasReceiveThread());
+    backend.runInThread([&calledIn]() { calledIn = QThread::currentThread(); });
+    QCOMPARE(calledIn, QThread::currentThread());
+}
+
 QTEST_MAIN(tst_QCanBusDevice)
 Q_IMPORT_PLUGIN(GenericBusPlugin)
 Q_IMPORT_PLUGIN(GenericBusPluginV1)
@@ -0,0 +1,303 @@
+/****************************************************************************
+**
+** Copyright (C) 2021 The Qt Company Ltd.
+** Contact: http://www.qt.io/licensing/
+**
+** This file is part of the QtSerialBus module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL3$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see http://www.qt.io/terms-conditions. For further
+** information use the contact form at http://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPLv3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or later as published by the Free
+** Software Foundation and appearing in the file LICENSE.GPL included in
+** the packaging of this file. Please review the following information to
+** ensure the GNU General Public License version 2.0 requirements will be
+** met: http://www.gnu.org/licenses/gpl-2.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+#include <QtSerialBus/qcanbusframelog.h>
+
+#include <QtCore/qfile.h>
+#include <QtCore/qfileinfo.h>
+#include <QtCore/qtemporarydir.h>
+#include <QtTest/qtest.h>
+
+class tst_QCanBusFrameLog : public QObject
+{
+    Q_OBJECT
+public:
+    explicit tst_QCanBusFrameLog();
+
+private slots:
+    void initTestCase();
+
+    void roundTrip();
+    void manyChunks();
+    void seek();
+    void unclosedLog();
+    void quietBus();
+    void invalidFile();
+    void recordWithoutLog();
+
+private:
+    QString filePath(const QString &name) const { return m_dir.filePath(name); }
+    static QCanBusFrame dataFrame(quint32 id, qint64 timeStamp);
+
+    QTemporaryDir m_dir;
+};
+
+tst_QCanBusFrameLog::tst_QCanBusFrameLog()
+{
+}
+
+void tst_QCanBusFrameLog::initTestCase()
+{
+    QVERIFY(m_dir.isValid());
+}
+
+QCanBusFrame tst_QCanBusFrameLog::dataFrame(quint32 id, qint64 timeStamp)
+{
+    QCanBusFrame frame(id, QByteArray::number(timeStamp, 16).left(8));
+    frame.setTimeStamp(QCanBusFrame::TimeStamp::fromMicroSeconds(timeStamp));
+    return frame;
+}
+
+void tst_QCanBusFrameLog::roundTrip()
+{
+    QList<QCanBusFrame> frames;
+
+    frames.append(dataFrame(0x123, 1000));
+
+    QCanBusFrame extended(0x1abcdef0, QByteArray::fromHex("0102030405060708"));
+    extended.setTimeStamp(QCanBusFrame::TimeStamp(2, 500));
+    frames.append(extended);
+
+    QCanBusFrame fd(0x7ff, QByteArray(64, '\x5a'));
+    fd.setFlexibleDataRateFormat(true);
+    fd.setBitrateSwitch(true);
+    fd.setErrorStateIndicator(true);
+    fd.setTimeStamp(QCanBusFrame::TimeStamp(3, 0));
+    frames.append(fd);
+
+    QCanBusFrame error(QCanBusFrame::ErrorFrame);
+    error.setError(QCanBusFrame::BusOffError);
+    error.setTimeStamp(QCanBusFrame::TimeStamp(4, 1));
+    frames.append(error);
+
+    QCanBusFrame remote(QCanBusFrame::RemoteRequestFrame);
+    remote.setFrameId(0x42);
+    remote.setTimeStamp(QCanBusFrame::TimeStamp(5, 2));
+    frames.append(remote);
+
+    QCanBusFrame echo = dataFrame(0x321, 6000000);
+    echo.setLocalEcho(true);
+    frames.append(echo);
+
+    const QString fileName = filePath(QStringLiteral("roundtrip.qcl"));
+    QCanBusFrameRecorder recorder;
+    QVERIFY(recorder.open(fileName));
+    QVERIFY(recorder.isOpen());
+    QCOMPARE(recorder.fileName(), fileName);
+    QCOMPARE(recorder.record(frames), frames.size());
+    QVERIFY(recorder.close());
+    QVERIFY(!recorder.isOpen());
+    QCOMPARE(recorder.recordedFrames(), quint64(frames.size()));
+    QCOMPARE(recorder.droppedFrames(), quint64(0));
+
+    QCanBusFrameLogReader reader;
+    QVERIFY2(reader.open(fileName), qPrintable(reader.errorString()));
+    QCOMPARE(reader.frameCount(), quint64(frames.size()));
+    QCOMPARE(reader.startTime(), qint64(1000));
+    QCOMPARE(reader.endTime(), qint64(6000000));
+
+    for (const QCanBusFrame &expected : std::as_const(frames)) {
+        QVERIFY(!reader.atEnd());
+        QCOMPARE(reader.nextTimeStamp(), expected.timeStamp().seconds() * 1000000
+                 + expected.timeStamp().microSeconds());
+        QCanBusFrame frame;
+        QVERIFY(reader.readFrame(&frame));
+        QCOMPARE(frame.frameType(), expected.frameType());
+        QCOMPARE(frame.frameId(), expected.frameId());
+        QCOMPARE(frame.error(), expected.error());
+        QCOMPARE(frame.hasExtendedFrameFormat(), expected.hasExtendedFrameFormat());
+        QCOMPARE(frame.hasFlexibleDataRateFormat(), expected.hasFlexibleDataRateFormat());
+        QCOMPARE(frame.hasBitrateSwitch(), expected.hasBitrateSwitch());
+        QCOMPARE(frame.hasErrorStateIndicator(), expected.hasErrorStateIndicator());
+        QCOMPARE(frame.hasLocalEcho(), expected.hasLocalEcho());
+        QCOMPARE(frame.payload(), expected.payload());
+        QCOMPARE(frame.timeStamp().seconds(), expected.timeStamp().seconds());
+        QCOMPARE(frame.timeStamp().microSeconds(), expected.timeStamp().microSeconds());
+    }
+    QVERIFY(reader.atEnd());
+    QCOMPARE(reader.nextTimeStamp(), qint64(-1));
+    QCanBusFrame frame;
+    QVERIFY(!reader.readFrame(&frame));
+
+    reader.rewind();
+    QVERIFY(reader.readFrame(&frame));
+    QCOMPARE(frame.frameId(), quint32(0x123));
+}
+
+void tst_QCanBusFrameLog::manyChunks()
+{
+    // 20000 short records span several 64 KiB chunks.
+    const int count = 20000;
+    const QString fileName = filePath(QStringLiteral("chunks.qcl"));
+    QCanBusFrameRecorder recorder;
+    QVERIFY(recorder.open(fileName));
+    for (int i = 0; i < count; ++i)
+        QVERIFY(recorder.record(dataFrame(quint32(i) & 0x7ff, qint64(i) * 10)));
+    QVERIFY(recorder.close());
+
+    QCanBusFrameLogReader reader;
+    QVERIFY(reader.open(fileName));
+    QCOMPARE(reader.frameCount(), quint64(count));
+    QCOMPARE(reader.endTime(), qint64(count - 1) * 10);
+
+    int read = 0;
+    QCanBusFrame frame;
+    while (reader.readFrame(&frame)) {
+        QCOMPARE(frame.frameId(), quint32(read) & 0x7ff);
+        QCOMPARE(frame.timeStamp().seconds() * 1000000 + frame.timeStamp().microSeconds(),
+                 qint64(read) * 10);
+        ++read;
+    }
+    QCOMPARE(read, count);
+}
+
+void tst_QCanBusFrameLog::seek()
+{
+    const int count = 20000;
+    const QString fileName = filePath(QStringLiteral("seek.qcl"));
+    QCanBusFrameRecorder recorder;
+    QVERIFY(recorder.open(fileName));
+    for (int i = 0; i < count; ++i)
+        QVERIFY(recorder.record(dataFrame(0x100, qint64(i) * 10)));
+    QVERIFY(recorder.close());
+
+    QCanBusFrameLogReader reader;
+    QVERIFY(reader.open(fileName));
+
+    QVERIFY(reader.seek(123455));
+    QCOMPARE(reader.nextTimeStamp(), qint64(123460));
+
+    QVERIFY(reader.seek(50));
+    QCOMPARE(reader.nextTimeStamp(), qint64(50));
+
+    QVERIFY(reader.seek(-1));
+    QCOMPARE(reader.nextTimeStamp(), qint64(0));
+
+    QVERIFY(reader.seek(qint64(count - 1) * 10));
+    QCanBusFrame frame;
+    QVERIFY(reader.readFrame(&frame));
+    QVERIFY(reader.atEnd());
+
+    QVERIFY(!reader.seek(qint64(count) * 10));
+    QVERIFY(reader.atEnd());
+}
+
+void tst_QCanBusFrameLog::unclosedLog()
+{
+    const int count = 10000;
+    const QString fileName = filePath(QStringLiteral("unclosed.qcl"));
+    const QString copyName = filePath(QStringLiteral("unclosed-copy.qcl"));
+    QCanBusFrameRecorder recorder;
+    QVERIFY(recorder.open(fileName));
+    for (int i = 0; i < count; ++i)
+        QVERIFY(recorder.record(dataFrame(0x200, qint64(i))));
+    QVERIFY(recorder.flush());
+
+    // The log has no index yet; the reader has to scan its chunks.
+    QVERIFY(QFile::copy(fileName, copyName));
+    QVERIFY(recorder.close());
+
+    QCanBusFrameLogReader reader;
+    QVERIFY2(reader.open(copyName), qPrintable(reader.errorString()));
+    QCOMPARE(reader.frameCount(), quint64(count));
+    QVERIFY(reader.seek(5000));
+    QCOMPARE(reader.nextTimeStamp(), qint64(5000));
+    reader.close();
+
+    // Cutting the log in the middle of the last chunk drops that chunk only.
+    QFile file(copyName);
+    QVERIFY(file.resize(file.size() - 100));
+
+    QVERIFY(reader.open(copyName));
+    int read = 0;
+    while (reader.readFrame(nullptr))
+        ++read;
+    QVERIFY(read > 0);
+    QVERIFY(read < count);
+}
+
+void tst_QCanBusFrameLog::quietBus()
+{
+    const QString fileName = filePath(QStringLiteral("quiet.qcl"));
+    const QString copyName = filePath(QStringLiteral("quiet-copy.qcl"));
+    QCanBusFrameRecorder recorder;
+    QVERIFY(recorder.open(fileName));
+    const qint64 headerSize = QFileInfo(fileName).size();
+    QVERIFY(recorder.record(dataFrame(0x300, 1)));
+
+    // No further frame is recorded, the writer thread writes the chunk once it is due.
+    QTRY_VERIFY_WITH_TIMEOUT(QFileInfo(fileName).size() > headerSize, 3000);
+    QVERIFY(QFile::copy(fileName, copyName));
+
+    QCanBusFrameLogReader reader;
+    QVERIFY2(reader.open(copyName), qPrintable(reader.errorString()));
+    QCOMPARE(reader.frameCount(), quint64(1));
+    QCanBusFrame frame;
+    QVERIFY(reader.readFrame(&frame));
+    QCOMPARE(frame.frameId(), QCanBusFrame::FrameId(0x300));
+    QVERIFY(recorder.close());
+}
+
+void tst_QCanBusFrameLog::invalidFile()
+{
+    QCanBusFrameLogReader reader;
+    QVERIFY(!reader.open(filePath(QStringLiteral("missing.qcl"))));
+    QVERIFY(!reader.errorString().isEmpty());
+    QVERIFY(!reader.isOpen());
+
+    const QString fileName = filePath(QStringLiteral("invalid.qcl"));
+    QFile file(fileName);
+    QVERIFY(file.open(QIODevice::WriteOnly));
+    file.write("This is not a CAN frame log at all.");
+    file.close();
+
+    QVERIFY(!reader.open(fileName));
+    QVERIFY(!reader.errorString().isEmpty());
+    QVERIFY(!reader.isOpen());
+    QVERIFY(reader.atEnd());
+}
+
+void tst_QCanBusFrameLog::recordWithoutLog()
+{
+    QCanBusFrameRecorder recorder;
+    QVERIFY(!recorder.isOpen());
+    QVERIFY(!recorder.record(dataFrame(0x1, 0)));
+    QVERIFY(!recorder.flush());
+    QVERIFY(recorder.close());
+}
+
+QTEST_MAIN(tst_QCanBusFrameLog)
+
+#include "tst_qcanbusframelog.moc"
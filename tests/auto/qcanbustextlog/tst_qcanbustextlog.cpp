@@ -0,0 +1,394 @@
+/****************************************************************************
+**
+** Copyright (C) 2021 The Qt Company Ltd.
+** Contact: http://www.qt.io/licensing/
+**
+** This file is part of the QtSerialBus module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL3$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see http://www.qt.io/terms-conditions. For further
+** information use the contact form at http://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPLv3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or later as published by the Free
+** Software Foundation and appearing in the file LICENSE.GPL included in
+** the packaging of this file. Please review the following information to
+** ensure the GNU General Public License version 2.0 requirements will be
+** met: http://www.gnu.org/licenses/gpl-2.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+#include <QtSerialBus/qcanbustextlog.h>
+
+#include <QtCore/qbuffer.h>
+#include <QtCore/qdatetime.h>
+#include <QtTest/qtest.h>
+
+Q_DECLARE_METATYPE(QCanBusTextLogReader::Format)
+
+class tst_QCanBusTextLog : public QObject
+{
+    Q_OBJECT
+public:
+    explicit tst_QCanBusTextLog();
+
+private slots:
+    void readCandump();
+    void writeCandump();
+    void readAsc();
+    void readAscRelativeDecimal();
+    void writeAsc();
+    void roundTrip_data();
+    void roundTrip();
+    void longLine();
+    void noDevice();
+
+private:
+    static QList<QCanBusFrame> readAll(QCanBusTextLogReader::Format format,
+                                       const QByteArray &log, qint64 *skippedLines = nullptr);
+    static QCanBusFrame frame(quint32 id, const QByteArray &payload, qint64 timeStamp);
+};
+
+tst_QCanBusTextLog::tst_QCanBusTextLog()
+{
+}
+
+QList<QCanBusFrame> tst_QCanBusTextLog::readAll(QCanBusTextLogReader::Format format,
+                                                const QByteArray &log, qint64 *skippedLines)
+{
+    QBuffer buffer;
+    buffer.setData(log);
+    buffer.open(QIODevice::ReadOnly);
+
+    QCanBusTextLogReader reader(format, &buffer);
+    QList<QCanBusFrame> frames;
+    QCanBusFrame frame;
+    while (reader.readFrame(&frame))
+        frames.append(frame);
+    if (skippedLines)
+        *skippedLines = reader.skippedLines();
+    return frames;
+}
+
+QCanBusFrame tst_QCanBusTextLog::frame(quint32 id, const QByteArray &payload, qint64 timeStamp)
+{
+    QCanBusFrame frame(id, payload);
+    frame.setTimeStamp(QCanBusFrame::TimeStamp::fromMicroSeconds(timeStamp));
+    return frame;
+}
+
+void tst_QCanBusTextLog::readCandump()
+{
+    const QByteArray log =
+            "(1602345600.123456) can0 123#DEADBEEF\n"
+            "(1602345600.200000) vcan1 00000042#0102\r\n"
+            "(1602345600.300000) can0 7FF##3112233445566778899\n"
+            "(1602345600.400000) can0 321#R5\n"
+            "(1602345600.500000) can0 20000040#0000000000000000\n"
+            "(1602345600.600000) can0 456#11.22 T\n"
+            "\n"
+            "this is not a frame\n"
+            "(1602345600.700000) can0 123#123\n"
+            "(1602345600.800000) can0 1234#00\n"
+            "(1602345600.900000) can0 123###000000\n"
+            "(1602345601.000000) can0 123#1122334455667788\n"
+            "(1602345601.100000) can0 1FFFFFFF#";
+
+    qint64 skippedLines = 0;
+    const QList<QCanBusFrame> frames = readAll(QCanBusTextLogReader::CandumpFormat, log,
+                                               &skippedLines);
+    QCOMPARE(frames.size(), qsizetype(8));
+    QCOMPARE(skippedLines, qint64(4));
+
+    QCOMPARE(frames.at(0).frameType(), QCanBusFrame::DataFrame);
+    QCOMPARE(frames.at(0).frameId(), quint32(0x123));
+    QVERIFY(!frames.at(0).hasExtendedFrameFormat());
+    QCOMPARE(frames.at(0).payload(), QByteArray::fromHex("deadbeef"));
+    QCOMPARE(frames.at(0).timeStamp().seconds(), qint64(1602345600));
+    QCOMPARE(frames.at(0).timeStamp().microSeconds(), qint64(123456));
+
+    QCOMPARE(frames.at(1).frameId(), quint32(0x42));
+    QVERIFY(frames.at(1).hasExtendedFrameFormat());
+    QCOMPARE(frames.at(1).payload(), QByteArray::fromHex("0102"));
+
+    QVERIFY(frames.at(2).hasFlexibleDataRateFormat());
+    QVERIFY(frames.at(2).hasBitrateSwitch());
+    QVERIFY(frames.at(2).hasErrorStateIndicator());
+    QCOMPARE(frames.at(2).payload(), QByteArray::fromHex("112233445566778899"));
+
+    QCOMPARE(frames.at(3).frameType(), QCanBusFrame::RemoteRequestFrame);
+    QCOMPARE(frames.at(3).frameId(), quint32(0x321));
+    QCOMPARE(frames.at(3).payload().size(), qsizetype(5));
+
+    QCOMPARE(frames.at(4).frameType(), QCanBusFrame::ErrorFrame);
+    QCOMPARE(int(frames.at(4).error()), int(QCanBusFrame::BusOffError));
+
+    QVERIFY(frames.at(5).hasLocalEcho());
+    QCOMPARE(frames.at(5).payload(), QByteArray::fromHex("1122"));
+
+    QCOMPARE(frames.at(6).payload().size(), qsizetype(8));
+
+    QCOMPARE(frames.at(7).frameId(), quint32(0x1fffffff));
+    QVERIFY(frames.at(7).payload().isEmpty());
+}
+
+void tst_QCanBusTextLog::writeCandump()
+{
+    QBuffer buffer;
+    buffer.open(QIODevice::WriteOnly);
+    QCanBusTextLogWriter writer(QCanBusTextLogReader::CandumpFormat, &buffer);
+    QCOMPARE(writer.channel(), QStringLiteral("can0"));
+
+    QVERIFY(writer.writeFrame(frame(0x123, QByteArray::fromHex("deadbeef"), 1602345600123456)));
+
+    QCanBusFrame extended = frame(0x42, QByteArray::fromHex("0102"), 12);
+    extended.setExtendedFrameFormat(true);
+    QVERIFY(writer.writeFrame(extended));
+
+    QCanBusFrame fd = frame(0x7ff, QByteArray::fromHex("112233445566778899"), 1000000);
+    fd.setBitrateSwitch(true);
+    QVERIFY(writer.writeFrame(fd));
+
+    QCanBusFrame remote(QCanBusFrame::RemoteRequestFrame);
+    remote.setFrameId(0x321);
+    remote.setPayload(QByteArray(5, 0));
+    QVERIFY(writer.writeFrame(remote));
+
+    QCanBusFrame error(QCanBusFrame::ErrorFrame);
+    error.setError(QCanBusFrame::BusOffError);
+    error.setPayload(QByteArray(8, 0));
+    QVERIFY(writer.writeFrame(error));
+
+    writer.setChannel(QStringLiteral("vcan1"));
+    QCanBusFrame echo = frame(0x456, QByteArray(), 0);
+    echo.setLocalEcho(true);
+    QVERIFY(writer.writeFrame(echo));
+
+    QVERIFY(buffer.data().isEmpty());
+    QVERIFY(writer.finish());
+    QCOMPARE(buffer.data(), QByteArray(
+            "(1602345600.123456) can0 123#DEADBEEF\n"
+            "(0000000000.000012) can0 00000042#0102\n"
+            "(0000000001.000000) can0 7FF##1112233445566778899\n"
+            "(0000000000.000000) can0 321#R5\n"
+            "(0000000000.000000) can0 20000040#0000000000000000\n"
+            "(0000000000.000000) vcan1 456# T\n"));
+}
+
+void tst_QCanBusTextLog::readAsc()
+{
+    const QByteArray log =
+            "date Mon Oct 19 02:15:30.250 pm 2026\n"
+            "base hex  timestamps absolute\n"
+            "internal events logged\n"
+            "// version 13.0.0\n"
+            "Begin Triggerblock Mon Oct 19 02:15:30.250 pm 2026\n"
+            "   0.000000 Start of measurement\n"
+            "   0.001000 1  123             Rx   d 4 DE AD BE EF\n"
+            "   0.002000 2  1ABCDEF0x       Tx   d 2 01 02\n"
+            "   0.003000 1  321             Rx   r 5\n"
+            "   0.004000 1  ErrorFrame\n"
+            "   0.005000 CANFD   1 Rx      7FF                                   1 0 9 9 "
+            "11 22 33 44 55 66 77 88 99   130000  130 3000 0 0 0 0 0\n"
+            "   0.006000 CANFD   1 Tx      124  Engine_Data  0 1 2  2 AA BB 0 0 5000 0 0 0 0 0\n"
+            "   0.007000 CANFD   1 Rx      125                                   0 0 3  0 "
+            "0 0 10 0 0 0 0 0\n"
+            "   0.008000 1  126             Rx   x 0\n"
+            "End TriggerBlock\n";
+
+    qint64 skippedLines = 0;
+    const QList<QCanBusFrame> frames = readAll(QCanBusTextLogReader::AscFormat, log,
+                                               &skippedLines);
+    QCOMPARE(frames.size(), qsizetype(7));
+    // "Start of measurement" and the line with an unknown frame type
+    QCOMPARE(skippedLines, qint64(2));
+
+    const qint64 start = QDateTime(QDate(2026, 10, 19), QTime(14, 15, 30, 250))
+            .toMSecsSinceEpoch() * 1000;
+    const auto timeStamp = [](const QCanBusFrame &frame) {
+        return frame.timeStamp().seconds() * 1000000 + frame.timeStamp().microSeconds();
+    };
+
+    QCOMPARE(frames.at(0).frameId(), quint32(0x123));
+    QCOMPARE(frames.at(0).payload(), QByteArray::fromHex("deadbeef"));
+    QCOMPARE(timeStamp(frames.at(0)), start + 1000);
+    QVERIFY(!frames.at(0).hasLocalEcho());
+
+    QCOMPARE(frames.at(1).frameId(), quint32(0x1abcdef0));
+    QVERIFY(frames.at(1).hasExtendedFrameFormat());
+    QVERIFY(frames.at(1).hasLocalEcho());
+
+    QCOMPARE(frames.at(2).frameType(), QCanBusFrame::RemoteRequestFrame);
+    QCOMPARE(frames.at(2).payload().size(), qsizetype(5));
+
+    QCOMPARE(frames.at(3).frameType(), QCanBusFrame::ErrorFrame);
+    QCOMPARE(timeStamp(frames.at(3)), start + 4000);
+
+    QCOMPARE(frames.at(4).frameId(), quint32(0x7ff));
+    QVERIFY(frames.at(4).hasFlexibleDataRateFormat());
+    QVERIFY(frames.at(4).hasBitrateSwitch());
+    QVERIFY(!frames.at(4).hasErrorStateIndicator());
+    QCOMPARE(frames.at(4).payload(), QByteArray::fromHex("112233445566778899"));
+
+    QCOMPARE(frames.at(5).frameId(), quint32(0x124));
+    QVERIFY(frames.at(5).hasErrorStateIndicator());
+    QVERIFY(frames.at(5).hasLocalEcho());
+    QCOMPARE(frames.at(5).payload(), QByteArray::fromHex("aabb"));
+
+    // A classic remote frame in the CAN FD format
+    QCOMPARE(frames.at(6).frameType(), QCanBusFrame::RemoteRequestFrame);
+    QVERIFY(!frames.at(6).hasFlexibleDataRateFormat());
+    QCOMPARE(frames.at(6).payload().size(), qsizetype(3));
+}
+
+void tst_QCanBusTextLog::readAscRelativeDecimal()
+{
+    const QByteArray log =
+            "base dec  timestamps relative\n"
+            "   1.000000 1  291             Rx   d 2 222 173\n"
+            "   0.500000 1  291             Rx   d 1 255\n"
+            "   0.500000 1  291             Rx   d 1 256\n";
+
+    qint64 skippedLines = 0;
+    const QList<QCanBusFrame> frames = readAll(QCanBusTextLogReader::AscFormat, log,
+                                               &skippedLines);
+    QCOMPARE(frames.size(), qsizetype(2));
+    QCOMPARE(skippedLines, qint64(1));
+    QCOMPARE(frames.at(0).frameId(), quint32(0x123));
+    QCOMPARE(frames.at(0).payload(), QByteArray::fromHex("dead"));
+    QCOMPARE(frames.at(0).timeStamp().seconds(), qint64(1));
+    QCOMPARE(frames.at(1).timeStamp().seconds(), qint64(1));
+    QCOMPARE(frames.at(1).timeStamp().microSeconds(), qint64(500000));
+}
+
+void tst_QCanBusTextLog::writeAsc()
+{
+    QBuffer buffer;
+    buffer.open(QIODevice::WriteOnly);
+    {
+        QCanBusTextLogWriter writer(QCanBusTextLogReader::AscFormat, &buffer);
+        QCOMPARE(writer.channel(), QStringLiteral("1"));
+        QVERIFY(writer.writeFrame(frame(0x123, QByteArray::fromHex("deadbeef"), 1001000)));
+
+        QCanBusFrame fd = frame(0x1abcdef0, QByteArray::fromHex("112233445566778899"), 2000000);
+        fd.setBitrateSwitch(true);
+        fd.setLocalEcho(true);
+        QVERIFY(writer.writeFrame(fd));
+    }
+
+    const QList<QByteArray> lines = buffer.data().split('\n');
+    QCOMPARE(lines.size(), qsizetype(10));
+    QVERIFY(lines.at(0).startsWith("date "));
+    QCOMPARE(lines.at(1), QByteArray("base hex  timestamps absolute"));
+    QVERIFY(lines.at(4).startsWith("Begin Triggerblock "));
+    QCOMPARE(lines.at(6), QByteArray("   0.000000 1  123             Rx   d 4 DE AD BE EF"));
+    QCOMPARE(lines.at(7), QByteArray("   0.999000 CANFD   1 Tx   1ABCDEF0x 1 0 9  9 "
+                                     "11 22 33 44 55 66 77 88 99 0 0 3000 0 0 0 0 0"));
+    QCOMPARE(lines.at(8), QByteArray("End TriggerBlock"));
+    QVERIFY(lines.at(9).isEmpty());
+}
+
+void tst_QCanBusTextLog::roundTrip_data()
+{
+    QTest::addColumn<QCanBusTextLogReader::Format>("format");
+
+    QTest::newRow("candump") << QCanBusTextLogReader::CandumpFormat;
+    QTest::newRow("asc") << QCanBusTextLogReader::AscFormat;
+}
+
+void tst_QCanBusTextLog::roundTrip()
+{
+    QFETCH(QCanBusTextLogReader::Format, format);
+
+    QList<QCanBusFrame> frames;
+    for (int i = 0; i < 1000; ++i) {
+        QCanBusFrame frame = tst_QCanBusTextLog::frame(quint32(i * 7919) & 0x7ff,
+                                                       QByteArray(i % 9, char(i)),
+                                                       1602345600123000 + i * 137);
+        frame.setExtendedFrameFormat(i % 3 == 0);
+        frame.setLocalEcho(i % 5 == 0);
+        if (i % 7 == 0) {
+            frame.setPayload(QByteArray(i % 4 * 16, char(i)));
+            frame.setFlexibleDataRateFormat(true);
+            frame.setBitrateSwitch(i % 2);
+        }
+        frames.append(frame);
+    }
+
+    QBuffer buffer;
+    buffer.open(QIODevice::WriteOnly);
+    QCanBusTextLogWriter writer(format, &buffer);
+    for (const QCanBusFrame &frame : std::as_const(frames))
+        QVERIFY(writer.writeFrame(frame));
+    QVERIFY(writer.finish());
+
+    qint64 skippedLines = 0;
+    const QList<QCanBusFrame> read = readAll(format, buffer.data(), &skippedLines);
+    QCOMPARE(read.size(), frames.size());
+    QCOMPARE(skippedLines, qint64(format == QCanBusTextLogReader::AscFormat ? 1 : 0));
+    for (qsizetype i = 0; i < frames.size(); ++i) {
+        QCOMPARE(read.at(i).frameId(), frames.at(i).frameId());
+        QCOMPARE(read.at(i).hasExtendedFrameFormat(), frames.at(i).hasExtendedFrameFormat());
+        QCOMPARE(read.at(i).hasFlexibleDataRateFormat(),
+                 frames.at(i).hasFlexibleDataRateFormat());
+        QCOMPARE(read.at(i).hasBitrateSwitch(), frames.at(i).hasBitrateSwitch());
+        QCOMPARE(read.at(i).hasLocalEcho(), frames.at(i).hasLocalEcho());
+        QCOMPARE(read.at(i).payload(), frames.at(i).payload());
+        QCOMPARE(read.at(i).timeStamp().seconds(), frames.at(i).timeStamp().seconds());
+        QCOMPARE(read.at(i).timeStamp().microSeconds(), frames.at(i).timeStamp().microSeconds());
+    }
+}
+
+void tst_QCanBusTextLog::longLine()
+{
+    QByteArray log = "(1.000000) can0 123#01\n(2.000000) can0 123#";
+    log.append(QByteArray(3 * 1024 * 1024, '0'));
+    log.append("\n(3.000000) can0 123#03\n");
+
+    QBuffer buffer;
+    buffer.setData(log);
+    buffer.open(QIODevice::ReadOnly);
+    QCanBusTextLogReader reader(QCanBusTextLogReader::CandumpFormat, &buffer);
+
+    QCanBusFrame frame;
+    QVERIFY(reader.readFrame(&frame));
+    QCOMPARE(frame.payload(), QByteArray::fromHex("01"));
+    QVERIFY(reader.readFrame(&frame));
+    QCOMPARE(frame.payload(), QByteArray::fromHex("03"));
+    QCOMPARE(reader.lineNumber(), qint64(3));
+    QCOMPARE(reader.skippedLines(), qint64(1));
+    QVERIFY(!reader.readFrame(&frame));
+    QVERIFY(reader.atEnd());
+    QCOMPARE(reader.error(), QCanBusTextLogReader::NoError);
+}
+
+void tst_QCanBusTextLog::noDevice()
+{
+    QCanBusTextLogReader reader;
+    QCanBusFrame frame;
+    QVERIFY(!reader.readFrame(&frame));
+    QVERIFY(reader.atEnd());
+
+    QCanBusTextLogWriter writer;
+    QVERIFY(!writer.writeFrame(frame));
+    QVERIFY(!writer.flush());
+}
+
+QTEST_MAIN(tst_QCanBusTextLog)
+
+#include "tst_qcanbustextlog.moc"
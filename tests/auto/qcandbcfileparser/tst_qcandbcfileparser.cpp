@@ -0,0 +1,178 @@
+/****************************************************************************
+**
+** Copyright (C) 2021 The Qt Company Ltd.
+** Contact: http://www.qt.io/licensing/
+**
+** This file is part of the QtSerialBus module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL3$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see http://www.qt.io/terms-conditions. For further
+** information use the contact form at http://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPLv3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or later as published by the Free
+** Software Foundation and appearing in the file LICENSE.GPL included in
+** the packaging of this file. Please review the following information to
+** ensure the GNU General Public License version 2.0 requirements will be
+** met: http://www.gnu.org/licenses/gpl-2.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include <QtSerialBus/qcandbcfileparser.h>
+#include <QtSerialBus/qcansignaldecoder.h>
+
+#include <QtTest/qtest.h>
+
+#include <cmath>
+
+static const char dbcFile[] = R"(VERSION ""
+
+NS_ :
+    CM_
+    BA_DEF_
+
+BS_:
+
+BU_: Engine Gateway
+
+BO_ 256 EngineData: 8 Engine
+ SG_ Rpm : 0|16@1+ (0.25,0) [0|16383.75] "rpm" Gateway
+ SG_ Temperature : 16|8@1- (1,-40) [-40|215] "degC" Gateway
+ SG_ Pressure : 31|12@0+ (0.1,0) [0|409.5] "kPa" Gateway
+
+BO_ 2566844926 Diagnostics: 8 Gateway
+ SG_ Mode M : 0|8@1+ (1,0) [0|255] "" Engine
+ SG_ Voltage m1 : 8|16@1+ (0.001,0) [0|65.535] "V" Engine
+ SG_ Current m2 : 8|16@1- (0.01,0) [-327.68|327.67] "A" Engine
+
+BO_ 512 Sensors: 8 Engine
+ SG_ Level : 0|32@1- (1,0) [0|0] "" Gateway
+
+BO_ 3221225472 VECTOR__INDEPENDENT_SIG_MSG: 0 Vector__XXX
+ SG_ Orphan : 0|8@1+ (1,0) [0|0] "" Vector__XXX
+
+CM_ SG_ 256 Rpm "Engine speed,
+BO_ 999 NotAMessage: 8 Engine";
+SIG_VALTYPE_ 512 Level : 1;
+)";
+
+class tst_QCanDbcFileParser : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void parse();
+    void decode();
+    void malformed_data();
+    void malformed();
+    void missingFile();
+};
+
+void tst_QCanDbcFileParser::parse()
+{
+    QCanDbcFileParser parser;
+    QVERIFY(parser.parseData(QByteArray(dbcFile)));
+    QCOMPARE(parser.error(), QCanDbcFileParser::NoError);
+
+    const QList<QCanMessageDescription> messages = parser.messageDescriptions();
+    QCOMPARE(messages.size(), 3);
+
+    const QCanMessageDescription engine = messages.at(0);
+    QCOMPARE(engine.name(), QStringLiteral("EngineData"));
+    QCOMPARE(engine.frameId(), 256u);
+    QVERIFY(!engine.hasExtendedFrameFormat());
+    QCOMPARE(engine.size(), 8);
+    QCOMPARE(engine.transmitter(), QStringLiteral("Engine"));
+
+    const QList<QCanSignalDescription> engineSignals = engine.signalDescriptions();
+    QCOMPARE(engineSignals.size(), 3);
+    QCOMPARE(engineSignals.at(0).name(), QStringLiteral("Rpm"));
+    QCOMPARE(engineSignals.at(0).factor(), 0.25);
+    QCOMPARE(engineSignals.at(0).maximum(), 16383.75);
+    QCOMPARE(engineSignals.at(0).unit(), QStringLiteral("rpm"));
+    QCOMPARE(engineSignals.at(1).valueType(), QCanSignalDescription::Signed);
+    QCOMPARE(engineSignals.at(1).offset(), -40.0);
+    QCOMPARE(engineSignals.at(2).byteOrder(), QSysInfo::BigEndian);
+    QCOMPARE(engineSignals.at(2).startBit(), 31);
+    QCOMPARE(engineSignals.at(2).bitLength(), 12);
+
+    const QCanMessageDescription diagnostics = messages.at(1);
+    QVERIFY(diagnostics.hasExtendedFrameFormat());
+    QCOMPARE(diagnostics.frameId(), 0x18fef1feu);
+    const QList<QCanSignalDescription> diagnosticSignals = diagnostics.signalDescriptions();
+    QCOMPARE(diagnosticSignals.at(0).multiplexing(), QCanSignalDescription::MultiplexorSwitch);
+    QCOMPARE(diagnosticSignals.at(2).multiplexing(), QCanSignalDescription::MultiplexedSignal);
+    QCOMPARE(diagnosticSignals.at(2).multiplexValue(), quint64(2));
+
+    const QCanSignalDescription level = messages.at(2).signalDescriptions().first();
+    QCOMPARE(level.valueType(), QCanSignalDescription::Float);
+    QVERIFY(level.isValid());
+}
+
+void tst_QCanDbcFileParser::decode()
+{
+    QCanDbcFileParser parser;
+    QVERIFY(parser.parseData(QByteArray(dbcFile)));
+    const QCanSignalDecoder decoder(parser.messageDescriptions());
+
+    // Rpm 3000, temperature 20 degC, pressure 101.3 kPa
+    double values[3] = {};
+    QCOMPARE(decoder.decode(QCanBusFrame(256, QByteArray::fromHex("e02e3c3f50000000")), values),
+             3);
+    QCOMPARE(values[0], 3000.0);
+    QCOMPARE(values[1], 20.0);
+    QCOMPARE(values[2], 101.3);
+
+    QCanBusFrame diagnostics(0x18fef1fe, QByteArray::fromHex("02ecff0000000000"));
+    QCOMPARE(decoder.decode(diagnostics, values), 3);
+    QVERIFY(std::isnan(values[1]));
+    QCOMPARE(values[2], -0.2);
+}
+
+void tst_QCanDbcFileParser::malformed_data()
+{
+    QTest::addColumn<QByteArray>("data");
+
+    QTest::newRow("message") << QByteArray("BO_ x Message: 8 Node\n");
+    QTest::newRow("signal") << QByteArray("BO_ 1 Message: 8 Node\n SG_ Value : 0|8@2+ (1,0) "
+                                          "[0|0] \"\" Node\n");
+    QTest::newRow("orphan signal") << QByteArray("SG_ Value : 0|8@1+ (1,0) [0|0] \"\" Node\n");
+}
+
+void tst_QCanDbcFileParser::malformed()
+{
+    QFETCH(QByteArray, data);
+
+    QCanDbcFileParser parser;
+    QVERIFY(!parser.parseData(data));
+    QCOMPARE(parser.error(), QCanDbcFileParser::ParseError);
+    QVERIFY(parser.errorString().contains(QStringLiteral("Line ")));
+    QVERIFY(parser.messageDescriptions().isEmpty());
+}
+
+void tst_QCanDbcFileParser::missingFile()
+{
+    QCanDbcFileParser parser;
+    QVERIFY(!parser.parse(QStringLiteral("does-not-exist.dbc")));
+    QCOMPARE(parser.error(), QCanDbcFileParser::FileReadError);
+}
+
+QTEST_MAIN(tst_QCanDbcFileParser)
+
+#include "tst_qcandbcfileparser.moc"
@@ -0,0 +1,338 @@
+/****************************************************************************
+**
+** Copyright (C) 2021 The Qt Company Ltd.
+** Contact: http://www.qt.io/licensing/
+**
+** This file is part of the QtSerialBus module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL3$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see http://www.qt.io/terms-conditions. For further
+** information use the contact form at http://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPLv3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or later as published by the Free
+** Software Foundation and appearing in the file LICENSE.GPL included in
+** the packaging of this file. Please review the following information to
+** ensure the GNU General Public License version 2.0 requirements will be
+** met: http://www.gnu.org/licenses/gpl-2.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include "../../shared/loopbackcanbusdevice.h"
+
+#include <QtSerialBus/qcanisotpchannel.h>
+
+#include <QtTest/qsignalspy.h>
+#include <QtTest/qtest.h>
+
+class tst_QCanIsoTpChannel : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void init();
+    void cleanup();
+
+    void singleFrame();
+    void segmentedMessage_data();
+    void segmentedMessage();
+    void flexibleDataRate();
+    void separationTime();
+    void sequenceError();
+    void overflow();
+    void busy();
+    void timeout();
+    void kernelOffload();
+
+private:
+    static void connectChannel(LoopbackCanBusDevice *device, QCanIsoTpChannel *channel)
+    {
+        QObject::connect(device, &QCanBusDevice::framesReceived, channel, [device, channel]() {
+            while (device->framesAvailable())
+                channel->processFrame(device->readFrame());
+        });
+    }
+
+    static QByteArray message(qsizetype size)
+    {
+        QByteArray data(size, Qt::Uninitialized);
+        for (qsizetype i = 0; i < size; ++i)
+            data[i] = char(i * 7);
+        return data;
+    }
+
+    LoopbackCanBusDevice *tester = nullptr;
+    LoopbackCanBusDevice *ecu = nullptr;
+    QCanIsoTpChannel *testerChannel = nullptr;
+    QCanIsoTpChannel *ecuChannel = nullptr;
+};
+
+void tst_QCanIsoTpChannel::init()
+{
+    tester = new LoopbackCanBusDevice;
+    ecu = new LoopbackCanBusDevice;
+    tester->peer = ecu;
+    ecu->peer = tester;
+    QVERIFY(tester->connectDevice());
+    QVERIFY(ecu->connectDevice());
+
+    testerChannel = new QCanIsoTpChannel(tester, 0x7e0, 0x7e8);
+    ecuChannel = new QCanIsoTpChannel(ecu, 0x7e8, 0x7e0);
+    connectChannel(tester, testerChannel);
+    connectChannel(ecu, ecuChannel);
+}
+
+void tst_QCanIsoTpChannel::cleanup()
+{
+    delete testerChannel;
+    delete ecuChannel;
+    delete tester;
+    delete ecu;
+}
+
+void tst_QCanIsoTpChannel::singleFrame()
+{
+    QSignalSpy sent(testerChannel, &QCanIsoTpChannel::messageSent);
+    QSignalSpy received(ecuChannel, &QCanIsoTpChannel::messageReceived);
+
+    QVERIFY(testerChannel->sendMessage(QByteArray::fromHex("1003")));
+    QCOMPARE(sent.count(), 1);
+    QCOMPARE(tester->written.size(), 1);
+    QCOMPARE(tester->written.first().frameId(), 0x7e0u);
+    QCOMPARE(tester->written.first().payload(), QByteArray::fromHex("021003"));
+
+    QCOMPARE(received.count(), 1);
+    QCOMPARE(ecuChannel->messagesAvailable(), qsizetype(1));
+    QCOMPARE(ecuChannel->readMessage(), QByteArray::fromHex("1003"));
+    QCOMPARE(ecuChannel->messagesAvailable(), qsizetype(0));
+    QVERIFY(ecuChannel->readMessage().isEmpty());
+
+    // Padding fills classic frames up to 8 bytes.
+    testerChannel->setPaddingByte(0xaa);
+    QVERIFY(testerChannel->sendMessage(QByteArray::fromHex("3e00")));
+    QCOMPARE(tester->written.last().payload(), QByteArray::fromHex("023e00aaaaaaaaaa"));
+    QCOMPARE(ecuChannel->readMessage(), QByteArray::fromHex("3e00"));
+
+    QVERIFY(!testerChannel->sendMessage(QByteArray()));
+    QCOMPARE(testerChannel->error(), QCanIsoTpChannel::MessageSizeError);
+}
+
+void tst_QCanIsoTpChannel::segmentedMessage_data()
+{
+    QTest::addColumn<int>("size");
+    QTest::addColumn<int>("blockSize");
+
+    QTest::newRow("8 bytes") << 8 << 0;
+    QTest::newRow("100 bytes") << 100 << 0;
+    QTest::newRow("100 bytes, block size 4") << 100 << 4;
+    QTest::newRow("4095 bytes") << 4095 << 0;
+    QTest::newRow("100 bytes, block size 1") << 100 << 1;
+    QTest::newRow("4095 bytes, block size 16") << 4095 << 16;
+}
+
+void tst_QCanIsoTpChannel::segmentedMessage()
+{
+    QFETCH(int, size);
+    QFETCH(int, blockSize);
+
+    ecuChannel->setBlockSize(blockSize);
+    QSignalSpy sent(testerChannel, &QCanIsoTpChannel::messageSent);
+    QSignalSpy received(ecuChannel, &QCanIsoTpChannel::messageReceived);
+
+    const QByteArray data = message(size);
+    QVERIFY(testerChannel->sendMessage(data));
+    QCOMPARE(sent.count(), 1);
+    QVERIFY(!testerChannel->isSending());
+    QCOMPARE(received.count(), 1);
+    QCOMPARE(ecuChannel->readMessage(), data);
+
+    // First frame, consecutive frames and one flow control frame per block.
+    const int consecutiveFrames = (size - 6 + 6) / 7;
+    QCOMPARE(tester->written.size(), 1 + consecutiveFrames);
+    const int blocks = blockSize ? (consecutiveFrames + blockSize - 1) / blockSize : 1;
+    QCOMPARE(ecu->written.size(), blocks);
+    QCOMPARE(quint8(ecu->written.first().payload().at(0)), quint8(0x30));
+    QCOMPARE(quint8(ecu->written.first().payload().at(1)), quint8(blockSize));
+    QCOMPARE(ecuChannel->error(), QCanIsoTpChannel::NoError);
+}
+
+void tst_QCanIsoTpChannel::flexibleDataRate()
+{
+    testerChannel->setFlexibleDataRateFormat(true);
+    QVERIFY(testerChannel->hasFlexibleDataRateFormat());
+
+    // Single frames longer than 7 bytes use the escape sequence.
+    const QByteArray shortMessage = message(20);
+    QVERIFY(testerChannel->sendMessage(shortMessage));
+    QCOMPARE(tester->written.size(), 1);
+    const QCanBusFrame singleFrame = tester->written.first();
+    QVERIFY(singleFrame.hasFlexibleDataRateFormat());
+    QCOMPARE(singleFrame.payload().size(), 24);
+    QCOMPARE(singleFrame.payload().left(2), QByteArray::fromHex("0014"));
+    QCOMPARE(ecuChannel->readMessage(), shortMessage);
+
+    // Messages longer than 4095 bytes use the 32 bit first frame length.
+    ecuChannel->setMaximumMessageSize(10000);
+    const QByteArray longMessage = message(10000);
+    tester->written.clear();
+    QVERIFY(testerChannel->sendMessage(longMessage));
+    QCOMPARE(tester->written.first().payload().left(6), QByteArray::fromHex("100000002710"));
+    QCOMPARE(tester->written.first().payload().size(), 64);
+    QCOMPARE(tester->written.size(), 1 + (10000 - 58 + 62) / 63);
+    QCOMPARE(ecuChannel->readMessage(), longMessage);
+}
+
+void tst_QCanIsoTpChannel::separationTime()
+{
+    ecuChannel->setSeparationTime(250);
+    QCOMPARE(ecuChannel->separationTime(), 300);
+    ecuChannel->setSeparationTime(1500);
+    QCOMPARE(ecuChannel->separationTime(), 2000);
+    ecuChannel->setSeparationTime(1000000);
+    QCOMPARE(ecuChannel->separationTime(), 127000);
+
+    ecuChannel->setSeparationTime(1000);
+    QSignalSpy sent(testerChannel, &QCanIsoTpChannel::messageSent);
+    const QByteArray data = message(30);
+    QVERIFY(testerChannel->sendMessage(data));
+    QCOMPARE(quint8(ecu->written.first().payload().at(2)), quint8(1));
+
+    // The consecutive frames are paced by the separation time.
+    QVERIFY(testerChannel->isSending());
+    QCOMPARE(tester->written.size(), 2);
+    QTRY_COMPARE(sent.count(), 1);
+    QCOMPARE(tester->written.size(), 5);
+    QCOMPARE(ecuChannel->readMessage(), data);
+}
+
+void tst_QCanIsoTpChannel::sequenceError()
+{
+    tester->peer = nullptr;
+    QSignalSpy errors(ecuChannel, &QCanIsoTpChannel::errorOccurred);
+
+    QCanBusFrame firstFrame(0x7e0, QByteArray::fromHex("1014000102030405"));
+    ecu->receive(firstFrame);
+    QCOMPARE(ecu->written.size(), 1);
+
+    QCanBusFrame outOfSequence(0x7e0, QByteArray::fromHex("22060708090a0b0c"));
+    ecu->receive(outOfSequence);
+    QCOMPARE(errors.count(), 1);
+    QCOMPARE(ecuChannel->error(), QCanIsoTpChannel::SequenceError);
+    QCOMPARE(ecuChannel->messagesAvailable(), qsizetype(0));
+
+    // Frames with other identifiers are left to the application.
+    QVERIFY(!ecuChannel->processFrame(QCanBusFrame(0x123, QByteArray::fromHex("0101"))));
+}
+
+void tst_QCanIsoTpChannel::overflow()
+{
+    ecuChannel->setMaximumMessageSize(100);
+    QSignalSpy testerErrors(testerChannel, &QCanIsoTpChannel::errorOccurred);
+    QSignalSpy ecuErrors(ecuChannel, &QCanIsoTpChannel::errorOccurred);
+
+    QVERIFY(testerChannel->sendMessage(message(101)));
+    QCOMPARE(ecuErrors.count(), 1);
+    QCOMPARE(ecuChannel->error(), QCanIsoTpChannel::OverflowError);
+    QCOMPARE(testerErrors.count(), 1);
+    QCOMPARE(testerChannel->error(), QCanIsoTpChannel::OverflowError);
+    QVERIFY(!testerChannel->isSending());
+}
+
+void tst_QCanIsoTpChannel::busy()
+{
+    ecu->peer = nullptr;
+    QVERIFY(testerChannel->sendMessage(message(20)));
+    QVERIFY(testerChannel->isSending());
+    QVERIFY(!testerChannel->sendMessage(message(20)));
+    QCOMPARE(testerChannel->error(), QCanIsoTpChannel::BusyError);
+}
+
+void tst_QCanIsoTpChannel::timeout()
+{
+    ecu->peer = nullptr;
+    testerChannel->setTimeout(50);
+    QSignalSpy errors(testerChannel, &QCanIsoTpChannel::errorOccurred);
+
+    QVERIFY(testerChannel->sendMessage(message(20)));
+    QTRY_COMPARE(errors.count(), 1);
+    QCOMPARE(testerChannel->error(), QCanIsoTpChannel::TimeoutError);
+    QVERIFY(!testerChannel->isSending());
+}
+
+void tst_QCanIsoTpChannel::kernelOffload()
+{
+    LoopbackCanBusDevice device;
+    device.setConfigurationParameter(QCanBusDevice::ProtocolKey,
+                                     int(QCanIsoTpChannel::KernelIsoTpProtocol));
+    QCanIsoTpChannel channel(&device, 0x18da10f1, 0x18daf110);
+    channel.setBlockSize(8);
+    channel.setMaximumMessageSize(2000);
+    QVERIFY(channel.isKernelOffloaded());
+    QVERIFY(channel.hasExtendedFrameFormat());
+
+    const auto key = [&device](QCanIsoTpChannel::ConfigurationKey key) {
+        return device.configurationParameter(QCanBusDevice::ConfigurationKey(key));
+    };
+    QCOMPARE(key(QCanIsoTpChannel::TransmitIdKey).toUInt(), 0x18da10f1u);
+    QCOMPARE(key(QCanIsoTpChannel::ReceiveIdKey).toUInt(), 0x18daf110u);
+    QCOMPARE(key(QCanIsoTpChannel::BlockSizeKey).toInt(), 8);
+    QCOMPARE(key(QCanIsoTpChannel::MaximumMessageSizeKey).toLongLong(), 2000);
+    QCOMPARE(key(QCanIsoTpChannel::ExtendedFrameFormatKey).toBool(), true);
+    QCOMPARE(key(QCanIsoTpChannel::BitrateSwitchKey).toBool(), false);
+
+    // Small identifiers may still use the extended frame format.
+    {
+        LoopbackCanBusDevice other;
+        other.setConfigurationParameter(QCanBusDevice::ProtocolKey,
+                                        int(QCanIsoTpChannel::KernelIsoTpProtocol));
+        QCanIsoTpChannel small(&other, 0x7e0, 0x7e8);
+        const auto otherKey = [&other](QCanIsoTpChannel::ConfigurationKey key) {
+            return other.configurationParameter(QCanBusDevice::ConfigurationKey(key));
+        };
+        QCOMPARE(otherKey(QCanIsoTpChannel::ExtendedFrameFormatKey).toBool(), false);
+        small.setExtendedFrameFormat(true);
+        small.setBitrateSwitch(true);
+        QCOMPARE(otherKey(QCanIsoTpChannel::ExtendedFrameFormatKey).toBool(), true);
+        QCOMPARE(otherKey(QCanIsoTpChannel::BitrateSwitchKey).toBool(), true);
+    }
+
+    // Whole messages are exchanged with the device.
+    QVERIFY(device.connectDevice());
+    const QByteArray data = message(1000);
+    QVERIFY(channel.sendMessage(data));
+    QCOMPARE(device.written.size(), 1);
+    QCOMPARE(device.written.first().payload(), data);
+
+    QCanBusFrame response(0x18daf110, data);
+    QVERIFY(channel.processFrame(response));
+    QCOMPARE(channel.readMessage(), data);
+
+    // The keys are not set on a connected device, but when it connects again.
+    QSignalSpy errors(&device, &QCanBusDevice::errorOccurred);
+    channel.setBlockSize(4);
+    QCOMPARE(key(QCanIsoTpChannel::BlockSizeKey).toInt(), 8);
+    QCOMPARE(errors.count(), 0);
+    device.disconnectDevice();
+    QVERIFY(device.connectDevice());
+    QCOMPARE(key(QCanIsoTpChannel::BlockSizeKey).toInt(), 4);
+}
+
+QTEST_MAIN(tst_QCanIsoTpChannel)
+
+#include "tst_qcanisotpchannel.moc"
@@ -0,0 +1,394 @@
+/****************************************************************************
+**
+** Copyright (C) 2021 The Qt Company Ltd.
+** Contact: http://www.qt.io/licensing/
+**
+** This file is part of the QtSerialBus module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL3$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see http://www.qt.io/terms-conditions. For further
+** information use the contact form at http://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPLv3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or later as published by the Free
+** Software Foundation and appearing in the file LICENSE.GPL included in
+** the packaging of this file. Please review the following information to
+** ensure the GNU General Public License version 2.0 requirements will be
+** met: http://www.gnu.org/licenses/gpl-2.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include "../../shared/loopbackcanbusdevice.h"
+
+#include <QtSerialBus/qcanj1939channel.h>
+
+#include <QtCore/qendian.h>
+
+#include <QtTest/qsignalspy.h>
+#include <QtTest/qtest.h>
+
+class tst_QCanJ1939Channel : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void init();
+    void cleanup();
+
+    void frameIdentifiers();
+    void claimAddress();
+    void addressConflict();
+    void cannotClaimAddress();
+    void requestAddressClaim();
+    void singleFrame();
+    void broadcastMessage();
+    void connectionMessage_data();
+    void connectionMessage();
+    void sequenceError();
+    void invalidMessage();
+    void kernelOffload();
+    void kernelOffloadAddressConflict();
+
+private:
+    static constexpr quint64 TesterName = 0x0000000000001000;
+    static constexpr quint64 EcuName = 0x8000000000002000;
+
+    static void connectChannel(LoopbackCanBusDevice *device, QCanJ1939Channel *channel)
+    {
+        QObject::connect(device, &QCanBusDevice::framesReceived, channel, [device, channel]() {
+            while (device->framesAvailable())
+                channel->processFrame(device->readFrame());
+        });
+    }
+
+    static QByteArray message(qsizetype size)
+    {
+        QByteArray data(size, Qt::Uninitialized);
+        for (qsizetype i = 0; i < size; ++i)
+            data[i] = char(i * 7);
+        return data;
+    }
+
+    static quint8 controlByte(const QCanBusFrame &frame)
+    {
+        return quint8(frame.payload().at(0));
+    }
+
+    void claimAddresses()
+    {
+        QVERIFY(testerChannel->claimAddress());
+        QVERIFY(ecuChannel->claimAddress());
+        QTRY_COMPARE(testerChannel->addressState(), QCanJ1939Channel::AddressClaimed);
+        QTRY_COMPARE(ecuChannel->addressState(), QCanJ1939Channel::AddressClaimed);
+    }
+
+    LoopbackCanBusDevice *tester = nullptr;
+    LoopbackCanBusDevice *ecu = nullptr;
+    QCanJ1939Channel *testerChannel = nullptr;
+    QCanJ1939Channel *ecuChannel = nullptr;
+};
+
+void tst_QCanJ1939Channel::init()
+{
+    tester = new LoopbackCanBusDevice;
+    ecu = new LoopbackCanBusDevice;
+    tester->peer = ecu;
+    ecu->peer = tester;
+    QVERIFY(tester->connectDevice());
+    QVERIFY(ecu->connectDevice());
+
+    testerChannel = new QCanJ1939Channel(tester, TesterName, 0xf9);
+    ecuChannel = new QCanJ1939Channel(ecu, EcuName, 0x00);
+    connectChannel(tester, testerChannel);
+    connectChannel(ecu, ecuChannel);
+}
+
+void tst_QCanJ1939Channel::cleanup()
+{
+    delete testerChannel;
+    delete ecuChannel;
+    delete tester;
+    delete ecu;
+}
+
+void tst_QCanJ1939Channel::frameIdentifiers()
+{
+    // PDU1 format: the destination address is part of the identifier.
+    const quint32 pdu1 = QCanJ1939Channel::frameId(0xef00, 6, 0x10, 0x20);
+    QCOMPARE(pdu1, 0x18ef2010u);
+    QCOMPARE(QCanJ1939Channel::parameterGroupNumber(pdu1), 0xef00u);
+    QCOMPARE(QCanJ1939Channel::sourceAddress(pdu1), quint8(0x10));
+    QCOMPARE(QCanJ1939Channel::destinationAddress(pdu1), quint8(0x20));
+    QCOMPARE(QCanJ1939Channel::priority(pdu1), quint8(6));
+
+    // PDU2 format: always broadcast, the destination is ignored.
+    const quint32 pdu2 = QCanJ1939Channel::frameId(0xfef1, 3, 0x10, 0x20);
+    QCOMPARE(pdu2, 0x0cfef110u);
+    QCOMPARE(QCanJ1939Channel::parameterGroupNumber(pdu2), 0xfef1u);
+    QCOMPARE(QCanJ1939Channel::destinationAddress(pdu2), quint8(QCanJ1939Channel::GlobalAddress));
+    QCOMPARE(QCanJ1939Channel::priority(pdu2), quint8(3));
+}
+
+void tst_QCanJ1939Channel::claimAddress()
+{
+    QSignalSpy stateChanged(testerChannel, &QCanJ1939Channel::addressStateChanged);
+
+    QVERIFY(testerChannel->claimAddress());
+    QCOMPARE(testerChannel->addressState(), QCanJ1939Channel::ClaimingAddress);
+    QCOMPARE(testerChannel->address(), quint8(QCanJ1939Channel::NullAddress));
+
+    QCOMPARE(tester->written.size(), 1);
+    const QCanBusFrame claim = tester->written.first();
+    QVERIFY(claim.hasExtendedFrameFormat());
+    QCOMPARE(claim.frameId(), QCanJ1939Channel::frameId(0xee00, 6, 0xf9));
+    QCOMPARE(claim.payload(), QByteArray::fromHex("0010000000000000"));
+
+    QTRY_COMPARE(testerChannel->addressState(), QCanJ1939Channel::AddressClaimed);
+    QCOMPARE(testerChannel->address(), quint8(0xf9));
+    QCOMPARE(stateChanged.count(), 2);
+}
+
+void tst_QCanJ1939Channel::addressConflict()
+{
+    delete ecuChannel;
+    ecuChannel = new QCanJ1939Channel(ecu, EcuName, 0xf9);
+    connectChannel(ecu, ecuChannel);
+
+    // The tester has the lower NAME and keeps the address, the ECU is arbitrary
+    // address capable and claims the first free address from 128.
+    claimAddresses();
+    QCOMPARE(testerChannel->address(), quint8(0xf9));
+    QCOMPARE(ecuChannel->address(), quint8(128));
+}
+
+void tst_QCanJ1939Channel::cannotClaimAddress()
+{
+    delete ecuChannel;
+    ecuChannel = new QCanJ1939Channel(ecu, EcuName & ~(quint64(1) << 63), 0xf9);
+    connectChannel(ecu, ecuChannel);
+    QSignalSpy errors(ecuChannel, &QCanJ1939Channel::errorOccurred);
+
+    QVERIFY(testerChannel->claimAddress());
+    ecuChannel->claimAddress();
+    QCOMPARE(ecuChannel->addressState(), QCanJ1939Channel::CannotClaimAddress);
+    QCOMPARE(ecuChannel->address(), quint8(QCanJ1939Channel::NullAddress));
+    QCOMPARE(errors.count(), 1);
+    QCOMPARE(ecuChannel->error(), QCanJ1939Channel::AddressClaimError);
+
+    // The failure is announced from the null address.
+    QCOMPARE(QCanJ1939Channel::sourceAddress(ecu->written.last().frameId()),
+             quint8(QCanJ1939Channel::NullAddress));
+
+    QTRY_COMPARE(testerChannel->addressState(), QCanJ1939Channel::AddressClaimed);
+    QVERIFY(!ecuChannel->sendMessage({ 0xfef1, 6, 0, QCanJ1939Channel::GlobalAddress,
+                                       message(8), {} }));
+}
+
+void tst_QCanJ1939Channel::requestAddressClaim()
+{
+    claimAddresses();
+    tester->written.clear();
+
+    QCanBusFrame request(QCanJ1939Channel::frameId(0xea00, 6, 0x00), QByteArray::fromHex("00ee00"));
+    ecu->writeFrame(request);
+    QCOMPARE(tester->written.size(), 1);
+    QCOMPARE(QCanJ1939Channel::parameterGroupNumber(tester->written.first().frameId()), 0xee00u);
+    QCOMPARE(QCanJ1939Channel::sourceAddress(tester->written.first().frameId()), quint8(0xf9));
+}
+
+void tst_QCanJ1939Channel::singleFrame()
+{
+    QVERIFY(!testerChannel->sendMessage({ 0xfef1, 6, 0, QCanJ1939Channel::GlobalAddress,
+                                          message(8), {} }));
+    QCOMPARE(testerChannel->error(), QCanJ1939Channel::BusyError);
+
+    claimAddresses();
+    QSignalSpy sent(testerChannel, &QCanJ1939Channel::messageSent);
+    QSignalSpy received(ecuChannel, &QCanJ1939Channel::messageReceived);
+
+    QVERIFY(testerChannel->sendMessage({ 0xef00, 3, 0, 0x00, message(8), {} }));
+    QCOMPARE(sent.count(), 1);
+    QCOMPARE(received.count(), 1);
+
+    const QCanJ1939Channel::Message result = ecuChannel->readMessage();
+    QCOMPARE(result.pgn, 0xef00u);
+    QCOMPARE(result.priority, quint8(3));
+    QCOMPARE(result.source, quint8(0xf9));
+    QCOMPARE(result.destination, quint8(0x00));
+    QCOMPARE(result.data, message(8));
+
+    // Messages to another node are left to the application.
+    QCanBusFrame other(QCanJ1939Channel::frameId(0xef00, 6, 0xf9, 0x42), message(8));
+    QVERIFY(!ecuChannel->processFrame(other));
+}
+
+void tst_QCanJ1939Channel::broadcastMessage()
+{
+    claimAddresses();
+    tester->written.clear();
+    QSignalSpy sent(testerChannel, &QCanJ1939Channel::messageSent);
+    QSignalSpy received(ecuChannel, &QCanJ1939Channel::messageReceived);
+
+    const QByteArray data = message(20);
+    QVERIFY(testerChannel->sendMessage({ 0xfeca, 6, 0, QCanJ1939Channel::GlobalAddress,
+                                         data, {} }));
+    QVERIFY(testerChannel->isSending());
+    QCOMPARE(tester->written.size(), 1);
+    QCOMPARE(controlByte(tester->written.first()), quint8(32));
+
+    // The packets are paced, the announcement and three packets are written.
+    QTRY_COMPARE(sent.count(), 1);
+    QVERIFY(!testerChannel->isSending());
+    QCOMPARE(tester->written.size(), 4);
+    QCOMPARE(received.count(), 1);
+
+    const QCanJ1939Channel::Message result = ecuChannel->readMessage();
+    QCOMPARE(result.pgn, 0xfecau);
+    QCOMPARE(result.destination, quint8(QCanJ1939Channel::GlobalAddress));
+    QCOMPARE(result.data, data);
+}
+
+void tst_QCanJ1939Channel::connectionMessage_data()
+{
+    QTest::addColumn<int>("size");
+
+    QTest::newRow("two packets") << 9;
+    QTest::newRow("one window") << 112;
+    QTest::newRow("maximum") << 1785;
+}
+
+void tst_QCanJ1939Channel::connectionMessage()
+{
+    QFETCH(int, size);
+
+    claimAddresses();
+    QSignalSpy sent(testerChannel, &QCanJ1939Channel::messageSent);
+    QSignalSpy received(ecuChannel, &QCanJ1939Channel::messageReceived);
+    QSignalSpy errors(testerChannel, &QCanJ1939Channel::errorOccurred);
+
+    const QByteArray data = message(size);
+    QVERIFY(testerChannel->sendMessage({ 0xef00, 6, 0, 0x00, data, {} }));
+    QCOMPARE(sent.count(), 1);
+    QCOMPARE(received.count(), 1);
+    QCOMPARE(errors.count(), 0);
+    QVERIFY(!testerChannel->isSending());
+
+    // The receiver acknowledges the end of the message.
+    QCOMPARE(controlByte(ecu->written.last()), quint8(19));
+
+    const QCanJ1939Channel::Message result = ecuChannel->readMessage();
+    QCOMPARE(result.source, quint8(0xf9));
+    QCOMPARE(result.destination, quint8(0x00));
+    QCOMPARE(result.data, data);
+}
+
+void tst_QCanJ1939Channel::sequenceError()
+{
+    claimAddresses();
+    ecu->written.clear();
+    ecu->peer = nullptr;
+    QSignalSpy errors(ecuChannel, &QCanJ1939Channel::errorOccurred);
+
+    const quint32 control = QCanJ1939Channel::frameId(0xec00, 7, 0x30, 0x00);
+    const quint32 transfer = QCanJ1939Channel::frameId(0xeb00, 7, 0x30, 0x00);
+    ecu->receive(QCanBusFrame(control, QByteArray::fromHex("101400031000ef00")));
+    QCOMPARE(ecu->written.size(), 1);
+    QCOMPARE(controlByte(ecu->written.first()), quint8(17));
+
+    ecu->receive(QCanBusFrame(transfer, QByteArray::fromHex("02ffffffffffffff")));
+    QCOMPARE(errors.count(), 1);
+    QCOMPARE(ecuChannel->error(), QCanJ1939Channel::AbortError);
+    QCOMPARE(ecu->written.size(), 2);
+    QCOMPARE(ecu->written.last().payload().left(2), QByteArray::fromHex("ff07"));
+    QCOMPARE(ecuChannel->messagesAvailable(), 0);
+}
+
+void tst_QCanJ1939Channel::invalidMessage()
+{
+    claimAddresses();
+    QVERIFY(!testerChannel->sendMessage({ 0xef00, 6, 0, 0x00, message(1786), {} }));
+    QCOMPARE(testerChannel->error(), QCanJ1939Channel::MessageSizeError);
+
+    tester->peer = nullptr;
+    QVERIFY(testerChannel->sendMessage({ 0xef00, 6, 0, 0x00, message(100), {} }));
+    QVERIFY(!testerChannel->sendMessage({ 0xef00, 6, 0, 0x00, message(100), {} }));
+    QCOMPARE(testerChannel->error(), QCanJ1939Channel::BusyError);
+
+    // Without a clear to send from the receiver the transfer times out.
+    QTRY_COMPARE_WITH_TIMEOUT(testerChannel->error(), QCanJ1939Channel::TimeoutError, 2000);
+    QVERIFY(!testerChannel->isSending());
+    QCOMPARE(controlByte(tester->written.last()), quint8(255));
+}
+
+void tst_QCanJ1939Channel::kernelOffload()
+{
+    LoopbackCanBusDevice device;
+    device.setConfigurationParameter(QCanBusDevice::ProtocolKey,
+                                     int(QCanJ1939Channel::KernelJ1939Protocol));
+    QCanJ1939Channel channel(&device, TesterName, 0x80);
+    QVERIFY(channel.isKernelOffloaded());
+
+    const auto key = [&device](QCanJ1939Channel::ConfigurationKey key) {
+        return device.configurationParameter(QCanBusDevice::ConfigurationKey(key));
+    };
+    QCOMPARE(key(QCanJ1939Channel::NameKey).toULongLong(), TesterName);
+    QCOMPARE(key(QCanJ1939Channel::AddressKey).toUInt(), 0x80u);
+
+    QVERIFY(device.connectDevice());
+    QVERIFY(channel.claimAddress());
+    QTRY_COMPARE(channel.addressState(), QCanJ1939Channel::AddressClaimed);
+    device.written.clear();
+
+    // Whole messages are exchanged with the device.
+    const QByteArray data = message(1000);
+    QVERIFY(channel.sendMessage({ 0xef00, 6, 0, 0x20, data, {} }));
+    QCOMPARE(device.written.size(), 1);
+    QCOMPARE(device.written.first().frameId(), QCanJ1939Channel::frameId(0xef00, 6, 0x80, 0x20));
+    QCOMPARE(device.written.first().payload(), data);
+
+    QCanBusFrame response(QCanJ1939Channel::frameId(0xef00, 6, 0x20, 0x80), data);
+    QVERIFY(channel.processFrame(response));
+    QCOMPARE(channel.readMessage().data, data);
+}
+
+void tst_QCanJ1939Channel::kernelOffloadAddressConflict()
+{
+    LoopbackCanBusDevice device;
+    device.setConfigurationParameter(QCanBusDevice::ProtocolKey,
+                                     int(QCanJ1939Channel::KernelJ1939Protocol));
+    QCanJ1939Channel channel(&device, EcuName, 0x80);
+    QVERIFY(device.connectDevice());
+    QVERIFY(channel.claimAddress());
+
+    // A node with a lower NAME claims the same address. The ECU is arbitrary address
+    // capable, but the socket is bound to 0x80, so it does not move to another address.
+    uchar name[8];
+    qToLittleEndian(TesterName, name);
+    const QCanBusFrame claim(QCanJ1939Channel::frameId(0xee00, 6, 0x80),
+                             QByteArray(reinterpret_cast<const char *>(name), 8));
+    QVERIFY(channel.processFrame(claim));
+    QCOMPARE(channel.addressState(), QCanJ1939Channel::CannotClaimAddress);
+    QCOMPARE(channel.address(), quint8(QCanJ1939Channel::NullAddress));
+    QCOMPARE(device.configurationParameter(QCanBusDevice::ConfigurationKey(
+                 QCanJ1939Channel::AddressKey)).toUInt(), 0x80u);
+}
+
+QTEST_MAIN(tst_QCanJ1939Channel)
+
+#include "tst_qcanj1939channel.moc"
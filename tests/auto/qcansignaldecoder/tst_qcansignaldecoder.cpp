@@ -0,0 +1,303 @@
+/****************************************************************************
+**
+** Copyright (C) 2021 The Qt Company Ltd.
+** Contact: http://www.qt.io/licensing/
+**
+** This file is part of the QtSerialBus module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL3$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see http://www.qt.io/terms-conditions. For further
+** information use the contact form at http://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPLv3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or later as published by the Free
+** Software Foundation and appearing in the file LICENSE.GPL included in
+** the packaging of this file. Please review the following information to
+** ensure the GNU General Public License version 2.0 requirements will be
+** met: http://www.gnu.org/licenses/gpl-2.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include <QtSerialBus/qcansignaldecoder.h>
+
+#include <QtTest/qtest.h>
+
+#include <cmath>
+#include <cstring>
+
+class tst_QCanSignalDecoder : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void signalDescription();
+    void extract_data();
+    void extract();
+    void valueTypes();
+    void scaling();
+    void multiplexing();
+    void shortPayload();
+    void lookup();
+    void batch();
+
+private:
+    static QCanMessageDescription message(quint32 id, const QString &name, int size,
+                                          const QList<QCanSignalDescription> &descriptions)
+    {
+        QCanMessageDescription description(id, name, size);
+        description.setSignalDescriptions(descriptions);
+        return description;
+    }
+};
+
+void tst_QCanSignalDecoder::signalDescription()
+{
+    QCanSignalDescription description;
+    QVERIFY(!description.isValid());
+
+    description = QCanSignalDescription(QStringLiteral("Speed"), 0, 16);
+    QVERIFY(description.isValid());
+    QCOMPARE(description.byteOrder(), QSysInfo::LittleEndian);
+    QCOMPARE(description.factor(), 1.0);
+
+    description.setBitLength(65);
+    QVERIFY(!description.isValid());
+    description.setBitLength(16);
+    description.setValueType(QCanSignalDescription::Float);
+    QVERIFY(!description.isValid());
+
+    // A big endian signal starting at bit 7 of the last byte ends past the payload.
+    QCanSignalDescription motorola(QStringLiteral("Value"), 511, 16, QSysInfo::BigEndian);
+    QVERIFY(!motorola.isValid());
+    motorola.setStartBit(495);
+    QVERIFY(motorola.isValid());
+
+    QVERIFY(QCanMessageDescription(0x123, QStringLiteral("Message"), 8).isValid());
+    QVERIFY(!QCanMessageDescription(0x123, QStringLiteral("Message"), 65).isValid());
+    QCanMessageDescription standard(0x800, QStringLiteral("Message"), 8);
+    QVERIFY(standard.hasExtendedFrameFormat());
+    standard.setExtendedFrameFormat(false);
+    QVERIFY(!standard.isValid());
+}
+
+void tst_QCanSignalDecoder::extract_data()
+{
+    QTest::addColumn<QByteArray>("payload");
+    QTest::addColumn<int>("startBit");
+    QTest::addColumn<int>("bitLength");
+    QTest::addColumn<bool>("bigEndian");
+    QTest::addColumn<quint64>("expected");
+
+    const QByteArray classic = QByteArray::fromHex("1122334455667788");
+    const QByteArray fd = QByteArray::fromHex("0123456789abcdeff1e1d2c3");
+
+    QTest::newRow("intel byte") << classic << 0 << 8 << false << quint64(0x11);
+    QTest::newRow("intel unaligned") << classic << 12 << 12 << false << quint64(0x332);
+    QTest::newRow("intel last nibble") << classic << 60 << 4 << false << quint64(0x8);
+    QTest::newRow("intel 64 bit") << classic << 0 << 64 << false << quint64(0x8877665544332211);
+    QTest::newRow("intel nine bytes") << fd << 4 << 64 << false << quint64(0x1efcdab896745230);
+    QTest::newRow("motorola word") << classic << 7 << 16 << true << quint64(0x1122);
+    QTest::newRow("motorola unaligned") << classic << 7 << 12 << true << quint64(0x112);
+    QTest::newRow("motorola inner") << classic << 27 << 10 << true << quint64(0x115);
+    QTest::newRow("motorola 64 bit") << classic << 7 << 64 << true << quint64(0x1122334455667788);
+    QTest::newRow("motorola nine bytes") << fd << 3 << 64 << true << quint64(0x123456789abcdeff);
+}
+
+void tst_QCanSignalDecoder::extract()
+{
+    QFETCH(QByteArray, payload);
+    QFETCH(int, startBit);
+    QFETCH(int, bitLength);
+    QFETCH(bool, bigEndian);
+    QFETCH(quint64, expected);
+
+    // Compare the raw bits through a double signal when all 64 bits are used.
+    QCanSignalDescription description(QStringLiteral("Value"), startBit, bitLength,
+                                      bigEndian ? QSysInfo::BigEndian : QSysInfo::LittleEndian,
+                                      bitLength == 64 ? QCanSignalDescription::Double
+                                                      : QCanSignalDescription::Unsigned);
+    const QCanSignalDecoder decoder({ message(0x100, QStringLiteral("Message"),
+                                              int(payload.size()), { description }) });
+
+    double value = 0;
+    QCOMPARE(decoder.decode(QCanBusFrame(0x100, payload), &value), 1);
+    if (bitLength == 64) {
+        quint64 bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+        QCOMPARE(bits, expected);
+    } else {
+        QCOMPARE(value, double(expected));
+    }
+}
+
+void tst_QCanSignalDecoder::valueTypes()
+{
+    QCanSignalDescription negative(QStringLiteral("Negative"), 0, 4, QSysInfo::LittleEndian,
+                                   QCanSignalDescription::Signed);
+    QCanSignalDescription positive(QStringLiteral("Positive"), 4, 4, QSysInfo::LittleEndian,
+                                   QCanSignalDescription::Signed);
+    QCanSignalDescription wide(QStringLiteral("Wide"), 8, 16, QSysInfo::LittleEndian,
+                               QCanSignalDescription::Signed);
+    QCanSignalDescription single(QStringLiteral("Float"), 32, 32, QSysInfo::LittleEndian,
+                                 QCanSignalDescription::Float);
+    const QCanSignalDecoder decoder({ message(0x100, QStringLiteral("Message"), 8,
+                                              { negative, positive, wide, single }) });
+
+    // -1, 7, -2 and 1.5f
+    const QByteArray payload = QByteArray::fromHex("7ffeff000000c03f");
+    double values[4] = {};
+    QCOMPARE(decoder.decode(QCanBusFrame(0x100, payload), values), 4);
+    QCOMPARE(values[0], -1.0);
+    QCOMPARE(values[1], 7.0);
+    QCOMPARE(values[2], -2.0);
+    QCOMPARE(values[3], 1.5);
+}
+
+void tst_QCanSignalDecoder::scaling()
+{
+    QCanSignalDescription temperature(QStringLiteral("Temperature"), 0, 8);
+    temperature.setFactor(0.5);
+    temperature.setOffset(-40.0);
+    const QCanSignalDecoder decoder({ message(0x100, QStringLiteral("Message"), 1,
+                                              { temperature }) });
+
+    double value = 0;
+    QCOMPARE(decoder.decode(QCanBusFrame(0x100, QByteArray::fromHex("64")), &value), 1);
+    QCOMPARE(value, 10.0);
+}
+
+void tst_QCanSignalDecoder::multiplexing()
+{
+    QCanSignalDescription selector(QStringLiteral("Selector"), 0, 8);
+    selector.setMultiplexing(QCanSignalDescription::MultiplexorSwitch);
+    QCanSignalDescription first(QStringLiteral("First"), 8, 8);
+    first.setMultiplexing(QCanSignalDescription::MultiplexedSignal);
+    first.setMultiplexValue(1);
+    QCanSignalDescription second(QStringLiteral("Second"), 8, 16);
+    second.setMultiplexing(QCanSignalDescription::MultiplexedSignal);
+    second.setMultiplexValue(2);
+    QCanSignalDescription always(QStringLiteral("Always"), 24, 8);
+    const QCanSignalDecoder decoder({ message(0x100, QStringLiteral("Message"), 4,
+                                              { selector, first, second, always }) });
+
+    double values[4] = {};
+    QCOMPARE(decoder.decode(QCanBusFrame(0x100, QByteArray::fromHex("012a0005")), values), 4);
+    QCOMPARE(values[0], 1.0);
+    QCOMPARE(values[1], 42.0);
+    QVERIFY(std::isnan(values[2]));
+    QCOMPARE(values[3], 5.0);
+
+    QCOMPARE(decoder.decode(QCanBusFrame(0x100, QByteArray::fromHex("02340105")), values), 4);
+    QVERIFY(std::isnan(values[1]));
+    QCOMPARE(values[2], 308.0);
+}
+
+void tst_QCanSignalDecoder::shortPayload()
+{
+    const QCanSignalDecoder decoder({ message(0x100, QStringLiteral("Message"), 8, {
+        QCanSignalDescription(QStringLiteral("Low"), 0, 8),
+        QCanSignalDescription(QStringLiteral("High"), 56, 8) }) });
+
+    double values[2] = {};
+    QCOMPARE(decoder.decode(QCanBusFrame(0x100, QByteArray::fromHex("0102")), values), 2);
+    QCOMPARE(values[0], 1.0);
+    QVERIFY(std::isnan(values[1]));
+}
+
+void tst_QCanSignalDecoder::lookup()
+{
+    QCanMessageDescription extended(0x100, QStringLiteral("Extended"), 8);
+    extended.setExtendedFrameFormat(true);
+    extended.addSignalDescription(QCanSignalDescription(QStringLiteral("A"), 0, 8));
+    const QCanSignalDecoder decoder({
+        message(0x100, QStringLiteral("Standard"), 8, {
+            QCanSignalDescription(QStringLiteral("A"), 0, 8),
+            QCanSignalDescription(QStringLiteral("B"), 8, 8) }),
+        extended });
+
+    QCOMPARE(decoder.messageCount(), 2);
+    QCOMPARE(decoder.signalCount(), 3);
+    QCOMPARE(decoder.signalCount(0), 2);
+    QCOMPARE(decoder.firstSignal(1), 2);
+    QCOMPARE(decoder.messageIndex(QStringLiteral("Extended")), 1);
+    QCOMPARE(decoder.signalIndex(QStringLiteral("Standard"), QStringLiteral("B")), 1);
+    QCOMPARE(decoder.signalIndex(QStringLiteral("Extended"), QStringLiteral("A")), 2);
+    QCOMPARE(decoder.signalIndex(QStringLiteral("Extended"), QStringLiteral("B")), -1);
+    QCOMPARE(decoder.messageOfSignal(2), 1);
+    QCOMPARE(decoder.messageOfSignal(3), -1);
+
+    QCanBusFrame frame(0x100, QByteArray(8, 0));
+    QCOMPARE(decoder.messageIndex(frame), 0);
+    frame.setExtendedFrameFormat(true);
+    QCOMPARE(decoder.messageIndex(frame), 1);
+    frame.setFrameId(0x101);
+    QCOMPARE(decoder.messageIndex(frame), -1);
+    frame.setFrameType(QCanBusFrame::RemoteRequestFrame);
+    frame.setFrameId(0x100);
+    QCOMPARE(decoder.messageIndex(frame), -1);
+}
+
+void tst_QCanSignalDecoder::batch()
+{
+    QCanSignalDescription speed(QStringLiteral("Speed"), 0, 16);
+    speed.setFactor(0.1);
+    const QCanSignalDecoder decoder({
+        message(0x100, QStringLiteral("Wheels"), 2, { speed }),
+        message(0x200, QStringLiteral("Engine"), 2, {
+            QCanSignalDescription(QStringLiteral("Rpm"), 0, 16),
+            QCanSignalDescription(QStringLiteral("Load"), 16, 8) }) });
+
+    QList<QCanBusFrame> frames;
+    for (int i = 0; i < 10; ++i) {
+        QCanBusFrame wheels(0x100, QByteArray::fromHex("6400"));
+        wheels.setTimeStamp(QCanBusFrame::TimeStamp(1, i));
+        frames.append(wheels);
+        frames.append(QCanBusFrame(0x300, QByteArray::fromHex("00")));
+        if (i % 2)
+            frames.append(QCanBusFrame(0x200, QByteArray::fromHex("e80332")));
+    }
+
+    QCanSignalBatch batch(decoder, 16);
+    QCOMPARE(decoder.decode(frames, &batch), qsizetype(15));
+    QCOMPARE(batch.rowCount(0), qsizetype(10));
+    QCOMPARE(batch.rowCount(1), qsizetype(5));
+    QCOMPARE(batch.timeStamps(0)[3], qint64(1000003));
+    QCOMPARE(batch.value(0, 9), 10.0);
+    QCOMPARE(batch.value(1, 4), 1000.0);
+    QCOMPARE(batch.column(2)[0], 50.0);
+
+    // Appending scales only the new rows.
+    QCOMPARE(decoder.decode(frames.mid(0, 2), &batch), qsizetype(1));
+    QCOMPARE(batch.rowCount(0), qsizetype(11));
+    QCOMPARE(batch.value(0, 0), 10.0);
+    QCOMPARE(batch.value(0, 10), 10.0);
+
+    batch.clear();
+    QCOMPARE(batch.rowCount(0), qsizetype(0));
+    QCOMPARE(decoder.decode(frames, &batch), qsizetype(15));
+    QCOMPARE(batch.value(0, 0), 10.0);
+
+    const QCanSignalDecoder other({});
+    QCanSignalBatch foreign(other);
+    QCOMPARE(decoder.decode(frames, &foreign), qsizetype(0));
+}
+
+QTEST_MAIN(tst_QCanSignalDecoder)
+
+#include "tst_qcansignaldecoder.moc"
@@ -215,6 +215,173 @@ private slots:
         QFETCH(quint16, crc);
         QCOMPARE(QModbusSerialAdu::calculateCRC(pdu.constData(), pdu.size()), crc);
     }
+
+    void testRtuFrameAssembler_data()
+    {
+        QTest::addColumn<QByteArray>("frame");
+        QTest::addColumn<int>("chunkSize");
+
+        const QByteArray readRegisters = QByteArray::fromHex("1103006b00037687");
+        const QByteArray writeMultiple =
+            QByteArray::fromHex("0110001200081000010001000100010001000100010001d551");
+        QTest::newRow("read holding registers, at once")
+            << readRegisters << int(readRegisters.size());
+        QTest::newRow("read holding registers, bytewise") << readRegisters << 1;
+        QTest::newRow("write multiple registers, at once")
+            << writeMultiple << int(writeMultiple.size());
+        QTest::newRow("write multiple registers, bytewise") << writeMultiple << 1;
+        QTest::newRow("write multiple registers, 3 bytes") << writeMultiple << 3;
+    }
+
+    void testRtuFrameAssembler()
+    {
+        QFETCH(QByteArray, frame);
+        QFETCH(int, chunkSize);
+
+        QModbusRtuFrameAssembler<QModbusRequest> assembler;
+        for (int i = 0; i < frame.size(); i += chunkSize) {
+            QCOMPARE(assembler.state(), QModbusRtuFrameAssembler<QModbusRequest>::Incomplete);
+            const int size = qMin(chunkSize, int(frame.size()) - i);
+            QCOMPARE(assembler.append(frame.constData() + i, size), qsizetype(size));
+        }
+        QCOMPARE(assembler.state(), QModbusRtuFrameAssembler<QModbusRequest>::Complete);
+        QCOMPARE(assembler.size(), qsizetype(frame.size()));
+        QCOMPARE(assembler.rawData(), frame);
+        QVERIFY(assembler.matchingChecksum());
+
+        const QModbusSerialAdu adu(QModbusSerialAdu::Rtu, frame);
+        QCOMPARE(assembler.serverAddress(), adu.serverAddress());
+        QCOMPARE(assembler.pdu().functionCode(), adu.pdu().functionCode());
+        QCOMPARE(assembler.pdu().data(), adu.pdu().data());
+        QCOMPARE(assembler.checksum(), adu.checksum<quint16>());
+        QCOMPARE(assembler.calculatedChecksum(), adu.checksum<quint16>());
+
+        // A complete frame does not take further bytes.
+        QCOMPARE(assembler.append(frame.constData(), frame.size()), qsizetype(0));
+        assembler.reset();
+        QCOMPARE(assembler.size(), qsizetype(0));
+        QCOMPARE(assembler.state(), QModbusRtuFrameAssembler<QModbusRequest>::Incomplete);
+    }
+
+    void testRtuFrameAssemblerCorruption()
+    {
+        QModbusRtuFrameAssembler<QModbusResponse> assembler;
+
+        const QModbusResponse response(QModbusResponse::ReadHoldingRegisters,
+                                       QByteArray::fromHex("06022b00000064"));
+        const QByteArray frame = QModbusSerialAdu::create(QModbusSerialAdu::Rtu, 17, response);
+        const qsizetype frameSize = frame.size();
+
+        // The frame ends after its size, the next frame's bytes are left over.
+        const QByteArray frames = frame + QByteArray::fromHex("1103");
+        QCOMPARE(assembler.append(frames.constData(), frames.size()), frameSize);
+        QCOMPARE(assembler.state(), QModbusRtuFrameAssembler<QModbusResponse>::Complete);
+        QCOMPARE(assembler.rawData(), frame);
+        QVERIFY(assembler.matchingChecksum());
+
+        // A wrong checksum is reported, not dropped silently.
+        assembler.reset();
+        QByteArray corrupt = frame;
+        corrupt[frameSize - 1] = char(corrupt.at(frameSize - 1) ^ 0x01);
+        QCOMPARE(assembler.append(corrupt.constData(), corrupt.size()), frameSize);
+        QCOMPARE(assembler.state(), QModbusRtuFrameAssembler<QModbusResponse>::Complete);
+        QVERIFY(!assembler.matchingChecksum());
+        QCOMPARE(assembler.checksum(), QModbusSerialAdu(QModbusSerialAdu::Rtu, corrupt)
+                                           .checksum<quint16>());
+        QCOMPARE(assembler.calculatedChecksum(), QModbusSerialAdu(QModbusSerialAdu::Rtu, frame)
+                                                     .checksum<quint16>());
+
+        // Without a known size the frame overruns once it exceeds the RTU maximum.
+        assembler.reset();
+        const QByteArray garbage(QModbusRtuFrameAssembler<QModbusResponse>::MaxFrameSize + 1,
+                                 char(0x64));
+        QCOMPARE(assembler.append(garbage.constData(), garbage.size()), qsizetype(garbage.size()));
+        QCOMPARE(assembler.state(), QModbusRtuFrameAssembler<QModbusResponse>::Overrun);
+        QCOMPARE(assembler.append(garbage.constData(), 4), qsizetype(4));
+        QCOMPARE(assembler.size(), qsizetype(garbage.size() + 4));
+    }
+
+    void testAsciiFrameAssembler()
+    {
+        const QByteArray frame(":1103006B00037E\r\n");
+
+        // Garbage before the colon is skipped, bytes after the frame are left over.
+        const QByteArray input = QByteArray::fromHex("00ff") + frame + ":11";
+        QModbusAsciiFrameAssembler<QModbusRequest> assembler;
+        QCOMPARE(assembler.append(input.constData(), input.size()), qsizetype(2 + frame.size()));
+        QCOMPARE(assembler.state(), QModbusAsciiFrameAssembler<QModbusRequest>::Complete);
+        QCOMPARE(assembler.size(), qsizetype(frame.size()));
+        QVERIFY(assembler.matchingChecksum());
+        QCOMPARE(assembler.serverAddress(), 0x11);
+        QCOMPARE(assembler.checksum(), quint8(0x7e));
+        QCOMPARE(assembler.pdu().functionCode(), QModbusPdu::ReadHoldingRegisters);
+        QCOMPARE(assembler.pdu().data(), QByteArray::fromHex("006b0003"));
+
+        // Characters arriving one by one, lower case hex digits.
+        const QByteArray lower = QModbusSerialAdu::create(QModbusSerialAdu::Ascii, 0x11,
+            QModbusRequest(QModbusRequest::ReadHoldingRegisters, QByteArray::fromHex("006b0003")));
+        QCOMPARE(lower, frame.toLower());
+        assembler.reset();
+        for (const char c : lower) {
+            QCOMPARE(assembler.state(), QModbusAsciiFrameAssembler<QModbusRequest>::Incomplete);
+            QCOMPARE(assembler.append(&c, 1), qsizetype(1));
+        }
+        QCOMPARE(assembler.state(), QModbusAsciiFrameAssembler<QModbusRequest>::Complete);
+        QVERIFY(assembler.matchingChecksum());
+
+        // A colon restarts the frame.
+        assembler.reset();
+        const QByteArray restarted = ":1103" + frame;
+        QCOMPARE(assembler.append(restarted.constData(), restarted.size()),
+                 qsizetype(restarted.size()));
+        QCOMPARE(assembler.state(), QModbusAsciiFrameAssembler<QModbusRequest>::Complete);
+        QCOMPARE(assembler.size(), qsizetype(frame.size()));
+
+        // Wrong LRC.
+        assembler.reset();
+        const QByteArray corrupt(":1103006B00037F\r\n");
+        assembler.append(corrupt.constData(), corrupt.size());
+        QCOMPARE(assembler.state(), QModbusAsciiFrameAssembler<QModbusRequest>::Complete);
+        QVERIFY(!assembler.matchingChecksum());
+        QCOMPARE(assembler.calculatedChecksum(), quint8(0x7e));
+
+        // Invalid characters and odd digit counts are malformed frames.
+        assembler.reset();
+        const QByteArray invalid(":1103006G00037E\r\n");
+        QCOMPARE(assembler.append(invalid.constData(), invalid.size()), qsizetype(9));
+        QCOMPARE(assembler.state(), QModbusAsciiFrameAssembler<QModbusRequest>::Overrun);
+
+        assembler.reset();
+        const QByteArray odd(":1103006B00037\r\n");
+        assembler.append(odd.constData(), odd.size());
+        QCOMPARE(assembler.state(), QModbusAsciiFrameAssembler<QModbusRequest>::Overrun);
+
+        // The delimiter can be changed.
+        assembler.reset();
+        assembler.setDelimiter('!');
+        const QByteArray delimited(":1103006B00037E\r!");
+        QCOMPARE(assembler.append(delimited.constData(), delimited.size()),
+                 qsizetype(delimited.size()));
+        QCOMPARE(assembler.state(), QModbusAsciiFrameAssembler<QModbusRequest>::Complete);
+    }
+
+    void testRtuFrameAssemblerEcho()
+    {
+        // Diagnostics Return Query Data echoes the request, the response has no length field.
+        const QModbusRequest request(QModbusRequest::Diagnostics,
+                                     QByteArray::fromHex("0000a537b0b1"));
+        const QByteArray frame = QModbusSerialAdu::create(QModbusSerialAdu::Rtu, 1, request);
+
+        QModbusRtuFrameAssembler<QModbusResponse> assembler;
+        assembler.setEcho(1, request);
+        for (int i = 0; i < frame.size(); ++i) {
+            QCOMPARE(assembler.state(), QModbusRtuFrameAssembler<QModbusResponse>::Incomplete);
+            QCOMPARE(assembler.append(frame.constData() + i, 1), qsizetype(1));
+        }
+        QCOMPARE(assembler.state(), QModbusRtuFrameAssembler<QModbusResponse>::Complete);
+        QVERIFY(assembler.matchingChecksum());
+        QCOMPARE(assembler.pdu().data(), request.data());
+    }
 };
 
 QTEST_MAIN(tst_QModbusAdu)
@@ -47,6 +47,10 @@ private slots:
     void constructors();
     void setters();
     void testAPI();
+    void typedValues_data();
+    void typedValues();
+    void typedValuesRoundTrip();
+    void strings();
 };
 
 tst_QModbusDataUnit::tst_QModbusDataUnit()
@@ -166,6 +170,110 @@ void tst_QModbusDataUnit::testAPI()
     QCOMPARE(unit.value(0), quint16(25));
 }
 
+void tst_QModbusDataUnit::typedValues_data()
+{
+    QTest::addColumn<QModbusDataUnit::ValueOrder>("order");
+    QTest::addColumn<QList<quint16>>("floatRegisters");
+    QTest::addColumn<QList<quint16>>("uint64Registers");
+
+    // 1.0f == 0x3f800000, 0x0102030405060708
+    QTest::newRow("ABCD") << QModbusDataUnit::BigEndian
+        << QList<quint16> { 0x3f80, 0x0000 }
+        << QList<quint16> { 0x0102, 0x0304, 0x0506, 0x0708 };
+    QTest::newRow("BADC") << QModbusDataUnit::BigEndianByteSwap
+        << QList<quint16> { 0x803f, 0x0000 }
+        << QList<quint16> { 0x0201, 0x0403, 0x0605, 0x0807 };
+    QTest::newRow("CDAB") << QModbusDataUnit::LittleEndianByteSwap
+        << QList<quint16> { 0x0000, 0x3f80 }
+        << QList<quint16> { 0x0708, 0x0506, 0x0304, 0x0102 };
+    QTest::newRow("DCBA") << QModbusDataUnit::LittleEndian
+        << QList<quint16> { 0x0000, 0x803f }
+        << QList<quint16> { 0x0807, 0x0605, 0x0403, 0x0201 };
+}
+
+void tst_QModbusDataUnit::typedValues()
+{
+    QFETCH(QModbusDataUnit::ValueOrder, order);
+    QFETCH(QList<quint16>, floatRegisters);
+    QFETCH(QList<quint16>, uint64Registers);
+
+    QModbusDataUnit unit(QModbusDataUnit::HoldingRegisters, 0, floatRegisters);
+    QCOMPARE(unit.valuesAs<float>(order), QList<float> { 1.0f });
+    QCOMPARE(unit.valuesAs<quint32>(order), QList<quint32> { 0x3f800000u });
+
+    unit.setValues(uint64Registers);
+    QCOMPARE(unit.valuesAs<quint64>(order), QList<quint64> { Q_UINT64_C(0x0102030405060708) });
+
+    // Registers left over at the end are ignored.
+    unit.setValues(uint64Registers.mid(0, 3));
+    QVERIFY(unit.valuesAs<quint64>(order).isEmpty());
+
+    unit.setValuesFrom(QList<float> { 1.0f }, order);
+    QCOMPARE(unit.values(), floatRegisters);
+    QCOMPARE(unit.valueCount(), 2u);
+
+    unit.setValuesFrom(QList<quint64> { Q_UINT64_C(0x0102030405060708) }, order);
+    QCOMPARE(unit.values(), uint64Registers);
+    QCOMPARE(unit.valueCount(), 4u);
+}
+
+void tst_QModbusDataUnit::typedValuesRoundTrip()
+{
+    // Enough values to cover both the vectorized part and the tail.
+    QList<double> doubles;
+    QList<qint32> ints;
+    QList<qint16> shorts;
+    for (int i = 0; i < 37; ++i) {
+        doubles.append(i * -1.25 + 0.1);
+        ints.append(i * -65537);
+        shorts.append(qint16(i * -1021));
+    }
+
+    const QModbusDataUnit::ValueOrder orders[] = {
+        QModbusDataUnit::BigEndian, QModbusDataUnit::BigEndianByteSwap,
+        QModbusDataUnit::LittleEndianByteSwap, QModbusDataUnit::LittleEndian
+    };
+    for (const auto order : orders) {
+        QModbusDataUnit unit(QModbusDataUnit::HoldingRegisters);
+        unit.setValuesFrom(doubles, order);
+        QCOMPARE(unit.values().size(), doubles.size() * 4);
+        QCOMPARE(unit.valuesAs<double>(order), doubles);
+
+        unit.setValuesFrom(ints, order);
+        QCOMPARE(unit.valuesAs<qint32>(order), ints);
+        // The most significant register comes first for the big endian word orders.
+        const quint16 high = quint16(quint32(ints.at(5)) >> 16);
+        const quint16 low = quint16(quint32(ints.at(5)));
+        const bool swapped = (order == QModbusDataUnit::BigEndianByteSwap
+                              || order == QModbusDataUnit::LittleEndian);
+        const quint16 first = (order == QModbusDataUnit::BigEndian
+                               || order == QModbusDataUnit::BigEndianByteSwap) ? high : low;
+        QCOMPARE(unit.value(10), swapped ? qbswap(first) : first);
+
+        unit.setValuesFrom(shorts, order);
+        QCOMPARE(unit.valuesAs<qint16>(order), shorts);
+    }
+}
+
+void tst_QModbusDataUnit::strings()
+{
+    QModbusDataUnit unit(QModbusDataUnit::HoldingRegisters, 10, 0);
+
+    unit.setString(QStringLiteral("Modbus"));
+    QCOMPARE(unit.values(), QList<quint16>({ 0x4d6f, 0x6462, 0x7573 }));
+    QCOMPARE(unit.valueCount(), 3u);
+    QCOMPARE(unit.toString(), QStringLiteral("Modbus"));
+    QCOMPARE(unit.toString(QModbusDataUnit::BigEndianByteSwap), QStringLiteral("oMbdsu"));
+
+    // Odd lengths are padded, the string ends at the first NUL.
+    unit.setString(QStringLiteral("Qt5"), QModbusDataUnit::LittleEndian);
+    QCOMPARE(unit.values(), QList<quint16>({ 0x7451, 0x0035 }));
+    QCOMPARE(unit.toString(QModbusDataUnit::LittleEndian), QStringLiteral("Qt5"));
+
+    unit.setValues({ 0x4142, 0x0043, 0x4445 });
+    QCOMPARE(unit.toString(), QStringLiteral("AB"));
+}
+
 QTEST_MAIN(tst_QModbusDataUnit)
 
 #include "tst_qmodbusdataunit.moc"
@@ -68,6 +68,11 @@ private slots:
     void state();
     void error();
 
+    void statistics();
+    void latencyBuckets_data();
+    void latencyBuckets();
+    void latencyPercentile();
+
 private:
     DummyDevice *device;
 };
@@ -133,6 +138,72 @@ void tst_QModbusDevice::error()
     QCOMPARE(device->errorString(), errorString);
 }
 
+void tst_QModbusDevice::statistics()
+{
+    const QModbusDeviceStatistics total = device->statistics();
+    QCOMPARE(total.requests, quint64(0));
+    QCOMPARE(total.responses, quint64(0));
+    QCOMPARE(total.latencySamples, quint64(0));
+    QCOMPARE(total.latencyPercentile(50), qint64(0));
+
+    const QModbusDeviceStatistics single = device->statistics(QModbusPdu::ReadCoils);
+    QCOMPARE(single.bytesSent, quint64(0));
+    QCOMPARE(single.bytesReceived, quint64(0));
+
+    device->resetStatistics();
+    QCOMPARE(device->statistics().requests, quint64(0));
+}
+
+void tst_QModbusDevice::latencyBuckets_data()
+{
+    QTest::addColumn<qint64>("usecs");
+    QTest::addColumn<int>("bucket");
+
+    QTest::newRow("zero") << qint64(0) << 0;
+    QTest::newRow("linear") << qint64(15) << 15;
+    QTest::newRow("first log") << qint64(16) << 16;
+    QTest::newRow("first log, upper") << qint64(17) << 16;
+    QTest::newRow("first log, last") << qint64(31) << 23;
+    QTest::newRow("second log") << qint64(32) << 24;
+    QTest::newRow("1 ms") << qint64(1000) << 63;
+    QTest::newRow("huge") << std::numeric_limits<qint64>::max()
+                          << QModbusDeviceStatistics::LatencyBucketCount - 1;
+}
+
+void tst_QModbusDevice::latencyBuckets()
+{
+    QFETCH(qint64, usecs);
+    QFETCH(int, bucket);
+
+    QCOMPARE(QModbusDeviceStatistics::latencyBucket(usecs), bucket);
+    if (bucket < QModbusDeviceStatistics::LatencyBucketCount - 1) {
+        QVERIFY(QModbusDeviceStatistics::latencyBucketLowerBound(bucket) <= usecs);
+        QVERIFY(QModbusDeviceStatistics::latencyBucketUpperBound(bucket) >= usecs);
+    }
+
+    // Buckets are contiguous.
+    for (int i = 1; i < QModbusDeviceStatistics::LatencyBucketCount; ++i) {
+        QCOMPARE(QModbusDeviceStatistics::latencyBucketLowerBound(i),
+                 QModbusDeviceStatistics::latencyBucketUpperBound(i - 1) + 1);
+    }
+}
+
+void tst_QModbusDevice::latencyPercentile()
+{
+    QModbusDeviceStatistics statistics;
+    for (qint64 usecs : { 10, 10, 10, 10, 10, 10, 10, 10, 10, 1000 }) {
+        ++statistics.latencyHistogram[QModbusDeviceStatistics::latencyBucket(usecs)];
+        ++statistics.latencySamples;
+        statistics.latencySumUSecs += quint64(usecs);
+        statistics.latencyMaxUSecs = qMax(statistics.latencyMaxUSecs, quint64(usecs));
+    }
+
+    QCOMPARE(statistics.latencyPercentile(50), qint64(10));
+    QCOMPARE(statistics.latencyPercentile(90), qint64(10));
+    QCOMPARE(statistics.latencyPercentile(99), qint64(1000));
+    QCOMPARE(statistics.latencyPercentile(100), qint64(1000));
+}
+
 QTEST_MAIN(tst_QModbusDevice)
 
 #include "tst_qmodbusdevice.moc"
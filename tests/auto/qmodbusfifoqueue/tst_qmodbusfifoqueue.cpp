@@ -0,0 +1,167 @@
+/****************************************************************************
+**
+** Copyright (C) 2021 The Qt Company Ltd.
+** Contact: http://www.qt.io/licensing/
+**
+** This file is part of the QtSerialBus module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL3$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see http://www.qt.io/terms-conditions. For further
+** information use the contact form at http://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPLv3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or later as published by the Free
+** Software Foundation and appearing in the file LICENSE.GPL included in
+** the packaging of this file. Please review the following information to
+** ensure the GNU General Public License version 2.0 requirements will be
+** met: http://www.gnu.org/licenses/gpl-2.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include <QtTest/QtTest>
+#include <QtSerialBus/qmodbusfifoqueue.h>
+
+#include <array>
+#include <atomic>
+#include <memory>
+#include <vector>
+
+class tst_QModbusFifoQueue : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void capacity_data();
+    void capacity();
+    void pushPop();
+    void overflow();
+    void concurrentProducers();
+};
+
+void tst_QModbusFifoQueue::capacity_data()
+{
+    QTest::addColumn<qsizetype>("requested");
+    QTest::addColumn<qsizetype>("capacity");
+
+    QTest::newRow("zero") << qsizetype(0) << qsizetype(2);
+    QTest::newRow("one") << qsizetype(1) << qsizetype(2);
+    QTest::newRow("power of two") << qsizetype(32) << qsizetype(32);
+    QTest::newRow("rounded") << qsizetype(33) << qsizetype(64);
+}
+
+void tst_QModbusFifoQueue::capacity()
+{
+    QFETCH(qsizetype, requested);
+    QFETCH(qsizetype, capacity);
+
+    const QModbusFifoQueue queue(requested);
+    QCOMPARE(queue.capacity(), capacity);
+    QCOMPARE(queue.size(), qsizetype(0));
+    QVERIFY(queue.isEmpty());
+}
+
+void tst_QModbusFifoQueue::pushPop()
+{
+    QModbusFifoQueue queue(8);
+    QVERIFY(queue.push(1));
+    QCOMPARE(queue.push(QList<quint16> { 2, 3, 4 }), qsizetype(3));
+    QCOMPARE(queue.size(), qsizetype(4));
+
+    QCOMPARE(queue.pop(2), QList<quint16>({ 1, 2 }));
+    QVERIFY(queue.push(5));
+
+    quint16 values[8] = {};
+    QCOMPARE(queue.pop(values, 8), qsizetype(3));
+    QCOMPARE(values[0], quint16(3));
+    QCOMPARE(values[1], quint16(4));
+    QCOMPARE(values[2], quint16(5));
+    QVERIFY(queue.isEmpty());
+    QCOMPARE(queue.pop(4), QList<quint16>());
+
+    // Wrap around the ring a few times.
+    for (quint16 i = 0; i < 100; ++i) {
+        QVERIFY(queue.push(i));
+        QCOMPARE(queue.pop(1), QList<quint16>({ i }));
+    }
+}
+
+void tst_QModbusFifoQueue::overflow()
+{
+    QModbusFifoQueue queue(4);
+    QCOMPARE(queue.push(QList<quint16> { 1, 2, 3 }), qsizetype(3));
+    QCOMPARE(queue.push(QList<quint16> { 4, 5, 6 }), qsizetype(1));
+    QVERIFY(!queue.push(7));
+    QCOMPARE(queue.overflowCount(), quint64(3));
+
+    // Dropped values are the newest ones, the queue keeps the oldest.
+    QCOMPARE(queue.pop(31), QList<quint16>({ 1, 2, 3, 4 }));
+
+    queue.resetOverflowCount();
+    QCOMPARE(queue.overflowCount(), quint64(0));
+}
+
+void tst_QModbusFifoQueue::concurrentProducers()
+{
+    constexpr int producerCount = 4;
+    constexpr int valuesPerProducer = 10000;
+
+    QModbusFifoQueue queue(64);
+    // Set when the consumer gives up, so that producers blocked on a full queue finish.
+    std::atomic<bool> stop { false };
+    std::vector<std::unique_ptr<QThread>> producers;
+    for (int producer = 0; producer < producerCount; ++producer) {
+        producers.emplace_back(QThread::create([&queue, &stop, producer]() {
+            for (int i = 0; i < valuesPerProducer; ++i) {
+                while (!queue.push(quint16(producer << 14 | i))) {
+                    if (stop.load(std::memory_order_relaxed))
+                        return;
+                    QThread::yieldCurrentThread();
+                }
+            }
+        }));
+        producers.back()->start();
+    }
+
+    // Every producer's values must arrive completely and in order.
+    std::array<int, producerCount> next = {};
+    int received = 0;
+    bool inOrder = true;
+    QDeadlineTimer deadline(30000);
+    while (received < producerCount * valuesPerProducer && !deadline.hasExpired()) {
+        const QList<quint16> values = queue.pop(31);
+        if (values.isEmpty())
+            QThread::yieldCurrentThread();
+        for (quint16 value : values) {
+            const int producer = value >> 14;
+            inOrder &= int(value & 0x3fff) == next[producer];
+            ++next[producer];
+            ++received;
+        }
+    }
+
+    stop.store(true, std::memory_order_relaxed);
+    for (auto &producer : producers)
+        QVERIFY(producer->wait());
+    QVERIFY(inOrder);
+    QCOMPARE(received, producerCount * valuesPerProducer);
+}
+
+QTEST_MAIN(tst_QModbusFifoQueue)
+
+#include "tst_qmodbusfifoqueue.moc"
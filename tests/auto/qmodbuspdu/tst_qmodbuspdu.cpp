@@ -243,6 +243,21 @@ private slots:
         QCOMPARE(bytes, quint8(2));
         QCOMPARE(firstByte, quint8(0xcd));
         QCOMPARE(secondByte, quint8(0x01));
+
+        // reading past the end yields zero
+        address = 0xffff, quantity = 0xffff;
+        readCoils.decodeData(&address, &quantity, &bytes);
+        QCOMPARE(address, quint16(0x0c));
+        QCOMPARE(quantity, quint16(0x0a));
+        QCOMPARE(bytes, quint8(0x00));
+
+        const QModbusResponse registers(QModbusResponse::ReadHoldingRegisters, quint8(0x06),
+            QList<quint16>({ 0x1234, 0xabcd, 0x0001 }));
+        QCOMPARE(registers.data().toHex(), QByteArray("061234abcd0001"));
+        registers.decodeData(&bytes, &address, &quantity);
+        QCOMPARE(bytes, quint8(0x06));
+        QCOMPARE(address, quint16(0x1234));
+        QCOMPARE(quantity, quint16(0xabcd));
     }
 
     void testQModbusExceptionResponsePdu()
@@ -0,0 +1,340 @@
+/****************************************************************************
+**
+** Copyright (C) 2021 The Qt Company Ltd.
+** Contact: http://www.qt.io/licensing/
+**
+** This file is part of the QtSerialBus module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL3$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see http://www.qt.io/terms-conditions. For further
+** information use the contact form at http://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPLv3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or later as published by the Free
+** Software Foundation and appearing in the file LICENSE.GPL included in
+** the packaging of this file. Please review the following information to
+** ensure the GNU General Public License version 2.0 requirements will be
+** met: http://www.gnu.org/licenses/gpl-2.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include <QtTest/QtTest>
+#include <QtSerialBus/qmodbusregisterstore.h>
+
+#include <atomic>
+
+class tst_QModbusRegisterStore : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void construction();
+    void readWrite();
+    void ranges_data();
+    void ranges();
+    void consistentSnapshots();
+    void persistence();
+    void persistenceLayoutMismatch();
+    void persistenceKeepsLiveValues();
+    void persistenceRestoresTornTable();
+    void persistenceRestoresAfterSystemCrash();
+
+private:
+    static QModbusDataUnitMap map()
+    {
+        QModbusDataUnitMap map;
+        map.insert(QModbusDataUnit::Coils, { QModbusDataUnit::Coils, 0, 10 });
+        map.insert(QModbusDataUnit::HoldingRegisters,
+                   { QModbusDataUnit::HoldingRegisters, 100, QList<quint16> { 1, 2, 3, 4 } });
+        return map;
+    }
+};
+
+void tst_QModbusRegisterStore::construction()
+{
+    const QModbusRegisterStore store(map());
+    QVERIFY(store.contains(QModbusDataUnit::Coils));
+    QVERIFY(store.contains(QModbusDataUnit::HoldingRegisters));
+    QVERIFY(!store.contains(QModbusDataUnit::InputRegisters));
+    QVERIFY(!store.contains(QModbusDataUnit::Invalid));
+
+    // A negative start address returns the entire table.
+    QModbusDataUnit unit(QModbusDataUnit::HoldingRegisters, -1, 0);
+    QVERIFY(store.data(&unit));
+    QCOMPARE(unit.startAddress(), 100);
+    QCOMPARE(unit.values(), QList<quint16>({ 1, 2, 3, 4 }));
+
+    QModbusDataUnit coils(QModbusDataUnit::Coils, -1, 0);
+    QVERIFY(store.data(&coils));
+    QCOMPARE(coils.valueCount(), 10u);
+    QCOMPARE(coils.values(), QList<quint16>(10, 0));
+
+    QVERIFY(!store.data(nullptr));
+}
+
+void tst_QModbusRegisterStore::readWrite()
+{
+    QModbusRegisterStore store(map());
+
+    QVERIFY(store.setData(QModbusDataUnit::HoldingRegisters, 101, 0xabcd));
+    quint16 value = 0;
+    QVERIFY(store.data(QModbusDataUnit::HoldingRegisters, 101, &value));
+    QCOMPARE(value, quint16(0xabcd));
+    QVERIFY(!store.data(QModbusDataUnit::HoldingRegisters, 101, nullptr));
+
+    QVERIFY(store.setData({ QModbusDataUnit::HoldingRegisters, 102, QList<quint16> { 7, 8 } }));
+    QModbusDataUnit unit(QModbusDataUnit::HoldingRegisters, 101, 3);
+    QVERIFY(store.data(&unit));
+    QCOMPARE(unit.values(), QList<quint16>({ 0xabcd, 7, 8 }));
+
+    QVERIFY(!store.setData(QModbusDataUnit::InputRegisters, 0, 1));
+}
+
+void tst_QModbusRegisterStore::ranges_data()
+{
+    QTest::addColumn<int>("address");
+    QTest::addColumn<int>("count");
+    QTest::addColumn<bool>("valid");
+
+    QTest::newRow("all") << 100 << 4 << true;
+    QTest::newRow("last") << 103 << 1 << true;
+    QTest::newRow("before start") << 99 << 2 << false;
+    QTest::newRow("beyond end") << 102 << 3 << false;
+    QTest::newRow("after end") << 104 << 1 << false;
+    QTest::newRow("empty") << 100 << 0 << false;
+}
+
+void tst_QModbusRegisterStore::ranges()
+{
+    QFETCH(int, address);
+    QFETCH(int, count);
+    QFETCH(bool, valid);
+
+    QModbusRegisterStore store(map());
+    QModbusDataUnit unit(QModbusDataUnit::HoldingRegisters, address, quint16(count));
+    QCOMPARE(store.data(&unit), valid);
+    QCOMPARE(store.setData(unit), valid);
+}
+
+void tst_QModbusRegisterStore::consistentSnapshots()
+{
+    QModbusDataUnitMap layout;
+    layout.insert(QModbusDataUnit::HoldingRegisters, { QModbusDataUnit::HoldingRegisters, 0, 64 });
+    QModbusRegisterStore store(layout);
+
+    // The writer always stores the same counter in every register, a reader must
+    // never see two different values within one snapshot.
+    std::atomic<bool> stop { false };
+    QScopedPointer<QThread> writer(QThread::create([&store, &stop]() {
+        QModbusDataUnit unit(QModbusDataUnit::HoldingRegisters, 0, 64);
+        for (quint16 counter = 0; !stop.load(); ++counter) {
+            unit.setValues(QList<quint16>(64, counter));
+            store.setData(unit);
+        }
+    }));
+    writer->start();
+
+    int torn = 0;
+    for (int i = 0; i < 20000; ++i) {
+        QModbusDataUnit unit(QModbusDataUnit::HoldingRegisters, 0, 64);
+        QVERIFY(store.data(&unit));
+        const QList<quint16> values = unit.values();
+        if (values.count(values.first()) != values.size())
+            ++torn;
+    }
+
+    stop = true;
+    QVERIFY(writer->wait());
+    QCOMPARE(torn, 0);
+}
+
+void tst_QModbusRegisterStore::persistence()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString fileName = dir.filePath(QStringLiteral("registers.bin"));
+
+    {
+        QModbusRegisterStore store(map(), fileName);
+        QVERIFY2(store.isPersistent(), qPrintable(store.errorString()));
+        QCOMPARE(store.fileName(), fileName);
+        QVERIFY(store.errorString().isEmpty());
+
+        // A new file starts with the values of the map.
+        quint16 value = 0;
+        QVERIFY(store.data(QModbusDataUnit::HoldingRegisters, 102, &value));
+        QCOMPARE(value, quint16(3));
+
+        QVERIFY(store.setData(QModbusDataUnit::HoldingRegisters, 102, 0x1234));
+        QVERIFY(store.setData(QModbusDataUnit::Coils, 9, 1));
+        QVERIFY(store.checkpoint());
+    }
+
+    // An existing file keeps its values, the values of the map are ignored.
+    QModbusRegisterStore store(map(), fileName);
+    QVERIFY(store.isPersistent());
+    QModbusDataUnit unit(QModbusDataUnit::HoldingRegisters, -1, 0);
+    QVERIFY(store.data(&unit));
+    QCOMPARE(unit.values(), QList<quint16>({ 1, 2, 0x1234, 4 }));
+    quint16 coil = 0;
+    QVERIFY(store.data(QModbusDataUnit::Coils, 9, &coil));
+    QCOMPARE(coil, quint16(1));
+
+    QModbusRegisterStore memoryOnly(map());
+    QVERIFY(!memoryOnly.isPersistent());
+    QVERIFY(!memoryOnly.checkpoint());
+}
+
+void tst_QModbusRegisterStore::persistenceLayoutMismatch()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString fileName = dir.filePath(QStringLiteral("registers.bin"));
+    {
+        QModbusRegisterStore store(map(), fileName);
+        QVERIFY(store.isPersistent());
+    }
+
+    QModbusDataUnitMap other = map();
+    other.insert(QModbusDataUnit::HoldingRegisters, { QModbusDataUnit::HoldingRegisters, 200, 4 });
+    QTest::ignoreMessage(QtWarningMsg, QRegularExpression("Cannot use .* for persistence"));
+    QModbusRegisterStore store(other, fileName);
+    QVERIFY(!store.isPersistent());
+    QVERIFY(!store.errorString().isEmpty());
+
+    // The store still works from memory.
+    QVERIFY(store.setData(QModbusDataUnit::HoldingRegisters, 200, 5));
+    quint16 value = 0;
+    QVERIFY(store.data(QModbusDataUnit::HoldingRegisters, 200, &value));
+    QCOMPARE(value, quint16(5));
+}
+
+void tst_QModbusRegisterStore::persistenceKeepsLiveValues()
+{
+    if (QSysInfo::bootUniqueId().isEmpty())
+        QSKIP("Without a boot identifier every unclean shutdown restores the checkpoint.");
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString fileName = dir.filePath(QStringLiteral("registers.bin"));
+    const QString crashedFileName = dir.filePath(QStringLiteral("crashed.bin"));
+    {
+        QModbusRegisterStore store(map(), fileName);
+        QVERIFY(store.isPersistent());
+        QVERIFY(store.setData(QModbusDataUnit::HoldingRegisters, 100, 10));
+        QVERIFY(store.checkpoint());
+        QVERIFY(store.setData(QModbusDataUnit::HoldingRegisters, 100, 11));
+        QVERIFY(store.checkpoint());
+        QVERIFY(store.setData(QModbusDataUnit::HoldingRegisters, 100, 12));
+
+        // A copy taken while the store is open looks like the file of a crashed process.
+        QVERIFY(QFile::copy(fileName, crashedFileName));
+    }
+
+    // No write was in progress, so the values written after the last checkpoint survive.
+    QModbusRegisterStore store(map(), crashedFileName);
+    QVERIFY(store.isPersistent());
+    quint16 value = 0;
+    QVERIFY(store.data(QModbusDataUnit::HoldingRegisters, 100, &value));
+    QCOMPARE(value, quint16(12));
+}
+
+void tst_QModbusRegisterStore::persistenceRestoresTornTable()
+{
+    if (QSysInfo::bootUniqueId().isEmpty())
+        QSKIP("Without a boot identifier every unclean shutdown restores the checkpoint.");
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString fileName = dir.filePath(QStringLiteral("registers.bin"));
+    const QString crashedFileName = dir.filePath(QStringLiteral("crashed.bin"));
+    {
+        QModbusRegisterStore store(map(), fileName);
+        QVERIFY(store.isPersistent());
+        QVERIFY(store.setData(QModbusDataUnit::HoldingRegisters, 100, 11));
+        QVERIFY(store.checkpoint());
+        QVERIFY(store.setData(QModbusDataUnit::HoldingRegisters, 100, 12));
+        QVERIFY(store.setData(QModbusDataUnit::Coils, 0, 1));
+        QVERIFY(QFile::copy(fileName, crashedFileName));
+    }
+
+    // Set the write marker of the holding registers, as if the process died in the
+    // middle of a write. The markers follow magic, version, clean shutdown flag,
+    // reserved word, start addresses and value counts in the file header.
+    {
+        QFile file(crashedFileName);
+        QVERIFY(file.open(QIODevice::ReadWrite));
+        const quint32 writing = 1;
+        QVERIFY(file.seek(qint64(sizeof(quint32)) * (4 + 4 + 4
+                                                      + QModbusDataUnit::HoldingRegisters - 1)));
+        QCOMPARE(file.write(reinterpret_cast<const char *>(&writing), sizeof(writing)),
+                 qint64(sizeof(writing)));
+    }
+
+    QTest::ignoreMessage(QtWarningMsg, QRegularExpression("was not closed cleanly during a write"));
+    QModbusRegisterStore store(map(), crashedFileName);
+    QVERIFY(store.isPersistent());
+    quint16 value = 0;
+    QVERIFY(store.data(QModbusDataUnit::HoldingRegisters, 100, &value));
+    QCOMPARE(value, quint16(11));
+    // Tables without a torn write keep their live values.
+    QVERIFY(store.data(QModbusDataUnit::Coils, 0, &value));
+    QCOMPARE(value, quint16(1));
+}
+
+void tst_QModbusRegisterStore::persistenceRestoresAfterSystemCrash()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString fileName = dir.filePath(QStringLiteral("registers.bin"));
+    const QString crashedFileName = dir.filePath(QStringLiteral("crashed.bin"));
+    {
+        QModbusRegisterStore store(map(), fileName);
+        QVERIFY(store.isPersistent());
+        QVERIFY(store.setData(QModbusDataUnit::HoldingRegisters, 100, 11));
+        QVERIFY(store.checkpoint());
+        QVERIFY(store.setData(QModbusDataUnit::HoldingRegisters, 100, 12));
+        QVERIFY(store.setData(QModbusDataUnit::Coils, 0, 1));
+        QVERIFY(QFile::copy(fileName, crashedFileName));
+    }
+
+    // Replace the boot identifier, as if the system restarted while the file was open.
+    // It follows the write markers, the last of the 16 words of the file header.
+    {
+        QFile file(crashedFileName);
+        QVERIFY(file.open(QIODevice::ReadWrite));
+        const QByteArray otherBoot("00000000-0000-0000-0000-000000000000", 40);
+        QVERIFY(file.seek(qint64(sizeof(quint32)) * 16));
+        QCOMPARE(file.write(otherBoot), qint64(otherBoot.size()));
+    }
+
+    // The values written after the checkpoint may not have reached the disk, so every
+    // table restarts from the checkpoint.
+    QTest::ignoreMessage(QtWarningMsg, QRegularExpression("before the system restarted, table 2"));
+    QTest::ignoreMessage(QtWarningMsg, QRegularExpression("before the system restarted, table 4"));
+    QModbusRegisterStore store(map(), crashedFileName);
+    QVERIFY(store.isPersistent());
+    quint16 value = 0;
+    QVERIFY(store.data(QModbusDataUnit::HoldingRegisters, 100, &value));
+    QCOMPARE(value, quint16(11));
+    QVERIFY(store.data(QModbusDataUnit::Coils, 0, &value));
+    QCOMPARE(value, quint16(0));
+}
+
+QTEST_MAIN(tst_QModbusRegisterStore)
+
+#include "tst_qmodbusregisterstore.moc"
@@ -35,9 +35,15 @@
 ****************************************************************************/
 
 #include <QtSerialBus/qmodbusrtuserialmaster.h>
+#include <QtSerialBus/qmodbusrtuserialslave.h>
 
+#include <QtSerialPort/qserialport.h>
 #include <QtTest/QtTest>
 
+#ifdef Q_OS_UNIX
+#include "../../shared/ptybridge.h"
+#endif
+
 class tst_QModbusRtuSerialMaster : public QObject
 {
     Q_OBJECT
@@ -54,6 +60,167 @@ private slots:
         qmrsm.setInterFrameDelay(-1);
         QCOMPARE(qmrsm.interFrameDelay(), 2000);
     }
+
+    void asciiRoundTrip()
+    {
+#ifdef Q_OS_UNIX
+        PtyBridge bridge;
+        if (!bridge.open())
+            QSKIP("Cannot allocate pseudo-terminals.");
+
+        const auto configure = [&bridge](QModbusDevice *device, int port) {
+            device->setConnectionParameter(QModbusDevice::SerialPortNameParameter,
+                                           bridge.portName(port));
+            device->setConnectionParameter(QModbusDevice::SerialBaudRateParameter, 115200);
+            device->setConnectionParameter(QModbusDevice::SerialTransmissionModeParameter,
+                                           QModbusDevice::AsciiTransmissionMode);
+        };
+
+        QModbusRtuSerialSlave slave;
+        slave.setServerAddress(1);
+        QModbusDataUnitMap map;
+        map.insert(QModbusDataUnit::HoldingRegisters,
+                   { QModbusDataUnit::HoldingRegisters, 0, QList<quint16> { 1, 2, 3, 4 } });
+        QVERIFY(slave.setMap(map));
+        configure(&slave, 0);
+        QVERIFY(slave.connectDevice());
+
+        QModbusRtuSerialMaster master;
+        master.setTimeout(1000);
+        master.setNumberOfRetries(0);
+        configure(&master, 1);
+        QVERIFY(master.connectDevice());
+        QTRY_COMPARE(master.state(), QModbusDevice::ConnectedState);
+        bridge.start();
+
+        // Both sides frame their traffic in ASCII, so each reply only succeeds if the
+        // request and the response were encoded and decoded in that mode.
+        QScopedPointer<QModbusReply> reply(master.sendWriteRequest(
+            { QModbusDataUnit::HoldingRegisters, 1, QList<quint16> { 0x1234, 0xabcd } }, 1));
+        QVERIFY(reply);
+        QTRY_VERIFY_WITH_TIMEOUT(reply->isFinished(), 5000);
+        QCOMPARE(reply->error(), QModbusDevice::NoError);
+
+        reply.reset(master.sendReadRequest({ QModbusDataUnit::HoldingRegisters, 0, 4 }, 1));
+        QVERIFY(reply);
+        QTRY_VERIFY_WITH_TIMEOUT(reply->isFinished(), 5000);
+        QCOMPARE(reply->error(), QModbusDevice::NoError);
+        QCOMPARE(reply->result().values(), QList<quint16>({ 1, 0x1234, 0xabcd, 4 }));
+
+        master.disconnectDevice();
+        slave.disconnectDevice();
+#else
+        QSKIP("Pseudo-terminals are only available on Unix.");
+#endif
+    }
+
+    void earlyEndOfFrame()
+    {
+#ifdef Q_OS_UNIX
+        PtyBridge bridge;
+        QSerialPort peer;
+        QModbusRtuSerialMaster master;
+        if (!bridge.open())
+            QSKIP("Cannot allocate pseudo-terminals.");
+        QVERIFY(connectToPeer(&bridge, &master, &peer));
+        // The pseudo-terminal may deliver a request in several parts.
+        QByteArray received;
+
+        // The response is handled as soon as its last byte arrived, long before the response
+        // timeout. Trailing bytes in the same read are dropped before the next request.
+        QScopedPointer<QModbusReply> reply(master.sendReadRequest(
+            { QModbusDataUnit::HoldingRegisters, 0, 2 }, 1));
+        QVERIFY(reply);
+        QTRY_COMPARE((received += peer.readAll()), QByteArray::fromHex("010300000002c40b"));
+        received.clear();
+        QElapsedTimer timer;
+        timer.start();
+        peer.write(QByteArray::fromHex("010304000100022a32" "ffff"));
+        QTRY_VERIFY_WITH_TIMEOUT(reply->isFinished(), 2000);
+        QVERIFY(timer.elapsed() < master.timeout());
+        QCOMPARE(reply->error(), QModbusDevice::NoError);
+        QCOMPARE(reply->result().values(), QList<quint16>({ 1, 2 }));
+
+        reply.reset(master.sendReadRequest({ QModbusDataUnit::HoldingRegisters, 0, 2 }, 1));
+        QVERIFY(reply);
+        QTRY_COMPARE((received += peer.readAll()), QByteArray::fromHex("010300000002c40b"));
+        received.clear();
+        peer.write(QByteArray::fromHex("010304000100022a32"));
+        QTRY_VERIFY_WITH_TIMEOUT(reply->isFinished(), 2000);
+        QCOMPARE(reply->error(), QModbusDevice::NoError);
+#else
+        QSKIP("Pseudo-terminals are only available on Unix.");
+#endif
+    }
+
+    void echoSizing()
+    {
+#ifdef Q_OS_UNIX
+        PtyBridge bridge;
+        QSerialPort peer;
+        QModbusRtuSerialMaster master;
+        if (!bridge.open())
+            QSKIP("Cannot allocate pseudo-terminals.");
+        QVERIFY(connectToPeer(&bridge, &master, &peer));
+        // The pseudo-terminal may deliver a request in several parts.
+        QByteArray received;
+
+        // Diagnostics Return Query Data has no length field, the response is sized from
+        // the request it echoes and completes without waiting for the timeout.
+        const QModbusRequest request(QModbusRequest::Diagnostics,
+                                     QByteArray::fromHex("0000a537"));
+        QScopedPointer<QModbusReply> reply(master.sendRawRequest(request, 1));
+        QVERIFY(reply);
+        QTRY_COMPARE((received += peer.readAll()), QByteArray::fromHex("01080000a537da8d"));
+        received.clear();
+        peer.write(QByteArray::fromHex("01080000a537da8d"));
+        QTRY_VERIFY_WITH_TIMEOUT(reply->isFinished(), 2000);
+        QCOMPARE(reply->error(), QModbusDevice::NoError);
+        QCOMPARE(reply->rawResult().data(), request.data());
+
+        // An echo with different data is reported as a mismatch, the request times out.
+        master.setTimeout(200);
+        reply.reset(master.sendRawRequest(request, 1));
+        QVERIFY(reply);
+        QTRY_COMPARE((received += peer.readAll()), QByteArray::fromHex("01080000a537da8d"));
+        received.clear();
+        peer.write(QByteArray::fromHex("01080000a5389a89"));
+        QTRY_VERIFY_WITH_TIMEOUT(reply->isFinished(), 2000);
+        QCOMPARE(reply->error(), QModbusDevice::TimeoutError);
+        QVERIFY(reply->intermediateErrors().contains(QModbusDevice::ResponseRequestMismatch));
+#else
+        QSKIP("Pseudo-terminals are only available on Unix.");
+#endif
+    }
+
+private:
+#ifdef Q_OS_UNIX
+    // Connects the master to one end of the bridge and opens the other end as \a peer,
+    // which the test drives in place of a slave.
+    static bool connectToPeer(PtyBridge *bridge, QModbusRtuSerialMaster *master,
+                              QSerialPort *peer)
+    {
+        peer->setPortName(bridge->portName(0));
+        peer->setBaudRate(QSerialPort::Baud115200);
+        if (!peer->open(QIODevice::ReadWrite))
+            return false;
+
+        master->setTimeout(1000);
+        master->setNumberOfRetries(0);
+        master->setConnectionParameter(QModbusDevice::SerialPortNameParameter,
+                                       bridge->portName(1));
+        master->setConnectionParameter(QModbusDevice::SerialBaudRateParameter,
+                                       QSerialPort::Baud115200);
+        if (!master->connectDevice())
+            return false;
+        if (!QTest::qWaitFor([master]() {
+                return master->state() == QModbusDevice::ConnectedState; })) {
+            return false;
+        }
+        bridge->start();
+        return true;
+    }
+#endif
 };
 
 QTEST_MAIN(tst_QModbusRtuSerialMaster)
@@ -40,6 +40,8 @@
 #endif
 #include <QtSerialBus/qmodbustcpserver.h>
 #include <QtSerialBus/qmodbusdeviceidentification.h>
+#include <QtSerialBus/qmodbusfifoqueue.h>
+#include <QtSerialBus/qmodbusregisterstore.h>
 
 #include <QtCore/qdebug.h>
 #include <QtTest/QtTest>
@@ -868,6 +870,129 @@ private slots:
         QCOMPARE(response.data(), QByteArray::fromHex("02"));
     }
 
+    void testProcessReadFifoQueueFromQueue()
+    {
+        QModbusFifoQueue queue(64);
+        for (quint16 i = 0; i < 40; ++i)
+            QVERIFY(queue.push(i));
+        server.setFifoQueue(0x04de, &queue);
+        QCOMPARE(server.fifoQueue(0x04de), &queue);
+
+        // At most 31 values per response, the remaining values stay queued.
+        QModbusRequest request(QModbusRequest::ReadFifoQueue, QByteArray::fromHex("04de"));
+        QModbusResponse response = server.processRequest(request);
+        QCOMPARE(response.isException(), false);
+        quint16 byteCount = 0, fifoCount = 0;
+        response.decodeData(&byteCount, &fifoCount);
+        QCOMPARE(byteCount, quint16(64));
+        QCOMPARE(fifoCount, quint16(31));
+        QCOMPARE(response.data().mid(4, 4), QByteArray::fromHex("00000001"));
+        QCOMPARE(queue.size(), qsizetype(9));
+
+        response = server.processRequest(request);
+        QCOMPARE(response.data().left(6), QByteArray::fromHex("00140009001f"));
+
+        // An empty queue answers with an empty FIFO.
+        response = server.processRequest(request);
+        QCOMPARE(response.data(), QByteArray::fromHex("00020000"));
+
+        server.setFifoQueue(0x04de, nullptr);
+        QCOMPARE(server.fifoQueue(0x04de), nullptr);
+    }
+
+    void tst_registerStore()
+    {
+        TestServer local;
+        local.setMap({ { QModbusDataUnit::HoldingRegisters,
+                         { QModbusDataUnit::HoldingRegisters, 0, 4 } } });
+        QModbusRegisterStore store({ { QModbusDataUnit::HoldingRegisters,
+            { QModbusDataUnit::HoldingRegisters, 0, QList<quint16> { 1, 2, 3, 4 } } } });
+        QVERIFY(!local.registerStore());
+        local.setRegisterStore(&store);
+        QCOMPARE(local.registerStore(), &store);
+        QSignalSpy spy(&local, &QModbusServer::dataWritten);
+
+        // Requests are answered from the store.
+        const QModbusRequest read(QModbusRequest::ReadHoldingRegisters,
+                                  QByteArray::fromHex("00000002"));
+        QModbusResponse response = local.processRequest(read);
+        QCOMPARE(response.isException(), false);
+        QCOMPARE(response.data(), QByteArray::fromHex("0400010002"));
+
+        // Only a client write that changes values is reported.
+        response = local.processRequest(QModbusRequest(QModbusRequest::WriteSingleRegister,
+                                                       QByteArray::fromHex("00010002")));
+        QCOMPARE(response.isException(), false);
+        QCOMPARE(spy.count(), 0);
+        response = local.processRequest(QModbusRequest(QModbusRequest::WriteSingleRegister,
+                                                       QByteArray::fromHex("00010009")));
+        QCOMPARE(response.isException(), false);
+        QCOMPARE(spy.count(), 1);
+        QCOMPARE(spy.at(0).at(1).toInt(), 1);
+        QCOMPARE(spy.at(0).at(2).toInt(), 1);
+        quint16 value = 0;
+        QVERIFY(store.data(QModbusDataUnit::HoldingRegisters, 1, &value));
+        QCOMPARE(value, quint16(9));
+
+        // Writes made directly to the store are not reported.
+        QVERIFY(store.setData(QModbusDataUnit::HoldingRegisters, 0, 7));
+        QCOMPARE(spy.count(), 1);
+        response = local.processRequest(read);
+        QCOMPARE(response.data(), QByteArray::fromHex("0400070009"));
+
+        // Without the store, the server uses its register map again.
+        local.setRegisterStore(nullptr);
+        QVERIFY(!local.registerStore());
+        response = local.processRequest(read);
+        QCOMPARE(response.data(), QByteArray::fromHex("0400000000"));
+    }
+
+    void tst_persistentMap()
+    {
+        QTemporaryDir dir;
+        QVERIFY(dir.isValid());
+        const QString fileName = dir.filePath(QStringLiteral("registers.bin"));
+        const QModbusDataUnitMap map { { QModbusDataUnit::HoldingRegisters,
+            { QModbusDataUnit::HoldingRegisters, 0, QList<quint16> { 1, 2, 3, 4 } } } };
+        quint16 value = 0;
+        {
+            TestServer local;
+            QVERIFY(local.setMap(map, fileName));
+            QVERIFY(local.registerStore());
+            QVERIFY(local.registerStore()->isPersistent());
+            QVERIFY(local.setData(QModbusDataUnit::HoldingRegisters, 3, 0x1234));
+        }
+
+        // A restarted server continues with the values of the file.
+        {
+            TestServer local;
+            QVERIFY(local.setMap(map, fileName));
+            QVERIFY(local.data(QModbusDataUnit::HoldingRegisters, 3, &value));
+            QCOMPARE(value, quint16(0x1234));
+            QVERIFY(local.data(QModbusDataUnit::HoldingRegisters, 0, &value));
+            QCOMPARE(value, quint16(1));
+
+            // Setting a map without a file releases the file.
+            QVERIFY(local.setMap(map));
+            QVERIFY(!local.registerStore());
+            QVERIFY(local.data(QModbusDataUnit::HoldingRegisters, 3, &value));
+            QCOMPARE(value, quint16(4));
+        }
+
+        // A file that cannot be created falls back to an in-memory store.
+        TestServer local;
+        QTest::ignoreMessage(QtWarningMsg, QRegularExpression("Cannot use .* for persistence"));
+        QVERIFY(!local.setMap(map, dir.filePath(QStringLiteral("missing/registers.bin"))));
+        QVERIFY(local.registerStore());
+        QVERIFY(!local.registerStore()->isPersistent());
+        QVERIFY(!local.registerStore()->errorString().isEmpty());
+        QVERIFY(local.data(QModbusDataUnit::HoldingRegisters, 3, &value));
+        QCOMPARE(value, quint16(4));
+        QVERIFY(local.setData(QModbusDataUnit::HoldingRegisters, 3, 5));
+        QVERIFY(local.data(QModbusDataUnit::HoldingRegisters, 3, &value));
+        QCOMPARE(value, quint16(5));
+    }
+
     void tst_dataCalls_data()
     {
         QTest::addColumn<QModbusDataUnit::RegisterType>("registerType");
@@ -1115,6 +1240,76 @@ private slots:
         QCOMPARE(data, 0);
     }
 
+    void tst_batchedDataWritten()
+    {
+        TestServer local;
+        local.setMap({ { QModbusDataUnit::HoldingRegisters,
+                         { QModbusDataUnit::HoldingRegisters, 0, MAP_RANGE } } });
+        QSignalSpy spy(&local, &QModbusServer::dataWritten);
+
+        local.beginUpdate();
+        for (quint16 i = 10; i < 20; ++i)
+            QVERIFY(local.setData(QModbusDataUnit::HoldingRegisters, i, quint16(i + 1)));
+        QVERIFY(local.setData(QModbusDataUnit::HoldingRegisters, 5, 0x1234));
+        QVERIFY(local.setData(QModbusDataUnit::HoldingRegisters, 6, 0x1234));
+        local.beginUpdate(); // nested
+        QVERIFY(local.setData(QModbusDataUnit::HoldingRegisters, 30, 0x1234));
+        local.endUpdate();
+        QVERIFY(local.setData(QModbusDataUnit::HoldingRegisters, 7, 0x1234));
+        QCOMPARE(spy.count(), 0);
+        local.endUpdate();
+
+        QCOMPARE(spy.count(), 3);
+        QCOMPARE(spy.at(0).at(1).toInt(), 5);
+        QCOMPARE(spy.at(0).at(2).toInt(), 3);
+        QCOMPARE(spy.at(1).at(1).toInt(), 10);
+        QCOMPARE(spy.at(1).at(2).toInt(), 10);
+        QCOMPARE(spy.at(2).at(1).toInt(), 30);
+        QCOMPARE(spy.at(2).at(2).toInt(), 1);
+
+        // unchanged values are not reported
+        spy.clear();
+        local.beginUpdate();
+        QVERIFY(local.setData(QModbusDataUnit::HoldingRegisters, 30, 0x1234));
+        local.endUpdate();
+        QCOMPARE(spy.count(), 0);
+    }
+
+    void tst_coalescedDataWritten()
+    {
+        TestServer local;
+        local.setMap({ { QModbusDataUnit::Coils, { QModbusDataUnit::Coils, 0, MAP_RANGE } },
+            { QModbusDataUnit::HoldingRegisters, { QModbusDataUnit::HoldingRegisters, 0, MAP_RANGE } } });
+        QCOMPARE(local.notificationMode(), QModbusServer::ImmediateNotification);
+        local.setNotificationMode(QModbusServer::CoalescedNotification);
+        QSignalSpy spy(&local, &QModbusServer::dataWritten);
+
+        QVERIFY(local.setData(QModbusDataUnit(QModbusDataUnit::HoldingRegisters, 100,
+                                              QList<quint16>(10, 1))));
+        QVERIFY(local.setData(QModbusDataUnit(QModbusDataUnit::HoldingRegisters, 95,
+                                              QList<quint16>(10, 2))));
+        QVERIFY(local.setData(QModbusDataUnit::Coils, 3, 1));
+        QVERIFY(local.setData(QModbusDataUnit::HoldingRegisters, 0, 7));
+        QCOMPARE(spy.count(), 0);
+
+        QTRY_COMPARE(spy.count(), 3);
+        QCOMPARE(spy.at(0).at(0).value<QModbusDataUnit::RegisterType>(), QModbusDataUnit::Coils);
+        QCOMPARE(spy.at(0).at(1).toInt(), 3);
+        QCOMPARE(spy.at(0).at(2).toInt(), 1);
+        QCOMPARE(spy.at(1).at(1).toInt(), 0);
+        QCOMPARE(spy.at(1).at(2).toInt(), 1);
+        QCOMPARE(spy.at(2).at(1).toInt(), 95);
+        QCOMPARE(spy.at(2).at(2).toInt(), 15);
+
+        // switching back delivers pending notifications immediately
+        spy.clear();
+        QVERIFY(local.setData(QModbusDataUnit::HoldingRegisters, 1, 7));
+        local.setNotificationMode(QModbusServer::ImmediateNotification);
+        QCOMPARE(spy.count(), 1);
+        QVERIFY(local.setData(QModbusDataUnit::HoldingRegisters, 2, 7));
+        QCOMPARE(spy.count(), 2);
+    }
+
     void tst_serverAddress()
     {
         server.setServerAddress(56);
@@ -1312,6 +1507,15 @@ private slots:
         response = server.processRequest(QModbusRequest(QModbusPdu::EncapsulatedInterfaceTransport,
                 QByteArray::fromHex("0e0102")));
         QCOMPARE(response.data(), QByteArray::fromHex("0e01010000010205") + "V2.11");
+
+        response = server.processRequest(QModbusRequest(QModbusPdu::EncapsulatedInterfaceTransport,
+                QByteArray::fromHex("0e0402")));
+        QCOMPARE(response.data(), QByteArray::fromHex("0e04010000010205") + "V2.11");
+
+        response = server.processRequest(QModbusRequest(QModbusPdu::EncapsulatedInterfaceTransport,
+                QByteArray::fromHex("0e0405")));
+        QVERIFY(response.isException());
+        QCOMPARE(response.exceptionCode(), QModbusPdu::IllegalDataAddress);
     }
 };
 
@@ -0,0 +1,353 @@
+/****************************************************************************
+**
+** Copyright (C) 2021 The Qt Company Ltd.
+** Contact: http://www.qt.io/licensing/
+**
+** This file is part of the QtSerialBus module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL3$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see http://www.qt.io/terms-conditions. For further
+** information use the contact form at http://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPLv3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or later as published by the Free
+** Software Foundation and appearing in the file LICENSE.GPL included in
+** the packaging of this file. Please review the following information to
+** ensure the GNU General Public License version 2.0 requirements will be
+** met: http://www.gnu.org/licenses/gpl-2.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include <QtNetwork/qtcpserver.h>
+#include <QtNetwork/qtcpsocket.h>
+#include <QtSerialBus/qmodbustcpserver.h>
+#include <QtTest/QtTest>
+
+class Observer : public QModbusTcpConnectionObserver
+{
+public:
+    explicit Observer(QList<QTcpSocket *> *clients) : m_clients(clients) {}
+
+    bool acceptNewConnection(QTcpSocket *newClient) override
+    {
+        m_clients->append(newClient);
+        return true;
+    }
+
+private:
+    QList<QTcpSocket *> *m_clients;
+};
+
+class VirtualServer : public QModbusServer
+{
+public:
+    bool open() override
+    {
+        setState(QModbusDevice::ConnectedState);
+        return true;
+    }
+    void close() override { setState(QModbusDevice::UnconnectedState); }
+};
+
+class tst_QModbusTcpServer : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void maxConnections();
+    void idleTimeout();
+    void connectionStatistics();
+    void writeBufferWaterMarks();
+    void responseCoalescing();
+    void virtualServers();
+    void unitIdRouting();
+
+private:
+    // Three requests to read two holding registers, and the matching responses.
+    static QByteArray requests()
+    {
+        return QByteArray::fromHex("000100000006ff0300000002"
+                                   "000200000006ff0300000002"
+                                   "000300000006ff0300000002");
+    }
+    static QByteArray responses()
+    {
+        return QByteArray::fromHex("000100000007ff030400000000"
+                                   "000200000007ff030400000000"
+                                   "000300000007ff030400000000");
+    }
+
+    static bool listen(QModbusTcpServer *server, quint16 *port)
+    {
+        QModbusDataUnitMap map;
+        map.insert(QModbusDataUnit::HoldingRegisters, { QModbusDataUnit::HoldingRegisters, 0, 10 });
+        server->setMap(map);
+        server->setConnectionParameter(QModbusDevice::NetworkAddressParameter,
+                                       QStringLiteral("127.0.0.1"));
+        server->setConnectionParameter(QModbusDevice::NetworkPortParameter, 0);
+        if (!server->connectDevice())
+            return false;
+        // Port 0 lets the system pick a free port, ask the listening socket for it.
+        const QTcpServer *tcpServer = server->findChild<QTcpServer *>();
+        *port = tcpServer ? tcpServer->serverPort() : 0;
+        return *port != 0;
+    }
+};
+
+void tst_QModbusTcpServer::maxConnections()
+{
+    QModbusTcpServer server;
+    QCOMPARE(server.maxConnections(), 0);
+    server.setMaxConnections(2);
+    QCOMPARE(server.maxConnections(), 2);
+    server.setMaxConnections(-1);
+    QCOMPARE(server.maxConnections(), 0);
+    server.setMaxConnections(2);
+
+    quint16 port = 0;
+    QVERIFY(listen(&server, &port));
+
+    QTcpSocket clients[3];
+    for (int i = 0; i < 2; ++i) {
+        clients[i].connectToHost(QHostAddress::LocalHost, port);
+        QVERIFY(clients[i].waitForConnected());
+        QTRY_COMPARE(server.connectionCount(), i + 1);
+    }
+
+    // The third client is accepted by the system, then dropped by the server.
+    clients[2].connectToHost(QHostAddress::LocalHost, port);
+    QTRY_COMPARE(clients[2].state(), QAbstractSocket::UnconnectedState);
+    QCOMPARE(server.connectionCount(), 2);
+
+    // Closing a connection makes room for a new one.
+    clients[0].disconnectFromHost();
+    QTRY_COMPARE(server.connectionCount(), 1);
+    QTcpSocket client;
+    client.connectToHost(QHostAddress::LocalHost, port);
+    QVERIFY(client.waitForConnected());
+    QTRY_COMPARE(server.connectionCount(), 2);
+}
+
+void tst_QModbusTcpServer::idleTimeout()
+{
+    QModbusTcpServer server;
+    QCOMPARE(server.idleTimeout(), 0);
+    server.setIdleTimeout(100);
+    QCOMPARE(server.idleTimeout(), 100);
+
+    quint16 port = 0;
+    QVERIFY(listen(&server, &port));
+    QSignalSpy closedSpy(&server, &QModbusTcpServer::connectionClosed);
+
+    QTcpSocket client;
+    client.connectToHost(QHostAddress::LocalHost, port);
+    QVERIFY(client.waitForConnected());
+    QTRY_COMPARE(server.connectionCount(), 1);
+
+    // A silent client is closed by the server.
+    QTRY_COMPARE(client.state(), QAbstractSocket::UnconnectedState);
+    QTRY_COMPARE(closedSpy.count(), 1);
+    QCOMPARE(server.connectionCount(), 0);
+    const auto statistics = closedSpy.at(0).at(1).value<QModbusTcpConnectionStatistics>();
+    QVERIFY(statistics.idleMSecs >= 100);
+    QCOMPARE(statistics.requestsReceived, quint64(0));
+
+    // Disabling the timeout keeps silent clients connected.
+    server.setIdleTimeout(0);
+    QTcpSocket other;
+    other.connectToHost(QHostAddress::LocalHost, port);
+    QVERIFY(other.waitForConnected());
+    QTRY_COMPARE(server.connectionCount(), 1);
+    QTest::qWait(300);
+    QCOMPARE(server.connectionCount(), 1);
+    QCOMPARE(other.state(), QAbstractSocket::ConnectedState);
+}
+
+void tst_QModbusTcpServer::connectionStatistics()
+{
+    QModbusTcpServer server;
+    QList<QTcpSocket *> serverSockets;
+    server.installConnectionObserver(new Observer(&serverSockets));
+
+    quint16 port = 0;
+    QVERIFY(listen(&server, &port));
+    QSignalSpy closedSpy(&server, &QModbusTcpServer::connectionClosed);
+    QSignalSpy disconnectedSpy(&server, &QModbusTcpServer::modbusClientDisconnected);
+
+    QTcpSocket client;
+    client.connectToHost(QHostAddress::LocalHost, port);
+    QVERIFY(client.waitForConnected());
+    QTRY_COMPARE(serverSockets.size(), 1);
+    QTcpSocket *serverSocket = serverSockets.first();
+
+    // Statistics of a client that is not connected are empty.
+    QCOMPARE(server.connectionStatistics(nullptr).requestsReceived, quint64(0));
+
+    // Read two holding registers, the response carries four zero bytes.
+    const QByteArray request = QByteArray::fromHex("000100000006ff0300000002");
+    const QByteArray response = QByteArray::fromHex("000100000007ff030400000000");
+    QCOMPARE(client.write(request), qint64(request.size()));
+    QTRY_COMPARE(client.bytesAvailable(), qint64(response.size()));
+    QCOMPARE(client.readAll(), response);
+
+    QModbusTcpConnectionStatistics statistics = server.connectionStatistics(serverSocket);
+    QCOMPARE(statistics.bytesReceived, quint64(request.size()));
+    QCOMPARE(statistics.bytesSent, quint64(response.size()));
+    QCOMPARE(statistics.requestsReceived, quint64(1));
+    QCOMPARE(statistics.responsesSent, quint64(1));
+    QVERIFY(statistics.connectedMSecs >= statistics.idleMSecs);
+
+    client.disconnectFromHost();
+    QTRY_COMPARE(closedSpy.count(), 1);
+    QCOMPARE(disconnectedSpy.count(), 1);
+    QCOMPARE(closedSpy.at(0).at(0).value<QTcpSocket *>(), serverSocket);
+    statistics = closedSpy.at(0).at(1).value<QModbusTcpConnectionStatistics>();
+    QCOMPARE(statistics.bytesReceived, quint64(request.size()));
+    QCOMPARE(statistics.responsesSent, quint64(1));
+    QCOMPARE(server.connectionCount(), 0);
+}
+
+void tst_QModbusTcpServer::writeBufferWaterMarks()
+{
+    QModbusTcpServer server;
+    QCOMPARE(server.writeBufferLowWaterMark(), qint64(16 * 1024));
+    QCOMPARE(server.writeBufferHighWaterMark(), qint64(64 * 1024));
+
+    // The low-water mark is capped to the high-water mark, negative values become 0.
+    server.setWriteBufferWaterMarks(200, 100);
+    QCOMPARE(server.writeBufferLowWaterMark(), qint64(100));
+    QCOMPARE(server.writeBufferHighWaterMark(), qint64(100));
+    server.setWriteBufferWaterMarks(-1, -1);
+    QCOMPARE(server.writeBufferLowWaterMark(), qint64(0));
+    QCOMPARE(server.writeBufferHighWaterMark(), qint64(0));
+
+    // With a high-water mark of one byte, the server pauses after every response and
+    // only resumes once it has been written, so each response gets its own write.
+    server.setWriteBufferWaterMarks(0, 1);
+    QList<QTcpSocket *> serverSockets;
+    server.installConnectionObserver(new Observer(&serverSockets));
+    quint16 port = 0;
+    QVERIFY(listen(&server, &port));
+
+    QTcpSocket client;
+    client.connectToHost(QHostAddress::LocalHost, port);
+    QVERIFY(client.waitForConnected());
+    QTRY_COMPARE(serverSockets.size(), 1);
+    QSignalSpy writtenSpy(serverSockets.first(), &QTcpSocket::bytesWritten);
+
+    QCOMPARE(client.write(requests()), qint64(requests().size()));
+    QTRY_COMPARE(client.bytesAvailable(), qint64(responses().size()));
+    QCOMPARE(client.readAll(), responses());
+    QTRY_COMPARE(writtenSpy.count(), 3);
+    for (const QList<QVariant> &arguments : qAsConst(writtenSpy))
+        QCOMPARE(arguments.at(0).toLongLong(), qint64(responses().size() / 3));
+
+    const QModbusTcpConnectionStatistics statistics =
+            server.connectionStatistics(serverSockets.first());
+    QCOMPARE(statistics.requestsReceived, quint64(3));
+    QCOMPARE(statistics.responsesSent, quint64(3));
+}
+
+void tst_QModbusTcpServer::responseCoalescing()
+{
+    QModbusTcpServer server;
+    QList<QTcpSocket *> serverSockets;
+    server.installConnectionObserver(new Observer(&serverSockets));
+    quint16 port = 0;
+    QVERIFY(listen(&server, &port));
+
+    QTcpSocket client;
+    client.connectToHost(QHostAddress::LocalHost, port);
+    QVERIFY(client.waitForConnected());
+    QTRY_COMPARE(serverSockets.size(), 1);
+    QSignalSpy writtenSpy(serverSockets.first(), &QTcpSocket::bytesWritten);
+
+    // All requests that arrive with one read are answered with a single write.
+    QCOMPARE(client.write(requests()), qint64(requests().size()));
+    QTRY_COMPARE(client.bytesAvailable(), qint64(responses().size()));
+    QCOMPARE(client.readAll(), responses());
+    QCOMPARE(writtenSpy.count(), 1);
+    QCOMPARE(writtenSpy.at(0).at(0).toLongLong(), qint64(responses().size()));
+
+    const QModbusTcpConnectionStatistics statistics =
+            server.connectionStatistics(serverSockets.first());
+    QCOMPARE(statistics.requestsReceived, quint64(3));
+    QCOMPARE(statistics.responsesSent, quint64(3));
+    QCOMPARE(statistics.bytesSent, quint64(responses().size()));
+}
+
+void tst_QModbusTcpServer::virtualServers()
+{
+    QModbusTcpServer server;
+    QVERIFY(!server.virtualServer(5));
+    QVERIFY(!server.virtualServer(-1));
+    QVERIFY(!server.virtualServer(256));
+
+    auto *virtualServer = new VirtualServer;
+    server.setVirtualServer(5, virtualServer);
+    QCOMPARE(server.virtualServer(5), static_cast<QModbusServer *>(virtualServer));
+
+    QTest::ignoreMessage(QtWarningMsg, "(TCP server) Invalid unit identifier: 256");
+    server.setVirtualServer(256, virtualServer);
+    QVERIFY(!server.virtualServer(256));
+
+    server.setVirtualServer(5, nullptr);
+    QVERIFY(!server.virtualServer(5));
+
+    // Deleting a virtual server removes its route.
+    server.setVirtualServer(6, virtualServer);
+    delete virtualServer;
+    QVERIFY(!server.virtualServer(6));
+}
+
+void tst_QModbusTcpServer::unitIdRouting()
+{
+    QModbusTcpServer server;
+    quint16 port = 0;
+    QVERIFY(listen(&server, &port));
+
+    VirtualServer virtualServer;
+    QModbusDataUnitMap map;
+    map.insert(QModbusDataUnit::HoldingRegisters,
+               { QModbusDataUnit::HoldingRegisters, 0, QList<quint16> { 42 } });
+    virtualServer.setMap(map);
+    server.setVirtualServer(5, &virtualServer);
+
+    QTcpSocket client;
+    client.connectToHost(QHostAddress::LocalHost, port);
+    QVERIFY(client.waitForConnected());
+
+    // Unit 5 is answered from the virtual server's map, unit 255 from the listening
+    // server's own map, unit 7 has no route and is ignored. The virtual server is a plain
+    // QModbusServer, yet the serial line only Report Server ID request is refused.
+    const QByteArray request = QByteArray::fromHex("000100000006050300000001"
+                                                   "000200000006ff0300000001"
+                                                   "000300000006070300000001"
+                                                   "0004000000020511");
+    const QByteArray response = QByteArray::fromHex("000100000005050302002a"
+                                                    "000200000005ff03020000"
+                                                    "000400000003059101");
+    QCOMPARE(client.write(request), qint64(request.size()));
+    QTRY_COMPARE(client.bytesAvailable(), qint64(response.size()));
+    QCOMPARE(client.readAll(), response);
+}
+
+QTEST_MAIN(tst_QModbusTcpServer)
+
+#include "tst_qmodbustcpserver.moc"
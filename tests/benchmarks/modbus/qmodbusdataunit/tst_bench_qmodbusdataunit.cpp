@@ -0,0 +1,128 @@
+/****************************************************************************
+**
+** Copyright (C) 2021 The Qt Company Ltd.
+** Contact: http://www.qt.io/licensing/
+**
+** This file is part of the QtSerialBus module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL3$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see http://www.qt.io/terms-conditions. For further
+** information use the contact form at http://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPLv3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or later as published by the Free
+** Software Foundation and appearing in the file LICENSE.GPL included in
+** the packaging of this file. Please review the following information to
+** ensure the GNU General Public License version 2.0 requirements will be
+** met: http://www.gnu.org/licenses/gpl-2.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include <QtSerialBus/qmodbusdataunit.h>
+
+#include <QtCore/qendian.h>
+#include <QtTest/QtTest>
+
+// Per value conversion as applications hand-roll it, kept as a baseline.
+static QList<float> scalarFloats(const QList<quint16> &registers, bool wordSwap)
+{
+    QList<float> result;
+    result.reserve(registers.size() / 2);
+    for (qsizetype i = 0; i + 1 < registers.size(); i += 2) {
+        const quint32 high = wordSwap ? registers.at(i + 1) : registers.at(i);
+        const quint32 low = wordSwap ? registers.at(i) : registers.at(i + 1);
+        const quint32 bits = high << 16 | low;
+        float value;
+        memcpy(&value, &bits, sizeof(value));
+        result.append(value);
+    }
+    return result;
+}
+
+class tst_QModbusDataUnitBenchmark : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void decodeFloats_data();
+    void decodeFloats();
+    void encodeDoubles_data();
+    void encodeDoubles();
+};
+
+void tst_QModbusDataUnitBenchmark::decodeFloats_data()
+{
+    QTest::addColumn<bool>("scalar");
+    QTest::addColumn<int>("registers");
+
+    for (int registers : { 2, 16, 124 }) {
+        QTest::addRow("scalar/%d", registers) << true << registers;
+        QTest::addRow("valuesAs/%d", registers) << false << registers;
+    }
+}
+
+void tst_QModbusDataUnitBenchmark::decodeFloats()
+{
+    QFETCH(bool, scalar);
+    QFETCH(int, registers);
+
+    QList<quint16> values(registers);
+    for (int i = 0; i < registers; ++i)
+        values[i] = quint16(0x3f80 + i);
+    const QModbusDataUnit unit(QModbusDataUnit::HoldingRegisters, 0, values);
+
+    QList<float> floats;
+    if (scalar) {
+        QBENCHMARK {
+            floats = scalarFloats(unit.values(), false);
+        }
+    } else {
+        QBENCHMARK {
+            floats = unit.valuesAs<float>();
+        }
+    }
+    QCOMPARE(floats, scalarFloats(values, false));
+}
+
+void tst_QModbusDataUnitBenchmark::encodeDoubles_data()
+{
+    QTest::addColumn<int>("count");
+
+    for (int count : { 1, 8, 31 })
+        QTest::addRow("%d", count) << count;
+}
+
+void tst_QModbusDataUnitBenchmark::encodeDoubles()
+{
+    QFETCH(int, count);
+
+    QList<double> doubles(count);
+    for (int i = 0; i < count; ++i)
+        doubles[i] = i * 0.5;
+
+    QModbusDataUnit unit(QModbusDataUnit::HoldingRegisters, 0, 0);
+    QBENCHMARK {
+        unit.setValuesFrom(doubles, QModbusDataUnit::LittleEndianByteSwap);
+    }
+    QCOMPARE(unit.valuesAs<double>(QModbusDataUnit::LittleEndianByteSwap), doubles);
+}
+
+QTEST_MAIN(tst_QModbusDataUnitBenchmark)
+
+#include "tst_bench_qmodbusdataunit.moc"
@@ -0,0 +1,162 @@
+/****************************************************************************
+**
+** Copyright (C) 2021 The Qt Company Ltd.
+** Contact: http://www.qt.io/licensing/
+**
+** This file is part of the QtSerialBus module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL3$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see http://www.qt.io/terms-conditions. For further
+** information use the contact form at http://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPLv3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or later as published by the Free
+** Software Foundation and appearing in the file LICENSE.GPL included in
+** the packaging of this file. Please review the following information to
+** ensure the GNU General Public License version 2.0 requirements will be
+** met: http://www.gnu.org/licenses/gpl-2.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include <QtSerialBus/qmodbuspdu.h>
+
+#include <QtCore/qdatastream.h>
+#include <QtTest/QtTest>
+
+// The QDataStream based encoding QModbusPdu used previously, kept as a baseline.
+static QByteArray streamEncode(quint16 address, quint16 count)
+{
+    QByteArray data;
+    QDataStream stream(&data, QIODevice::WriteOnly);
+    stream << address << count;
+    return data;
+}
+
+static QByteArray streamEncode(quint8 byteCount, const QList<quint16> &values)
+{
+    QByteArray data;
+    QDataStream stream(&data, QIODevice::WriteOnly);
+    stream << byteCount;
+    for (quint16 value : values)
+        stream << value;
+    return data;
+}
+
+class tst_QModbusPduBenchmark : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void encodeRequest_data();
+    void encodeRequest();
+    void decodeRequest_data();
+    void decodeRequest();
+    void encodeRegisterResponse_data();
+    void encodeRegisterResponse();
+};
+
+void tst_QModbusPduBenchmark::encodeRequest_data()
+{
+    QTest::addColumn<bool>("dataStream");
+    QTest::newRow("QDataStream") << true;
+    QTest::newRow("QModbusPdu") << false;
+}
+
+void tst_QModbusPduBenchmark::encodeRequest()
+{
+    QFETCH(bool, dataStream);
+
+    quint16 address = 0;
+    if (dataStream) {
+        QBENCHMARK {
+            const QModbusRequest request(QModbusRequest::ReadHoldingRegisters,
+                                         streamEncode(++address, quint16(10)));
+            Q_UNUSED(request);
+        }
+    } else {
+        QBENCHMARK {
+            const QModbusRequest request(QModbusRequest::ReadHoldingRegisters, ++address,
+                                         quint16(10));
+            Q_UNUSED(request);
+        }
+    }
+}
+
+void tst_QModbusPduBenchmark::decodeRequest_data()
+{
+    encodeRequest_data();
+}
+
+void tst_QModbusPduBenchmark::decodeRequest()
+{
+    QFETCH(bool, dataStream);
+
+    const QModbusRequest request(QModbusRequest::ReadWriteMultipleRegisters,
+                                 QByteArray::fromHex("00030006000e000306ff00ff00ff00"));
+    quint16 readAddress = 0, readCount = 0, writeAddress = 0, writeCount = 0;
+    quint8 byteCount = 0;
+    if (dataStream) {
+        QBENCHMARK {
+            QDataStream stream(request.data());
+            stream >> readAddress >> readCount >> writeAddress >> writeCount >> byteCount;
+        }
+    } else {
+        QBENCHMARK {
+            request.decodeData(&readAddress, &readCount, &writeAddress, &writeCount, &byteCount);
+        }
+    }
+    QCOMPARE(readAddress, quint16(3));
+    QCOMPARE(byteCount, quint8(6));
+}
+
+void tst_QModbusPduBenchmark::encodeRegisterResponse_data()
+{
+    QTest::addColumn<bool>("dataStream");
+    QTest::addColumn<int>("registers");
+
+    for (int registers : { 1, 16, 125 }) {
+        QTest::addRow("QDataStream/%d", registers) << true << registers;
+        QTest::addRow("QModbusPdu/%d", registers) << false << registers;
+    }
+}
+
+void tst_QModbusPduBenchmark::encodeRegisterResponse()
+{
+    QFETCH(bool, dataStream);
+    QFETCH(int, registers);
+
+    const QList<quint16> values(registers, 0xabcd);
+    if (dataStream) {
+        QBENCHMARK {
+            const QModbusResponse response(QModbusResponse::ReadHoldingRegisters,
+                                           streamEncode(quint8(registers * 2), values));
+            Q_UNUSED(response);
+        }
+    } else {
+        QBENCHMARK {
+            const QModbusResponse response(QModbusResponse::ReadHoldingRegisters,
+                                           quint8(registers * 2), values);
+            Q_UNUSED(response);
+        }
+    }
+}
+
+QTEST_MAIN(tst_QModbusPduBenchmark)
+
+#include "tst_bench_qmodbuspdu.moc"
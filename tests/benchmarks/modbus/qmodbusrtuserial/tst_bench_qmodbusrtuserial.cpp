@@ -0,0 +1,113 @@
+/****************************************************************************
+**
+** Copyright (C) 2021 The Qt Company Ltd.
+** Contact: http://www.qt.io/licensing/
+**
+** This file is part of the QtSerialBus module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL3$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see http://www.qt.io/terms-conditions. For further
+** information use the contact form at http://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPLv3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or later as published by the Free
+** Software Foundation and appearing in the file LICENSE.GPL included in
+** the packaging of this file. Please review the following information to
+** ensure the GNU General Public License version 2.0 requirements will be
+** met: http://www.gnu.org/licenses/gpl-2.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include "../shared/modbusbenchmark.h"
+#include "../../../shared/ptybridge.h"
+
+#include <QtSerialBus/qmodbusrtuserialmaster.h>
+#include <QtSerialBus/qmodbusrtuserialslave.h>
+
+#include <QtSerialPort/qserialport.h>
+#include <QtTest/QtTest>
+
+class tst_QModbusRtuSerialBenchmark : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+
+    void roundTrip_data();
+    void roundTrip();
+
+private:
+    PtyBridge m_bridge;
+    QModbusRtuSerialSlave m_slave;
+    QModbusRtuSerialMaster m_master;
+};
+
+void tst_QModbusRtuSerialBenchmark::initTestCase()
+{
+    if (!m_bridge.open())
+        QSKIP("Cannot allocate pseudo-terminals.");
+
+    m_slave.setServerAddress(1);
+    QVERIFY(m_slave.setMap(ModbusBenchmark::registerMap()));
+    m_slave.setConnectionParameter(QModbusDevice::SerialPortNameParameter, m_bridge.portName(0));
+    m_slave.setConnectionParameter(QModbusDevice::SerialBaudRateParameter, QSerialPort::Baud115200);
+    QVERIFY(m_slave.connectDevice());
+
+    m_master.setTimeout(1000);
+    m_master.setNumberOfRetries(0);
+    m_master.setConnectionParameter(QModbusDevice::SerialPortNameParameter, m_bridge.portName(1));
+    m_master.setConnectionParameter(QModbusDevice::SerialBaudRateParameter, QSerialPort::Baud115200);
+    QVERIFY(m_master.connectDevice());
+    QTRY_COMPARE(m_master.state(), QModbusDevice::ConnectedState);
+
+    m_bridge.start();
+}
+
+void tst_QModbusRtuSerialBenchmark::cleanupTestCase()
+{
+    m_master.disconnectDevice();
+    m_slave.disconnectDevice();
+}
+
+void tst_QModbusRtuSerialBenchmark::roundTrip_data()
+{
+    ModbusBenchmark::addFunctionCodeRows(500);
+}
+
+void tst_QModbusRtuSerialBenchmark::roundTrip()
+{
+    QFETCH(int, functionCode);
+    QFETCH(int, depth);
+    QFETCH(int, transactions);
+
+    ModbusBenchmark::Result result;
+    QBENCHMARK_ONCE {
+        result = ModbusBenchmark::run(&m_master, QModbusPdu::FunctionCode(functionCode), 1,
+                                      transactions, depth);
+    }
+    ModbusBenchmark::report(result);
+    QCOMPARE(result.failed, 0);
+    QCOMPARE(result.completed, transactions);
+}
+
+QTEST_MAIN(tst_QModbusRtuSerialBenchmark)
+
+#include "tst_bench_qmodbusrtuserial.moc"
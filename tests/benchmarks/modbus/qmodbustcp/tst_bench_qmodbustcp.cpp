@@ -0,0 +1,114 @@
+/****************************************************************************
+**
+** Copyright (C) 2021 The Qt Company Ltd.
+** Contact: http://www.qt.io/licensing/
+**
+** This file is part of the QtSerialBus module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL3$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see http://www.qt.io/terms-conditions. For further
+** information use the contact form at http://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPLv3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or later as published by the Free
+** Software Foundation and appearing in the file LICENSE.GPL included in
+** the packaging of this file. Please review the following information to
+** ensure the GNU General Public License version 2.0 requirements will be
+** met: http://www.gnu.org/licenses/gpl-2.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include "../shared/modbusbenchmark.h"
+
+#include <QtSerialBus/qmodbustcpclient.h>
+#include <QtSerialBus/qmodbustcpserver.h>
+
+#include <QtNetwork/qtcpserver.h>
+#include <QtTest/QtTest>
+
+class tst_QModbusTcpBenchmark : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+
+    void roundTrip_data();
+    void roundTrip();
+
+private:
+    QModbusTcpServer m_server;
+    QModbusTcpClient m_client;
+};
+
+void tst_QModbusTcpBenchmark::initTestCase()
+{
+    // Find a free port on the loopback interface.
+    QTcpServer probe;
+    QVERIFY(probe.listen(QHostAddress::LocalHost));
+    const quint16 port = probe.serverPort();
+    probe.close();
+
+    m_server.setServerAddress(1);
+    QVERIFY(m_server.setMap(ModbusBenchmark::registerMap()));
+    m_server.setConnectionParameter(QModbusDevice::NetworkAddressParameter,
+                                    QStringLiteral("127.0.0.1"));
+    m_server.setConnectionParameter(QModbusDevice::NetworkPortParameter, port);
+    QVERIFY(m_server.connectDevice());
+
+    m_client.setTimeout(5000);
+    m_client.setNumberOfRetries(0);
+    m_client.setConnectionParameter(QModbusDevice::NetworkAddressParameter,
+                                    QStringLiteral("127.0.0.1"));
+    m_client.setConnectionParameter(QModbusDevice::NetworkPortParameter, port);
+    QVERIFY(m_client.connectDevice());
+    QTRY_COMPARE(m_client.state(), QModbusDevice::ConnectedState);
+}
+
+void tst_QModbusTcpBenchmark::cleanupTestCase()
+{
+    m_client.disconnectDevice();
+    m_server.disconnectDevice();
+}
+
+void tst_QModbusTcpBenchmark::roundTrip_data()
+{
+    ModbusBenchmark::addFunctionCodeRows(10000);
+}
+
+void tst_QModbusTcpBenchmark::roundTrip()
+{
+    QFETCH(int, functionCode);
+    QFETCH(int, depth);
+    QFETCH(int, transactions);
+
+    ModbusBenchmark::Result result;
+    QBENCHMARK_ONCE {
+        result = ModbusBenchmark::run(&m_client, QModbusPdu::FunctionCode(functionCode), 1,
+                                      transactions, depth);
+    }
+    ModbusBenchmark::report(result);
+    QCOMPARE(result.failed, 0);
+    QCOMPARE(result.completed, transactions);
+}
+
+QTEST_MAIN(tst_QModbusTcpBenchmark)
+
+#include "tst_bench_qmodbustcp.moc"
@@ -0,0 +1,215 @@
+/****************************************************************************
+**
+** Copyright (C) 2021 The Qt Company Ltd.
+** Contact: http://www.qt.io/licensing/
+**
+** This file is part of the QtSerialBus module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL3$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see http://www.qt.io/terms-conditions. For further
+** information use the contact form at http://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPLv3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or later as published by the Free
+** Software Foundation and appearing in the file LICENSE.GPL included in
+** the packaging of this file. Please review the following information to
+** ensure the GNU General Public License version 2.0 requirements will be
+** met: http://www.gnu.org/licenses/gpl-2.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#ifndef MODBUSBENCHMARK_H
+#define MODBUSBENCHMARK_H
+
+#include <QtSerialBus/qmodbusclient.h>
+#include <QtSerialBus/qmodbusreply.h>
+#include <QtSerialBus/qmodbusserver.h>
+
+#include <QtCore/qelapsedtimer.h>
+#include <QtCore/qeventloop.h>
+#include <QtCore/qtimer.h>
+#include <QtTest/QtTest>
+
+#include <algorithm>
+#include <functional>
+#include <vector>
+
+namespace ModbusBenchmark {
+
+static constexpr int MapSize = 1000;
+
+inline QModbusDataUnitMap registerMap()
+{
+    QModbusDataUnitMap map;
+    map.insert(QModbusDataUnit::Coils, { QModbusDataUnit::Coils, 0, MapSize });
+    map.insert(QModbusDataUnit::DiscreteInputs, { QModbusDataUnit::DiscreteInputs, 0, MapSize });
+    map.insert(QModbusDataUnit::InputRegisters, { QModbusDataUnit::InputRegisters, 0, MapSize });
+    map.insert(QModbusDataUnit::HoldingRegisters, { QModbusDataUnit::HoldingRegisters, 0, MapSize });
+    return map;
+}
+
+inline void addFunctionCodeRows(int transactions)
+{
+    QTest::addColumn<int>("functionCode");
+    QTest::addColumn<int>("depth");
+    QTest::addColumn<int>("transactions");
+
+    const QList<QPair<const char *, QModbusPdu::FunctionCode>> codes = {
+        { "ReadCoils", QModbusPdu::ReadCoils },
+        { "ReadDiscreteInputs", QModbusPdu::ReadDiscreteInputs },
+        { "ReadHoldingRegisters", QModbusPdu::ReadHoldingRegisters },
+        { "ReadInputRegisters", QModbusPdu::ReadInputRegisters },
+        { "WriteSingleCoil", QModbusPdu::WriteSingleCoil },
+        { "WriteSingleRegister", QModbusPdu::WriteSingleRegister },
+        { "WriteMultipleCoils", QModbusPdu::WriteMultipleCoils },
+        { "WriteMultipleRegisters", QModbusPdu::WriteMultipleRegisters },
+        { "ReadWriteMultipleRegisters", QModbusPdu::ReadWriteMultipleRegisters }
+    };
+    for (const auto &code : codes) {
+        QTest::addRow("%s/sequential", code.first) << int(code.second) << 1 << transactions;
+        QTest::addRow("%s/pipelined", code.first) << int(code.second) << 16 << transactions;
+    }
+}
+
+inline QModbusReply *sendRequest(QModbusClient *client, QModbusPdu::FunctionCode code,
+                                 int serverAddress, int sequence)
+{
+    const int address = (sequence * 8) % (MapSize - 125);
+    switch (code) {
+    case QModbusPdu::ReadCoils:
+        return client->sendReadRequest({ QModbusDataUnit::Coils, address, 64 }, serverAddress);
+    case QModbusPdu::ReadDiscreteInputs:
+        return client->sendReadRequest({ QModbusDataUnit::DiscreteInputs, address, 64 },
+                                       serverAddress);
+    case QModbusPdu::ReadHoldingRegisters:
+        return client->sendReadRequest({ QModbusDataUnit::HoldingRegisters, address, 125 },
+                                       serverAddress);
+    case QModbusPdu::ReadInputRegisters:
+        return client->sendReadRequest({ QModbusDataUnit::InputRegisters, address, 125 },
+                                       serverAddress);
+    case QModbusPdu::WriteSingleCoil:
+        return client->sendWriteRequest({ QModbusDataUnit::Coils, address,
+                                          QList<quint16>{ quint16(sequence & 1) } }, serverAddress);
+    case QModbusPdu::WriteSingleRegister:
+        return client->sendWriteRequest({ QModbusDataUnit::HoldingRegisters, address,
+                                          QList<quint16>{ quint16(sequence) } }, serverAddress);
+    case QModbusPdu::WriteMultipleCoils:
+        return client->sendWriteRequest({ QModbusDataUnit::Coils, address,
+                                          QList<quint16>(64, quint16(sequence & 1)) },
+                                        serverAddress);
+    case QModbusPdu::WriteMultipleRegisters:
+        return client->sendWriteRequest({ QModbusDataUnit::HoldingRegisters, address,
+                                          QList<quint16>(123, quint16(sequence)) }, serverAddress);
+    case QModbusPdu::ReadWriteMultipleRegisters:
+        return client->sendReadWriteRequest({ QModbusDataUnit::HoldingRegisters, address, 64 },
+                                            { QModbusDataUnit::HoldingRegisters, address,
+                                              QList<quint16>(64, quint16(sequence)) },
+                                            serverAddress);
+    default:
+        break;
+    }
+    return nullptr;
+}
+
+struct Result
+{
+    int completed = 0;
+    int failed = 0;
+    qint64 elapsedNSecs = 0;
+    std::vector<qint64> latencies; // nanoseconds, one per completed transaction
+
+    double requestsPerSecond() const
+    {
+        return elapsedNSecs > 0 ? completed * 1e9 / elapsedNSecs : 0.;
+    }
+
+    qint64 percentile(double p)
+    {
+        if (latencies.empty())
+            return 0;
+        const size_t index = std::min(latencies.size() - 1, size_t(p * latencies.size()));
+        std::nth_element(latencies.begin(), latencies.begin() + index, latencies.end());
+        return latencies[index];
+    }
+};
+
+/*
+    Runs \a transactions requests of the given function code against the
+    server, keeping at most \a depth requests in flight. A depth of 1 waits for
+    each reply before sending the next request.
+*/
+inline Result run(QModbusClient *client, QModbusPdu::FunctionCode code, int serverAddress,
+                  int transactions, int depth)
+{
+    Result result;
+    result.latencies.reserve(size_t(transactions));
+
+    QEventLoop loop;
+    QElapsedTimer clock;
+    int sent = 0;
+
+    // A request the client refuses to send counts as failed and the next one is
+    // tried right away, so the loop still ends after \a transactions attempts.
+    std::function<void()> sendNext;
+    sendNext = [&]() {
+        while (sent < transactions) {
+            const int sequence = sent++;
+            const qint64 start = clock.nsecsElapsed();
+            QModbusReply *reply = sendRequest(client, code, serverAddress, sequence);
+            if (!reply) {
+                ++result.failed;
+                continue;
+            }
+            QObject::connect(reply, &QModbusReply::finished, &loop, [&, reply, start]() {
+                if (reply->error() == QModbusDevice::NoError) {
+                    ++result.completed;
+                    result.latencies.push_back(clock.nsecsElapsed() - start);
+                } else {
+                    ++result.failed;
+                }
+                reply->deleteLater();
+                sendNext();
+            });
+            return;
+        }
+        if (result.completed + result.failed == transactions)
+            loop.quit();
+    };
+
+    QTimer::singleShot(60000, &loop, &QEventLoop::quit); // watchdog
+    clock.start();
+    for (int i = 0; i < qMin(depth, transactions); ++i)
+        sendNext();
+    if (result.completed + result.failed < transactions)
+        loop.exec();
+    result.elapsedNSecs = clock.nsecsElapsed();
+    return result;
+}
+
+inline void report(Result &result)
+{
+    qInfo().noquote() << QString::asprintf("%d transactions (%d failed): %.0f req/s, "
+        "latency p50 %.1f us, p99 %.1f us", result.completed, result.failed,
+        result.requestsPerSecond(), result.percentile(0.50) / 1000.,
+        result.percentile(0.99) / 1000.);
+}
+
+} // namespace ModbusBenchmark
+
+#endif // MODBUSBENCHMARK_H
@@ -0,0 +1,73 @@
+/****************************************************************************
+**
+** Copyright (C) 2021 The Qt Company Ltd.
+** Contact: http://www.qt.io/licensing/
+**
+** This file is part of the QtSerialBus module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL3$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see http://www.qt.io/terms-conditions. For further
+** information use the contact form at http://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPLv3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or later as published by the Free
+** Software Foundation and appearing in the file LICENSE.GPL included in
+** the packaging of this file. Please review the following information to
+** ensure the GNU General Public License version 2.0 requirements will be
+** met: http://www.gnu.org/licenses/gpl-2.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#ifndef LOOPBACKCANBUSDEVICE_H
+#define LOOPBACKCANBUSDEVICE_H
+
+#include <QtSerialBus/qcanbusdevice.h>
+
+/*
+    A CAN bus device without hardware for the channel tests. Written frames are
+    recorded and, if a peer is set, received by the peer right away, so two
+    devices act as the two nodes of a bus.
+*/
+class LoopbackCanBusDevice : public QCanBusDevice
+{
+public:
+    bool open() override
+    {
+        setState(QCanBusDevice::ConnectedState);
+        return true;
+    }
+    void close() override { setState(QCanBusDevice::UnconnectedState); }
+
+    bool writeFrame(const QCanBusFrame &frame) override
+    {
+        written.append(frame);
+        if (peer)
+            peer->enqueueReceivedFrames({ frame });
+        return true;
+    }
+
+    QString interpretErrorFrame(const QCanBusFrame &) override { return QString(); }
+
+    void receive(const QCanBusFrame &frame) { enqueueReceivedFrames({ frame }); }
+
+    LoopbackCanBusDevice *peer = nullptr;
+    QList<QCanBusFrame> written;
+};
+
+#endif // LOOPBACKCANBUSDEVICE_H
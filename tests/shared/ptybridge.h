@@ -0,0 +1,121 @@
+/****************************************************************************
+**
+** Copyright (C) 2021 The Qt Company Ltd.
+** Contact: http://www.qt.io/licensing/
+**
+** This file is part of the QtSerialBus module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL3$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see http://www.qt.io/terms-conditions. For further
+** information use the contact form at http://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPLv3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or later as published by the Free
+** Software Foundation and appearing in the file LICENSE.GPL included in
+** the packaging of this file. Please review the following information to
+** ensure the GNU General Public License version 2.0 requirements will be
+** met: http://www.gnu.org/licenses/gpl-2.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#ifndef PTYBRIDGE_H
+#define PTYBRIDGE_H
+
+#include <QtCore/qobject.h>
+#include <QtCore/qsocketnotifier.h>
+#include <QtCore/qstring.h>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+/*
+    Connects two pseudo-terminals back to back: bytes written to the slave side
+    of one terminal show up on the slave side of the other, like a null-modem
+    cable between two serial ports.
+*/
+class PtyBridge : public QObject
+{
+public:
+    ~PtyBridge()
+    {
+        for (const End &end : m_ends) {
+            if (end.master >= 0)
+                ::close(end.master);
+        }
+    }
+
+    bool open()
+    {
+        for (End &end : m_ends) {
+            end.master = ::posix_openpt(O_RDWR | O_NOCTTY);
+            if (end.master < 0 || ::grantpt(end.master) != 0 || ::unlockpt(end.master) != 0)
+                return false;
+            ::fcntl(end.master, F_SETFL, ::fcntl(end.master, F_GETFL) | O_NONBLOCK);
+            end.portName = QString::fromLocal8Bit(::ptsname(end.master));
+        }
+        return true;
+    }
+
+    // Must be called once both serial ports are open, an unused pty reports hang-up.
+    void start()
+    {
+        for (int i = 0; i < 2; ++i) {
+            auto notifier = new QSocketNotifier(m_ends[i].master, QSocketNotifier::Read, this);
+            connect(notifier, &QSocketNotifier::activated, this, [this, i]() { forward(i, 1 - i); });
+        }
+    }
+
+    QString portName(int index) const { return m_ends[index].portName; }
+
+private:
+    void forward(int from, int to)
+    {
+        char buffer[4096];
+        for (;;) {
+            const ssize_t read = ::read(m_ends[from].master, buffer, sizeof(buffer));
+            if (read <= 0)
+                return;
+            for (ssize_t written = 0; written < read; ) {
+                const ssize_t result = ::write(m_ends[to].master, buffer + written,
+                                               size_t(read - written));
+                if (result >= 0) {
+                    written += result;
+                } else if (errno == EAGAIN) {
+                    // The receiving side is full, wait until it drained some bytes.
+                    pollfd fd = { m_ends[to].master, POLLOUT, 0 };
+                    const int ready = ::poll(&fd, 1, 1000);
+                    if (ready == 0 || (ready < 0 && errno != EINTR))
+                        return;
+                } else if (errno != EINTR) {
+                    return;
+                }
+            }
+        }
+    }
+
+    struct End {
+        int master = -1;
+        QString portName;
+    } m_ends[2];
+};
+
+#endif // PTYBRIDGE_H